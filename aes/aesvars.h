@@ -17,7 +17,7 @@
 extern AESPD    *rlr;
 
 extern AESPD    *drl, *nrl;
-extern EVB      *eul, *dlr, *zlr;
+extern EVB      *eul, *zlr;
 
 /* Convert an EVB list root pointer to a fake EVB,
  * as if it was the e_link field of the struct.
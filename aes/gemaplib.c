@@ -35,6 +35,7 @@
 #include "gemasm.h"
 #include "gemdisp.h"
 #include "gemaplib.h"
+#include "gemqueue.h"
 #include "gsx2.h"
 #include "funcdef.h"
 #include "intmath.h"
@@ -76,6 +77,7 @@ WORD ap_rdwr(WORD code, AESPD *p, WORD length, WORD *pbuff)
      */
     if ((code == MU_MESAG) && (p->p_qindex == length) && (length == 16))
     {
+        qstats_read(p, length);
         memcpy(pbuff, p->p_qaddr, p->p_qindex);
         p->p_qindex = 0;
         return 1;       /* non-zero means it worked */
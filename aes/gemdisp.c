@@ -33,8 +33,12 @@
 #include "gemasm.h"
 #include "optimize.h"
 #include "gemdosif.h"
+#include "gemevlib.h"
 
 #include "asm.h"
+#if CONF_WITH_AES_SCHED_STATS
+#include "cookie.h"
+#endif
 
 #define KEYMASK 0xffff0000L             /* for comparing data to KEYSTOP */
 #define KEYSTOP 0x2b1c0000L             /* control-backslash */
@@ -69,10 +73,65 @@ WORD forkq(FCODE fcode, LONG fdata)
 }
 
 
+#if CONF_WITH_AES_SCHED_STATS
+static SCHEDINFO schedinfo;
+
+/*
+ * reset the scheduling statistics & publish them via the cookie jar
+ *
+ * called at each AES startup, after the AESPDs have been initialised
+ */
+void sched_init(void)
+{
+    ULONG dummy;
+
+    bzero(&schedinfo, sizeof(SCHEDINFO));
+    schedinfo.si_npds = totpds;
+    schedinfo.si_statsize = sizeof(SCHEDSTAT);
+
+    if (!cookie_get(COOKIE_AESS, &dummy))
+        cookie_add(COOKIE_AESS, (ULONG)&schedinfo);
+}
+
+static void sched_wait_start(AESPD *p)
+{
+    SCHEDSTAT *s = &schedinfo.si_pd[p->p_pid];
+
+    s->s_waits++;
+    s->s_waitstart = ABS_TICK;
+    s->s_waiting = TRUE;
+}
+
+static void sched_wait_end(AESPD *p)
+{
+    SCHEDSTAT *s = &schedinfo.si_pd[p->p_pid];
+
+    if (s->s_waiting)
+    {
+        s->s_waitms += (ABS_TICK - s->s_waitstart) * gl_ticktime;
+        s->s_waiting = FALSE;
+    }
+}
+
+static void sched_switch(AESPD *p)
+{
+    SCHEDSTAT *s = &schedinfo.si_pd[p->p_pid];
+
+    s->s_switches++;
+    memcpy(s->s_name, p->p_name, AP_NAMELEN);
+}
+#else
+#define sched_wait_start(p)
+#define sched_wait_end(p)
+#define sched_switch(p)
+#endif
+
+
 static void disp_act(AESPD *p)
 {
     /* process is ready, so put him on RLR */
     p->p_stat &= ~WAITIN;
+    sched_wait_end(p);
     insert_process(p, &rlr);
 }
 
@@ -87,6 +146,7 @@ static void mwait_act(AESPD *p)
         /* good night, Mrs. Calabash, wherever you are */
         p->p_link = nrl;
         nrl = p;
+        sched_wait_start(p);
     }
 }
 
@@ -117,6 +177,10 @@ void forker(void)
             fph = 0;
         enable_interrupts();
 
+#if CONF_WITH_AES_SCHED_STATS
+        schedinfo.si_forks++;
+#endif
+
         /* see if recording */
         if (gl_recd)
         {
@@ -176,13 +240,19 @@ void chkkbd(void)
 }
 
 
+/*
+ * run through lists until someone is on the rlr or the fork list
+ *
+ * nothing can become ready except as a consequence of an interrupt: the
+ * tick handler forks tchange() only when the earliest timer deadline is
+ * reached, and the other handlers fork button/mouse changes.  so when
+ * there is nothing to do, we can sleep until the next interrupt instead
+ * of spinning.
+ */
 static void schedule(void)
 {
     AESPD *p;
 
-    /* run through lists until someone is on the rlr
-     * or the fork list
-     */
     for (;;)
     {
         /* poll the keyboard    */
@@ -196,6 +266,9 @@ static void schedule(void)
         /* check if there is something to run */
         if (rlr || fpcnt)
             break;
+#if CONF_WITH_AES_SCHED_STATS
+        schedinfo.si_idle++;
+#endif
 #if USE_STOP_INSN_TO_FREE_HOST_CPU
         stop_until_interrupt();
 #endif
@@ -247,5 +320,7 @@ void disp(void)
      *      3) returns to appropriate address
      * so we'll never return from this
      */
+    if (rlr != p)
+        sched_switch(rlr);
     switchto(rlr->p_uda);
 }
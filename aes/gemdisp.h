@@ -15,5 +15,8 @@
 WORD forkq(FCODE fcode, LONG fdata);
 void forker(void);
 void chkkbd(void);
+#if CONF_WITH_AES_SCHED_STATS
+void sched_init(void);
+#endif
 
 #endif
@@ -24,6 +24,9 @@ extern LONG     CMP_TICK;                       /* indicates to tick    */
                                                 /*   time to wait before*/
                                                 /*   sending the first  */
                                                 /*   tchange            */
+extern LONG     ABS_TICK;                       /* free-running tick    */
+                                                /*   count, used for    */
+                                                /*   timer deadlines    */
 
 
 extern void disable_interrupts(void);
@@ -27,43 +27,185 @@
 #include "gemasm.h"
 #include "gemflag.h"
 
+#include "biosext.h"
 
-void tchange(LONG c)            /* c=number of ticks that have gone by  */
+
+/*
+ * Delayed (MU_TIMER) EVBs are kept in a binary min-heap ordered by their
+ * absolute deadline, expressed in AES ticks (see ABS_TICK in gemdosif.S).
+ * While an EVB is on the heap, its e_parm field holds that deadline.
+ *
+ * Each process can wait for at most one timer event at a time, so the
+ * heap never holds more than NUM_PDS entries.
+ */
+static EVB *dlheap[NUM_PDS];
+static WORD dlcnt;
+
+/* deadlines are compared via their difference, so that ABS_TICK may wrap */
+#define DL_BEFORE(a,b)  ((LONG)((a)->e_parm - (b)->e_parm) < 0L)
+
+
+static void dl_siftup(WORD i)
 {
-    EVB *d;
-    LONG c1;
+    EVB *e = dlheap[i];
+    WORD parent;
 
-    /*
-     * pull pd's off the delay list that have waited long enough
-     */
-    d = dlr;
-    while (d)
+    while (i > 0)
     {
-        /* take a bite out of the amount of time the pd is waiting */
-        c1 = c - d->e_parm;
-        d->e_parm -= c;
-        c = c1;
+        parent = (i - 1) / 2;
+        if (!DL_BEFORE(e, dlheap[parent]))
+            break;
+        dlheap[i] = dlheap[parent];
+        i = parent;
+    }
+    dlheap[i] = e;
+}
+
+
+static void dl_siftdown(WORD i)
+{
+    EVB *e = dlheap[i];
+    WORD child;
+
+    while ((child = 2 * i + 1) < dlcnt)
+    {
+        if ((child + 1 < dlcnt) && DL_BEFORE(dlheap[child+1], dlheap[child]))
+            child++;
+        if (!DL_BEFORE(dlheap[child], e))
+            break;
+        dlheap[i] = dlheap[child];
+        i = child;
+    }
+    dlheap[i] = e;
+}
 
-        /* finished waiting? */
-        if (d->e_parm <= 0L)
+
+/*
+ * remove the entry at position i of the heap
+ */
+static void dl_delete(WORD i)
+{
+    if (--dlcnt == i)
+        return;
+
+    dlheap[i] = dlheap[dlcnt];
+    if ((i > 0) && DL_BEFORE(dlheap[i], dlheap[(i-1)/2]))
+        dl_siftup(i);
+    else
+        dl_siftdown(i);
+}
+
+
+/*
+ * tell the tick handler how long to wait before sending the next tchange
+ *
+ * must be called with interrupts disabled
+ */
+static void dl_rearm(void)
+{
+    LONG c;
+
+    if (dlcnt == 0)
+    {
+        CMP_TICK = 0L;
+        return;
+    }
+
+    c = dlheap[0]->e_parm - ABS_TICK;
+    if (c <= 0L)
+        c = 1L;
+
+    if (CMP_TICK == 0L)
+        NUM_TICK = 0L;      /* start NUM_TICK out at zero */
+    CMP_TICK = c;
+}
+
+
+void dl_init(void)
+{
+    dlcnt = 0;
+}
+
+
+/*
+ * add a delay event that expires at absolute tick 'deadline'
+ *
+ * must be NODISP
+ */
+void dl_insert(EVB *e, LONG deadline)
+{
+    if (dlcnt >= NUM_PDS)
+        panic("delay heap full\n");
+
+    e->e_parm = deadline;
+    dlheap[dlcnt] = e;
+    dl_siftup(dlcnt++);
+
+    if (dlheap[0] == e)
+    {
+        disable_interrupts();
+        dl_rearm();
+        enable_interrupts();
+    }
+}
+
+
+/*
+ * remove a delay event that has not expired (e.g. cancelled by ev_multi())
+ *
+ * the heap is tiny, so a linear search to locate the EVB is cheaper than
+ * maintaining a back-pointer in every EVB
+ */
+void dl_remove(EVB *e)
+{
+    WORD i;
+
+    for (i = 0; i < dlcnt; i++)
+    {
+        if (dlheap[i] == e)
         {
-            d->e_parm = 0L;
-            evremove(d, 0);
-            d = dlr;
+            dl_delete(i);
+            if (i == 0)
+            {
+                disable_interrupts();
+                dl_rearm();
+                enable_interrupts();
+            }
+            return;
         }
-        else
-        {
-            /*
-             * set compare tick time to the amount the
-             * first guy is waiting
-             */
-            disable_interrupts();
-            CMP_TICK = d->e_parm;
-            NUM_TICK = 0L;
-            enable_interrupts();
+    }
+}
+
+
+/*
+ * called via the fork ring when the tick handler's countdown expires
+ *
+ * c is the number of ticks that have gone by; it is only of interest to
+ * appl_trecd(), since the expiry test uses the absolute deadlines
+ */
+void tchange(LONG c)
+{
+    EVB *d;
+
+    /*
+     * pull pd's off the delay heap that have waited long enough
+     */
+    while (dlcnt)
+    {
+        d = dlheap[0];
+        if ((LONG)(d->e_parm - ABS_TICK) > 0L)
             break;
-        }
+        dl_delete(0);
+        azombie(d, 0);
     }
+
+    /*
+     * set compare tick time to the amount the
+     * first guy is still waiting
+     */
+    disable_interrupts();
+    dl_rearm();
+    enable_interrupts();
 }
 
 
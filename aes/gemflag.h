@@ -10,6 +10,9 @@
 #ifndef GEMFLAG_H
 #define GEMFLAG_H
 
+void dl_init(void);
+void dl_insert(EVB *e, LONG deadline);
+void dl_remove(EVB *e);
 void tchange(LONG c);
 WORD tak_flag(SPB *sy);
 void amutex(EVB *e, LONG ls);
@@ -40,7 +40,9 @@
 #include "geminit.h"
 #include "gemmnlib.h"
 #include "gemfmlib.h"
+#include "gemgsxif.h"
 #include "scancode.h"
+#include "rectfunc.h"
 
 
 #define FORWARD 0
@@ -54,6 +56,10 @@ static OBJECT   *ml_mnhold;
 static GRECT    ml_ctrl;
 static AESPD    *ml_pmown;
 static char     alert_str[256]; /* must be long enough for longest alert in gem.rsc */
+#if CONF_WITH_FSEL_CATALOGUE
+static OBJECT   *ed_hooktree;   /* see fm_edhook() */
+static void     (*ed_hook)(OBJECT *tree, WORD obj);
+#endif
 
 /*
  * The following arrays are used by eralert() to generate values to
@@ -276,6 +282,20 @@ WORD fm_button(OBJECT *tree, WORD new_obj, WORD clks, WORD *pnew_obj)
 }
 
 
+#if CONF_WITH_FSEL_CATALOGUE
+/*
+ *  Set the function that fm_do() calls after each character typed into
+ *  an editable field of the specified tree.  This is used internally by
+ *  the file selector; a NULL tree removes the function.
+ */
+void fm_edhook(OBJECT *tree, void (*hook)(OBJECT *tree, WORD obj))
+{
+    ed_hooktree = tree;
+    ed_hook = hook;
+}
+#endif
+
+
 /*
  *  ForM DO routine to allow the user to interactively fill out a
  *  form.  The cursor is placed at the starting field.  This routine
@@ -327,7 +347,13 @@ WORD fm_do(OBJECT *tree, WORD start_fld)
         {
             cont = fm_keybd(tree, edit_obj, &rets[4], &next_obj);
             if (rets[4])
+            {
               ob_edit(tree, edit_obj, rets[4], &idx, EDCHAR);
+#if CONF_WITH_FSEL_CATALOGUE
+              if (tree == ed_hooktree)
+                ed_hook(tree, edit_obj);
+#endif
+            }
         }
 
         /* handle button event */
@@ -362,15 +388,39 @@ WORD fm_do(OBJECT *tree, WORD start_fld)
 /*
  *  Form DIALogue routine to handle visual effects of drawing and
  *  undrawing a dialogue
+ *
+ *  'saveunder' is only set for the AES's own dialogs: applications may
+ *  draw underneath their dialogs, and expect FMD_FINISH to send them
+ *  redraw messages
  */
-WORD fm_dial(WORD fmd_type, GRECT *pi, GRECT *pt)
+WORD fm_dial(WORD fmd_type, GRECT *pi, GRECT *pt, BOOL saveunder)
 {
+#if !CONF_WITH_SAVE_UNDER_STACK
+    UNUSED(saveunder);
+#else
+    GRECT   t;
+
+    /* the area saved underneath the dialog, if any */
+    rc_copy(pt, &t);
+    rc_intersect(&gl_rscreen, &t);
+#endif
+
     /* adjust tree position */
     gsx_sclip(&gl_rscreen);
     switch(fmd_type)
     {
     case FMD_START:
         /* grab screen sync or some other mutual exclusion method */
+#if CONF_WITH_SAVE_UNDER_STACK
+        /*
+         * if the caller owns the screen, nobody else can draw underneath
+         * the dialog until FMD_FINISH, unless it gives up the screen or
+         * changes the windows, which bb_pop() will notice
+         */
+        if (saveunder && (wind_spb.sy_tas > 0) && (wind_spb.sy_owner == rlr)
+         && (t.g_w > 0) && (t.g_h > 0))
+            bb_push(&t, TRUE);
+#endif
         break;
     case FMD_GROW:
         gr_growbox(pi, pt);
@@ -379,6 +429,11 @@ WORD fm_dial(WORD fmd_type, GRECT *pi, GRECT *pt)
         gr_shrinkbox(pi, pt);
         break;
     case FMD_FINISH:
+#if CONF_WITH_SAVE_UNDER_STACK
+        /* if nothing changed underneath the dialog, blitting it back is enough */
+        if (saveunder && bb_pop(&t))
+            break;
+#endif
         /* update certain portion of the screen */
         w_drawdesk(pt);
         w_update(DESKWH, pt, DESKWH, FALSE);
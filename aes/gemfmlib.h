@@ -19,7 +19,10 @@ BOOL fm_lock_exists(void);
 WORD fm_keybd(OBJECT *tree, WORD obj, WORD *pchar, WORD *pnew_obj);
 WORD fm_button(OBJECT *tree, WORD new_obj, WORD clks, WORD *pnew_obj);
 WORD fm_do(OBJECT *tree, WORD start_fld);
-WORD fm_dial(WORD fmd_type, GRECT *pi, GRECT *pt);
+#if CONF_WITH_FSEL_CATALOGUE
+void fm_edhook(OBJECT *tree, void (*hook)(OBJECT *tree, WORD obj));
+#endif
+WORD fm_dial(WORD fmd_type, GRECT *pi, GRECT *pt, BOOL saveunder);
 WORD fm_show(WORD string, WORD *pwd, WORD level);
 WORD eralert(WORD n, WORD d);
 WORD fm_error(WORD n);
@@ -43,14 +43,79 @@
 #define LEN_FSNAME (LEN_ZFNAME+1)   /* includes leading flag byte & trailing nul */
 #define LEN_FSPATH  (LEN_ZPATH+4)   /* at least 3 bytes longer than max path */
 #define LEN_FSWORK  (3*LEN_FSPATH)  /* total workarea length in fs_input() */
+#define MAX_FSFILES 0x3fff          /* so that the merge sort widths fit in a WORD */
+
+/*
+ * The directory entries are held as packed keys: the folder/file flag,
+ * then the name as formatted by fmt_str(), padded with spaces to 11
+ * characters.  Comparing the keys as three longs sorts the folders first
+ * (since FS_FOLDER < FS_FILE), then the names as in an 8.3 directory.
+ */
+#define FS_FOLDER   0x07
+#define FS_FILE     ' '
+#define LEN_FSKEY   12              /* flag + 8 + 3 characters */
+
+typedef union
+{
+    char k_name[LEN_FSKEY];
+    ULONG k_long[LEN_FSKEY/sizeof(ULONG)];
+} FSKEY;
 
 static GRECT gl_rfs;
 
 static const char gl_fsobj[4] = {FTITLE, FILEBOX, SCRLBAR, 0x0};
 
-static char *ad_fsnames;    /* holds filenames in currently-displayed directory */
-static LONG *g_fslist;      /* offsets of filenames within ad_fsnames */
-static LONG nm_files;       /* total number of slots in g_fslist[] */
+static FSKEY *fs_keys;      /* entries of the current directory, sorted */
+static WORD fs_nkeys;       /* number of entries in fs_keys[] */
+static FSKEY *fs_work;      /* workarea that directories are read into */
+static WORD *fs_shown;      /* indexes in fs_keys[] of the entries that match the mask */
+static WORD *fs_tmp;        /* workarea for fs_sort() */
+static LONG nm_files;       /* total number of slots in the workareas */
+
+/*
+ * the state of the scrollable list in fs_input(), shared with fs_typeahead()
+ */
+static struct
+{
+    WORD curr;              /* index in fs_shown[] of the top row */
+    WORD count;             /* number of entries in fs_shown[] */
+    WORD sel;               /* selected row (1-NM_NAMES), or 0 if none */
+} fsv;
+
+#if CONF_WITH_FSEL_CATALOGUE
+/*
+ * The catalogue holds the entries of the directories read recently, so that
+ * they can be displayed again without reading the disk.  An entry is only
+ * used if GEMDOS reports no change to any directory or medium since it was
+ * read, see dos_dirchanges().
+ */
+#define NM_FSCAT        8           /* directories in the catalogue */
+#define FSCAT_MAXSIZE   (32*1024L)  /* memory for their entries, at most */
+
+typedef struct
+{
+    char  c_path[LEN_ZPATH+1];      /* the directory as read, i.e. 'X:\...\*.*'; empty if unused */
+    FSKEY *c_keys;                  /* entries, within fscat_pool[] */
+    WORD  c_nkeys;
+    ULONG c_lru;                    /* value of fscat_lru when last used */
+    ULONG c_changes;                /* value of dos_dirchanges() when read */
+} FSCAT;
+
+static FSCAT fscat[NM_FSCAT];
+static ULONG fscat_lru;
+static FSKEY *fscat_pool;
+static LONG fscat_size;     /* number of FSKEYs in fscat_pool[] */
+static LONG fscat_used;     /* number of FSKEYs used, at the start of fscat_pool[] */
+
+/*
+ * for type-ahead: for each group (folders, files), and for each first
+ * character of a name from 0x20 to 0x7f, the first index in fs_shown[]
+ * of an entry starting with it, or -1
+ */
+#define FS_INDEX_FIRST  0x20
+#define FS_INDEX_SIZE   0x60
+static WORD fs_index[2][FS_INDEX_SIZE];
+#endif
 
 
 /*
@@ -237,93 +302,364 @@ static char *fs_pspec(char *pstr, char *pend)
 
 
 /*
- *  Routine to compare files based on name
- *  Note: folders always sort lowest because the first character is \007
+ *  Routine to pack a directory entry from the DTA into a key
+ */
+static void fs_pack(FSKEY *key, const DTA *dta)
+{
+    char *p, name[LEN_FSKEY];
+    WORD i;
+
+    key->k_name[0] = (dta->d_attrib & FA_SUBDIR) ? FS_FOLDER : FS_FILE;
+    fmt_str(dta->d_fname, name);
+    for (i = 1, p = name; i < LEN_FSKEY; i++)
+        key->k_name[i] = *p ? *p++ : ' ';
+}
+
+
+/*
+ *  Routine to unpack a key into the form displayed by the file selector,
+ *  i.e. the flag followed by the name as returned by fmt_str()
+ */
+static void fs_unpack(const FSKEY *key, char *name)
+{
+    char *p;
+
+    memcpy(name, key->k_name, LEN_FSKEY);
+    for (p = name + LEN_FSKEY; (p > name+1) && (p[-1] == ' '); p--)
+        ;
+    *p = '\0';
+}
+
+
+/*
+ *  Routine to compare keys: returns TRUE iff key1 sorts before key2
+ */
+static BOOL fs_less(const FSKEY *key1, const FSKEY *key2)
+{
+    const ULONG *p = key1->k_long, *q = key2->k_long;
+
+    if (*p != *q)
+        return *p < *q;
+    if (*++p != *++q)
+        return *p < *q;
+    return *++p < *++q;
+}
+
+
+/*
+ *  Routine to sort the first n keys of fs_work[].  This is a bottom-up
+ *  merge sort of their indexes, so the keys are only moved once, when
+ *  they are put in the final order.
+ */
+static void fs_sort(WORD n)
+{
+    WORD *src = fs_shown, *dst = fs_tmp, *t;
+    WORD width, lo, mid, hi, i, j, k;
+    FSKEY key;
+
+    for (i = 0; i < n; i++)
+        src[i] = i;
+
+    for (width = 1; width < n; width *= 2)
+    {
+        for (lo = 0; lo < n; lo += 2*width)
+        {
+            mid = min(lo + width, n);
+            hi = min(lo + 2*width, n);
+            for (i = lo, j = mid, k = lo; k < hi; k++)
+            {
+                if ((j >= hi) || ((i < mid) && !fs_less(&fs_work[src[j]], &fs_work[src[i]])))
+                    dst[k] = src[i++];
+                else
+                    dst[k] = src[j++];
+            }
+        }
+        t = src;
+        src = dst;
+        dst = t;
+    }
+
+    /* move the keys to their place, one cycle of the permutation at a time */
+    for (i = 0; i < n; i++)
+    {
+        if (src[i] < 0)             /* already in place */
+            continue;
+        key = fs_work[i];
+        for (k = i; (j = src[k]) != i; k = j)
+        {
+            fs_work[k] = fs_work[j];
+            src[k] = -1;
+        }
+        fs_work[k] = key;
+        src[k] = -1;
+    }
+}
+
+
+/*
+ *  Routine to build the list of the entries that are displayed: all
+ *  the folders, and the files that match pspec
+ *
+ *  Returns the number of entries
  */
-static WORD fs_comp(char *name1, char *name2)
+static WORD fs_filter(char *pspec)
 {
-    return strcmp(name1, name2);
+    WORD i, count;
+    char name[LEN_FSNAME], dotted[LEN_FSNAME];
+
+    for (i = 0, count = 0; i < fs_nkeys; i++)
+    {
+        if (fs_keys[i].k_name[0] == FS_FILE)
+        {
+            fs_unpack(&fs_keys[i], name);
+            unfmt_str(name+1, dotted);
+            if (!wildcmp(pspec, dotted))
+                continue;
+        }
+        fs_shown[count++] = i;
+    }
+
+#if CONF_WITH_FSEL_CATALOGUE
+    {
+        WORD c, group;
+        FSKEY *key;
+
+        for (c = 0; c < FS_INDEX_SIZE; c++)
+            fs_index[0][c] = fs_index[1][c] = -1;
+        for (i = count - 1; i >= 0; i--)
+        {
+            key = &fs_keys[fs_shown[i]];
+            group = (key->k_name[0] == FS_FILE);
+            c = (UBYTE)key->k_name[1] - FS_INDEX_FIRST;
+            if ((c >= 0) && (c < FS_INDEX_SIZE))
+                fs_index[group][c] = i;
+        }
+    }
+#endif
+
+    return count;
 }
 
 
-static LONG fs_add(WORD thefile, LONG fs_index)
+#if CONF_WITH_FSEL_CATALOGUE
+/*
+ *  allocate the memory for the catalogue, when the AES starts
+ */
+void fs_alloc(void)
 {
-    WORD len;
+    LONG size;
+
+    bzero(fscat, sizeof(fscat));
+    fscat_used = 0;
 
-    g_fslist[thefile] = fs_index;
-    ad_fsnames[fs_index++] = (D.g_dta.d_attrib & FA_SUBDIR) ? 0x07 : ' ';
-    len = strlencpy(ad_fsnames+fs_index,D.g_dta.d_fname);
-    fs_index += len + 1;
-    return fs_index;
+    size = min(dos_avail_anyram() / 32, FSCAT_MAXSIZE);
+    fscat_size = size / sizeof(FSKEY);
+    fscat_pool = (fscat_size > 0) ? dos_alloc_anyram(fscat_size * sizeof(FSKEY)) : NULL;
+    if (!fscat_pool)
+        fscat_size = 0;
 }
 
 
+/*
+ *  free the memory for the catalogue, when the AES exits
+ */
+void fs_free(void)
+{
+    if (fscat_pool)
+        dos_free(fscat_pool);
+    fscat_pool = NULL;
+    fscat_size = 0;
+}
+
+
+/*
+ *  Routine to remove a directory from the catalogue, moving down the
+ *  entries of the directories stored after it
+ */
+static void fscat_drop(FSCAT *cat)
+{
+    FSCAT *p;
+    FSKEY *end;
+
+    if (!cat->c_path[0])
+        return;
+
+    end = cat->c_keys + cat->c_nkeys;
+    memmove(cat->c_keys, end, (fscat_pool + fscat_used - end) * sizeof(FSKEY));
+    for (p = fscat; p < fscat + NM_FSCAT; p++)
+    {
+        if (p->c_path[0] && (p->c_keys > cat->c_keys))
+            p->c_keys -= cat->c_nkeys;
+    }
+    fscat_used -= cat->c_nkeys;
+    cat->c_path[0] = '\0';
+}
+
+
+/*
+ *  Routine to find a directory in the catalogue
+ */
+static FSCAT *fscat_find(const char *path)
+{
+    FSCAT *p;
+
+    for (p = fscat; p < fscat + NM_FSCAT; p++)
+    {
+        if (p->c_path[0] && !strcmp(p->c_path, path))
+            return p;
+    }
+
+    return NULL;
+}
+
+
+/*
+ *  Routine to find the least recently used slot of the catalogue, or
+ *  an unused slot if 'used' is FALSE and there is one
+ */
+static FSCAT *fscat_oldest(BOOL used)
+{
+    FSCAT *p, *oldest = NULL;
+
+    for (p = fscat; p < fscat + NM_FSCAT; p++)
+    {
+        if (!p->c_path[0])
+        {
+            if (!used)
+                return p;
+            continue;
+        }
+        if (!oldest || (p->c_lru < oldest->c_lru))
+            oldest = p;
+    }
+
+    return oldest;
+}
+
+
+/*
+ *  Routine to use the entries of a directory from the catalogue, if
+ *  they are still valid
+ *
+ *  Returns TRUE iff they are
+ */
+static BOOL fscat_fetch(const char *path)
+{
+    FSCAT *cat;
+    ULONG changes;
+
+    cat = fscat_find(path);
+    if (!cat)
+        return FALSE;
+
+    if (!dos_dirchanges(&changes) || (changes != cat->c_changes))
+    {
+        fscat_drop(cat);
+        return FALSE;
+    }
+
+    cat->c_lru = ++fscat_lru;
+    fs_keys = cat->c_keys;
+    fs_nkeys = cat->c_nkeys;
+
+    return TRUE;
+}
+
+
+/*
+ *  Routine to store the entries of a directory just read in the
+ *  catalogue, evicting the least recently used ones if necessary
+ */
+static void fscat_store(const char *path)
+{
+    FSCAT *cat;
+    ULONG changes;
+
+    if ((fs_nkeys > fscat_size) || !dos_dirchanges(&changes))
+        return;
+
+    cat = fscat_find(path);
+    if (cat)
+        fscat_drop(cat);
+
+    while (fscat_size - fscat_used < fs_nkeys)
+        fscat_drop(fscat_oldest(TRUE));
+
+    cat = fscat_oldest(FALSE);
+    fscat_drop(cat);
+
+    cat->c_keys = fscat_pool + fscat_used;
+    cat->c_nkeys = fs_nkeys;
+    cat->c_lru = ++fscat_lru;
+    cat->c_changes = changes;
+    memcpy(cat->c_keys, fs_work, fs_nkeys * sizeof(FSKEY));
+    strcpy(cat->c_path, path);
+    fscat_used += fs_nkeys;
+}
+#endif
+
+
 /*
  *  Make a particular path the active path.  This involves
- *  reading its directory, initializing a file list, and filling
- *  out the information in the path node.  Then sort the files.
+ *  reading its directory (unless it is in the catalogue), sorting it,
+ *  and building the list of the entries that match pspec.
  *
  *  Returns FALSE iff error occurred
  */
 static WORD fs_active(char *ppath, char *pspec, WORD *pcount)
 {
     WORD ret;
-    LONG thefile, fs_index, temp;
-    WORD i, j, gap;
+    LONG thefile;
     char *fname, allpath[LEN_ZPATH+1];
     DTA *user_dta;
 
     set_mouse_to_hourglass();
 
     thefile = 0L;
-    fs_index = 0L;
 
     strcpy(allpath, ppath);         /* 'allpath' gets all files */
     fname = fs_pspec(allpath,NULL);
     set_all_files(fname);
 
+    /*
+     * the first search is always done, even if the directory is in the
+     * catalogue: it detects media changes, and reports a missing path
+     */
     user_dta = dos_gdta();          /* remember user's DTA */
     dos_sdta(&D.g_dta);
     ret = dos_sfirst(allpath, FA_SUBDIR);
 
-    /*
-     * like Atari TOS, we silently ignore any filenames that we don't
-     * have room for.  this should be an extremely rare occurrence.
-     */
-    while((ret == 0) && (thefile < nm_files))
+#if CONF_WITH_FSEL_CATALOGUE
+    if (((ret == 0) || (ret == EFILNF) || (ret == ENMFIL)) && fscat_fetch(allpath))
+        ret = ENMFIL;
+    else
+#endif
     {
-        /* if it is a real file or directory then save it and set
-         * the first byte to tell which
+        /*
+         * like Atari TOS, we silently ignore any filenames that we don't
+         * have room for.  this should be an extremely rare occurrence.
          */
-        if (D.g_dta.d_fname[0] != '.')
+        while((ret == 0) && (thefile < nm_files))
         {
-            if ((D.g_dta.d_attrib & FA_SUBDIR) || (wildcmp(pspec, D.g_dta.d_fname)))
-            {
-                fs_index = fs_add(thefile, fs_index);
-                thefile++;
-            }
+            /* if it is a real file or directory then save it */
+            if (D.g_dta.d_fname[0] != '.')
+                fs_pack(&fs_work[thefile++], &D.g_dta);
+            ret = dos_snext();
         }
-        ret = dos_snext();
+
+        fs_keys = fs_work;
+        fs_nkeys = thefile;
+        fs_sort(fs_nkeys);
+
+#if CONF_WITH_FSEL_CATALOGUE
+        if ((ret == EFILNF) || (ret == ENMFIL))
+            fscat_store(allpath);
+#endif
     }
 
-    *pcount = thefile;
     dos_sdta(user_dta);             /* restore user DTA */
 
-    /* sort files using shell sort from page 108 of K&R C Prog. Lang. */
-    for (gap = thefile/2; gap > 0; gap /= 2)
-    {
-        for (i = gap; i < thefile; i++)
-        {
-            for (j = i-gap; j >= 0; j -= gap)
-            {
-                if (fs_comp(ad_fsnames+g_fslist[j],ad_fsnames+g_fslist[j+gap]) <= 0)
-                    break;
-                temp = g_fslist[j];
-                g_fslist[j] = g_fslist[j+gap];
-                g_fslist[j+gap] = temp;
-            }
-        }
-    }
+    *pcount = fs_filter(pspec);
 
     set_mouse_to_arrow();
 
@@ -364,7 +700,7 @@ static void fs_format(OBJECT *tree, WORD currtop, WORD count)
 {
     WORD i, cnt;
     WORD y, h, th;
-    char   *p, name[LEN_FSNAME];
+    char   name[LEN_FSNAME];
     OBJECT *obj, *treeptr = tree;
 
     /* build in real text strings */
@@ -372,11 +708,7 @@ static void fs_format(OBJECT *tree, WORD currtop, WORD count)
     for (i = 0, obj = treeptr+NAME_OFFSET; i < NM_NAMES; i++, obj++)
     {
         if (i < cnt)
-        {
-            p = ad_fsnames + g_fslist[currtop+i];
-            fmt_str(p+1, name+1);       /* format file/folder name */
-            name[0] = p[0];             /* copy file/folder indicator */
-        }
+            fs_unpack(&fs_keys[fs_shown[currtop+i]], name);
         else
         {
             name[0] = ' ';
@@ -478,6 +810,85 @@ static WORD fs_nscroll(OBJECT *tree, WORD *psel, WORD curr, WORD count,
 }
 
 
+#if CONF_WITH_FSEL_CATALOGUE
+/*
+ *  Routine to find the first entry displayed whose name starts with
+ *  the specified prefix (in fmt_str() format), looking at the files
+ *  first, since a filename is being typed
+ *
+ *  Returns the index in fs_shown[], or -1 if none
+ */
+static WORD fs_lookup(const char *prefix)
+{
+    WORD i, group, c, len;
+    const char *name;
+
+    len = strlen(prefix);
+    if (len == 0)
+        return -1;
+
+    c = toupper((UBYTE)prefix[0]) - FS_INDEX_FIRST;
+    if ((c < 0) || (c >= FS_INDEX_SIZE))
+        return -1;
+
+    for (group = 1; group >= 0; group--)
+    {
+        for (i = fs_index[group][c]; (i >= 0) && (i < fsv.count); i++)
+        {
+            name = fs_keys[fs_shown[i]].k_name;
+            if ((name[0] == FS_FILE) != group)
+                break;
+            if (toupper((UBYTE)name[1]) != c + FS_INDEX_FIRST)
+                break;
+            if ((len < LEN_FSKEY) && !strncasecmp(name+1, prefix, len))
+                return i;
+        }
+    }
+
+    return -1;
+}
+
+
+/*
+ *  Routine called by fm_do() after each character typed into the
+ *  file selector: scroll to and select the first matching entry
+ */
+static void fs_typeahead(OBJECT *tree, WORD obj)
+{
+    WORD pos, top;
+    GRECT clip;
+
+    if (obj != FSSELECT)
+        return;
+
+    pos = fs_lookup(((TEDINFO *)tree[FSSELECT].ob_spec)->te_ptext);
+    if (pos < 0)
+        return;
+
+    gsx_gclip(&clip);
+
+    /* scroll the entry to the top, unless it is already visible */
+    top = fsv.curr;
+    if ((pos < fsv.curr) || (pos >= fsv.curr + NM_NAMES))
+        top = min(pos, max(fsv.count - NM_NAMES, 0));
+    if (top > fsv.curr)
+        fsv.curr = fs_nscroll(tree, &fsv.sel, fsv.curr, fsv.count, FDNAROW, top - fsv.curr);
+    else if (top < fsv.curr)
+        fsv.curr = fs_nscroll(tree, &fsv.sel, fsv.curr, fsv.count, FUPAROW, fsv.curr - top);
+
+    if (fsv.sel != pos - fsv.curr + 1)
+    {
+        gsx_sclip(&gl_rfull);
+        fs_sel(fsv.sel, NORMAL);
+        fsv.sel = pos - fsv.curr + 1;
+        fs_sel(fsv.sel, SELECTED);
+    }
+
+    gsx_sclip(&clip);
+}
+#endif
+
+
 /*
  *  Routine to call when a new directory has been specified.  This
  *  will activate the directory, format it, and display it.
@@ -611,7 +1022,6 @@ WORD fs_input(char *pipath, char *pisel, WORD *pbutton, char *pilabel)
     BOOL cont, newlist, newsel, newdrive;
     WORD drive, dclkret, error;
     WORD touchob, value, fnum;
-    WORD curr, count, sel;
     WORD mx, my;
     OBJECT *tree;
     ULONG bitmask;
@@ -623,8 +1033,8 @@ WORD fs_input(char *pipath, char *pisel, WORD *pbutton, char *pilabel)
     OBJECT *obj;
     TEDINFO *tedinfo;
 
-    curr = 0;
-    count = 0;
+    fsv.curr = 0;
+    fsv.count = 0;
 
     /* get out quick if path is nullptr */
     if (pipath == NULL)
@@ -638,32 +1048,35 @@ WORD fs_input(char *pipath, char *pisel, WORD *pbutton, char *pilabel)
     }
 
     /*
-     * get memory for the filename array & the array that points to it:
-     * we must have enough memory for the first page of directory names.
+     * get memory for the directory entries & the arrays of indexes into
+     * them: we must have enough memory for the first page of directory names.
      *
      * also get memory for some pathname workareas to save stack space
      * (this also happily reduces code size).
      *
      * the order of data within the gotten area is:
-     *  filename pointers
-     *  filename array
+     *  directory entries
+     *  indexes of displayed entries
+     *  indexes for sorting
      *  locstr
      *  locold
      *  mask
      */
     memblk = NULL;
-    nm_files = (dos_avail_anyram()-LEN_FSWORK) / (LEN_FSNAME+sizeof(char *));
+    nm_files = (dos_avail_anyram()-LEN_FSWORK) / (sizeof(FSKEY)+2*sizeof(WORD));
+    nm_files = min(nm_files, MAX_FSFILES);
     if (nm_files >= NM_NAMES)
-        memblk = dos_alloc_anyram(nm_files*(LEN_FSNAME+sizeof(char *))+LEN_FSWORK);
+        memblk = dos_alloc_anyram(nm_files*(sizeof(FSKEY)+2*sizeof(WORD))+LEN_FSWORK);
     if (!memblk)
     {
         fm_show(ALFSMEM, NULL, 1);
         return FALSE;
     }
 
-    g_fslist = (LONG *)memblk;
-    ad_fsnames = (char *)(g_fslist+nm_files);
-    locstr = ad_fsnames + (nm_files * LEN_FSNAME);
+    fs_work = (FSKEY *)memblk;
+    fs_shown = (WORD *)(fs_work+nm_files);
+    fs_tmp = fs_shown + nm_files;
+    locstr = (char *)(fs_tmp + nm_files);
     locold = locstr + LEN_FSPATH;
     mask = locold + LEN_FSPATH;
 
@@ -705,11 +1118,15 @@ WORD fs_input(char *pipath, char *pisel, WORD *pbutton, char *pilabel)
 
     /* set clip and start form fill-in by drawing the form */
     gsx_sclip(&gl_rfs);
-    fm_dial(FMD_START, &gl_rcenter, &gl_rfs);
+    fm_dial(FMD_START, &gl_rcenter, &gl_rfs, TRUE);
     ob_draw(tree, ROOT, 2);
 
+#if CONF_WITH_FSEL_CATALOGUE
+    fm_edhook(tree, fs_typeahead);
+#endif
+
     /* init for while loop by forcing initial fs_newdir call */
-    sel = 0;
+    fsv.sel = 0;
     newsel = newdrive = FALSE;
     cont = newlist = TRUE;
     error = 0;      /* consecutive error count */
@@ -720,14 +1137,14 @@ WORD fs_input(char *pipath, char *pisel, WORD *pbutton, char *pilabel)
 
         if (newlist)
         {
-            fs_sel(sel, NORMAL);
+            fs_sel(fsv.sel, NORMAL);
             inf_sset(tree, FSDIRECT, locstr);
             pstr = fs_pspec(locstr, NULL);
             strcpy(pstr, mask);
-            curr = 0;
-            sel = 0;
+            fsv.curr = 0;
+            fsv.sel = 0;
             newlist = FALSE;
-            if (fs_newdir(locstr, mask, tree, &count))  /* ok reading dir */
+            if (fs_newdir(locstr, mask, tree, &fsv.count))  /* ok reading dir */
                 error = 0;
             else ++error;
             if (error == 1)     /* only retry once; this avoids continual retries */
@@ -790,7 +1207,7 @@ WORD fs_input(char *pipath, char *pisel, WORD *pbutton, char *pilabel)
             fm_own(TRUE);
             value = gr_slidebox(tree, FSVSLID, FSVELEV, TRUE);
             fm_own(FALSE);
-            value = curr - mul_div_round(value, count-NM_NAMES, 1000);
+            value = fsv.curr - mul_div_round(value, fsv.count-NM_NAMES, 1000);
             if (value >= 0)
                 touchob = FUPAROW;
             else
@@ -809,14 +1226,14 @@ WORD fs_input(char *pipath, char *pisel, WORD *pbutton, char *pilabel)
         case F8NAME:
         case F9NAME:
             fnum = touchob - F1NAME + 1;
-            if (fnum > count)
+            if (fnum > fsv.count)
                 break;
-            if (sel && (sel != fnum))
-                fs_sel(sel, NORMAL);
-            if (sel != fnum)
+            if (fsv.sel && (fsv.sel != fnum))
+                fs_sel(fsv.sel, NORMAL);
+            if (fsv.sel != fnum)
             {
-                sel = fnum;
-                fs_sel(sel, SELECTED);
+                fsv.sel = fnum;
+                fs_sel(fsv.sel, SELECTED);
             }
             /* get string and see if file or folder */
             inf_sget(tree, touchob, selname);
@@ -907,16 +1324,20 @@ WORD fs_input(char *pipath, char *pisel, WORD *pbutton, char *pilabel)
         }
 
         if (value)
-            curr = fs_nscroll(tree, &sel, curr, count, touchob, value);
+            fsv.curr = fs_nscroll(tree, &fsv.sel, fsv.curr, fsv.count, touchob, value);
     }
 
+#if CONF_WITH_FSEL_CATALOGUE
+    fm_edhook(NULL, NULL);
+#endif
+
     /* return path and file name to caller */
     strcpy(pipath, locstr);
     unfmt_str(ad_fname, selname);
     strcpy(pisel, selname);
 
     /* start the redraw */
-    fm_dial(FMD_FINISH, &gl_rcenter, &gl_rfs);
+    fm_dial(FMD_FINISH, &gl_rcenter, &gl_rfs, TRUE);
 
     /* return exit button */
     *pbutton = inf_what(tree, FSOK);
@@ -12,5 +12,9 @@
 
 WORD fs_input(char *pipath, char *pisel, WORD *pbutton, char *pilabel);
 void fs_start(void);
+#if CONF_WITH_FSEL_CATALOGUE
+void fs_alloc(void);
+void fs_free(void);
+#endif
 
 #endif
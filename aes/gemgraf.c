@@ -30,6 +30,8 @@
 #include "optimopt.h"
 #include "gsx2.h"
 #include "rectfunc.h"
+#include "cookie.h"
+#include "string.h"
 
 
 GLOBAL WORD     gl_width;       /* screen width */
@@ -71,6 +73,7 @@ GLOBAL GRECT    gl_rmenu;       /* the menu bar */
 static WORD     gl_mode;        /* text writing mode (vswr_mode) */
 static WORD     gl_tcolor;      /* text colour (vst_color) */
 static WORD     gl_lcolor;      /* line colour (vsl_color) */
+static WORD     gl_fcolor;      /* fill colour (vsf_color) */
 static WORD     gl_fis;         /* interior type (vsf_interior) */
 static WORD     gl_patt;        /* style of fill pattern (vsf_style) */
 static WORD     gl_font;        /* font type (IBM/SMALL) for v_gtext */
@@ -81,6 +84,26 @@ static WORD     gl_hptschar;    /* height of character (normal font) */
 static WORD     gl_wsptschar;   /* width of character (small font) */
 static WORD     gl_hsptschar;   /* height of character (small font) */
 
+#if CONF_WITH_OBDRAW_BATCH
+/*
+ * while batching is enabled (i.e. within ob_draw()), a box fill is
+ * not output immediately, but is held as 'pending'.  subsequent fills
+ * with the same attributes that are inside the pending fill are
+ * skipped, and those that extend it into a larger rectangle are merged
+ * with it.  any other drawing operation must call gr_flush() first to
+ * output the pending fill.
+ */
+static BOOL     gl_batch;       /* TRUE iff batching box fills */
+static GRECT    gl_pend;        /* pending fill (g_w == 0 => none) */
+static WORD     gl_pcolor;      /*  & its colour, */
+static WORD     gl_pfis;        /*  interior type */
+static WORD     gl_ppatt;       /*  & fill pattern */
+#endif
+
+#if CONF_WITH_AES_DRAW_STATS
+DRAWSTAT drawstat;              /* published via the 'AESD' cookie */
+#endif
+
 
 /*
  *  Routine to set the clip rectangle.  If the w,h of the clip is 0,
@@ -88,6 +111,8 @@ static WORD     gl_hsptschar;   /* height of character (small font) */
  */
 void gsx_sclip(const GRECT *pt)
 {
+    gr_flush();                 /* pending fill uses the old clip */
+
     gl_clip = *pt;
 
     if (gl_clip.g_w && gl_clip.g_h)
@@ -142,6 +167,8 @@ static void gsx_xline(WORD ptscount, WORD *ppoints)
     WORD    *linexy, i;
     WORD    st;
 
+    gr_flush();
+
     for (i = 1; i < ptscount; i++)
     {
         if (*ppoints == *(ppoints + 2))
@@ -187,6 +214,7 @@ void gsx_cline(UWORD x1, UWORD y1, UWORD x2, UWORD y2)
 {
     WORD pxy[4] = { x1, y1, x2, y2 };
 
+    gr_flush();
     gsx_moff();
     v_pline(2, pxy);
     gsx_mon();
@@ -200,6 +228,8 @@ void gsx_attr(UWORD text, UWORD mode, UWORD color)
 {
     WORD    tmp;
 
+    gr_flush();                 /* pending fill uses the old attributes */
+
     tmp = intin[0];
     contrl[1] = 0;
     contrl[3] = 1;
@@ -210,6 +240,7 @@ void gsx_attr(UWORD text, UWORD mode, UWORD color)
         intin[0] = gl_mode = mode;
         gsx2();
     }
+    else DRAW_COUNT(ds_attrsaved);
 
     contrl[0] = FALSE;
     if (text)
@@ -234,10 +265,27 @@ void gsx_attr(UWORD text, UWORD mode, UWORD color)
         intin[0] = color;
         gsx2();
     }
+    else DRAW_COUNT(ds_attrsaved);
     intin[0] = tmp;
 }
 
 
+/*
+ *  Routine to set the fill colour
+ */
+void gsx_fcolor(WORD color)
+{
+    gr_flush();
+
+    if (color != gl_fcolor)
+    {
+        vsf_color(color);
+        gl_fcolor = color;
+    }
+    else DRAW_COUNT(ds_attrsaved);
+}
+
+
 /*
  *  Routine to set up the points for drawing a box
  */
@@ -261,6 +309,7 @@ static void gsx_bxpts(GRECT *pt)
  */
 static void gsx_box(GRECT *pt)
 {
+    gr_flush();
     gsx_bxpts(pt);
     v_pline(5, ptsin);
 }
@@ -329,6 +378,7 @@ void gsx_blt(void *saddr, WORD sx, WORD sy,
 {
     WORD pxyarray[8];
 
+    gr_flush();
     gsx_fix(&gl_src, (void *)saddr, w/8, h);
     gsx_fix_screen(&gl_dst);
 
@@ -383,7 +433,7 @@ void gsx_start(void)
     WORD dummy;
 
     /* reset variables to force initial VDI calls */
-    gl_mode = gl_tcolor = gl_lcolor = -1;
+    gl_mode = gl_tcolor = gl_lcolor = gl_fcolor = -1;
     gl_fis = gl_patt = gl_font = -1;
 
     gl_clip.g_x = 0;
@@ -429,7 +479,7 @@ void gsx_start(void)
 /*
  *  Routine to do a filled bit blit (a rectangle)
  */
-void bb_fill(WORD mode, WORD fis, WORD patt, WORD hx, WORD hy, WORD hw, WORD hh)
+static void bb_attr(WORD mode, WORD fis, WORD patt)
 {
     gsx_attr(TRUE, mode, gl_tcolor);
     if (fis != gl_fis)
@@ -437,11 +487,20 @@ void bb_fill(WORD mode, WORD fis, WORD patt, WORD hx, WORD hy, WORD hw, WORD hh)
         vsf_interior(fis);
         gl_fis = fis;
     }
+    else DRAW_COUNT(ds_attrsaved);
     if (patt != gl_patt)
     {
         vsf_style(patt);
         gl_patt = patt;
     }
+    else DRAW_COUNT(ds_attrsaved);
+}
+
+
+void bb_fill(WORD mode, WORD fis, WORD patt, WORD hx, WORD hy, WORD hw, WORD hh)
+{
+    gr_flush();
+    bb_attr(mode, fis, patt);
 
     ptsin[0] = hx;
     ptsin[1] = hy;
@@ -497,6 +556,8 @@ static void gsx_tcalc(WORD font, char *ptext, WORD *ptextw, WORD *ptexth, WORD *
 
 void gsx_tblt(WORD tb_f, WORD x, WORD y, WORD tb_nc)
 {
+    gr_flush();
+
     if (tb_f == IBM)
     {
         if (tb_f != gl_font)
@@ -539,6 +600,108 @@ void gr_inside(GRECT *pt, WORD th)
 }
 
 
+#if CONF_WITH_OBDRAW_BATCH
+/*
+ *  Routine to output the pending box fill, if any
+ *
+ *  intin[0] is preserved, since callers may already have stored a
+ *  character there; ptsin[] is not used.
+ */
+void gr_flush(void)
+{
+    GRECT r;
+    WORD tmp, pxy[4];
+
+    if (!gl_pend.g_w)
+        return;
+
+    /* mark it done first, since the attribute routines call us too */
+    r = gl_pend;
+    gl_pend.g_w = 0;
+
+    tmp = intin[0];
+    gsx_fcolor(gl_pcolor);
+    bb_attr(MD_REPLACE, gl_pfis, gl_ppatt);
+    pxy[0] = r.g_x;
+    pxy[1] = r.g_y;
+    pxy[2] = r.g_x + r.g_w - 1;
+    pxy[3] = r.g_y + r.g_h - 1;
+    vr_recfl(pxy);
+    intin[0] = tmp;
+}
+
+
+/*
+ *  Routine to enable/disable batching of box fills
+ *
+ *  returns the previous setting; disabling batching outputs any
+ *  pending fill
+ */
+BOOL gr_batch(BOOL on)
+{
+    BOOL old = gl_batch;
+
+    if (!on)
+        gr_flush();
+    gl_batch = on;
+
+    return old;
+}
+
+
+/*
+ *  Routine to add a box fill to the batch
+ *
+ *  A fill in replace mode is idempotent, so one that lies within the
+ *  pending fill (with the same attributes) can be skipped entirely;
+ *  one that abuts it along a whole edge is merged with it.
+ */
+static void gr_batchfill(WORD color, WORD fis, WORD patt, GRECT *pt)
+{
+    GRECT *p = &gl_pend;
+
+    if ((pt->g_w <= 0) || (pt->g_h <= 0))
+    {
+        gr_flush();                 /* let the VDI handle it as before */
+        gsx_fcolor(color);
+        bb_fill(MD_REPLACE, fis, patt, pt->g_x, pt->g_y, pt->g_w, pt->g_h);
+        return;
+    }
+
+    if (p->g_w && (color == gl_pcolor) && (fis == gl_pfis) && (patt == gl_ppatt))
+    {
+        if ((pt->g_x >= p->g_x) && (pt->g_y >= p->g_y)
+         && (pt->g_x + pt->g_w <= p->g_x + p->g_w)
+         && (pt->g_y + pt->g_h <= p->g_y + p->g_h))
+        {
+            DRAW_COUNT(ds_fillsaved);
+            return;
+        }
+        if ((pt->g_y == p->g_y) && (pt->g_h == p->g_h)
+         && (pt->g_x == p->g_x + p->g_w))
+        {
+            p->g_w += pt->g_w;
+            DRAW_COUNT(ds_fillsaved);
+            return;
+        }
+        if ((pt->g_x == p->g_x) && (pt->g_w == p->g_w)
+         && (pt->g_y == p->g_y + p->g_h))
+        {
+            p->g_h += pt->g_h;
+            DRAW_COUNT(ds_fillsaved);
+            return;
+        }
+    }
+
+    gr_flush();
+    *p = *pt;
+    gl_pcolor = color;
+    gl_pfis = fis;
+    gl_ppatt = patt;
+}
+#endif
+
+
 /*
  *  Routine to draw a colored, patterned, rectangle
  */
@@ -552,7 +715,15 @@ void gr_rect(UWORD icolor, UWORD ipattern, GRECT *pt)
     else if (ipattern == IP_SOLID)
         fis = FIS_SOLID;
 
-    vsf_color(icolor);
+#if CONF_WITH_OBDRAW_BATCH
+    if (gl_batch)
+    {
+        gr_batchfill(icolor, fis, ipattern, pt);
+        return;
+    }
+#endif
+
+    gsx_fcolor(icolor);
     bb_fill(MD_REPLACE, fis, ipattern, pt->g_x, pt->g_y, pt->g_w, pt->g_h);
 }
 
@@ -642,6 +813,7 @@ static void gr_colourblit(WORD *pdata, GRECT *pi, WORD num_planes)
     WORD pxyarray[8];
     WORD mode;
 
+    gr_flush();
     gsx_fix(&gl_src, pdata, pi->g_w/8, pi->g_h);
     gl_src.fd_nplanes = num_planes;
 
@@ -828,3 +1000,22 @@ void gr_box(WORD x, WORD y, WORD w, WORD h, WORD th)
         gsx_mon();
     }
 }
+
+
+#if CONF_WITH_AES_DRAW_STATS
+/*
+ * initialise the object drawing statistics & publish them via the
+ * 'AESD' cookie, for use by tools/aesstat.c
+ *
+ * called at each AES startup
+ */
+void gr_stats_init(void)
+{
+    ULONG dummy;
+
+    bzero(&drawstat, sizeof(DRAWSTAT));
+
+    if (!cookie_get(COOKIE_AESD, &dummy))
+        cookie_add(COOKIE_AESD, (ULONG)&drawstat);
+}
+#endif
@@ -27,5 +27,36 @@ void gr_gtext(WORD just, WORD font, char *ptext, GRECT *pt);
 void gr_crack(UWORD color, WORD *pbc, WORD *ptc, WORD *pip, WORD *pic, WORD *pmd);
 void gr_gicon(WORD state, ICONBLK *ib, CICON *cicon);
 void gr_box(WORD x, WORD y, WORD w, WORD h, WORD th);
+void gsx_fcolor(WORD color);
+
+#if CONF_WITH_OBDRAW_BATCH
+BOOL gr_batch(BOOL on);
+void gr_flush(void);
+#else
+#define gr_flush()
+#endif
+
+#if CONF_WITH_AES_DRAW_STATS
+/*
+ * object drawing statistics: see tools/aesstat.c
+ */
+typedef struct
+{
+    ULONG ds_draws;             /* calls to ob_draw() */
+    ULONG ds_objects;           /* objects drawn (not trivially rejected) */
+    ULONG ds_culled;            /* subtrees skipped because outside clip */
+    ULONG ds_attrsaved;         /* VDI attribute calls skipped (unchanged) */
+    ULONG ds_fillsaved;         /* VDI fill calls saved by batching */
+    ULONG ds_lastsaved;         /* VDI calls saved by the latest ob_draw() */
+} DRAWSTAT;
+
+extern DRAWSTAT drawstat;
+
+void gr_stats_init(void);
+
+#define DRAW_COUNT(field)   drawstat.field++
+#else
+#define DRAW_COUNT(field)
+#endif
 
 #endif
@@ -32,6 +32,7 @@
 #include "asm.h"
 
 #include "cookie.h"
+#include "rectfunc.h"
 
 /*
  * calculate memory size to buffer a display area, given its
@@ -81,6 +82,34 @@ static PFVOID old_bcode;
 static LONG  gl_mlen;
 static BOOL  gl_graphic;
 
+#if CONF_WITH_SAVE_UNDER_STACK
+/*
+ * The save-under stack holds the screen areas underneath dialogs, submenus
+ * and popups, which may be nested, and may be open while a menu or an
+ * alert uses the menu/alert buffer.  It follows that buffer in memory.
+ *
+ * gl_damage counts the events that may have changed the screen under a
+ * dialog (see bb_damage()), so that an area saved for a dialog is only
+ * blitted back if nothing has happened underneath it.
+ */
+#define SAVE_LEVELS     8
+
+typedef struct
+{
+    GRECT   su_rect;        /* as passed to bb_push() */
+    UBYTE   *su_addr;
+    LONG    su_size;
+    UWORD   su_damage;      /* gl_damage when saved */
+    BOOL    su_check;       /* only restore if gl_damage is unchanged */
+} SAVEUNDER;
+
+static SAVEUNDER save_stack[SAVE_LEVELS];
+static WORD  save_level;
+static UBYTE *save_base;
+static LONG  save_len;
+static UWORD gl_damage;
+#endif
+
 
 /* Some local Prototypes: */
 static void v_opnwk(WORD *pwork_in, WORD *phandle, WS *pwork_out);
@@ -105,9 +134,26 @@ static ULONG gsx_mcalc(void)
 void gsx_malloc(void)
 {
     ULONG   mlen;
+#if CONF_WITH_SAVE_UNDER_STACK
+    LONG    avail;
+#endif
 
     mlen = gsx_mcalc();                     /* need side effects now     */
+#if CONF_WITH_SAVE_UNDER_STACK
+    /*
+     * the save-under stack gets up to 1/16 of the free memory, but never
+     * more than a screenful
+     */
+    avail = (dos_avail_anyram() - (LONG)mlen) / 16;
+    save_len = memsize((gl_width+15)/16, gl_height, gl_nplanes);
+    if (save_len > avail)
+        save_len = (avail > 0) ? (avail & ~1L) : 0L;
+    save_level = 0;
+    gl_tmp.fd_addr = dos_alloc_anyram(mlen + save_len);
+    save_base = (UBYTE *)gl_tmp.fd_addr + mlen;
+#else
     gl_tmp.fd_addr = dos_alloc_anyram(mlen);
+#endif
 }
 
 
@@ -300,25 +346,40 @@ void gsx_graphic(BOOL tographic)
 }
 
 
-static void bb_set(BOOL save, GRECT *r)
+/*
+ * return the size of the buffer needed to save an area, and get its
+ * x position and width on word boundaries
+ */
+static LONG bb_size(GRECT *r, WORD *psx, WORD *psw)
 {
-    FDB *psrc, *pdst;
+    WORD sx, sw;
+
+    sx = (r->g_x / 16) * 16;
+    sw = ( ((r->g_x - sx) + (r->g_w + 15)) / 16 ) * 16;
+    *psx = sx;
+    *psw = sw;
+
+    return memsize(sw/16,r->g_h,gl_tmp.fd_nplanes);
+}
+
+
+/*
+ * save or restore an area, using a buffer of 'len' bytes at 'addr'
+ */
+static void bb_set(BOOL save, GRECT *r, void *addr, LONG len)
+{
+    FDB tmp, *psrc, *pdst;
     WORD pxyarray[8], *pts1, *pts2;
-    WORD sx, sy, sw, sh, oldsx;
+    WORD sx, sy, sw, sh;
     LONG            size;
 
-    /* extract x/y/w/h from GRECT */
-    r_get(r, &sx, &sy, &sw, &sh);
-
-    /* get on word boundary */
-    oldsx = sx;
-    sx = (sx / 16) * 16;
-    sw = ( ((oldsx - sx) + (sw + 15)) / 16 ) * 16;
-    size = memsize(sw/16,sh,gl_tmp.fd_nplanes);
+    size = bb_size(r, &sx, &sw);
+    sy = r->g_y;
+    sh = r->g_h;
 
-    if (size > gl_mlen) {       /* buffer too small */
+    if (size > len) {           /* buffer too small */
         /* adjust height to fit buffer: this will leave droppings! */
-        sh = (ULONG)gl_mlen * sh / size;
+        sh = (ULONG)len * sh / size;
 
         /* issue warning message for backup only, not for subsequent restore */
         if (save)
@@ -326,22 +387,23 @@ static void bb_set(BOOL save, GRECT *r)
     }
 
     gsx_fix_screen(&gl_src);
-    /* gl_tmp.fd_addr was set by gsx_malloc() */
-    gl_tmp.fd_stand = TRUE;
-    gl_tmp.fd_wdwidth = sw / 16;
-    gl_tmp.fd_w = sw;
-    gl_tmp.fd_h = sh;
+    tmp = gl_tmp;               /* fd_nplanes was set by gsx_mcalc() */
+    tmp.fd_addr = addr;
+    tmp.fd_stand = TRUE;
+    tmp.fd_wdwidth = sw / 16;
+    tmp.fd_w = sw;
+    tmp.fd_h = sh;
 
     if (save)
     {
         psrc = &gl_src;
-        pdst = &gl_tmp;
+        pdst = &tmp;
         pts1 = pxyarray;
         pts2 = pxyarray + 4;
     }
     else
     {
-        psrc = &gl_tmp;         /* invert FDBs & coordinates */
+        psrc = &tmp;            /* invert FDBs & coordinates */
         pdst = &gl_src;
         pts1 = pxyarray + 4;
         pts2 = pxyarray;
@@ -364,16 +426,96 @@ static void bb_set(BOOL save, GRECT *r)
 
 void bb_save(GRECT *ps)
 {
-    bb_set(TRUE, ps);
+    bb_set(TRUE, ps, gl_tmp.fd_addr, gl_mlen);
 }
 
 
 void bb_restore(GRECT *pr)
 {
-    bb_set(FALSE, pr);
+    bb_set(FALSE, pr, gl_tmp.fd_addr, gl_mlen);
+}
+
+
+#if CONF_WITH_SAVE_UNDER_STACK
+/*
+ * note that the screen underneath dialogs may have changed
+ */
+void bb_damage(void)
+{
+    gl_damage++;
 }
 
 
+/*
+ * save an area on the save-under stack.  If 'check' is set, bb_pop()
+ * will only restore it if bb_damage() was not called in the meantime.
+ *
+ * returns FALSE if there is no room for it
+ */
+BOOL bb_push(GRECT *r, BOOL check)
+{
+    SAVEUNDER *su;
+    UBYTE *addr;
+    LONG size;
+    WORD sx, sw;
+
+    /* areas of dialogs that can't be restored any more are just in the way */
+    while ((save_level > 0) && save_stack[save_level-1].su_check
+        && (save_stack[save_level-1].su_damage != gl_damage))
+        save_level--;
+
+    if (save_level >= SAVE_LEVELS)
+        return FALSE;
+
+    su = &save_stack[save_level];
+    addr = save_level ? su[-1].su_addr + su[-1].su_size : save_base;
+    size = bb_size(r, &sx, &sw);
+    if (addr + size > save_base + save_len)
+        return FALSE;
+
+    su->su_rect = *r;
+    su->su_addr = addr;
+    su->su_size = size;
+    su->su_damage = gl_damage;
+    su->su_check = check;
+    save_level++;
+
+    bb_set(TRUE, r, addr, size);
+
+    return TRUE;
+}
+
+
+/*
+ * restore an area saved by bb_push(), and drop it from the stack, along
+ * with any area saved after it and never restored
+ *
+ * returns FALSE if the area was not found, or can't be restored
+ */
+BOOL bb_pop(GRECT *r)
+{
+    SAVEUNDER *su;
+    WORD level;
+
+    for (level = save_level; level > 0; level--)
+    {
+        su = &save_stack[level-1];
+        if (!rc_equal(&su->su_rect, r))
+            continue;
+
+        save_level = level - 1;
+        if (su->su_check && (su->su_damage != gl_damage))
+            return FALSE;
+
+        bb_set(FALSE, r, su->su_addr, su->su_size);
+        return TRUE;
+    }
+
+    return FALSE;
+}
+#endif
+
+
 WORD gsx_tick(void *tcode, void *ptsave)
 {
     i_ptr( tcode );
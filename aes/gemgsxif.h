@@ -34,6 +34,11 @@ void gsx_init(void);
 void gsx_graphic(BOOL tographic);
 void bb_save(GRECT *ps);
 void bb_restore(GRECT *pr);
+#if CONF_WITH_SAVE_UNDER_STACK
+void bb_damage(void);
+BOOL bb_push(GRECT *r, BOOL check);
+BOOL bb_pop(GRECT *r);
+#endif
 
 WORD gsx_tick(void *tcode, void *ptsave);
 void gsx_mfset(const MFORM *new_cursor);
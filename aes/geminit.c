@@ -46,6 +46,10 @@
 #include "gemasm.h"
 #include "gemaplib.h"
 #include "geminput.h"
+#include "gemflag.h"
+#include "gemdisp.h"
+#include "gemsuper.h"
+#include "gemgraf.h"
 #include "gemmnext.h"
 #include "gemmnlib.h"
 #include "gemoblib.h"
@@ -119,7 +123,7 @@ GLOBAL MFORM    gl_prevmouse;           /* previous AES  mouse form */
 #endif
 
 GLOBAL AESPD    *rlr, *drl, *nrl;
-GLOBAL EVB      *eul, *dlr, *zlr;
+GLOBAL EVB      *eul, *zlr;
 
 GLOBAL UBYTE    indisp;
 
@@ -745,6 +749,9 @@ void gem_main(void)
     /* initialise AES libraries */
     fm_init();
     mn_init();
+#if CONF_WITH_CICON_CACHE
+    rs_cache_init();
+#endif
 
     num_accs = count_accs();        /* puts ACC names in acc[].name */
 
@@ -783,7 +790,8 @@ void gem_main(void)
 
     /* initialize list and unused lists   */
     nrl = drl = NULL;
-    dlr = zlr = NULL;
+    zlr = NULL;
+    dl_init();
     fph = fpt = fpcnt = 0;
 
     /* init initial process */
@@ -815,6 +823,16 @@ void gem_main(void)
     rlr->p_pid = curpid++;
     rlr->p_link = NULL;
 
+#if CONF_WITH_AES_SCHED_STATS
+    sched_init();
+#endif
+#if CONF_WITH_AES_DRAW_STATS
+    gr_stats_init();
+#endif
+#if CONF_WITH_AES_CALL_STATS
+    callstats_init();
+#endif
+
     /* end of process init */
 
     /* restart the tick     */
@@ -839,4 +857,7 @@ void gem_main(void)
 
     if (D.g_acc)
         dos_free(D.g_acc);
+#if CONF_WITH_CICON_CACHE
+    rs_cache_exit();
+#endif
 }
@@ -63,6 +63,11 @@ GLOBAL SMIB *gl_submenu_hwm;        /* high water mark of gl_submenu[] */
 static WORD keystate;
 static void *blitsave;
 
+#if CONF_WITH_SAVE_UNDER_STACK
+/* returned by popup_blit() when the area was saved on the save-under stack */
+#define ON_SAVE_STACK   ((void *)-1L)
+#endif
+
 /*
  * values for 'settings' below
  */
@@ -149,6 +154,16 @@ static void *popup_blit(OBJECT *tree, void *buf)
     rc_intersect(&gl_rfull, &t);
     gsx_sclip(&t);
 
+#if CONF_WITH_SAVE_UNDER_STACK
+    if (save ? bb_push(&t, FALSE) : (buf == ON_SAVE_STACK))
+    {
+        if (!save)
+            bb_pop(&t);
+        gsx_sclip(&gl_rscreen);
+        return save ? ON_SAVE_STACK : NULL;
+    }
+#endif
+
     /* get save area */
     if (save)
     {
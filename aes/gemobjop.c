@@ -20,6 +20,7 @@
 #include "emutos.h"
 #include "obdefs.h"
 #include "gemobjop.h"
+#include "gemgraf.h"
 
 
 char ob_sst(OBJECT *tree, WORD obj, LONG *pspec, WORD *pstate, WORD *ptype,
@@ -73,8 +74,41 @@ char ob_sst(OBJECT *tree, WORD obj, LONG *pspec, WORD *pstate, WORD *ptype,
 }
 
 
+/*
+ * amount by which an object's outline, shadow or 3D effect may extend
+ * beyond its box
+ */
+#define OB_SLOP     16
+
+
+/*
+ *  Routine to determine if an object at x,y (allowing for decorations)
+ *  intersects the clip rectangle
+ */
+static BOOL ob_visible(OBJECT *obj, WORD x, WORD y, const GRECT *pclip)
+{
+    if (x - OB_SLOP >= pclip->g_x + pclip->g_w)
+        return FALSE;
+    if (y - OB_SLOP >= pclip->g_y + pclip->g_h)
+        return FALSE;
+    if (x + obj->ob_width + OB_SLOP <= pclip->g_x)
+        return FALSE;
+    if (y + obj->ob_height + OB_SLOP <= pclip->g_y)
+        return FALSE;
+
+    return TRUE;
+}
+
+
+/*
+ *  Routine to walk a tree, calling 'routine' for each object.
+ *
+ *  If 'pclip' is not NULL, the children of an object are skipped when
+ *  the object (allowing for decorations) lies outside *pclip: like
+ *  ob_find(), we assume that children lie within their parent.
+ */
 void everyobj(OBJECT *tree, WORD this, WORD last, EVERYOBJ_CALLBACK routine,
-              WORD startx, WORD starty, WORD maxdep)
+              WORD startx, WORD starty, WORD maxdep, const GRECT *pclip)
 {
     WORD    tmp1;
     WORD    depth;
@@ -105,9 +139,13 @@ child:
     {
         if (!(obj->ob_flags & HIDETREE) && (depth <= maxdep))
         {
-            depth++;
-            this = tmp1;
-            goto child;
+            if (!pclip || ob_visible(obj, x[depth], y[depth], pclip))
+            {
+                depth++;
+                this = tmp1;
+                goto child;
+            }
+            DRAW_COUNT(ds_culled);
         }
     }
 
@@ -442,6 +442,8 @@ static WORD ob_user(OBJECT *tree, WORD obj, GRECT *pt, LONG spec,
     gsx_gclip((GRECT *)&pb.pb_xc);      /* FIXME: ditto */
     pb.pb_parm = ub->ub_parm;
 
+    gr_flush();                         /* the user code uses its own VDI calls */
+
     return call_usercode(ub, &pb);
 }
 
@@ -539,6 +541,8 @@ static void just_draw(OBJECT *tree, WORD obj, WORD sx, WORD sy)
             return;
     }
 
+    DRAW_COUNT(ds_objects);
+
 #if CONF_WITH_3D_OBJECTS
     rc_copy(&t, &effect_grect); /* save for add_3d_effect() at the end */
 #endif
@@ -891,7 +895,7 @@ static void just_draw(OBJECT *tree, WORD obj, WORD sx, WORD sy)
 
         if ((state & SHADOWED) && th)
         {
-            vsf_color(bcol);
+            gsx_fcolor(bcol);
             bb_fill(MD_REPLACE, FIS_SOLID, 0, t.g_x, t.g_y+t.g_h+th,
                     t.g_w + th, 2*th);
             bb_fill(MD_REPLACE, FIS_SOLID, 0, t.g_x+t.g_w+th, t.g_y,
@@ -922,7 +926,7 @@ static void just_draw(OBJECT *tree, WORD obj, WORD sx, WORD sy)
             if ((flags & FL3DMASK) == FL3DBAK)
                 bcol = backgrcol;
 #endif
-            vsf_color(bcol);
+            gsx_fcolor(bcol);
             bb_fill(MD_TRANS, FIS_PATTERN, IP_4PATT, t.g_x, t.g_y,
                     t.g_w, t.g_h);
         }
@@ -959,6 +963,15 @@ void ob_draw(OBJECT *tree, WORD obj, WORD depth)
     WORD pobj;
     WORD last = NIL;
     WORD sx, sy;
+    GRECT clip, *pclip;
+#if CONF_WITH_OBDRAW_BATCH
+    BOOL oldbatch;
+#endif
+#if CONF_WITH_AES_DRAW_STATS
+    ULONG saved = drawstat.ds_attrsaved + drawstat.ds_fillsaved;
+
+    drawstat.ds_draws++;
+#endif
 
     if (obj != ROOT)
         last = tree[obj].ob_next;
@@ -969,9 +982,23 @@ void ob_draw(OBJECT *tree, WORD obj, WORD depth)
     else
         sx = sy = 0;
 
+    /* only cull if clipping is in effect */
+    gsx_gclip(&clip);
+    pclip = (clip.g_w && clip.g_h) ? &clip : NULL;
+
     gsx_moff();
-    everyobj(tree, obj, last, just_draw, sx, sy, depth);
+#if CONF_WITH_OBDRAW_BATCH
+    oldbatch = gr_batch(TRUE);
+    everyobj(tree, obj, last, just_draw, sx, sy, depth, pclip);
+    gr_batch(oldbatch);
+#else
+    everyobj(tree, obj, last, just_draw, sx, sy, depth, pclip);
+#endif
     gsx_mon();
+
+#if CONF_WITH_AES_DRAW_STATS
+    drawstat.ds_lastsaved = drawstat.ds_attrsaved + drawstat.ds_fillsaved - saved;
+#endif
 }
 
 
@@ -25,6 +25,78 @@
 #include "rectfunc.h"
 #include "gemasync.h"
 #include "gemqueue.h"
+#if CONF_WITH_AES_CALL_STATS
+#include "finetime.h"
+#endif
+
+
+#if CONF_WITH_AES_CALL_STATS
+/*
+ * record that n bytes have been added to the queue of p (n may be 0 if
+ * the message was merged with one already queued)
+ */
+static void qstats_write(AESPD *p, WORD n)
+{
+    APPSTAT *a = &callinfo.ci_pd[p->p_pid];
+
+    a->a_msgs++;
+    if (p->p_qindex > a->a_maxdepth)
+        a->a_maxdepth = p->p_qindex;
+
+    /*
+     * once the slots are full, the following messages are only counted,
+     * until they have all been read
+     */
+    if (a->a_qlost || (a->a_nq == NUM_QSLOTS))
+        a->a_qlost += n;
+    else if (n)
+    {
+        a->a_qtime[a->a_nq] = fine_time();
+        a->a_qbytes[a->a_nq++] = n;
+    }
+}
+
+
+/*
+ * record that n bytes are removed from the start of the queue of p,
+ * and how long the messages removed were queued for
+ */
+void qstats_read(AESPD *p, WORD n)
+{
+    APPSTAT *a = &callinfo.ci_pd[p->p_pid];
+    ULONG ms, limit;
+    WORD i, bucket;
+
+    while (n > 0)
+    {
+        if (a->a_nq == 0)           /* untimed messages */
+        {
+            a->a_qlost = (n < a->a_qlost) ? a->a_qlost - n : 0;
+            break;
+        }
+        if (n < a->a_qbytes[0])     /* message partly read */
+        {
+            a->a_qbytes[0] -= n;
+            break;
+        }
+        n -= a->a_qbytes[0];
+
+        ms = FINE_TIME_MS(fine_time() - a->a_qtime[0]);
+        for (bucket = 0, limit = 1; (bucket < QLAT_BUCKETS-1) && (ms >= limit); bucket++)
+            limit <<= 1;
+        a->a_lat[bucket]++;
+
+        a->a_nq--;
+        for (i = 0; i < a->a_nq; i++)
+        {
+            a->a_qtime[i] = a->a_qtime[i+1];
+            a->a_qbytes[i] = a->a_qbytes[i+1];
+        }
+    }
+}
+#else
+#define qstats_write(p,n)
+#endif
 
 
 static void doq(WORD donq, AESPD *p, QPB *m)
@@ -70,9 +142,11 @@ static void doq(WORD donq, AESPD *p, QPB *m)
             }
         }
         p->p_qindex += n;
+        qstats_write(p, n);
     }
     else
     {
+        qstats_read(p, n);
         memcpy((char *)m->qpb_buf, p->p_qaddr, n);
         p->p_qindex -= n;
         if (p->p_qindex)
@@ -11,5 +11,10 @@
 #define GEMQUEUE_H
 
 void aqueue(WORD isqwrite, EVB *e, LONG lm);
+#if CONF_WITH_AES_CALL_STATS
+void qstats_read(AESPD *p, WORD n);
+#else
+#define qstats_read(p,n)
+#endif
 
 #endif
@@ -285,60 +285,61 @@ static CICON *best_match(CICONBLK *start)
  * expand cicon data from S to D planes (S is strictly less than D)
  *
  * we use the same algorithm as Atari TOS:
- *  1. copy the source to the first S (0 to S-1) planes of the
- *     destination data
- *  2. create the Sth plane of the destination data by ANDing
- *     together all the source planes
- *  3. copy the Sth plane of the destination data to the remaining
- *     destination planes
- *  4. AND all the destination planes with the mask plane
+ *  1. the first S (0 to S-1) planes of the destination are the
+ *     source planes
+ *  2. the remaining destination planes are the AND of all the
+ *     source planes
+ *  3. all the destination planes are ANDed with the mask plane
+ *
+ * rather than making a separate pass over the data for each step, we
+ * do all three in a single pass, two words at a time
  */
 static void expand_cicondata(WORD *src, WORD *dst, WORD *mask, WORD w, WORD h, WORD src_planes, WORD dst_planes)
 {
-    WORD *p, *q;
-    WORD plane_words, src_words;
+    ULONG *p, *q;
+    ULONG all, m;
+    UWORD *pw, *qw;
+    UWORD allw, mw;
+    WORD plane_words;
     WORD i, j;
 
     plane_words = w / 16 * h;           /* in WORDS */
-    src_words = plane_words * src_planes;
 
-    /*
-     * 1. the first src_planes of dst are the same as src
-     */
-    memcpy(dst, src, src_words*sizeof(WORD));
-
-    /*
-     * 2. copy the zeroth src plane to the next dst plane,
-     *    then AND in the remaining planes
-     */
-    memcpy(dst+src_words, src, plane_words*sizeof(WORD));
-    p = src + plane_words;      /* p -> start of remainder */
-    for (i = 1; i < src_planes; i++)
+    for (j = 0; j < plane_words-1; j += 2)
     {
-        q = dst + src_words;    /* q -> target */
-        for (j = 0; j < plane_words; j++, p++, q++)
-            *q = *p & *q;
-    }
-
-    /*
-     * 3. copy the ANDed plane to the rest of the destination planes
-     */
-    p = dst + src_words;        /* p -> source (ANDed) plane */
-    q = p + plane_words;        /* q -> start of remaining planes */
-    for (i = 1; i < (dst_planes-src_planes); i++, q += plane_words)
-    {
-        memcpy(q, p, plane_words*sizeof(WORD));
+        m = *(ULONG *)(mask+j);
+        all = 0xffffffffUL;
+        p = (ULONG *)(src+j);
+        q = (ULONG *)(dst+j);
+        for (i = 0; i < src_planes; i++)
+        {
+            all &= *p;
+            *q = *p & m;
+            p = (ULONG *)((WORD *)p + plane_words);
+            q = (ULONG *)((WORD *)q + plane_words);
+        }
+        all &= m;
+        for ( ; i < dst_planes; i++)
+        {
+            *q = all;
+            q = (ULONG *)((WORD *)q + plane_words);
+        }
     }
 
-    /*
-     * 4. AND the mask plane into all destination planes
-     */
-    q = dst;
-    for (i = 0; i < dst_planes; i++)
+    if (j < plane_words)        /* odd number of words per plane */
     {
-        p = mask;
-        for (j = 0; j < plane_words; j++, p++, q++)
-            *q &= *p;
+        mw = mask[j];
+        allw = 0xffff;
+        pw = (UWORD *)src + j;
+        qw = (UWORD *)dst + j;
+        for (i = 0; i < src_planes; i++, pw += plane_words, qw += plane_words)
+        {
+            allw &= *pw;
+            *qw = *pw & mw;
+        }
+        allw &= mw;
+        for ( ; i < dst_planes; i++, qw += plane_words)
+            *qw = allw;
     }
 }
 
@@ -395,6 +396,276 @@ static void transform_cicon(WORD *src, WORD *dest, WORD w, WORD h, WORD planes)
 #endif
 }
 
+#if CONF_WITH_CICON_CACHE
+/*
+ * converted colour icon cache
+ *
+ * converting colour icons to device-dependent form is slow, and the
+ * same resource file (notably the desktop's icon file) is often loaded
+ * again and again.  so we keep the converted icon data for the most
+ * recently loaded files in a pool allocated at AES startup.  entries
+ * are identified by the resource file's name, length & date/time, and
+ * by the screen format.  on a hit, the data is simply copied into the
+ * buffers that transform_all_cicons() would otherwise fill.
+ *
+ * entries are kept in order of their position in the pool, with any
+ * unused entries at the end; when an entry is discarded, the data of
+ * the following entries is moved down to fill the gap.
+ */
+#define CC_ENTRIES      4
+#define CC_POOLSIZE     (64*1024L)      /* maximum pool size */
+#define CC_MINPOOL      (8*1024L)       /* don't bother with a smaller pool */
+
+#define CC_PACKED       0x8000          /* format flag: packed pixels */
+#if CONF_WITH_CHUNKY8
+#define CC_FORMAT       (gl_nplanes | CC_PACKED)
+#else
+#define CC_FORMAT       gl_nplanes
+#endif
+
+typedef struct
+{
+    LONG  rslsize;                      /* length of resource file */
+    UWORD datime[2];                    /* its time & date, from Fdatime() */
+    UWORD format;                       /* screen format, see CC_FORMAT */
+    char  name[MAXPATHLEN];             /* its name, from sh_find() */
+} CCKEY;
+
+typedef struct
+{
+    CCKEY key;
+    LONG  offset;                       /* of converted data in pool */
+    LONG  length;                       /*  & its length (0 => unused) */
+    UWORD stamp;                        /* for LRU replacement */
+} CCENTRY;
+
+static UBYTE *cc_pool;
+static LONG cc_poolsize;
+static CCENTRY cc_entry[CC_ENTRIES];
+static UWORD cc_clock;
+static CCKEY cc_key;                    /* identifies resource being loaded */
+static BOOL cc_keyvalid;
+
+
+/*
+ * allocate the cache pool: called at AES startup, so that the pool
+ * belongs to the AES rather than to the current application
+ */
+void rs_cache_init(void)
+{
+    LONG size;
+
+    bzero(cc_entry, sizeof(cc_entry));
+    cc_keyvalid = FALSE;
+    cc_pool = NULL;
+
+    size = (dos_avail_anyram() / 16) & ~1L;
+    if (size > CC_POOLSIZE)
+        size = CC_POOLSIZE;
+    if (size < CC_MINPOOL)
+        return;
+
+    cc_pool = dos_alloc_anyram(size);
+    if (cc_pool)
+        cc_poolsize = size;
+}
+
+
+/*
+ * free the cache pool: called at AES exit
+ */
+void rs_cache_exit(void)
+{
+    if (cc_pool)
+        dos_free(cc_pool);
+    cc_pool = NULL;
+}
+
+
+/*
+ * set up the cache key for the resource file being loaded
+ */
+static void cc_setkey(WORD fd, LONG rslsize)
+{
+    cc_keyvalid = FALSE;
+
+    if (!cc_pool)
+        return;
+    if (gl_nplanes > 8)                 /* Truecolor icons depend on the palette */
+        return;
+    if (Fdatime(cc_key.datime, fd, 0) < 0L)
+        return;
+
+    cc_key.rslsize = rslsize;
+    cc_key.format = CC_FORMAT;
+    strcpy(cc_key.name, tmprsfname);
+    cc_keyvalid = TRUE;
+}
+
+
+/*
+ * look for a cache entry for the resource being loaded
+ */
+static CCENTRY *cc_find(void)
+{
+    CCENTRY *e;
+
+    if (!cc_keyvalid)
+        return NULL;
+
+    for (e = cc_entry; (e < cc_entry+CC_ENTRIES) && e->length; e++)
+    {
+        if ((e->key.rslsize == cc_key.rslsize)
+         && (e->key.datime[0] == cc_key.datime[0])
+         && (e->key.datime[1] == cc_key.datime[1])
+         && (e->key.format == cc_key.format)
+         && (strcmp(e->key.name, cc_key.name) == 0))
+        {
+            e->stamp = ++cc_clock;
+            return e;
+        }
+    }
+
+    return NULL;
+}
+
+
+/*
+ * discard a cache entry, closing up the pool
+ */
+static void cc_discard(CCENTRY *e)
+{
+    CCENTRY *last = cc_entry + CC_ENTRIES - 1;
+    CCENTRY *f;
+    LONG end;
+
+    end = e->offset + e->length;
+    for (f = e + 1; (f <= last) && f->length; f++)
+        f->offset -= e->length;
+    if (f > e + 1)
+        memmove(cc_pool+e->offset, cc_pool+end, (f-1)->offset+(f-1)->length-e->offset);
+
+    memmove(e, e+1, (last-e)*sizeof(CCENTRY));
+    last->length = 0L;
+}
+
+
+/*
+ * make a cache entry of the specified length for the resource being
+ * loaded, discarding the least-recently-used entries as necessary
+ *
+ * returns pointer to the entry's data area, or NULL
+ */
+static UBYTE *cc_new(LONG length)
+{
+    CCENTRY *e, *lru;
+    LONG used;
+
+    if (!cc_keyvalid || (length == 0L) || (length > cc_poolsize))
+        return NULL;
+
+    while(1)
+    {
+        used = 0L;
+        lru = NULL;
+        for (e = cc_entry; (e < cc_entry+CC_ENTRIES) && e->length; e++)
+        {
+            used = e->offset + e->length;
+            if (!lru || ((WORD)(e->stamp - lru->stamp) < 0))
+                lru = e;
+        }
+        if ((e < cc_entry+CC_ENTRIES) && (used + length <= cc_poolsize))
+            break;
+        cc_discard(lru);
+    }
+
+    e->key = cc_key;
+    e->offset = used;
+    e->length = length;
+    e->stamp = ++cc_clock;
+
+    return cc_pool + used;
+}
+
+
+/*
+ * fill in the colour icons from a cache entry
+ */
+static void fetch_all_cicons(LONG num_cicons, CICONBLK **ciconblkptr, CCENTRY *e)
+{
+    CICONBLK *ciconblk;
+    CICON *cicon;
+    UBYTE *data = cc_pool + e->offset;
+    WORD *colbuf;
+    LONG data_size, n;
+    WORD i;
+
+    for (i = 0; i < num_cicons; i++)
+    {
+        ciconblk = ciconblkptr[i];
+        cicon = best_match(ciconblk);
+        ciconblk->mainlist = cicon;
+        if (!cicon)
+            continue;
+        data_size = muls(ciconblk->monoblk.ib_wicon/8*gl_nplanes,ciconblk->monoblk.ib_hicon);
+        n = cicon->sel_data ? 2*data_size : data_size;
+
+        colbuf = dos_alloc_anyram(n);
+        if (colbuf)
+        {
+            memcpy(colbuf, data, n);
+            cicon->col_data = colbuf;
+            if (cicon->sel_data)
+                cicon->sel_data = colbuf + data_size/sizeof(WORD);
+            cicon->num_planes = gl_nplanes; /* neatness only */
+            cicon->next_res = NULL;
+        }
+        else ciconblk->mainlist = NULL;     /* no colour for this icon */
+        data += n;
+    }
+}
+
+
+/*
+ * save the converted colour icons in a new cache entry
+ */
+static void store_all_cicons(LONG num_cicons, CICONBLK **ciconblkptr)
+{
+    CICONBLK *ciconblk;
+    CICON *cicon;
+    UBYTE *data;
+    LONG length, n;
+    WORD i;
+
+    for (i = 0, length = 0L; i < num_cicons; i++)
+    {
+        ciconblk = ciconblkptr[i];
+        cicon = ciconblk->mainlist;
+        if (!cicon)
+            continue;
+        n = muls(ciconblk->monoblk.ib_wicon/8*gl_nplanes,ciconblk->monoblk.ib_hicon);
+        length += cicon->sel_data ? 2*n : n;
+    }
+
+    data = cc_new(length);
+    if (!data)
+        return;
+
+    for (i = 0; i < num_cicons; i++)
+    {
+        ciconblk = ciconblkptr[i];
+        cicon = ciconblk->mainlist;
+        if (!cicon)
+            continue;
+        n = muls(ciconblk->monoblk.ib_wicon/8*gl_nplanes,ciconblk->monoblk.ib_hicon);
+        if (cicon->sel_data)
+            n *= 2;
+        memcpy(data, cicon->col_data, n);
+        data += n;
+    }
+}
+#endif
+
 /*
  * for each CICONBLK in the resource, select the CICON with the number of
  * planes that best matches the current resolution.  then expand the icon
@@ -408,6 +679,17 @@ static void transform_all_cicons(LONG num_cicons, CICONBLK **ciconblkptr)
     LONG data_size, n;
     BOOL expand;
     WORD i, w, h;
+#if CONF_WITH_CICON_CACHE
+    CCENTRY *e;
+    BOOL complete = TRUE;
+
+    e = cc_find();
+    if (e)
+    {
+        fetch_all_cicons(num_cicons, ciconblkptr, e);
+        return;
+    }
+#endif
 
     for (i = 0; i < num_cicons; i++)
     {
@@ -429,6 +711,9 @@ static void transform_all_cicons(LONG num_cicons, CICONBLK **ciconblkptr)
             if (!expandbuf)
             {
                 ciconblk->mainlist = NULL;  /* no colour for this icon */
+#if CONF_WITH_CICON_CACHE
+                complete = FALSE;
+#endif
                 continue;
             }
         }
@@ -441,6 +726,9 @@ static void transform_all_cicons(LONG num_cicons, CICONBLK **ciconblkptr)
             if (expandbuf)
                 dos_free(expandbuf);
             ciconblk->mainlist = NULL;      /* no colour for this icon */
+#if CONF_WITH_CICON_CACHE
+            complete = FALSE;
+#endif
             continue;
         }
 
@@ -474,6 +762,12 @@ static void transform_all_cicons(LONG num_cicons, CICONBLK **ciconblkptr)
         if (expandbuf)
             dos_free(expandbuf);
     }
+
+#if CONF_WITH_CICON_CACHE
+    /* only cache a complete conversion, so a later hit can't be worse */
+    if (complete)
+        store_all_cicons(num_cicons, ciconblkptr);
+#endif
 }
 
 /*
@@ -772,6 +1066,10 @@ static WORD rs_readit(AESGLOBAL *pglobal,UWORD fd)
     }
 #endif
 
+#if CONF_WITH_CICON_CACHE
+    cc_setkey(fd, rslsize);
+#endif
+
     rs_hdr = (RSHDR *)dos_alloc_anyram(rslsize);
     if (!rs_hdr)
         return FALSE;
@@ -33,5 +33,9 @@ WORD rs_gaddr(AESGLOBAL *pglobal, UWORD rtype, UWORD rindex, void **rsaddr);
 WORD rs_saddr(AESGLOBAL *pglobal, UWORD rtype, UWORD rindex, void *rsaddr);
 void rs_fixit(AESGLOBAL *pglobal);
 WORD rs_load(AESGLOBAL *pglobal, char *rsfname);
+#if CONF_WITH_CICON_CACHE
+void rs_cache_init(void);
+void rs_cache_exit(void);
+#endif
 
 #endif
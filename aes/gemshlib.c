@@ -39,6 +39,7 @@
 #include "gemoblib.h"
 #include "gemwmlib.h"
 #include "gemfmlib.h"
+#include "gemfslib.h"
 #include "gempd.h"
 #include "gemflag.h"
 #include "geminit.h"
@@ -249,6 +250,9 @@ void sh_tographic(void)
     gsx_graphic(TRUE);      /* convert to graphic */
     gsx_sclip(&gl_rscreen); /* set initial clip rectangle */
     gsx_malloc();           /* allocate screen space */
+#if CONF_WITH_FSEL_CATALOGUE
+    fs_alloc();             /* allocate file selector catalogue */
+#endif
     ratinit();              /* start up the mouse */
     set_mouse_to_hourglass();/* put mouse to hourglass */
 }
@@ -270,6 +274,9 @@ static void sh_toalpha(void)
     enable_interrupts();
 
     ratexit();              /* turn off the mouse */
+#if CONF_WITH_FSEL_CATALOGUE
+    fs_free();              /* return file selector catalogue */
+#endif
     gsx_mfree();            /* return screen space */
     gsx_graphic(FALSE);     /* close workstation */
 }
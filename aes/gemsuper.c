@@ -47,6 +47,10 @@
 #include "gemctrl.h"
 
 #include "string.h"
+#if CONF_WITH_AES_CALL_STATS
+#include "cookie.h"
+#include "finetime.h"
+#endif
 
 
 LONG super(WORD cx, AESPB *pcrys_blk);  /* called only from gemdosif.S */
@@ -54,6 +58,61 @@ LONG super(WORD cx, AESPB *pcrys_blk);  /* called only from gemdosif.S */
 static void     *ad_rso;
 
 
+#if CONF_WITH_AES_CALL_STATS
+CALLINFO callinfo;
+
+/*
+ * reset the call statistics & publish them via the cookie jar
+ *
+ * called at each AES startup, after the AESPDs have been initialised
+ */
+void callstats_init(void)
+{
+    ULONG dummy;
+
+    bzero(&callinfo, sizeof(CALLINFO));
+    callinfo.ci_nops = NUM_AES_OPS;
+    callinfo.ci_npds = totpds;
+    callinfo.ci_appsize = sizeof(APPSTAT);
+    callinfo.ci_hz = FINE_TIME_HZ;
+
+    if (!cookie_get(COOKIE_AESC, &dummy))
+        cookie_add(COOKIE_AESC, (ULONG)&callinfo);
+}
+
+static void callstat_add(CALLSTAT *c, ULONG time)
+{
+    ULONG old = c->c_time;
+
+    c->c_calls++;
+    c->c_time += time;
+    if (c->c_time < old)
+        c->c_time_hi++;
+    if (time > c->c_max)
+        c->c_max = time;
+}
+
+/*
+ * account for an AES call by process p, that started at time 'start'
+ *
+ * the event library calls are not charged to the process, since most of
+ * their time is spent waiting
+ */
+static void callstats_add(AESPD *p, WORD opcode, ULONG start)
+{
+    APPSTAT *a = &callinfo.ci_pd[p->p_pid];
+    ULONG time = fine_time_since(start);
+
+    if ((opcode >= 0) && (opcode < NUM_AES_OPS))
+        callstat_add(&callinfo.ci_op[opcode], time);
+
+    memcpy(a->a_name, p->p_name, AP_NAMELEN);
+    if ((opcode < EVNT_KEYBD) || (opcode > EVNT_MULTI))
+        callstat_add(&a->a_calls, time);
+}
+#endif
+
+
 #ifdef ENABLE_KDEBUG
 static void aestrace(const char* message)
 {
@@ -237,7 +296,7 @@ static UWORD crysbind(WORD opcode, AESGLOBAL *pglobal, WORD control[], WORD int_
         ret = fm_do((OBJECT *)FM_FORM, FM_START);
         break;
     case FORM_DIAL:
-        ret = fm_dial(FM_TYPE, (GRECT *)&FM_IX, (GRECT *)&FM_X);
+        ret = fm_dial(FM_TYPE, (GRECT *)&FM_IX, (GRECT *)&FM_X, FALSE);
         break;
     case FORM_ALERT:
         ret = fm_alert(FM_DEFBUT, (char *)FM_ASTRING);
@@ -428,6 +487,10 @@ static void xif(AESPB *pcrys_blk)
     WORD    int_in[I_SIZE];
     WORD    int_out[O_SIZE];
     LONG    addr_in[AI_SIZE];
+#if CONF_WITH_AES_CALL_STATS
+    AESPD   *p = rlr;
+    ULONG   start = fine_time();
+#endif
 
     memcpy(control, pcrys_blk->control, C_SIZE*sizeof(WORD));
     if (IN_LEN)
@@ -438,6 +501,10 @@ static void xif(AESPB *pcrys_blk)
     RET_CODE = crysbind(OP_CODE, (AESGLOBAL *)pcrys_blk->global, control, int_in, int_out,
                                 addr_in);
 
+#if CONF_WITH_AES_CALL_STATS
+    callstats_add(p, OP_CODE, start);
+#endif
+
     if (OUT_LEN)
         memcpy(pcrys_blk->intout, int_out, OUT_LEN*sizeof(WORD));
     if (OP_CODE == RSRC_GADDR)
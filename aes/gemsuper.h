@@ -19,4 +19,8 @@ typedef struct aespb {
     LONG *addrout;
 } AESPB;
 
+#if CONF_WITH_AES_CALL_STATS
+void callstats_init(void);
+#endif
+
 #endif
@@ -357,6 +357,9 @@ void w_drawdesk(GRECT *pc)
     }
 
     do_walk(DESKWH, tree, root, depth, pc);
+#if CONF_WITH_SAVE_UNDER_STACK
+    bb_damage();
+#endif
 }
 
 
@@ -907,6 +910,102 @@ static void w_redraw(WORD w_handle, GRECT *pt)
 }
 
 
+/*
+ *  Store the parts of 'ps' outside 'pd' in 'pr' (up to 4 rectangles: the
+ *  bands above and below 'pd', then those on its left and right), and
+ *  return their number
+ */
+static WORD w_exposed(const GRECT *ps, const GRECT *pd, GRECT *pr)
+{
+    GRECT   i;
+    WORD    n = 0;
+
+    rc_copy(pd, &i);
+    if (!rc_intersect(ps, &i))
+    {
+        rc_copy(ps, pr);
+        return 1;
+    }
+
+    if (i.g_y > ps->g_y)
+        r_set(&pr[n++], ps->g_x, ps->g_y, ps->g_w, i.g_y - ps->g_y);
+    if (i.g_y + i.g_h < ps->g_y + ps->g_h)
+        r_set(&pr[n++], ps->g_x, i.g_y + i.g_h, ps->g_w, ps->g_y + ps->g_h - i.g_y - i.g_h);
+    if (i.g_x > ps->g_x)
+        r_set(&pr[n++], ps->g_x, i.g_y, i.g_x - ps->g_x, i.g_h);
+    if (i.g_x + i.g_w < ps->g_x + ps->g_w)
+        r_set(&pr[n++], i.g_x + i.g_w, i.g_y, ps->g_x + ps->g_w - i.g_x - i.g_w, i.g_h);
+
+    return n;
+}
+
+
+/*
+ *  Move the contents of the part 'pt' of a window's work area by dx,dy.
+ *  In each rectangle of the window's rectangle list, what is still visible
+ *  after the move is blitted, and the exposed strips are then passed to
+ *  'redraw', or sent to the owner of the window as WM_REDRAW messages if
+ *  'redraw' is NULL.
+ */
+#define MAX_EXPOSED 16
+
+void wm_scroll(WORD w_handle, const GRECT *pt, WORD dx, WORD dy, WM_REDRAW_FUNC redraw)
+{
+    ORECT   *po;
+    GRECT   a, r, d, clip, strips[MAX_EXPOSED];
+    WORD    i, n = 0;
+
+    rc_copy(pt, &a);
+    w_getsize(WS_WORK, w_handle, &r);
+    if (!rc_intersect(&r, &a) || !rc_intersect(&gl_rfull, &a))
+        return;
+
+    gsx_gclip(&clip);
+    gsx_moff();
+    for (po = D.w_win[w_handle].w_rlist; po; po = po->o_link)
+    {
+        rc_copy(&po->o_gr, &r);
+        if (!rc_intersect(&a, &r))
+            continue;
+
+        /* the part of r that shows part of r once moved */
+        rc_copy(&r, &d);
+        d.g_x += dx;
+        d.g_y += dy;
+        if (rc_intersect(&r, &d))
+        {
+            gsx_sclip(&r);
+            bb_screen(d.g_x - dx, d.g_y - dy, d.g_x, d.g_y, d.g_w, d.g_h);
+        }
+
+        /*
+         * a scroll exposes at most 2 strips per rectangle.  if there are
+         * too many, just redraw the whole area.
+         */
+        if (n + 2 > MAX_EXPOSED)
+            n = MAX_EXPOSED + 1;
+        else
+            n += w_exposed(&r, &d, strips + n);
+    }
+    gsx_mon();
+    gsx_sclip(&clip);
+
+    /* the rectangle list may change while redrawing, so do it now */
+    if (n > MAX_EXPOSED)
+    {
+        rc_copy(&a, strips);
+        n = 1;
+    }
+    for (i = 0; i < n; i++)
+    {
+        if (redraw)
+            redraw(w_handle, &strips[i]);
+        else
+            w_redraw(w_handle, &strips[i]);
+    }
+}
+
+
 /*
  *  Routine to fix rectangles in preparation for a source to destination
  *  blit.  If the source is at -1, then the source and destination left
@@ -1045,6 +1144,9 @@ void w_update(WORD bottom, GRECT *pt, WORD top, BOOL moved)
     }
 
     gsx_mon();
+#if CONF_WITH_SAVE_UNDER_STACK
+    bb_damage();                /* applications will redraw */
+#endif
 }
 
 
@@ -1060,7 +1162,7 @@ static void draw_change(WORD w_handle, GRECT *pt)
     GRECT   c, pprev;
     GRECT   *pw;
     WORD    start, stop;
-    BOOL    moved;
+    BOOL    moved, blitted = FALSE;
     WORD    oldtop, clrold, wasclr;
 
     wasclr = !(D.w_win[w_handle].w_flags & VF_BROKEN);
@@ -1086,7 +1188,7 @@ static void draw_change(WORD w_handle, GRECT *pt)
         return;
 
     /* update rectangle lists */
-    everyobj(gl_wtree, ROOT, NIL, (EVERYOBJ_CALLBACK)newrect, 0, 0, MAX_DEPTH);
+    everyobj(gl_wtree, ROOT, NIL, (EVERYOBJ_CALLBACK)newrect, 0, 0, MAX_DEPTH, NULL);
 
     /* remember oldtop & set new one */
     oldtop = gl_wtop;
@@ -1173,7 +1275,7 @@ static void draw_change(WORD w_handle, GRECT *pt)
             /* do a move of top guy */
             if ((pt->g_w == c.g_w) && (pt->g_h == c.g_h) && (gl_wtop == w_handle))
             {
-                moved = w_move(w_handle, &stop, &c);
+                blitted = moved = w_move(w_handle, &stop, &c);
                 start = DESKWH;
             }
 
@@ -1210,6 +1312,27 @@ static void draw_change(WORD w_handle, GRECT *pt)
         }
     }
 
+    /*
+     * if the top window was moved by blitting it, only what it uncovered
+     * needs to be redrawn.  w_move() has already added the drop shadow to c.
+     */
+    if (blitted)
+    {
+        GRECT   strips[4];
+        WORD    i, n;
+
+        w_getsize(WS_TRUE, w_handle, &pprev);
+        pprev.g_w += DROP_SHADOW_SIZE;
+        pprev.g_h += DROP_SHADOW_SIZE;
+        n = w_exposed(&c, &pprev, strips);
+        for (i = 0; i < n; i++)
+        {
+            w_drawdesk(&strips[i]);
+            w_update(start, &strips[i], stop, moved);
+        }
+        return;
+    }
+
     /* account for drop shadow (BUGFIX in 2.1) */
     c.g_w += DROP_SHADOW_SIZE;
     c.g_h += DROP_SHADOW_SIZE;
@@ -1787,7 +1910,14 @@ void wm_update(WORD beg_update)
 
         }
         else
+        {
+#if CONF_WITH_SAVE_UNDER_STACK
+            /* once the screen is given up, anyone may draw on it */
+            if ((wind_spb.sy_tas == 1) && (wind_spb.sy_owner == rlr))
+                bb_damage();
+#endif
             unsync(&wind_spb);
+        }
     }
     else
     {
@@ -195,7 +195,7 @@ void newrect(OBJECT *tree, WORD wh)
     gl_mkrect.o_link = NULL;
 
     /* break other window's rects with our current rect */
-    everyobj(tree, ROOT, wh, (EVERYOBJ_CALLBACK)mkrect, 0, 0, MAX_DEPTH);
+    everyobj(tree, ROOT, wh, (EVERYOBJ_CALLBACK)mkrect, 0, 0, MAX_DEPTH, NULL);
 
     /* get an orect in this window's list */
     new = get_orect();
@@ -178,6 +178,78 @@ struct fpd                  /* fork process descriptor */
 } ;
 
 
+#if CONF_WITH_AES_SCHED_STATS
+/*
+ * per-process scheduling statistics, published via the AESS cookie
+ *
+ * the layout is used by tools/aesstat.c and must be kept in sync with it
+ */
+typedef struct
+{
+        char    s_name[AP_NAMELEN]; /* process name (not NUL-terminated) */
+        ULONG   s_switches;     /* number of times switched to */
+        ULONG   s_waits;        /* number of times blocked waiting for an event */
+        ULONG   s_waitms;       /* total time spent blocked, in ms */
+        LONG    s_waitstart;    /* ABS_TICK value when last blocked */
+        WORD    s_waiting;      /* TRUE iff currently blocked */
+} SCHEDSTAT;
+
+typedef struct
+{
+        WORD    si_npds;        /* number of valid entries in si_pd[] */
+        WORD    si_statsize;    /* sizeof(SCHEDSTAT) */
+        ULONG   si_idle;        /* number of idle passes through the scheduler */
+        ULONG   si_forks;       /* number of FPDs processed by forker() */
+        SCHEDSTAT si_pd[NUM_PDS];
+} SCHEDINFO;
+#endif
+
+#if CONF_WITH_AES_CALL_STATS
+/*
+ * per-opcode & per-process call statistics, and per-process message
+ * queue statistics, published via the AESC cookie
+ *
+ * the layout is used by tools/aesstat.c and must be kept in sync with it
+ */
+#define NUM_AES_OPS     136     /* opcodes 0-135 */
+#define NUM_QSLOTS      8       /* messages tracked in each queue */
+#define QLAT_BUCKETS    12      /* latency < 1, 2, 4 ... 1024 ms, or more */
+
+typedef struct
+{
+        ULONG   c_calls;
+        ULONG   c_time_hi;      /* total time, high 32 bits */
+        ULONG   c_time;         /* total time, low 32 bits */
+        ULONG   c_max;          /* longest call */
+} CALLSTAT;
+
+typedef struct
+{
+        char    a_name[AP_NAMELEN]; /* process name (not NUL-terminated) */
+        CALLSTAT a_calls;       /* calls made, except to the event library */
+        ULONG   a_msgs;         /* number of messages queued for it */
+        WORD    a_maxdepth;     /* highest number of bytes in its queue */
+        WORD    a_nq;           /* number of entries in a_qtime[] & a_qbytes[] */
+        WORD    a_qlost;        /* bytes queued after those, which are not timed */
+        ULONG   a_lat[QLAT_BUCKETS]; /* histogram of the time spent in the queue */
+        ULONG   a_qtime[NUM_QSLOTS]; /* time each queued message was sent */
+        WORD    a_qbytes[NUM_QSLOTS]; /* bytes of each queued message */
+} APPSTAT;
+
+typedef struct
+{
+        WORD    ci_nops;        /* NUM_AES_OPS */
+        WORD    ci_npds;        /* number of valid entries in ci_pd[] */
+        WORD    ci_appsize;     /* sizeof(APPSTAT) */
+        WORD    ci_reserved;
+        ULONG   ci_hz;          /* frequency of the times */
+        CALLSTAT ci_op[NUM_AES_OPS]; /* includes the time spent waiting */
+        APPSTAT ci_pd[NUM_PDS];
+} CALLINFO;
+
+extern CALLINFO callinfo;
+#endif
+
 typedef enum /* specify type of requested resolution change */
 {
 	NO_RES_CHANGE,
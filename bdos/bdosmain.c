@@ -30,6 +30,9 @@
 #include "string.h"
 #include "bdosstub.h"
 #include "tosvars.h"
+#if CONF_WITH_FSEL_CATALOGUE || CONF_WITH_DIR_CACHE
+#include "gemdos.h"
+#endif
 
 /*
 **  externals
@@ -49,6 +52,9 @@ PFVOID old_trap2; /* Old trap #2 handler, also used by rwa.S */
 
 static long ni(void);
 static long xgetver(void);
+#if CONF_WITH_FSEL_CATALOGUE || CONF_WITH_DIR_CACHE
+static long xdirchanges(ULONG *pcount);
+#endif
 
 
 /*
@@ -94,7 +100,8 @@ typedef struct {
 /*
  * table of special names, used by Fopen()/Fcreate() to access
  * a character device.  note that special names can be upper or
- * lower case, but NOT mixed case.
+ * lower case, but NOT mixed case.  "PIPE:", which creates a new
+ * pipe, is handled separately.
  */
 static const SPECNAME specname_table[] =
 {
@@ -274,7 +281,11 @@ static const FND funcs[] =
     { F(xsfirst),  0, 3 },      /* 0x4E */
     { F(xsnext),   0, 0 },      /* 0x4F */
 
+#if CONF_WITH_FSEL_CATALOGUE || CONF_WITH_DIR_CACHE
+    { F(xdirchanges), 0, 2 },   /* 0x50 */
+#else
     { NI, 0, 0 },               /* 0x50 */
+#endif
     { NI, 0, 0 },
     { NI, 0, 0 },
     { NI, 0, 0 },
@@ -308,6 +319,26 @@ static long ni(void)
 }
 
 
+#if CONF_WITH_FSEL_CATALOGUE || CONF_WITH_DIR_CACHE
+ULONG dir_changes;
+
+/*
+ *  xdirchanges - Function 0x50 (Ddirchanges)
+ *
+ *  get the number of changes made to directories and media, for the AES
+ *  file selector and the desktop's directory cache.  This call is specific
+ *  to EmuTOS: another GEMDOS (e.g. MiNT) returns EINVFN, so that callers
+ *  know the changes are not counted.
+ */
+static long xdirchanges(ULONG *pcount)
+{
+    *pcount = dir_changes;
+
+    return E_OK;
+}
+#endif
+
+
 /*
  *  osinit - the bios calls this routine to initialize the os
  */
@@ -493,8 +524,12 @@ restrt:
     if (typ && fn && ((fn<12) || ((fn>=16) && (fn<=19)))) /* std funcs */
     {
         h = run->p_uft[typ & 0x7f];
+#if CONF_WITH_BDOS_PIPES
+        if ((h > 0) || ispipe(h))
+#else
         if (h > 0)
-        {   /* handle standard device functions redirected to a file */
+#endif
+        {   /* handle standard device functions redirected to a file (or pipe) */
             switch(fn)
             {
             case 6:                 /* Crawio() */
@@ -591,13 +626,23 @@ restrt:
                 /* -3   -2   -1  */
 
             num = numl;
+            pb = (char **) &pw[4];
+
+#if CONF_WITH_BDOS_PIPES
+            if (ispipe(num))
+            {
+                if (fn == GEMDOS_FREAD)
+                    return xread(num, *(long *)&pw[2], *pb);
+                if (fn == GEMDOS_FWRITE)
+                    return xwrite(num, *(long *)&pw[2], *pb);
+                return 0;
+            }
+#endif
 
             /*  check for valid handle  */ /* M01.01.0528.01 */
             if (num < -3)
                 return EIHNDL;
 
-            pb = (char **) &pw[4];
-
             /* only do things on read and write */
 
             if (fn == GEMDOS_FREAD)     /* read */
@@ -655,6 +700,10 @@ restrt:
                 break;
             }
         }
+#if CONF_WITH_BDOS_PIPES
+        if ((fn == GEMDOS_FCREATE) && (!strcmp(p,"PIPE:") || !strcmp(p,"pipe:")))
+            rc = pipe_create();
+#endif
     }
 
     if (!rc)
@@ -23,6 +23,7 @@
 #define H_Console       -1
 #define H_Aux           -2
 #define H_Print         -3
+#define H_Pipe          -4      /* first pipe, others follow downwards */
 
 
 /****************************************
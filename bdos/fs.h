@@ -44,6 +44,8 @@
 #define NUMHANDLES  (NUMSTD+OPNFILES)
 #define KBBUFSZ     64              /* size of typeahead buffer -- must be power of 2!! */
 #define KBBUFMASK   (KBBUFSZ-1)
+#define NUMPIPES    4               /* max pipes in system */
+#define PIPEBLOCK   8192L           /* pipes grow by this many bytes */
 
 /*
  *  Error handling
@@ -370,6 +372,17 @@ long ixforce(int std, int h, PD *p);
 /* duplicate a file handle. */
 long xdup(int h);
 
+#if CONF_WITH_BDOS_PIPES
+/* in-memory pipes, with character device handles */
+long pipe_create(void);
+BOOL ispipe(int h);
+long pipe_read(int h, long len, void *ubufr);
+long pipe_write(int h, long len, void *ubufr);
+long pipe_eof(int h);
+long pipe_close(int h);
+void pipe_term(PD *p);
+#endif
+
 /*
  * in fsopnclo.c
  */
@@ -458,6 +471,15 @@ OFD *makofd(DND *p);
 WORD free_available_dnds(void);
 
 
+#if CONF_WITH_FSEL_CATALOGUE || CONF_WITH_DIR_CACHE
+/* count of changes to directories and media, see xdirchanges() */
+extern ULONG dir_changes;
+# define DIR_CHANGED()  dir_changes++
+#else
+# define DIR_CHANGED()
+#endif
+
+
 /*
  * in fsmain.c
  */
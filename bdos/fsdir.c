@@ -404,6 +404,9 @@ long xchmod(char *p, int wrt, UBYTE mod)
     const char *s;
     long pos;
 
+    if (wrt)
+        DIR_CHANGED();
+
     dn = findit(p,&s,0);
     if (!dn)                                /* M01.01.1214.01 */
         return EPTHNF;
@@ -907,6 +910,8 @@ long xrename(int n, char *p1, char *p2)
     CLNO clust;
     LONG fileln;
 
+    DIR_CHANGED();
+
     if (!ixsfirst(p2,FA_SUBDIR,(DTAINFO *)0L))       /* check if new path exists */
         return EACCDN;
 
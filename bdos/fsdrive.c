@@ -187,6 +187,8 @@ WORD log_media(BPB *b, int drv)
     DMD *dm;
     unsigned long rsiz, cs, n, fs;
 
+    DIR_CHANGED();
+
     rsiz = b->recsiz;
     cs = b->clsiz;
     n = b->rdlen;
@@ -14,6 +14,10 @@
 #include "emutos.h"
 #include "fs.h"
 #include "gemerror.h"
+#include "console.h"
+#include "mem.h"
+#include "string.h"
+#include "intmath.h"
 #include "bdosstub.h"
 
 /*
@@ -49,7 +53,13 @@ long ixforce(int std, int h, PD *p)
         return EIHNDL;
 
     if (h < 0)                  /* if the non-std handle is a BIOS handle, */
+    {
+#if CONF_WITH_BDOS_PIPES
+        if ((h < H_Print) && !ispipe(h))
+            return EIHNDL;
+#endif
         p->p_uft[std] = h;      /* just store it as-is in the PD table */
+    }
     else
     {
         if (h < NUMSTD)         /* validate the non-std handle */
@@ -119,3 +129,232 @@ long xdup(int h)
 
     return i+NUMSTD;            /* return the new handle */
 }
+
+
+#if CONF_WITH_BDOS_PIPES
+
+/*
+ * in-memory pipes
+ *
+ * A pipe is a character device created by Fcreate("PIPE:"), which returns
+ * a BDOS character device handle, from H_Pipe downwards.  Since only one
+ * process runs at a time, everything written to a pipe is kept until it
+ * is read back, typically by the next command of a shell pipeline: the
+ * shell uses Fforce() to connect the pipe to the standard output of one
+ * command, then to the standard input of the next one.
+ *
+ * A pipe is a chain of PIPEBLOCK-byte blocks, so it holds as much as there
+ * is free memory.  The first block is allocated when the pipe is created,
+ * and all of them belong to the process that created the pipe rather than
+ * to the child writing into it.  Blocks are freed as they are read, and
+ * the pipe is freed by Fclose() of its handle, or when its owner
+ * terminates.
+ */
+typedef struct pipeblk PIPEBLK;
+struct pipeblk
+{
+    PIPEBLK *pb_next;           /* next block to read, NULL for the last */
+    char pb_data[PIPEBLOCK];
+};
+
+typedef struct
+{
+    PD   *pi_own;               /* owner, or NULL if free */
+    PIPEBLK *pi_first;          /* block being read */
+    PIPEBLK *pi_last;           /* block being written */
+    long pi_pos;                /* bytes read from pi_first */
+    long pi_len;                /* bytes written to pi_last */
+} PIPE;
+
+static PIPE pipes[NUMPIPES];
+
+
+static PIPE *getpipe(int h)
+{
+    int i = H_Pipe - h;
+
+    if ((i < 0) || (i >= NUMPIPES) || !pipes[i].pi_own)
+        return NULL;
+
+    return &pipes[i];
+}
+
+
+/*
+ * allocate a block for a pipe, on behalf of its owner
+ */
+static PIPEBLK *pipe_block(PD *own)
+{
+    PIPEBLK *pb = xmalloc(sizeof(PIPEBLK));
+
+    if (pb)
+    {
+        set_owner(pb, own);
+        pb->pb_next = NULL;
+    }
+
+    return pb;
+}
+
+
+/*
+ * pipe_create - create a pipe, for Fcreate("PIPE:")
+ *
+ * like the other special names, the handle is returned as a WORD
+ *
+ * Error returns:
+ *     ENHNDL
+ *     ENSMEM
+ */
+long pipe_create(void)
+{
+    PIPE *pi;
+    int i;
+
+    for (i = 0, pi = pipes; i < NUMPIPES; i++, pi++)
+        if (!pi->pi_own)
+            break;
+
+    if (i == NUMPIPES)
+        return ENHNDL;          /* no free pipes */
+
+    pi->pi_first = pi->pi_last = pipe_block(run);
+    if (!pi->pi_first)
+        return ENSMEM;
+
+    pi->pi_own = run;
+    pi->pi_len = pi->pi_pos = 0L;
+
+    return (UWORD)(H_Pipe - i);
+}
+
+
+BOOL ispipe(int h)
+{
+    return getpipe(h) != NULL;
+}
+
+
+/*
+ * pipe_read - read from a pipe
+ *
+ * returns the number of bytes read, 0 if the pipe is empty
+ */
+long pipe_read(int h, long len, void *ubufr)
+{
+    PIPE *pi = getpipe(h);
+    PIPEBLK *pb;
+    long n, done = 0L;
+
+    if (!pi)
+        return EIHNDL;
+
+    while (done < len)
+    {
+        pb = pi->pi_first;
+        n = ((pb == pi->pi_last) ? pi->pi_len : PIPEBLOCK) - pi->pi_pos;
+        if (n == 0)
+        {
+            if (pb == pi->pi_last)
+                break;          /* empty */
+            pi->pi_first = pb->pb_next;
+            pi->pi_pos = 0L;
+            xmfree(pb);
+            continue;
+        }
+        n = min(n, len - done);
+        memcpy((char *)ubufr + done, pb->pb_data + pi->pi_pos, n);
+        pi->pi_pos += n;
+        done += n;
+    }
+
+    /* once everything has been read, the last block can be reused */
+    if ((pi->pi_first == pi->pi_last) && (pi->pi_pos == pi->pi_len))
+        pi->pi_pos = pi->pi_len = 0L;
+
+    return done;
+}
+
+
+/*
+ * pipe_write - write to a pipe
+ *
+ * returns the number of bytes written, which is short if memory is full
+ */
+long pipe_write(int h, long len, void *ubufr)
+{
+    PIPE *pi = getpipe(h);
+    PIPEBLK *pb;
+    long n, done = 0L;
+
+    if (!pi)
+        return EIHNDL;
+
+    while (done < len)
+    {
+        if (pi->pi_len == PIPEBLOCK)
+        {
+            pb = pipe_block(pi->pi_own);
+            if (!pb)
+                break;
+            pi->pi_last->pb_next = pb;
+            pi->pi_last = pb;
+            pi->pi_len = 0L;
+        }
+        n = min(PIPEBLOCK - pi->pi_len, len - done);
+        memcpy(pi->pi_last->pb_data + pi->pi_len, (char *)ubufr + done, n);
+        pi->pi_len += n;
+        done += n;
+    }
+
+    return done;
+}
+
+
+long pipe_eof(int h)
+{
+    PIPE *pi = getpipe(h);
+
+    if (!pi)
+        return EIHNDL;
+
+    return ((pi->pi_first == pi->pi_last) && (pi->pi_pos >= pi->pi_len)) ? 1 : 0;
+}
+
+
+long pipe_close(int h)
+{
+    PIPE *pi = getpipe(h);
+    PIPEBLK *pb;
+
+    if (!pi)
+        return EIHNDL;
+
+    while (pi->pi_first)
+    {
+        pb = pi->pi_first;
+        pi->pi_first = pb->pb_next;
+        xmfree(pb);
+    }
+    pi->pi_own = NULL;
+
+    return E_OK;
+}
+
+
+/*
+ * pipe_term - forget the pipes of a terminating process
+ *
+ * their buffers are freed along with the rest of its memory
+ */
+void pipe_term(PD *p)
+{
+    PIPE *pi;
+    int i;
+
+    for (i = 0, pi = pipes; i < NUMPIPES; i++, pi++)
+        if (pi->pi_own == p)
+            pi->pi_own = NULL;
+}
+
+#endif /* CONF_WITH_BDOS_PIPES */
@@ -293,6 +293,11 @@ long eof(int h)
 {
     OFD *f;
 
+#if CONF_WITH_BDOS_PIPES
+    if (ispipe(h))
+        return pipe_eof(h);
+#endif
+
     f = getofd(h);
     if (!f)
         return EIHNDL;
@@ -439,6 +444,11 @@ long xread(int h, long len, void *ubufr)
     OFD *p;
     long ret;
 
+#if CONF_WITH_BDOS_PIPES
+    if (ispipe(h))
+        return pipe_read(h,len,ubufr);
+#endif
+
     p = getofd(h);
     if (p)
         ret = ixread(p,len,ubufr);
@@ -526,6 +536,11 @@ long xwrite(int h, long len, void *ubufr)
     OFD *p;
     long ret;
 
+#if CONF_WITH_BDOS_PIPES
+    if (ispipe(h))
+        return pipe_write(h,len,ubufr);
+#endif
+
     p = getofd(h);
 
     /*
@@ -104,6 +104,7 @@ long ixcreat(char *name, UBYTE attr)
     long pos, rc;
 
     n[0] = ERASE_MARKER; n[1] = 0;
+    DIR_CHANGED();
 
     /* first find path */
 
@@ -427,7 +428,13 @@ long xclose(int h)
     long rc;
 
     if (h < 0)
+    {
+#if CONF_WITH_BDOS_PIPES
+        if (ispipe(h))
+            return pipe_close(h);
+#endif
         return E_OK;    /* always a good close on a character device */
+    }
 
     if (h >= NUMHANDLES)            /* M01.01.1022.01 */
         return EIHNDL;
@@ -528,10 +535,16 @@ long ixclose(OFD *fd, int part)
     {
         FCB *fcb;
         UBYTE attr;
+#if CONF_WITH_FSEL_CATALOGUE || CONF_WITH_DIR_CACHE
+        UBYTE old[10];
+#endif
 
         ixlseek(fd->o_dirfil,fd->o_dirbyt); /* start of dir entry */
         fcb = ixgetfcb(fd->o_dirfil);
         attr = fcb->f_attrib;               /* get attributes */
+#if CONF_WITH_FSEL_CATALOGUE || CONF_WITH_DIR_CACHE
+        memcpy(old,&fcb->f_td,10);
+#endif
         memcpy(&fcb->f_td,&dfd->o_td,10);   /* copy date/time, start, length */
         swpw(fcb->f_clust);                 /*  & fixup byte order */
         swpl(fcb->f_fileln);
@@ -541,6 +554,11 @@ long ixclose(OFD *fd, int part)
         else
             attr |= FA_ARCHIVE;             /* set the archive flag for files */
 
+#if CONF_WITH_FSEL_CATALOGUE || CONF_WITH_DIR_CACHE
+        if (memcmp(old,&fcb->f_td,10))      /* date/time or length changed */
+            DIR_CHANGED();
+#endif
+
         ixlseek(fd->o_dirfil,fd->o_dirbyt+FNAMELEN);/* seek to attrib byte */
         ixwrite(fd->o_dirfil,1,&attr);          /*  & rewrite it       */
         dfd->o_flag &= ~O_DIRTY;            /* not dirty any more */
@@ -654,6 +672,8 @@ long ixdel(DND *dn, FCB *f, long pos)
     int n;
     char c;
 
+    DIR_CHANGED();
+
     for (fd = dn->d_files; fd; fd = fd->o_link)
         if (fd->o_dirbyt == pos)
             for (n = 0; n < OPNFILES; n++)
@@ -16,15 +16,154 @@
 
 
 /*
- *  STATIUMEM - cond comp; set to true to count calls to these routines
+ *  STATIUMEM - cond comp; set to true to count calls to these routines,
+ *  and the number of MDs they visit
  */
+#ifndef STATIUMEM
 #define STATIUMEM   FALSE
+#endif
 
 #if STATIUMEM
 long ccffit;
 long ccfreeit;
+long ccvisits;
+# define VISIT()    ++ccvisits
+#else
+# define VISIT()
+#endif
+
+
+#if CONF_WITH_FFIT_SIZE_CLASSES
+/*
+ *  size class hints
+ *
+ *  The free lists must stay singly-linked lists of MDs in ascending address
+ *  sequence, because programs may look at them.  Small fragments tend to
+ *  collect at the start of the lists, so ffit() would walk over them for
+ *  every request.  To avoid that, we remember for each size class an MD
+ *  such that all the free blocks up to and including it are smaller than
+ *  the class.  A search for a block of that class can start just after it,
+ *  and still finds the same block as a walk from the start of the list.
+ *
+ *  The hint is the MD before the first candidate, so that ffit() can
+ *  unlink it; when there is nothing to skip, it is the MPB itself, whose
+ *  mp_mfl is at the same offset as m_link.
+ */
+#define NUM_CLASSES     8
+#define CLASS_SIZE(k)   (16L << (2*(k)))    /* 16 bytes to 256KB */
+
+typedef struct {
+    MEMORY_PARTITION_BLOCK *mp; /* NULL until fit_hints_reset() */
+    MEMORY_DESCRIPTOR *before[NUM_CLASSES];
+} FITHINTS;
+
+#if CONF_WITH_ALT_RAM
+static FITHINTS fithints[2];
+#else
+static FITHINTS fithints[1];
+#endif
+
+#define HEAD(mp)    ((MEMORY_DESCRIPTOR *)(mp))
+
+
+/*
+ *  fit_hints_reset - forget the hints for a memory partition
+ *
+ *  must be called when the free list is modified other than by ffit()
+ *  and freeit()
+ */
+void fit_hints_reset(MEMORY_PARTITION_BLOCK *mp)
+{
+    FITHINTS *h = &fithints[0];
+    WORD k;
+
+#if CONF_WITH_ALT_RAM
+    if (mp == &pmdalt)
+        h = &fithints[1];
+    else
+#endif
+    if (mp != &pmd)
+        return;
+
+    h->mp = mp;
+    for (k = 0; k < NUM_CLASSES; k++)
+        h->before[k] = HEAD(mp);
+}
+
+
+static FITHINTS *get_hints(MEMORY_PARTITION_BLOCK *mp)
+{
+    if (fithints[0].mp == mp)
+        return &fithints[0];
+#if CONF_WITH_ALT_RAM
+    if (fithints[1].mp == mp)
+        return &fithints[1];
 #endif
 
+    return NULL;
+}
+
+
+/*
+ *  size_class - return the largest class not larger than 'amount', or -1
+ */
+static WORD size_class(LONG amount)
+{
+    WORD k;
+
+    for (k = NUM_CLASSES-1; k >= 0; k--)
+        if (amount >= CLASS_SIZE(k))
+            break;
+
+    return k;
+}
+
+
+/*
+ *  hints_unlinked - MD 'q', which followed 'p', was removed from the free list
+ */
+static void hints_unlinked(FITHINTS *h, MEMORY_DESCRIPTOR *q, MEMORY_DESCRIPTOR *p)
+{
+    WORD k;
+
+    for (k = 0; k < NUM_CLASSES; k++)
+        if (h->before[k] == q)
+            h->before[k] = p;
+}
+
+
+/*
+ *  hints_grown - the free block 'q' was added or enlarged: move the hints
+ *  that are not before it to 'p', the MD before it
+ */
+static void hints_grown(FITHINTS *h, MEMORY_DESCRIPTOR *q, MEMORY_DESCRIPTOR *p)
+{
+    WORD k;
+
+    for (k = 0; k < NUM_CLASSES; k++)
+        if ((h->before[k] != HEAD(h->mp)) && (h->before[k]->m_start >= q->m_start))
+            h->before[k] = p;
+}
+
+
+/*
+ *  max_free - return the size of the largest block from 'q' onwards
+ */
+static LONG max_free(MEMORY_DESCRIPTOR *q)
+{
+    LONG maxval;
+
+    for (maxval = 0L; q; q = q->m_link)
+    {
+        VISIT();
+        if (q->m_length > maxval)
+            maxval = q->m_length;
+    }
+
+    return maxval;
+}
+#endif /* CONF_WITH_FFIT_SIZE_CLASSES */
+
 
 /*
  *  ffit - find first fit for requested memory in ospool
@@ -33,6 +172,10 @@ MEMORY_DESCRIPTOR *ffit(long amount, MEMORY_PARTITION_BLOCK *mp)
 {
     MEMORY_DESCRIPTOR *p, *q, *p1;     /* free list is composed of MEMORY_DESCRIPTOR's */
     LONG maxval;
+#if CONF_WITH_FFIT_SIZE_CLASSES
+    FITHINTS *h;
+    WORD k;
+#endif
 
 #ifdef ENABLE_KDEBUG
     if (mp == &pmd)
@@ -62,9 +205,27 @@ MEMORY_DESCRIPTOR *ffit(long amount, MEMORY_PARTITION_BLOCK *mp)
      */
     if (amount == -1L)
     {
+#if CONF_WITH_FFIT_SIZE_CLASSES
+        /*
+         * the blocks up to a hint are smaller than its class, so they
+         * only need to be looked at if none of the following ones is
+         * at least as large
+         */
+        h = get_hints(mp);
+        for (k = h ? NUM_CLASSES-1 : -1; k >= 0; k--)
+        {
+            p = h->before[k];
+            maxval = max_free(p->m_link);
+            if ((maxval >= CLASS_SIZE(k)) || (p == HEAD(mp)))
+                break;
+        }
+        if (k < 0)
+            maxval = max_free(q);
+#else
         for (maxval = 0L; q; p = q, q = p->m_link)
             if (q->m_length > maxval)
                 maxval = q->m_length;
+#endif
 
         KDEBUG(("BDOS ffit: maxval=%ld\n",maxval));
         return (MEMORY_DESCRIPTOR *)maxval;
@@ -82,14 +243,31 @@ MEMORY_DESCRIPTOR *ffit(long amount, MEMORY_PARTITION_BLOCK *mp)
     else
         amount = (amount + MALLOC_ALIGN_ALTRAM) & ~MALLOC_ALIGN_ALTRAM;
 
+#if CONF_WITH_FFIT_SIZE_CLASSES
+    /* skip the blocks known to be too small */
+    h = get_hints(mp);
+    k = h ? size_class(amount) : -1;
+    if (k >= 0)
+    {
+        p = h->before[k];
+        q = p->m_link;
+    }
+#endif
+
     /*
      * look for first free space that's large enough
      * (this could be changed to a best-fit quite easily)
      */
     for ( ; q; p = q, q = p->m_link)
     {
+        VISIT();
         if (q->m_length >= amount)
             break;
+#if CONF_WITH_FFIT_SIZE_CLASSES
+        /* no block of class k so far: move the hint on */
+        if ((k >= 0) && (p == h->before[k]) && (q->m_length < CLASS_SIZE(k)))
+            h->before[k] = q;
+#endif
     }
     if (!q)
     {
@@ -123,6 +301,12 @@ MEMORY_DESCRIPTOR *ffit(long amount, MEMORY_PARTITION_BLOCK *mp)
         q->m_length = amount;
     }
 
+#if CONF_WITH_FFIT_SIZE_CLASSES
+    /* q is no longer on the free list */
+    if (h)
+        hints_unlinked(h, q, p);
+#endif
+
     /*
      * link allocated block into allocated list & mark owner of block
      */
@@ -136,23 +320,29 @@ MEMORY_DESCRIPTOR *ffit(long amount, MEMORY_PARTITION_BLOCK *mp)
 
 
 /*
- *  freeit - Free up a memory descriptor
+ *  freeaddr - Free up the allocated block starting at 'addr'
+ *
+ *  returns -1 if there is no such block
  */
-void freeit(MEMORY_DESCRIPTOR *m, MEMORY_PARTITION_BLOCK *mp)
+WORD freeaddr(UBYTE *addr, MEMORY_PARTITION_BLOCK *mp)
 {
     MEMORY_DESCRIPTOR *p, *q, *f;
+#if CONF_WITH_FFIT_SIZE_CLASSES
+    MEMORY_DESCRIPTOR *r = NULL;
+    FITHINTS *h = get_hints(mp);
+#endif
 
 #ifdef ENABLE_KDEBUG
     if (mp == &pmd)
-        KDEBUG(("BDOS freeit: mp=&pmd\n"));
+        KDEBUG(("BDOS freeaddr: mp=&pmd\n"));
 #if CONF_WITH_ALT_RAM
     else if (mp == &pmdalt)
-        KDEBUG(("BDOS freeit: mp=&pmdalt\n"));
+        KDEBUG(("BDOS freeaddr: mp=&pmdalt\n"));
 #endif /* CONF_WITH_ALT_RAM */
     else
-        KDEBUG(("BDOS freeit: mp=%p\n",mp));
+        KDEBUG(("BDOS freeaddr: mp=%p\n",mp));
 #endif
-    KDEBUG(("BDOS freeit: start=%p, length=%ld\n",m->m_start,m->m_length));
+    KDEBUG(("BDOS freeaddr: start=%p\n",addr));
 
 #if STATIUMEM
     ++ccfreeit;
@@ -162,13 +352,16 @@ void freeit(MEMORY_DESCRIPTOR *m, MEMORY_PARTITION_BLOCK *mp)
      * first, find it in the allocated list
      */
     for (p = mp->mp_mal, q = NULL; p; q = p, p = p->m_link)
-        if (m->m_start == p->m_start)
+    {
+        VISIT();
+        if (addr == p->m_start)
             break;
+    }
 
     if (!p)
     {
-        KDEBUG(("BDOS freeit: invalid MEMORY_DESCRIPTOR address %p\n",m));
-        return;
+        KDEBUG(("BDOS freeaddr: invalid block address %p\n",addr));
+        return -1;
     }
 
     /*
@@ -185,9 +378,16 @@ void freeit(MEMORY_DESCRIPTOR *m, MEMORY_PARTITION_BLOCK *mp)
      *
      * p -> MEMORY_DESCRIPTOR to be added
      */
+#if CONF_WITH_FFIT_SIZE_CLASSES
+    for (f = mp->mp_mfl, q = NULL; f; r = q, q = f, f = f-> m_link)
+#else
     for (f = mp->mp_mfl, q = NULL; f; q = f, f = f-> m_link)
+#endif
+    {
+        VISIT();
         if (p->m_start <= f->m_start)
             break;
+    }
 
     /*
      * insert it
@@ -198,6 +398,21 @@ void freeit(MEMORY_DESCRIPTOR *m, MEMORY_PARTITION_BLOCK *mp)
     else
         mp->mp_mfl = p;
 
+#if CONF_WITH_FFIT_SIZE_CLASSES
+    /*
+     * the hints must now be before the new block, or before its lower
+     * neighbour if they are about to be joined.  This also moves any hint
+     * that points to the higher neighbour.
+     */
+    if (h)
+    {
+        if (q && (q->m_start + q->m_length == p->m_start))
+            hints_grown(h, q, r ? r : HEAD(mp));
+        else
+            hints_grown(h, p, q ? q : HEAD(mp));
+    }
+#endif
+
     /*
      * finally, coalesce free blocks if possible
      */
@@ -216,6 +431,17 @@ void freeit(MEMORY_DESCRIPTOR *m, MEMORY_PARTITION_BLOCK *mp)
             q->m_link = p->m_link;
             xmfremd(p);
         }
+
+    return 0;
+}
+
+
+/*
+ *  freeit - Free up a memory descriptor
+ */
+void freeit(MEMORY_DESCRIPTOR *m, MEMORY_PARTITION_BLOCK *mp)
+{
+    freeaddr(m->m_start, mp);
 }
 
 
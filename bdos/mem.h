@@ -56,6 +56,20 @@ void xmfremd(MEMORY_DESCRIPTOR *md);       /* xmfremd - free an MEMORY_DESCRIPTO
 /* init os memory */
 void osmem_init(void);
 
+#if CONF_WITH_DYNAMIC_OSMEM
+/* os memory usage, published via the OSMS cookie */
+typedef struct {
+    ULONG os_evictions;     /* times DNDs had to be freed to get a block */
+    UWORD os_static;        /* blocks in the static pool */
+    UWORD os_slabsize;      /* blocks added to the pool at a time */
+    UWORD os_slabs;         /* slabs taken from the TPA */
+    UWORD os_inuse[4];      /* blocks in use, per MEMTYPE_xxx */
+    UWORD os_maxuse[4];     /* highest value of os_inuse[] */
+} OSMSTAT;
+
+extern OSMSTAT osmstat;
+#endif
+
 /*
  * in umem.c
  */
@@ -87,10 +101,16 @@ void set_owner(void *addr, PD *p);
 
 /* find first fit for requested memory in ospool */
 MEMORY_DESCRIPTOR *ffit(long amount, MEMORY_PARTITION_BLOCK *mp);
+/* Free up the allocated block at an address, -1 if there is none */
+WORD freeaddr(UBYTE *addr, MEMORY_PARTITION_BLOCK *mp);
 /* Free up a memory descriptor */
 void freeit(MEMORY_DESCRIPTOR *m, MEMORY_PARTITION_BLOCK *mp);
 /* shrink a memory descriptor */
 WORD shrinkit(MEMORY_DESCRIPTOR *m, MEMORY_PARTITION_BLOCK *mp, LONG newlen);
+#if CONF_WITH_FFIT_SIZE_CLASSES
+/* forget the ffit() hints after changing a free list directly */
+void fit_hints_reset(MEMORY_PARTITION_BLOCK *mp);
+#endif
 
 
 #endif /* MEM_H */
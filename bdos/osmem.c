@@ -27,6 +27,8 @@
 #include "mem.h"
 #include "bdosstub.h"
 #include "biosext.h"
+#include "cookie.h"
+#include "string.h"
 
 /*
  *  local constants
@@ -36,6 +38,12 @@
 /* size of os memory pool, in words: */
 #define LENOSM          (LEN_OSM_BLOCK*NUM_OSM_BLOCKS/sizeof(WORD))
 
+#if CONF_WITH_DYNAMIC_OSMEM
+#define OSM_SLAB_BLOCKS 32          /* blocks added to the pool at a time */
+#define OSM_MAX_SLABS   16          /* limits the memory taken from the TPA */
+#define OSM_RESERVE     2           /* blocks kept free for MDBLOCKs */
+#endif
+
 
 /*
  *  local typedefs
@@ -51,6 +59,7 @@ typedef struct _mdb MDBLOCK;
 struct _mdb {
     MDBLOCK *mdb_next;
     MDEXT entry[MDS_PER_BLOCK];
+    MDBLOCK *mdb_prev;          /* the entries must follow mdb_next, see xmfremd() */
 };
 
 
@@ -77,6 +86,15 @@ WORD *root[MAXQUICK];
 
 static MDBLOCK *mdbroot;    /* root for partially-used MDBLOCKs */
 
+#if CONF_WITH_DYNAMIC_OSMEM
+/*
+ *  usage statistics, published via the OSMS cookie for tools/osmstat.c
+ */
+OSMSTAT osmstat;
+
+static BOOL growing;        /* grow_pool() is running */
+#endif
+
 
 /*
  *  local debug counters
@@ -113,6 +131,93 @@ static WORD *getosm(WORD n)
 }
 
 
+#if CONF_WITH_DYNAMIC_OSMEM
+/*
+ * few_blocks_left - return TRUE iff fewer than OSM_RESERVE blocks are
+ * available, counting those still in osmem[]
+ */
+static BOOL few_blocks_left(void)
+{
+    WORD **p;
+    WORD n;
+
+    n = osmlen / (LEN_OSM_BLOCK/sizeof(WORD));
+    for (p = (WORD **)root[4]; p && (n < OSM_RESERVE); p = (WORD **)*p)
+        n++;
+
+    return n < OSM_RESERVE;
+}
+
+
+/*
+ * grow_pool - add a slab of OSM_SLAB_BLOCKS blocks to the free list
+ *
+ * The memory is taken from the TPA, preferably from alternative RAM, and
+ * permanently allocated as by Ptermres(): this is what FOLDRnnn.PRG does.
+ * Allocating it needs an MD, which is why we grow before the free list
+ * is empty.
+ *
+ * Returns TRUE iff the pool was grown.
+ */
+static BOOL grow_pool(void)
+{
+    MEMORY_PARTITION_BLOCK *mp;
+    MEMORY_DESCRIPTOR *m = NULL;
+    WORD *p;
+    WORD i;
+
+    if (growing || (osmstat.os_slabs >= OSM_MAX_SLABS))
+        return FALSE;
+
+    growing = TRUE;
+#if CONF_WITH_ALT_RAM
+    mp = &pmdalt;
+    m = ffit(OSM_SLAB_BLOCKS*(LONG)LEN_OSM_BLOCK, mp);
+    if (!m)
+#endif
+    {
+        mp = &pmd;
+        m = ffit(OSM_SLAB_BLOCKS*(LONG)LEN_OSM_BLOCK, mp);
+    }
+    growing = FALSE;
+
+    if (!m)
+    {
+        KDEBUG(("grow_pool(): no memory for a new slab\n"));
+        return FALSE;
+    }
+
+    /* ffit() put the block at the start of the allocated list: remove it */
+    mp->mp_mal = m->m_link;
+    p = (WORD *)m->m_start;
+    xmfremd(m);
+
+    for (i = 0; i < OSM_SLAB_BLOCKS; i++, p += LEN_OSM_BLOCK/sizeof(WORD))
+    {
+        *p = 4;                     /* size in control word */
+        xmfreblk(p+1);
+    }
+    osmstat.os_slabs++;
+    KDEBUG(("grow_pool(): slab %d added\n",osmstat.os_slabs));
+
+    return TRUE;
+}
+#endif
+
+
+/*
+ *  link_mdblock - adds an MDBLOCK to the front of the mdb chain
+ */
+static void link_mdblock(MDBLOCK *mdb)
+{
+    mdb->mdb_prev = NULL;
+    mdb->mdb_next = mdbroot;
+    if (mdbroot)
+        mdbroot->mdb_prev = mdb;
+    mdbroot = mdb;
+}
+
+
 /*
  *  unlink_mdblock - unlinks an MDBLOCK from the mdb chain
  *
@@ -122,29 +227,24 @@ static WORD unlink_mdblock(MDBLOCK *mdb)
 {
     MDBLOCK *prev, *next;
 
+    prev = mdb->mdb_prev;
     next = mdb->mdb_next;
-    mdb->mdb_next = NULL;   /* neatness */
 
-    if (mdb == mdbroot)     /* first on mdb chain? */
+    if (prev)
+        prev->mdb_next = next;  /* just snip it out */
+    else if (mdb == mdbroot)    /* first on mdb chain? */
+        mdbroot = next;         /* yes, just point root to next */
+    else
     {
-        mdbroot = next;     /* yes, just point root to next */
-        return 0;
+        KDEBUG(("unlink_mdblock(): cannot unlink MDBLOCK at %p, not on mdb chain\n",mdb));
+        return -1;
     }
 
-    /*
-     * find previous MDBLOCK
-     */
-    for (prev = mdbroot; prev; prev = prev->mdb_next)
-    {
-        if (prev->mdb_next == mdb)
-        {
-            prev->mdb_next = next; /* just snip it out */
-            return 0;
-        }
-    }
+    if (next)
+        next->mdb_prev = prev;
+    mdb->mdb_next = mdb->mdb_prev = NULL;   /* neatness */
 
-    KDEBUG(("unlink_mdblock(): cannot unlink MDBLOCK at %p, not on mdb chain\n",mdb));
-    return -1;
+    return 0;
 }
 
 
@@ -152,9 +252,9 @@ static WORD unlink_mdblock(MDBLOCK *mdb)
  *  xmgetmd - get an MEMORY_DESCRIPTOR
  *
  *  To create a single pool for all osmem requests, MDs are grouped in
- *  blocks of 3 called MDBLOCKs which occupy 58 bytes.  MDBLOCKs are
+ *  blocks of 3 called MDBLOCKs which occupy 62 bytes.  MDBLOCKs are
  *  handled as follows:
- *    . they are linked in a chain, initially empty
+ *    . they are doubly linked in a chain, initially empty
  *    . when the first MEMORY_DESCRIPTOR is required, an MDBLOCK is obtained via
  *      xmgetblk() and put on the chain, and the first slot is allocated
  *    . MDs are obtained from existing partially-used MDBLOCKS
@@ -177,10 +277,9 @@ MEMORY_DESCRIPTOR *xmgetmd(void)
             return NULL;
 
         /* initialise new MDBLOCK */
-        mdb->mdb_next = NULL;
         for (i = 0; i < MDS_PER_BLOCK; i++)
             mdb->entry[i].index = -1;   /* unused */
-        mdbroot = mdb;
+        link_mdblock(mdb);
         KDEBUG(("xmgetmd(): got new MDBLOCK at %p\n",mdb));
     }
 
@@ -259,8 +358,7 @@ void xmfremd(MEMORY_DESCRIPTOR *md)
     case 2:
         break;
     case 1:             /* add to mdb chain */
-        mdb->mdb_next = mdbroot;
-        mdbroot = mdb;
+        link_mdblock(mdb);
         KDEBUG(("xmfremd(): MDBLOCK at %p now has free entry, moved to mdb chain\n",mdb));
         break;
     default:
@@ -302,6 +400,16 @@ void *xmgetblk(WORD memtype)
     i = 4;                          /* always from root[4] */
     w = 32;                         /* number of words */
 
+#if CONF_WITH_DYNAMIC_OSMEM
+    /*
+     * if the pool is nearly exhausted, grow it while we can still get an
+     * MD to do so.  MDBLOCK requests may come from the memory management
+     * routines themselves, so they must not cause ffit() to be reentered.
+     */
+    if ((memtype != MEMTYPE_MDBLOCK) && few_blocks_left())
+        grow_pool();
+#endif
+
     /*
      * we should execute the following loop a maximum of twice: the second
      * time only if we're allocating a DMD/DND/OFD & no memory is available
@@ -333,6 +441,9 @@ void *xmgetblk(WORD memtype)
          * worked, but we're here again, then it lied and we should quit
          * to avoid an infinite loop
          */
+#if CONF_WITH_DYNAMIC_OSMEM
+        osmstat.os_evictions++;
+#endif
         if ((j >= 2) || (free_available_dnds() == 0))
         {
             kcprintf(_("\033EOut of internal memory.\nUse FOLDR100.PRG to get more.\nSystem halted!\n"));
@@ -340,6 +451,18 @@ void *xmgetblk(WORD memtype)
         }
     }
 
+#if CONF_WITH_DYNAMIC_OSMEM
+    /*
+     * remember the type in the high byte of the control word, for xmfreblk()
+     */
+    if (m)
+    {
+        m[-1] = i | ((memtype+1) << 8);
+        if (++osmstat.os_inuse[memtype] > osmstat.os_maxuse[memtype])
+            osmstat.os_maxuse[memtype] = osmstat.os_inuse[memtype];
+    }
+#endif
+
     /*
      *  zero out the block
      */
@@ -361,6 +484,15 @@ void xmfreblk(void *m)
 
     i = *(((WORD *)m) - 1);
 
+#if CONF_WITH_DYNAMIC_OSMEM
+    if ((i & 0xff00) && ((i >> 8) <= MEMTYPE_OFD+1))
+    {
+        osmstat.os_inuse[(i>>8)-1]--;
+        i &= 0x00ff;
+        *(((WORD *)m) - 1) = i;
+    }
+#endif
+
     if (i != 4)
     {
         /*  bad index  */
@@ -392,4 +524,16 @@ void osmem_init(void)
     dbgfreblk = 0;
     dbggtosm = 0;
     dbggtblk = 0;
+
+#if CONF_WITH_DYNAMIC_OSMEM
+    {
+        ULONG dummy;
+
+        bzero(&osmstat, sizeof(osmstat));
+        osmstat.os_static = NUM_OSM_BLOCKS;
+        osmstat.os_slabsize = OSM_SLAB_BLOCKS;
+        if (!cookie_get(COOKIE_OSMS, &dummy))
+            cookie_add(COOKIE_OSMS, (ULONG)&osmstat);
+    }
+#endif
 }
@@ -120,6 +120,9 @@ static void ixterm(PD *r)
         if (r == sft[i].f_own)
             xclose(i+NUMSTD);
 
+#if CONF_WITH_BDOS_PIPES
+    pipe_term(r);
+#endif
 
     /* decrement usage counts for current directories */
 
@@ -132,7 +132,6 @@ void *xmalloc(long amount)
  */
 long xmfree(void *addr)
 {
-    MEMORY_DESCRIPTOR *p;
     MEMORY_PARTITION_BLOCK *mpb;
 
     KDEBUG(("BDOS: Mfree(%p)\n",addr));
@@ -143,14 +142,9 @@ long xmfree(void *addr)
 
     KDEBUG(("BDOS Mfree: mpb=%s\n",(mpb==&pmd)?"pmd":"pmdalt"));
 
-    for (p = mpb->mp_mal; p; p = p->m_link)
-        if (addr == p->m_start)
-            break;
-
-    if (!p)
+    if (freeaddr(addr,mpb) < 0)
         return EIMBA;
 
-    freeit(p,mpb);
     dump_mem_map();
 
     return E_OK;
@@ -417,6 +411,9 @@ void *srealloc(long amount)
 
     /* update length in MEMORY_DESCRIPTOR, plus saved video ram info */
     last->m_length = last->m_length + video_ram_size - amount;
+#if CONF_WITH_FFIT_SIZE_CLASSES
+    fit_hints_reset(&pmd);
+#endif
     video_ram_size = amount;
     video_ram_addr = last->m_start + last->m_length;
 
@@ -516,6 +513,9 @@ long xmaddalt(UBYTE *start, LONG size)
         pmdalt.mp_mal = NULL;
         has_alt_ram = 1;
     }
+#if CONF_WITH_FFIT_SIZE_CLASSES
+    fit_hints_reset(&pmdalt);
+#endif
 
     return 0;
 }
@@ -562,6 +562,9 @@ void umem_init(void)
     start_stram = pmd.mp_mfl->m_start;
     end_stram = start_stram + pmd.mp_mfl->m_length;
     KDEBUG(("umem_init(): start_stram=%p, end_stram=%p\n",start_stram,end_stram));
+#if CONF_WITH_FFIT_SIZE_CLASSES
+    fit_hints_reset(&pmd);
+#endif
 
 #if CONF_WITH_ALT_RAM
     /* there is no known alternative RAM initially */
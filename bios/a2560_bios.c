@@ -51,8 +51,10 @@
 #include "../foenix/interrupts.h"
 #include "../foenix/mpu401.h"
 #include "../foenix/shadow_fb.h"
+#include "../foenix/sn76489.h"
 #include "../foenix/timer.h"
 #include "../foenix/vicky2.h"
+#include "../foenix/ym262.h"
 #include "a2560_bios.h"
 #include "../foenix/regutils.h"
 
@@ -230,8 +232,22 @@ void a2560_bios_xbtimer(uint16_t timer, uint16_t control, uint16_t data, void *v
         KDEBUG(("Not supported MFP timer %d mode %04x\n", 'A' + timer, control));
         return;
     }
+    /* The OS drivers may be using the timer, see a2560_timer_claim() */
+    if (!a2560_timer_claim(timer, A2560_TIMER_XBTIMER))
+    {
+        KDEBUG(("MFP timer %c is in use by the OS\n", 'A' + timer));
+        return;
+    }
+    if ((control & 0x7) == 0)
+    {
+        /* Timer stopped: give it back */
+        a2560_timer_enable(timer, false);
+        a2560_timer_release(timer, A2560_TIMER_XBTIMER);
+        return;
+    }
+
     /* Quantity of 2.4576MHz ticks before the timer fires */
-    frequency = mfp_timer_prediv[frequency]; // FIXME something wrong here "frequency is not initialised"
+    frequency = mfp_timer_prediv[control & 0x7];
     if (data != 0)
         frequency *= data;
 
@@ -246,6 +262,9 @@ void a2560_bios_xbtimer(uint16_t timer, uint16_t control, uint16_t data, void *v
 
 #include "../foenix/trap_bindings.h"
 
+/* The PS/2 devices are being reset in the background */
+static BOOL kbd_init_pending;
+
 void a2560_bios_kbd_init(void)
 {
     /* We're using the VBL counter: that may depend on the resolution, if it changes,
@@ -261,6 +280,23 @@ void a2560_bios_kbd_init(void)
     fnx_ps2_set_key_down_handler(kbd_int);
 #endif
     fnx_ps2_set_mouse_handler(call_mousevec);
+    kbd_init_pending = TRUE;
+}
+
+
+/* Called every 20ms by the system timer, to carry on resetting the PS/2 devices */
+void a2560_bios_kbd_init_step(void)
+{
+    if (kbd_init_pending && fnx_kbd_init_step())
+        kbd_init_pending = FALSE;
+}
+
+
+/* Wait until the keyboard and mouse are ready */
+void a2560_bios_kbd_init_wait(void)
+{
+    fnx_kbd_init_wait();
+    kbd_init_pending = FALSE;
 }
 
 
@@ -437,16 +473,174 @@ void a2560_bios_midi_init(void) {
     mpu401_rx_handler = kbdvecs.midivec;
 }
 
+/* MIDI output goes through the MPU-401 driver's queue, so it is sent in the
+ * background and Bconout(3)/Midiws() bytes are kept in order */
 uint32_t a2560_bios_bcostat3(void)
 {
-    return mpu401_can_write();
+    return mpu401_tx_free() != 0;
 }
 
 void a2560_bios_bconout3(uint8_t byte)
 {
-    mpu401_write(byte);
+    a2560_bios_midiws(1, &byte);
+}
+
+/* Queue count bytes, only waiting if the queue is full */
+void a2560_bios_midiws(uint32_t count, const uint8_t *ptr)
+{
+    uint16_t n;
+    WORD old_sr;
+
+    while (count)
+    {
+        n = mpu401_tx_put(ptr, count > 0x8000 ? 0x8000 : count);
+        if (n == 0)
+        {
+            /* In case we're called with interrupts masked. The ISRs also
+             * move tx_tail, so keep them out while we do it ourselves. */
+            old_sr = set_sr(0x2700);
+            mpu401_tx_drain();
+            set_sr(old_sr);
+            continue;
+        }
+        ptr += n;
+        count -= n;
+    }
 }
 
 #endif // CONF_WITH_MPU401
 
+
+#if CONF_WITH_PSG_EMULATION
+
+/* PSG emulation support */
+
+static SNREGS sn_last;          /* what the SN76489s are playing */
+static BOOL opl3_ready;
+
+static void sn76489_play(const PSGVOICES *v)
+{
+    SNREGS sn;
+    uint8_t selected;
+    int i;
+
+    /* this runs under interrupt: keep the selection made by the program */
+    selected = sn76489_selected();
+    sn76489_select(2);          /* both chips */
+
+    if (!v)
+    {
+        sn76489_mute_all();
+        sn76489_attenuation(3, 15);
+        for (i = 0; i < 4; i++)
+            sn_last.att[i] = 15;
+    }
+    else
+    {
+        /* only write what changed, the chips are slow */
+        psgconv_sn76489(v, SN76489_CLOCK, &sn);
+        for (i = 0; i < 3; i++)
+        {
+            if (sn.tone[i] != sn_last.tone[i])
+                sn76489_tone(i, sn.tone[i]);
+        }
+        if (sn.noise != sn_last.noise)
+            sn76489_noise_source(sn.noise & 0x04, sn.noise & 0x03);
+        for (i = 0; i < 4; i++)
+        {
+            if (sn.att[i] != sn_last.att[i])
+                sn76489_attenuation(i, sn.att[i]);
+        }
+        sn_last = sn;
+    }
+
+    sn76489_select(selected);
+}
+
+/*
+ * Use OPL3 channels 0 to 2 as square wave generators: the modulator is
+ * silent, and the carrier plays at a constant level while the key is on.
+ */
+static void opl3_setup(void)
+{
+    int ch, osc;
+
+    ym262_write_reg(YM262_REG_TEST, YM262_WS_ENABLE_MASK);
+    ym262_write_reg(YM262_REG_OPL3_EN, YM262_OPL3_EN_MASK);
+
+    for (ch = 0; ch < 3; ch++)
+    {
+        ym262_channel_off(ch);
+        ym262_set_osc_connection(ch, YM262_SYN_ADD);
+        ym262_set_output(ch, YM262_OUTSEL_LR);
+        for (osc = 0; osc < 2; osc++)
+        {
+            ym262_set_oscfreqmult(ch, osc, 1);
+            ym262_set_env_type(ch, osc, YM262_EGT_SUSTAINED);
+            ym262_set_attack_rate(ch, osc, 15);
+            ym262_set_decay_rate(ch, osc, 0);
+            ym262_set_slope_rate(ch, osc, 0);
+            ym262_set_release_rate(ch, osc, 15);
+            ym262_set_osc_volume(ch, osc, 0);
+        }
+        ym262_set_osc_waveform(ch, 0, 6);   /* square */
+    }
+    opl3_ready = TRUE;
+}
+
+static void opl3_play(const PSGVOICES *v)
+{
+    static UWORD period[3];
+    static UBYTE level[3];
+    int ch;
+
+    if (!opl3_ready)
+        opl3_setup();
+
+    for (ch = 0; ch < 3; ch++)
+    {
+        if (!v || !v->level[ch] || !v->period[ch])
+        {
+            if (level[ch])
+                ym262_channel_off(ch);
+            level[ch] = 0;
+            continue;
+        }
+
+        if (v->period[ch] != period[ch])
+        {
+            /* f = 2MHz / (16 * period), in 1/10000 Hz */
+            ym262_set_freq(ch, 1250000000UL / v->period[ch]);
+            period[ch] = v->period[ch];
+        }
+        if (v->level[ch] != level[ch])
+        {
+            /* both chips have about 3dB steps, the OPL3 volume 0.75dB ones */
+            ym262_set_osc_volume(ch, 0, 63 - (15 - v->level[ch]) * 4);
+            if (!level[ch])
+                ym262_channel_on(ch);
+            level[ch] = v->level[ch];
+        }
+    }
+}
+
+/*
+ * Play what the emulated YM2149 plays on a Foenix sound chip (see PSG_TARGET_*),
+ * or silence it if 'v' is NULL. The noise channels are only played on the SN76489.
+ */
+void a2560_bios_psg_play(UWORD target, const PSGVOICES *v)
+{
+    switch(target)
+    {
+    case PSG_TARGET_SN76489:
+        sn76489_play(v);
+        break;
+    case PSG_TARGET_OPL3:
+        opl3_play(v);
+        break;
+    }
+}
+
+#endif /* CONF_WITH_PSG_EMULATION */
+
 #endif /* defined(MACHINE_FOENIX) */
@@ -65,6 +65,9 @@
 #include "amiga.h"
 #include "lisa.h"
 #include "coldfire.h"
+#include "boottime.h"
+#include "hwcache.h"
+#include "cachemap.h"
 /* Foenix A2560 stuff */
 #include "a2560_bios.h"
 #include "../foenix/trap.h"
@@ -245,6 +248,7 @@ static void bios_init(void)
 #endif
 
     /* Initialize the processor */
+    BOOT_MARK("processor_init");
     KDEBUG(("processor_init()\n"));
     processor_init();   /* Set CPU type, longframe and FPU type */
 	/* Initialise the trap interface of the Foenix library */
@@ -263,13 +267,21 @@ static void bios_init(void)
     delay_init();
 
     /* Detect optional hardware (video, sound, etc.) */
+    BOOT_MARK("machine_detect");
     KDEBUG(("machine_detect()\n"));
     machine_detect();
 
     /* Initialise machine-specific stuff */
+    BOOT_MARK("machine_init");
     KDEBUG(("machine_init()\n"));
     machine_init();
 
+#if CONF_WITH_WARM_BOOT_CACHE
+    /* Check the hardware probe results left by the previous boot */
+    KDEBUG(("hwcache_init()\n"));
+    hwcache_init();
+#endif
+
 #if defined(MACHINE_A2560U) || defined(MACHINE_A2560K) || defined(MACHINE_A2560M) || defined(MACHINE_A2560X) || defined(MACHINE_GENX)
     /* This must be done first because it detects long stack frames, that the trap handler needs to know about */
 	m68k_cpu_init();
@@ -278,6 +290,7 @@ static void bios_init(void)
 #endif
 
     /* Initialize the BIOS memory management */
+    BOOT_MARK("bmem_init");
     KDEBUG(("bmem_init()\n"));
     bmem_init();
 
@@ -302,6 +315,16 @@ static void bios_init(void)
     }
 #endif /* CONF_WITH_68040_PMMU */
 
+#if CONF_WITH_CACHE_MAP
+    /*
+     * Set the cache modes of the memory map.
+     * Must be done after bmem_init(), since it allocates the PMMU tree.
+     */
+    BOOT_MARK("cachemap_init");
+    KDEBUG(("cachemap_init()\n"));
+    cachemap_init();
+#endif
+
     /* Setup and fill the cookie jar */
     KDEBUG(("cookie_init()\n"));
     cookie_init();
@@ -330,10 +353,12 @@ static void bios_init(void)
 #endif
 
     /* Initialise the font list (requires cookie jar to be ready as it uses _AKP) */
+    BOOT_MARK("font_init");
     KDEBUG(("font_init()\n"));
     font_init();
 
     /* Set some sensible screen mode/resolution based on what's hooked to the computer */
+    BOOT_MARK("screen_init");
     KDEBUG(("screen_init()\n"));
     screen_init();
 
@@ -365,6 +390,7 @@ static void bios_init(void)
     vbl_init();
 
    /* Initialize the character devices, RS-232 port(s) */
+    BOOT_MARK("chardev_init");
     KDEBUG(("chardev_init()\n"));
     chardev_init();     /* Initialize low-memory bios vectors */
     boot_status |= CHARDEV_AVAILABLE;   /* track progress */
@@ -441,6 +467,7 @@ static void bios_init(void)
     dmasound_init();
 #endif
 
+    BOOT_MARK("snd_init");
     KDEBUG(("snd_init()\n"));
     snd_init();         /* Reset Soundchip, deselect floppies */
 
@@ -448,6 +475,7 @@ static void bios_init(void)
      * Initialise the two ACIA devices (MIDI and KBD), then initialise
      * the associated IORECs & vectors
      */
+    BOOT_MARK("kbd_init");
     KDEBUG(("kbd_init()\n"));
     kbd_init();         /* init keyboard, disable mouse and joystick */
 
@@ -461,6 +489,7 @@ static void bios_init(void)
 #endif
 #endif
 
+    BOOT_MARK("init_acia_vecs");
     KDEBUG(("init_acia_vecs()\n"));
     init_acia_vecs();   /* Init the ACIA interrupt vector and related stuff */
     KDEBUG(("after init_acia_vecs()\n"));
@@ -472,6 +501,7 @@ static void bios_init(void)
     /* Enable 50 Hz processing */
     timer_start_20ms_routine();
 
+    BOOT_MARK("delay_calibrate");
     KDEBUG(("delay_calibrate()\n"));
     delay_calibrate();  /* determine values for delay() function */
                         /*  - requires interrupts to be enabled  */
@@ -516,6 +546,7 @@ static void bios_init(void)
     }
 #endif
 
+    BOOT_MARK("boot delay");
     /* User configurable boot delay to allow harddisks etc. to get ready */
     if (FIRST_BOOT && osxhbootdelay)
     {
@@ -528,21 +559,31 @@ static void bios_init(void)
         }
     }
 
+    BOOT_MARK("blkdev_init");
     KDEBUG(("blkdev_init()\n"));
     blkdev_init();      /* floppy and harddisk initialisation */
     KDEBUG(("after blkdev_init()\n"));
 
     /* initialize BIOS components */
 
+    BOOT_MARK("parport_init");
     KDEBUG(("parport_init()\n"));
     parport_init();     /* parallel port */
 
 #if 1
+    BOOT_MARK("clock_init");
     KDEBUG(("clock_init()\n"));
     clock_init();       /* init clock */
     KDEBUG(("after clock_init()\n"));
 #endif
 
+#if defined(MACHINE_A2560U) || defined(MACHINE_A2560K) || defined(MACHINE_A2560M) || defined(MACHINE_A2560X) || defined(MACHINE_GENX)
+    /* The PS/2 devices have been resetting since kbd_init(), we need them from now on */
+    BOOT_MARK("kbd_init_wait");
+    KDEBUG(("a2560_bios_kbd_init_wait()\n"));
+    a2560_bios_kbd_init_wait();
+#endif
+
 #if CONF_WITH_NOVA
     /* Detect and initialize a Nova card, skip if Ctrl is pressed */
     if (HAS_NOVA && !(kbshift(-1) & MODE_CTRL)) {
@@ -564,6 +605,7 @@ static void bios_init(void)
      * as this is always true. */
     exec_os = os_header.os_magic->gm_init;
 
+    BOOT_MARK("osinit");
     KDEBUG(("osinit_before_xmaddalt()\n"));
     osinit_before_xmaddalt();   /* initialize BDOS (part 1) */
     KDEBUG(("after osinit_before_xmaddalt()\n"));
@@ -629,6 +671,7 @@ static void bios_init(void)
 #endif
 
 
+    BOOT_MARK("bios_init end");
     KDEBUG(("bios_init() end\n"));
 }
 
@@ -870,6 +913,7 @@ void biosmain(void)
     show_initinfo = FIRST_BOOT;
 #endif
 
+    BOOT_MARK("initinfo");
     if (show_initinfo)
         bootdev = initinfo(&shiftbits); /* show the welcome screen */
     else
@@ -886,6 +930,7 @@ void biosmain(void)
     KDEBUG(("bootflags = 0x%02x\n", bootflags));
 
     /* boot eventually from a block device (floppy or harddisk) */
+    BOOT_MARK("blkdev_boot");
     blkdev_boot();
 //#if 0 // HACK:
     Dsetdrv(bootdev);           /* Set boot drive */
@@ -0,0 +1,59 @@
+/*
+ * boottime.c - boot timeline recorder
+ *
+ * bios_init() and biosmain() mark the start of each initialisation step,
+ * so that the time spent in each can be displayed by tools/boottime.c.
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#include "emutos.h"
+#include "boottime.h"
+#include "tosvars.h"
+#include "asm.h"
+
+#if CONF_WITH_BOOT_TIMELINE
+
+#if defined(MACHINE_A2560U) || defined(MACHINE_A2560K) || defined(MACHINE_A2560M) || defined(MACHINE_A2560X) || defined(MACHINE_GENX)
+# include <stdint.h>
+# include "../foenix/foenix.h"
+# include "../foenix/regutils.h"
+/* The system timer counts up at the CPU frequency */
+# define FINE_TIME()    R32(TIMER2_VALUE)
+# define FINE_HZ        CPU_FREQ
+#else
+# define FINE_TIME()    0UL
+# define FINE_HZ        0UL
+#endif
+
+/* not initialized here, since the DATA segment may be in ROM */
+BOOTTIMELINE boot_timeline;
+
+void boot_timeline_mark(const char *name)
+{
+    BOOTSTEP *step;
+    WORD old_sr;
+
+    if (boot_timeline.bt_nsteps >= BOOT_TIMELINE_STEPS)
+        return;
+
+    if (boot_timeline.bt_nsteps == 0)
+    {
+        boot_timeline.bt_maxsteps = BOOT_TIMELINE_STEPS;
+        boot_timeline.bt_fine_hz = FINE_HZ;
+    }
+
+    step = &boot_timeline.bt_step[boot_timeline.bt_nsteps++];
+    step->bt_name = name;
+
+    /* read both counters within the same tick */
+    old_sr = set_sr(0x2700);
+    step->bt_ticks = hz_200;
+    step->bt_fine = hz_200 ? FINE_TIME() : 0UL;
+    set_sr(old_sr);
+}
+
+#endif /* CONF_WITH_BOOT_TIMELINE */
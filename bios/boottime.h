@@ -0,0 +1,46 @@
+/*
+ * boottime.h - boot timeline recorder
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#ifndef BOOTTIME_H
+#define BOOTTIME_H
+
+#if CONF_WITH_BOOT_TIMELINE
+
+#define BOOT_TIMELINE_STEPS 40
+
+/*
+ * The timeline is published via the BTIM cookie, for tools/boottime.c.
+ * The time of a step is bt_ticks/200 + bt_fine/bt_fine_hz seconds; steps
+ * recorded before the system timer is started have a time of 0.
+ */
+typedef struct
+{
+    const char *bt_name;        /* step that starts at this time */
+    ULONG bt_ticks;             /* hz_200 */
+    ULONG bt_fine;              /* system timer count within that tick */
+} BOOTSTEP;
+
+typedef struct
+{
+    UWORD bt_nsteps;
+    UWORD bt_maxsteps;          /* BOOT_TIMELINE_STEPS */
+    ULONG bt_fine_hz;           /* 0 if there is no fine counter */
+    BOOTSTEP bt_step[BOOT_TIMELINE_STEPS];
+} BOOTTIMELINE;
+
+extern BOOTTIMELINE boot_timeline;
+
+void boot_timeline_mark(const char *name);
+
+# define BOOT_MARK(name) boot_timeline_mark(name)
+#else
+# define BOOT_MARK(name)
+#endif
+
+#endif /* BOOTTIME_H */
@@ -0,0 +1,356 @@
+/*
+ * cachemap.c - cache modes of the Foenix memory map on the 68040/68060
+ *
+ * processor_init() sets up the transparent translation registers like on
+ * Atari machines: every supervisor data access is uncached, and user data
+ * is cached in write-through mode.  On the Foenix machines, this is
+ * replaced by a profile of their memory map:
+ *  - system RAM and TPA are cached in copyback mode,
+ *  - video RAM is cached in write-through mode, so VICKY sees every write,
+ *  - the I/O areas (GAVIN, BEATRIX, VICKY, SuperIO) are precise.
+ *
+ * The first 16MB are mapped 1:1 by a PMMU tree of 8K pages, since the
+ * system and video RAM of the A2560K/X share them.  The I/O areas, and the
+ * A2560M video RAM in DDR3, are covered by the transparent translation
+ * registers.  Anything else is left unmapped.
+ *
+ * The 68EC060 has no PMMU.  There, the transparent translation registers
+ * do all the work, with the default mode of the 68060 (precise) for the
+ * I/O areas, and the RAM sharing 16MB with video RAM is written through.
+ *
+ * When EmuTOS runs from RAM, the PMMU also write-protects the pages
+ * holding its TEXT segment.
+ *
+ * The modes may be changed through the FCMP cookie, mainly so that
+ * tools/cachebench.c can compare them.
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+/* #define ENABLE_KDEBUG */
+
+#include "emutos.h"
+#include "cachemap.h"
+#include "asm.h"
+#include "biosext.h"
+#include "processor.h"
+#include "bios.h"
+
+#if CONF_WITH_CACHE_MAP
+
+#include <stdint.h>
+#include "../foenix/foenix.h"
+
+#define CACHEMAP_VERSION    1
+
+/*
+ * PMMU tree: 128 root descriptors of 32MB, 128 pointer descriptors of
+ * 256KB, and page tables of 32 descriptors of 8KB
+ */
+#define TREE_TOP        0x01000000UL    /* end of the area mapped by the tree */
+#define PAGE_SIZE       0x2000UL
+#define PTR_SIZE        0x40000UL
+#define ROOT_ENTRIES    128
+#define PTR_ENTRIES     128
+#define PAGE_ENTRIES    32
+#define PAGE_TABLES     (TREE_TOP / PTR_SIZE)
+#define TREE_SIZE       ((ROOT_ENTRIES + PTR_ENTRIES + PAGE_TABLES * PAGE_ENTRIES) * sizeof(ULONG))
+#define TREE_ALIGN      512             /* alignment of the root and pointer tables */
+
+/* descriptor bits */
+#define TD_RESIDENT     0x02            /* root and pointer level */
+#define PD_RESIDENT     0x01            /* page level */
+#define PD_WRITE_PROTECT 0x04
+#define PD_USED         0x08
+#define PD_MODIFIED     0x10
+#define PD_MODE_SHIFT   5
+#define PD_MODE_MASK    (3 << PD_MODE_SHIFT)
+
+/* translation control: enable, 8K pages, default data mode precise */
+#define TC_ENABLE       0x8000
+#define TC_8K           0x4000
+#define TC_DCO_PRECISE  (CACHE_MODE_PRECISE << 8)   /* 68060 only */
+
+/* transparent translation registers: base and mask of the top address byte */
+#define TTR(base, mask, mode) \
+    (((ULONG)(base) << 24) | ((ULONG)(mask) << 16) | 0xc000 | ((mode) << 5))
+#define TTR_IO          TTR(0xfc, 0x03, CACHE_MODE_PRECISE) /* 0xfc000000-0xffffffff */
+#define TTR_FLASH_CODE  TTR(0xff, 0x00, CACHE_MODE_WRITETHROUGH)
+#define TTR_LOW_16MB(mode)  TTR(0x00, 0x00, mode)
+
+/* 68060 CACR: data, store buffer, branch and instruction caches */
+#define CACR_060        0xa0c08000UL
+#define CACR_040        0x80008000UL
+
+/* the setup of processor_init() */
+#define ATARI_DTT0      0x00ffa040UL
+#define ATARI_DTT1      0x00ff8000UL
+#define ATARI_ITT0      0x00ffe000UL
+
+/* what the regions of the first 16MB contain */
+#define KIND_RAM        0
+#define KIND_VRAM       1
+#define KIND_IO         2
+
+struct region
+{
+    ULONG start;
+    ULONG end;
+    UBYTE kind;
+};
+
+static const struct region regions[] =
+{
+    { 0, SRAM_TOP, KIND_RAM },
+#if defined(MACHINE_A2560M)
+    /* the A2560M video RAM is usually in DDR3, at CONF_VRAM_ADDRESS */
+    { SRAM_TOP, TREE_TOP, KIND_VRAM }
+#else
+    { SRAM_TOP, VRAM_Bank0, KIND_IO },
+    { VRAM_Bank0, TREE_TOP, KIND_VRAM }
+#endif
+};
+
+/* Video RAM above the tree gets its own transparent translation register */
+#if CONF_VRAM_ADDRESS >= TREE_TOP
+# define VRAM_TTR_BASE  (CONF_VRAM_ADDRESS >> 24)
+#endif
+
+/* registers loaded by cachemap_load(), in this order */
+typedef struct
+{
+    ULONG tc;
+    ULONG srp;
+    ULONG dtt0;
+    ULONG dtt1;
+    ULONG itt0;
+    ULONG itt1;
+    ULONG cacr;
+} MMUREGS;
+
+void cachemap_load(const MMUREGS *regs);    /* in processor.S */
+
+static LONG set_modes(LONG ram_mode, LONG vram_mode);
+
+/* not initialized here, since the DATA segment may be in ROM */
+CACHEMAP cachemap;
+
+static ULONG *root_table;
+static ULONG *page_tables;      /* all of them, contiguous */
+
+
+static ULONG *page_descriptor(ULONG addr)
+{
+    return &page_tables[addr / PAGE_SIZE];
+}
+
+
+/*
+ * build the PMMU tree, with the pages in precise mode for now
+ */
+static void build_tree(void)
+{
+    ULONG *ptr_table;
+    UBYTE *p;
+    ULONG addr;
+    WORD i;
+
+    p = balloc_stram(TREE_SIZE + TREE_ALIGN - 1, FALSE);
+    p = (UBYTE *)(((ULONG)p + TREE_ALIGN - 1) & ~(ULONG)(TREE_ALIGN - 1));
+
+    root_table = (ULONG *)p;
+    ptr_table = root_table + ROOT_ENTRIES;
+    page_tables = ptr_table + PTR_ENTRIES;
+
+    for (i = 0; i < ROOT_ENTRIES; i++)
+        root_table[i] = 0;
+    root_table[0] = (ULONG)ptr_table | TD_RESIDENT;
+
+    for (i = 0; i < PTR_ENTRIES; i++)
+        ptr_table[i] = (i < PAGE_TABLES) ? (ULONG)&page_tables[i * PAGE_ENTRIES] | TD_RESIDENT : 0;
+
+    for (addr = 0; addr < TREE_TOP; addr += PAGE_SIZE)
+        *page_descriptor(addr) = addr | (CACHE_MODE_PRECISE << PD_MODE_SHIFT)
+                                      | PD_MODIFIED | PD_USED | PD_RESIDENT;
+}
+
+
+#if EMUTOS_LIVES_IN_RAM
+/*
+ * write-protect the pages entirely covered by the TEXT segment
+ */
+static void protect_text(void)
+{
+    ULONG start = ((ULONG)_text + PAGE_SIZE - 1) & ~(PAGE_SIZE - 1);
+    ULONG end = (ULONG)_etext & ~(PAGE_SIZE - 1);
+    ULONG addr;
+
+    if (end > TREE_TOP)
+        end = TREE_TOP;
+
+    for (addr = start; addr < end; addr += PAGE_SIZE)
+        *page_descriptor(addr) |= PD_WRITE_PROTECT;
+
+    KDEBUG(("cachemap: TEXT protected from %p to %p\n", (void *)start, (void *)end));
+}
+#endif
+
+
+/*
+ * check that the PMMU translates addresses: map the last page of RAM to
+ * the page holding the root table, and look for a magic value stored in an
+ * unused root descriptor.  Without a PMMU, the RAM itself would be read.
+ */
+static BOOL pmmu_works(void)
+{
+    ULONG *magic = &root_table[ROOT_ENTRIES - 1];
+    ULONG offset = (ULONG)magic & (PAGE_SIZE - 1);
+    ULONG probe = SRAM_TOP - PAGE_SIZE;
+    ULONG *pd = page_descriptor(probe);
+    ULONG saved = *pd;
+    MMUREGS regs;
+    ULONG expected, seen;
+    WORD old_sr;
+
+    /* an invalid descriptor, unlike what the last page already holds */
+    expected = 0x464e5800UL;            /* 'FNX\0' */
+    if (*(volatile ULONG *)(probe + offset) == expected)
+        expected ^= 0xff00UL;
+    *magic = expected;
+
+    *pd = ((ULONG)magic & ~(PAGE_SIZE - 1)) | (saved & (PAGE_SIZE - 1));
+
+    regs.tc = TC_ENABLE | TC_8K | TC_DCO_PRECISE;
+    regs.srp = (ULONG)root_table;
+    regs.dtt0 = TTR_IO;
+    regs.dtt1 = 0;
+    regs.itt0 = TTR_FLASH_CODE;
+    regs.itt1 = 0;
+    regs.cacr = 0;
+
+    old_sr = set_sr(0x2700);
+    cachemap_load(&regs);
+    seen = *(volatile ULONG *)(probe + offset);
+    regs.tc = 0;
+    cachemap_load(&regs);
+    set_sr(old_sr);
+
+    *pd = saved;
+    *magic = 0;
+
+    return seen == expected;
+}
+
+
+/*
+ * the mode to use for memory holding data needing modes 'a' and 'b'
+ */
+static LONG safest_mode(LONG a, LONG b)
+{
+    if ((a == CACHE_MODE_PRECISE) || (b == CACHE_MODE_PRECISE))
+        return CACHE_MODE_PRECISE;
+    if ((a == CACHE_MODE_WRITETHROUGH) || (b == CACHE_MODE_WRITETHROUGH))
+        return CACHE_MODE_WRITETHROUGH;
+
+    return CACHE_MODE_COPYBACK;
+}
+
+
+/*
+ * apply the modes
+ */
+static LONG set_modes(LONG ram_mode, LONG vram_mode)
+{
+    MMUREGS regs;
+    const struct region *r;
+    ULONG addr, *pd;
+    LONG mode;
+
+    if ((ram_mode < CACHE_MODE_WRITETHROUGH) || (ram_mode > CACHE_MODE_PRECISE)
+     || (vram_mode < CACHE_MODE_WRITETHROUGH) || (vram_mode > CACHE_MODE_PRECISE))
+        return -1;
+
+    regs.srp = (ULONG)root_table;
+#ifdef VRAM_TTR_BASE
+    regs.dtt1 = TTR(VRAM_TTR_BASE, 0x00, vram_mode);
+#else
+    regs.dtt1 = 0;
+#endif
+    regs.itt1 = 0;
+    regs.cacr = (mcpu == 60) ? CACR_060 : CACR_040;
+
+    if (cachemap.cm_flags & CACHEMAP_PMMU)
+    {
+        for (r = regions; r < regions + ARRAY_SIZE(regions); r++)
+        {
+            mode = (r->kind == KIND_RAM) ? ram_mode
+                 : (r->kind == KIND_VRAM) ? vram_mode : CACHE_MODE_PRECISE;
+            for (addr = r->start; addr < r->end; addr += PAGE_SIZE)
+            {
+                pd = page_descriptor(addr);
+                *pd = (*pd & ~PD_MODE_MASK) | ((ULONG)mode << PD_MODE_SHIFT);
+            }
+        }
+        regs.tc = TC_ENABLE | TC_8K | TC_DCO_PRECISE;
+        regs.dtt0 = TTR_IO;
+        regs.itt0 = TTR_FLASH_CODE;
+    }
+    else
+    {
+#ifndef VRAM_TTR_BASE
+        /* the RAM and the video RAM share the first 16MB */
+        ram_mode = vram_mode = safest_mode(ram_mode, vram_mode);
+#endif
+        /* everything else uses the default modes: data is precise, code cached */
+        regs.tc = TC_DCO_PRECISE;
+        regs.dtt0 = TTR_LOW_16MB(ram_mode);
+        regs.itt0 = 0;
+    }
+
+    cachemap_load(&regs);
+
+    cachemap.cm_ram_mode = ram_mode;
+    cachemap.cm_vram_mode = vram_mode;
+    KDEBUG(("cachemap: RAM mode %ld, video RAM mode %ld\n", ram_mode, vram_mode));
+
+    return (ram_mode << 8) | vram_mode;
+}
+
+
+/*
+ * replace the Atari-like setup of processor_init() with the Foenix profile.
+ * This needs balloc_stram().
+ */
+void cachemap_init(void)
+{
+    if ((mcpu != 40) && (mcpu != 60))
+        return;
+
+    cachemap.cm_version = CACHEMAP_VERSION;
+    cachemap.cm_set = set_modes;
+
+    build_tree();
+    if (pmmu_works())
+    {
+        cachemap.cm_flags |= CACHEMAP_PMMU;
+#if EMUTOS_LIVES_IN_RAM
+        protect_text();
+#endif
+    }
+    else if (mcpu != 60)
+    {
+        /* the 68040 has no default mode for the I/O areas: keep the old setup */
+        MMUREGS regs = { 0, 0, ATARI_DTT0, ATARI_DTT1, ATARI_ITT0, 0, CACR_040 };
+
+        cachemap_load(&regs);
+        return;
+    }
+
+    cachemap.cm_flags |= CACHEMAP_ACTIVE;
+    set_modes(CACHE_MODE_COPYBACK, CACHE_MODE_WRITETHROUGH);
+}
+
+#endif /* CONF_WITH_CACHE_MAP */
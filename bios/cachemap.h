@@ -0,0 +1,45 @@
+/*
+ * cachemap.h - cache modes of the Foenix memory map on the 68040/68060
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#ifndef CACHEMAP_H
+#define CACHEMAP_H
+
+#if CONF_WITH_CACHE_MAP
+
+/* Cache modes, as encoded in the 68040/68060 descriptors and TTRs */
+#define CACHE_MODE_WRITETHROUGH 0
+#define CACHE_MODE_COPYBACK     1
+#define CACHE_MODE_PRECISE      2       /* not cached, serialized */
+
+/* cm_flags */
+#define CACHEMAP_ACTIVE         0x0001  /* the modes below are in use */
+#define CACHEMAP_PMMU           0x0002  /* they are set by the PMMU tree */
+
+/*
+ * The FCMP cookie points to this.  cm_set() must be called in supervisor
+ * mode, and returns the modes actually used, as (ram_mode << 8) | vram_mode,
+ * or -1 if a mode is invalid.  Its parameters are LONGs, so that it
+ * can be called from programs built without -mshort.
+ */
+typedef struct
+{
+    UWORD cm_version;
+    UWORD cm_flags;
+    UWORD cm_ram_mode;          /* system RAM and TPA */
+    UWORD cm_vram_mode;         /* video RAM */
+    LONG (*cm_set)(LONG ram_mode, LONG vram_mode);
+} CACHEMAP;
+
+extern CACHEMAP cachemap;
+
+void cachemap_init(void);
+
+#endif /* CONF_WITH_CACHE_MAP */
+
+#endif /* CACHEMAP_H */
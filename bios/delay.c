@@ -21,6 +21,7 @@
 #include "delay.h"
 #include "a2560_bios.h"
 #include "coldfire.h" /* For cookie jar info. */
+#include "hwcache.h"
 
 /*
  * initial 1 millisecond delay loop values
@@ -107,6 +108,17 @@ void delay_init(void)
  */
 void delay_calibrate(void)
 {
+#if CONF_WITH_WARM_BOOT_CACHE
+    ULONG cached = hwcache_get_loopcount();
+
+    if (cached)         /* the CPU hasn't changed since the last boot */
+    {
+        loopcount_1_msec = cached;
+        KDEBUG(("delay_calibrate cached loopcount_1_msec=%ld\n", loopcount_1_msec));
+        return;
+    }
+#endif
+
 #if defined(MACHINE_FOENIX)
     loopcount_1_msec = a2560_delay_calibrate(CALIBRATION_TIME);
 #elif CONF_WITH_MFP
@@ -146,4 +158,8 @@ void delay_calibrate(void)
 #endif
 
     KDEBUG(("delay_calibrate loopcount_1_msec=%ld\n", loopcount_1_msec));
+
+#if CONF_WITH_WARM_BOOT_CACHE
+    hwcache_set_loopcount(loopcount_1_msec);
+#endif
 }
@@ -0,0 +1,150 @@
+/*
+ * hwcache.c - warm boot hardware cache
+ *
+ * Some hardware probes are slow: the delay calibration runs for 100ms, and
+ * resetting the IDE interfaces to detect their devices can take seconds.
+ * Their results are kept here, in a section that is not cleared on reset
+ * (see emutos.ld), so that a warm boot can reuse them.
+ *
+ * The cache is emptied on every first boot, since the hardware may have
+ * changed while the machine was switched off.  It is also ignored if it was
+ * not written by this very ROM, or if its checksum is wrong.  The callers
+ * verify that cached devices still answer before relying on them.
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+/* #define ENABLE_KDEBUG */
+
+#include "emutos.h"
+#include "hwcache.h"
+#include "bios.h"
+#include "biosext.h"
+#include "biosdefs.h"
+#include "machine.h"
+#include "memory.h"
+#include "string.h"
+
+#if CONF_WITH_WARM_BOOT_CACHE
+
+#define HWCACHE_MAGIC   0x48574341UL    /* 'HWCA' */
+#define HWCACHE_VERSION 1
+
+#define HWC_LOOPCOUNT   0x0001          /* hc_loopcount is valid */
+#define HWC_IDE         0x0002          /* hc_ide_type[] is valid */
+
+typedef struct
+{
+    ULONG hc_magic;
+    UWORD hc_version;
+    UWORD hc_valid;             /* HWC_* flags */
+    ULONG hc_osdate;            /* identify the ROM that wrote the cache */
+    UBYTE *hc_osend;
+    ULONG hc_loopcount;         /* loopcount_1_msec */
+    UBYTE hc_ide_type[HWCACHE_IDE_DEVICES]; /* IDE device types */
+    ULONG hc_checksum;
+} HWCACHE;
+
+/* This is in the .warm_stram section, which survives resets */
+static HWCACHE hwcache;
+
+
+static ULONG checksum(void)
+{
+    const UBYTE *p = (const UBYTE *)&hwcache;
+    const UBYTE *end = (const UBYTE *)&hwcache.hc_checksum;
+    ULONG sum = 0;
+
+    while (p < end)
+        sum = ((sum << 5) | (sum >> 27)) + *p++;
+
+    return sum;
+}
+
+static void update(void)
+{
+    hwcache.hc_checksum = checksum();
+
+    /* a reset doesn't write back a copyback data cache */
+    flush_data_cache(&hwcache, sizeof(hwcache));
+}
+
+/*
+ * check the cache left by the previous boot, and empty it if it can't be
+ * trusted.  Must be called before any of the functions below.
+ */
+void hwcache_init(void)
+{
+    if (!FIRST_BOOT
+     && (hwcache.hc_magic == HWCACHE_MAGIC)
+     && (hwcache.hc_version == HWCACHE_VERSION)
+     && (hwcache.hc_osdate == os_header.os_date)
+     && (hwcache.hc_osend == os_header.os_end)
+     && (hwcache.hc_checksum == checksum()))
+    {
+        KDEBUG(("hwcache_init(): reusing cache, valid=0x%04x\n", hwcache.hc_valid));
+        return;
+    }
+
+    KDEBUG(("hwcache_init(): starting with an empty cache\n"));
+    bzero(&hwcache, sizeof(hwcache));
+    hwcache.hc_magic = HWCACHE_MAGIC;
+    hwcache.hc_version = HWCACHE_VERSION;
+    hwcache.hc_osdate = os_header.os_date;
+    hwcache.hc_osend = os_header.os_end;
+    update();
+}
+
+/*
+ * return the cached delay loop count, or 0 if it is not known
+ */
+ULONG hwcache_get_loopcount(void)
+{
+    return (hwcache.hc_valid & HWC_LOOPCOUNT) ? hwcache.hc_loopcount : 0UL;
+}
+
+void hwcache_set_loopcount(ULONG loopcount)
+{
+    hwcache.hc_loopcount = loopcount;
+    hwcache.hc_valid |= HWC_LOOPCOUNT;
+    update();
+}
+
+/*
+ * copy the cached types of the first 'n' IDE devices to 'types',
+ * returning FALSE if they are not known
+ */
+BOOL hwcache_get_ide(UBYTE *types, WORD n)
+{
+    if (!(hwcache.hc_valid & HWC_IDE) || (n > HWCACHE_IDE_DEVICES))
+        return FALSE;
+
+    memcpy(types, hwcache.hc_ide_type, n);
+
+    return TRUE;
+}
+
+void hwcache_set_ide(const UBYTE *types, WORD n)
+{
+    if (n > HWCACHE_IDE_DEVICES)
+        return;
+
+    bzero(hwcache.hc_ide_type, sizeof(hwcache.hc_ide_type));
+    memcpy(hwcache.hc_ide_type, types, n);
+    hwcache.hc_valid |= HWC_IDE;
+    update();
+}
+
+/*
+ * forget the IDE devices, e.g. because a cached device did not answer
+ */
+void hwcache_forget_ide(void)
+{
+    hwcache.hc_valid &= ~HWC_IDE;
+    update();
+}
+
+#endif /* CONF_WITH_WARM_BOOT_CACHE */
@@ -0,0 +1,28 @@
+/*
+ * hwcache.h - warm boot hardware cache
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#ifndef HWCACHE_H
+#define HWCACHE_H
+
+#if CONF_WITH_WARM_BOOT_CACHE
+
+#define HWCACHE_IDE_DEVICES 8   /* up to 4 interfaces of 2 devices */
+
+void hwcache_init(void);
+
+ULONG hwcache_get_loopcount(void);
+void hwcache_set_loopcount(ULONG loopcount);
+
+BOOL hwcache_get_ide(UBYTE *types, WORD n);
+void hwcache_set_ide(const UBYTE *types, WORD n);
+void hwcache_forget_ide(void);
+
+#endif /* CONF_WITH_WARM_BOOT_CACHE */
+
+#endif /* HWCACHE_H */
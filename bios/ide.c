@@ -35,6 +35,7 @@
 #include "amiga.h"
 #include "a2560_bios.h"
 #include "intmath.h"
+#include "hwcache.h"
 
 #if CONF_WITH_IDE
 
@@ -380,6 +381,10 @@ static struct {             /* space to build return data for Inquiry */
 /* prototypes */
 static WORD clear_multiple_mode(UWORD ifnum,UWORD dev);
 static void ide_detect_devices(UWORD ifnum);
+#if CONF_WITH_WARM_BOOT_CACHE
+static BOOL ide_cached_devices(void);
+static void ide_cache_devices(void);
+#endif
 static LONG ata_identify(WORD dev);
 static int ide_select_device(volatile struct IDE *interface,UWORD dev);
 static void set_chs_mode(WORD dev,struct IDENTIFY *identify);
@@ -636,10 +641,18 @@ void ide_init(void)
     KDEBUG(("ide_init(): has_ide = 0x%02x\n",has_ide));
 #endif
 
-    /* detect devices */
-    for (i = 0, bitmask = 1; i < NUM_IDE_INTERFACES; i++, bitmask <<= 1)
-        if (has_ide&bitmask)
-            ide_detect_devices(i);
+    /* detect devices, unless they are known from the previous boot */
+#if CONF_WITH_WARM_BOOT_CACHE
+    if (!ide_cached_devices())
+#endif
+    {
+        for (i = 0, bitmask = 1; i < NUM_IDE_INTERFACES; i++, bitmask <<= 1)
+            if (has_ide&bitmask)
+                ide_detect_devices(i);
+#if CONF_WITH_WARM_BOOT_CACHE
+        ide_cache_devices();
+#endif
+    }
 
     /* set multiple mode for all devices that we have info for */
     for (i = 0; i < DEVICES_PER_BUS; i++)
@@ -804,6 +817,65 @@ static void ide_detect_devices(UWORD ifnum)
         KDEBUG(("IDE i/f %d device %d is type %d\n",ifnum,i,info->dev[i].type));
 }
 
+#if CONF_WITH_WARM_BOOT_CACHE
+/*
+ * on a warm boot, use the device types found by the previous boot, which
+ * avoids resetting the interfaces.  This fails if they are not known, or
+ * if one of the ATA devices no longer answers IDENTIFY DEVICE.
+ */
+static BOOL ide_cached_devices(void)
+{
+    UBYTE types[NUM_IDE_INTERFACES*2];
+    volatile struct IDE *interface;
+    struct IFINFO_DEV *dev;
+    int i;
+
+    if (!hwcache_get_ide(types, NUM_IDE_INTERFACES*2))
+        return FALSE;
+
+    for (i = 0; i < NUM_IDE_INTERFACES*2; i++) {
+        dev = &ifinfo[i/2].dev[i&1];
+        dev->type = (has_ide & (1<<(i/2))) ? types[i] : DEVTYPE_NONE;
+        dev->options = 0;
+        dev->spi = 0;
+#if CONF_WITH_SCSI_DRIVER
+        dev->sense = 0;
+#endif
+    }
+
+    for (i = 0; i < NUM_IDE_INTERFACES; i++) {
+        if (has_ide & (1<<i)) {
+            interface = ifinfo[i].base_address;
+            MAYBE_UNUSED(interface);
+            IDE_WRITE_CONTROL(interface,IDE_CONTROL_nIEN);    /* no interrupts please */
+        }
+    }
+
+    for (i = 0; i < NUM_IDE_INTERFACES*2; i++) {
+        if ((ide_device_type(i) == DEVTYPE_ATA) && (ata_identify(i) != 0)) {
+            KDEBUG(("IDE device %d has gone, detecting devices again\n",i));
+            hwcache_forget_ide();
+            return FALSE;
+        }
+    }
+
+    KDEBUG(("IDE devices taken from the warm boot cache\n"));
+
+    return TRUE;
+}
+
+static void ide_cache_devices(void)
+{
+    UBYTE types[NUM_IDE_INTERFACES*2];
+    int i;
+
+    for (i = 0; i < NUM_IDE_INTERFACES*2; i++)
+        types[i] = ifinfo[i/2].dev[i&1].type;
+
+    hwcache_set_ide(types, NUM_IDE_INTERFACES*2);
+}
+#endif
+
 /*
  * the following code is intended to follow the PIO data transfer diagrams
  * as shown in the X3T10 specifications for the ATA/ATAPI interface.  note
@@ -44,6 +44,12 @@
 #include "timer.h"
 #include "amiga.h"
 #include "a2560_bios.h"
+#include "sound.h"
+#include "boottime.h"
+#include "cachemap.h"
+#if MACHINE_A2560_TRACE
+#include "../foenix/a2560_debug.h"
+#endif
 
 #if CONF_WITH_ADVANCED_CPU
 UBYTE is_bus32; /* 1 if address bus is 32-bit, 0 if it is 24-bit */
@@ -811,6 +817,23 @@ void fill_cookie_jar(void)
      * interrupt vector so FreeMiNT can hook it. */
     cookie_add(COOKIE__5MS, (ULONG)&vector_5ms);
 #endif
+
+#if MACHINE_A2560_TRACE
+    cookie_add(COOKIE_FTRC, (ULONG)a2560_trace_info());
+#endif
+
+#if CONF_WITH_PSG_EMULATION
+    cookie_add(COOKIE_FPSG, (ULONG)&psg_target);
+#endif
+
+#if CONF_WITH_BOOT_TIMELINE
+    cookie_add(COOKIE_BTIM, (ULONG)&boot_timeline);
+#endif
+
+#if CONF_WITH_CACHE_MAP
+    if (cachemap.cm_flags & CACHEMAP_ACTIVE)
+        cookie_add(COOKIE_FCMP, (ULONG)&cachemap);
+#endif
 }
 
 static const char * guess_machine_name(void)
@@ -130,9 +130,14 @@ LONG bconout3(WORD dev, WORD c)
  */
 void midiws(WORD cnt, const UBYTE *ptr)
 {
+#if defined(FOENIX_WITH_MIDI) && CONF_WITH_MPU401
+    /* queue the whole string at once, it is sent in the background */
+    a2560_bios_midiws((UWORD)cnt + 1UL, ptr);
+#else
     do
     {
         bconout3(3, *ptr++);
     } while(cnt--);
+#endif
 }
 
@@ -0,0 +1,148 @@
+/*
+ * psgconv.c - YM2149 register state translation
+ *
+ * This is used to emulate the ST's YM2149 on machines that have other
+ * sound chips: Giaccess() and Dosound() only update a copy of the YM2149
+ * registers, which is translated here once per system timer tick.
+ *
+ * This file has no other dependencies, so that tests/psgconv can build it
+ * on the host with PSGCONV_TEST defined.
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#ifdef PSGCONV_TEST
+# include "portab.h"
+# define CONF_WITH_PSG_EMULATION 1
+#else
+# include "emutos.h"
+#endif
+#include "psgconv.h"
+
+#if CONF_WITH_PSG_EMULATION
+
+/* YM2149 register numbers */
+#define REG_NOISE       6
+#define REG_MIXER       7
+#define REG_LEVEL       8       /* to 10 */
+#define REG_ENV_LO      11
+#define REG_ENV_HI      12
+#define REG_ENV_SHAPE   13
+
+#define LEVEL_ENV       0x10    /* level register: use the envelope */
+
+/* envelope shape bits */
+#define ENV_HOLD        0x01
+#define ENV_ALT         0x02
+#define ENV_ATT         0x04
+#define ENV_CONT        0x08
+
+/*
+ * YM2149 levels are about 3dB apart, SN76489 attenuation steps are 2dB.
+ * The quietest levels are beyond the SN76489's range, but remain audible.
+ */
+static const UBYTE level_to_att[16] = {
+    15, 14, 14, 14, 14, 14, 14, 12, 11, 9, 8, 6, 5, 3, 2, 0
+};
+
+
+/*
+ * return the envelope level (0-15), 'usecs' after the shape register
+ * was written.  A ramp lasts 16 steps of 8 * period us (the YM2149 has
+ * 32 half-size steps, but levels only have 16 values here).
+ */
+UBYTE psgconv_envelope(UBYTE shape, UWORD period, ULONG usecs)
+{
+    ULONG steps, cycle;
+    UBYTE pos, attack;
+
+    steps = usecs / (8UL * (period ? period : 1));
+    cycle = steps / 16;
+    pos = steps % 16;
+    attack = (shape & ENV_ATT) ? 1 : 0;
+
+    if (cycle == 0)
+        return attack ? pos : 15 - pos;
+
+    if (!(shape & ENV_CONT))
+        return 0;
+    if (shape & ENV_HOLD)
+        return (attack ^ ((shape & ENV_ALT) ? 1 : 0)) ? 15 : 0;
+    if ((shape & ENV_ALT) && (cycle & 1))
+        attack ^= 1;
+
+    return attack ? pos : 15 - pos;
+}
+
+
+/*
+ * work out what the YM2149 is playing, given its registers
+ */
+void psgconv_voices(const UBYTE *regs, ULONG env_usecs, PSGVOICES *v)
+{
+    UBYTE mixer = regs[REG_MIXER];
+    UBYTE env, level;
+    int i;
+
+    env = psgconv_envelope(regs[REG_ENV_SHAPE],
+                    (regs[REG_ENV_HI] << 8) | regs[REG_ENV_LO], env_usecs);
+
+    v->noise_period = regs[REG_NOISE] & 0x1f;
+    v->noise_level = 0;
+
+    for (i = 0; i < 3; i++)
+    {
+        v->period[i] = ((regs[2*i+1] & 0x0f) << 8) | regs[2*i];
+
+        level = regs[REG_LEVEL+i];
+        level = (level & LEVEL_ENV) ? env : (level & 0x0f);
+
+        /* mixer bits are active low */
+        v->level[i] = (mixer & (0x01 << i)) ? 0 : level;
+        if (!(mixer & (0x08 << i)) && (level > v->noise_level))
+            v->noise_level = level;
+    }
+}
+
+
+/*
+ * translate to the registers of a SN76489 clocked at 'snclock' Hz
+ */
+void psgconv_sn76489(const PSGVOICES *v, ULONG snclock, SNREGS *sn)
+{
+    ULONG n;
+    int i;
+
+    for (i = 0; i < 3; i++)
+    {
+        /*
+         * YM2149: f = clock / (16 * period), SN76489: f = clock / (32 * period).
+         * Notes below about 110Hz can't be reached and are played as high as that.
+         */
+        n = v->period[i] ? v->period[i] : 1;
+        n = (n * (snclock / 1000) + PSGCONV_YM_CLOCK / 1000) / (2 * PSGCONV_YM_CLOCK / 1000);
+        if (n < 1)
+            n = 1;
+        else if (n > 1023)
+            n = 1023;
+        sn->tone[i] = n;
+        sn->att[i] = level_to_att[v->level[i]];
+    }
+
+    /*
+     * There is one noise channel, with its own level, and 3 rates.
+     * Use white noise, with the rate closest to that of the YM2149.
+     */
+    sn->att[3] = level_to_att[v->noise_level];
+    if (v->noise_period <= 10)
+        sn->noise = 0x04;
+    else if (v->noise_period <= 20)
+        sn->noise = 0x05;
+    else
+        sn->noise = 0x06;
+}
+
+#endif /* CONF_WITH_PSG_EMULATION */
@@ -0,0 +1,50 @@
+/*
+ * psgconv.h - YM2149 register state translation
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#ifndef PSGCONV_H
+#define PSGCONV_H
+
+#include "portab.h"
+
+#define PSGCONV_YM_CLOCK    2000000UL   /* YM2149 clock on the ST */
+
+/*
+ * Sound chip that the PSG emulation plays on.  The FPSG cookie points to
+ * a UWORD holding one of these, which programs may change.
+ */
+#define PSG_TARGET_NONE     0
+#define PSG_TARGET_SN76489  1
+#define PSG_TARGET_OPL3     2
+
+/*
+ * What the YM2149 is playing, once the mixer and the envelope have been
+ * taken into account
+ */
+typedef struct {
+    UWORD period[3];        /* tone periods of channels A-C (12 bits) */
+    UBYTE level[3];         /* their levels, 0 (silent) to 15 */
+    UBYTE noise_period;     /* noise period (5 bits) */
+    UBYTE noise_level;      /* level of the loudest channel playing noise */
+} PSGVOICES;
+
+/*
+ * SN76489 registers: tone periods (10 bits), attenuations (0 loudest to
+ * 15 off, 3 is the noise channel) and noise control
+ */
+typedef struct {
+    UWORD tone[3];
+    UBYTE att[4];
+    UBYTE noise;
+} SNREGS;
+
+UBYTE psgconv_envelope(UBYTE shape, UWORD period, ULONG usecs);
+void psgconv_voices(const UBYTE *regs, ULONG env_usecs, PSGVOICES *v);
+void psgconv_sn76489(const PSGVOICES *v, ULONG snclock, SNREGS *sn);
+
+#endif /* PSGCONV_H */
@@ -18,6 +18,10 @@
 #include "vectors.h"
 #include "machine.h"
 #include "cookie.h"
+#include "psgconv.h"
+#if CONF_WITH_PSG_EMULATION
+# include "a2560_bios.h"
+#endif
 
 /*
  * This is a straightforward implementation of PSG-related xbios routines.
@@ -42,7 +46,42 @@
 static void do_bell(void);
 static void do_keyclick(void);
 
-#if CONF_WITH_YM2149
+#if CONF_WITH_PSG_EMULATION
+
+/*
+ * PSG emulation: there is no YM2149, so Giaccess() and Dosound() update a
+ * copy of its registers, which is played on the machine's sound chips.
+ * The registers are translated once per tick (see psg_update()), however
+ * many times they were written.
+ */
+static UBYTE psg_regs[16];
+static UBYTE psg_select;
+static BOOL psg_dirty;
+static ULONG psg_env_usecs;         /* time since the envelope shape was set */
+static UWORD psg_played;            /* target actually playing */
+UWORD psg_target;                   /* set by snd_init(): DATA may be in ROM */
+
+static void psg_write(UBYTE data)
+{
+    psg_regs[psg_select] = data;
+    if (psg_select == 13)           /* envelope shape: restart it */
+        psg_env_usecs = 0;
+    psg_dirty = TRUE;
+}
+
+# define PSG_SELECT(reg)    (psg_select = (reg) & 0x0f)
+# define PSG_READ()         (psg_regs[psg_select])
+# define PSG_WRITE(data)    psg_write(data)
+
+#elif CONF_WITH_YM2149
+
+# define PSG_SELECT(reg)    (PSG->control = (reg))
+# define PSG_READ()         (PSG->control)
+# define PSG_WRITE(data)    (PSG->data = (data))
+
+#endif
+
+#if CONF_WITH_YM2149 || CONF_WITH_PSG_EMULATION
 
 /* data used by dosound: */
 
@@ -84,6 +123,9 @@ void snd_init(void)
 
     /* dosound init */
     sndtable = NULL;
+#elif CONF_WITH_PSG_EMULATION
+    sndtable = NULL;
+    psg_target = PSG_TARGET_SN76489;
 #endif
 
     /* set bell_hook and kcl_hook */
@@ -93,17 +135,17 @@ void snd_init(void)
 
 LONG giaccess(WORD data, WORD reg)
 {
-#if CONF_WITH_YM2149
+#if CONF_WITH_YM2149 || CONF_WITH_PSG_EMULATION
     WORD old_sr;
     LONG value = 0;
 
     old_sr = set_sr(0x2700);
-    PSG->control = reg & 0xF;
+    PSG_SELECT(reg & 0xF);
     if (reg & GIACCESS_WRITE)
     {
-        PSG->data = data;
+        PSG_WRITE(data);
     }
-    value = PSG->control;
+    value = PSG_READ();
     set_sr(old_sr);
 
     return value;
@@ -144,7 +186,7 @@ void offgibit(WORD data)
 
 LONG dosound(const UBYTE *table)
 {
-#if CONF_WITH_YM2149
+#if CONF_WITH_YM2149 || CONF_WITH_PSG_EMULATION
     const UBYTE *oldtable = sndtable;
 
     if ((LONG)table >= 0)
@@ -159,8 +201,8 @@ LONG dosound(const UBYTE *table)
 #endif
 }
 
-#if CONF_WITH_YM2149
-void sndirq(void)
+#if CONF_WITH_YM2149 || CONF_WITH_PSG_EMULATION
+static void sndplay(void)
 {
     const UBYTE *code;
     UBYTE instr, data;
@@ -184,21 +226,21 @@ void sndirq(void)
             continue;
         }
         /* other values are assumed to be PSG register numbers (0-15) */
-        PSG->control = instr;
+        PSG_SELECT(instr);
         if (instr == PSG_MULTI)
         {
-            UBYTE tmp = PSG->control;
-            PSG->data = (tmp & PSG_PORT_MASK) | (data & PSG_MIXER_MASK);
+            UBYTE tmp = PSG_READ();
+            PSG_WRITE((tmp & PSG_PORT_MASK) | (data & PSG_MIXER_MASK));
         } else {
-            PSG->data = data;
+            PSG_WRITE(data);
         }
     }
 
     if (instr == 0x81)
     {
-        PSG->control = *code++;     /* register number */
+        PSG_SELECT(*code++);        /* register number */
         sndtmp += *code++;          /* increment register value */
-        PSG->data = sndtmp;         /*  & send to register      */
+        PSG_WRITE(sndtmp);          /*  & send to register      */
         if (sndtmp != *code++)      /* if current value != ending value, */
             code -= 4;              /*  rewind to run again next time    */
     }
@@ -212,6 +254,43 @@ void sndirq(void)
     sndtable = code;
 }
 
+#if CONF_WITH_PSG_EMULATION
+/*
+ * play the current PSG state on the target chip, if it may have changed
+ */
+static void psg_update(void)
+{
+    PSGVOICES v;
+    BOOL env = (psg_regs[8] | psg_regs[9] | psg_regs[10]) & 0x10;
+
+    if (psg_target != psg_played)
+    {
+        a2560_bios_psg_play(psg_played, NULL);  /* silence the old target */
+        psg_played = psg_target;
+        psg_dirty = TRUE;
+    }
+
+    if (psg_dirty || env)
+    {
+        psgconv_voices(psg_regs, psg_env_usecs, &v);
+        a2560_bios_psg_play(psg_played, &v);
+        psg_dirty = FALSE;
+    }
+
+    if (env)
+        psg_env_usecs += timer_ms * 1000UL;
+}
+#endif
+
+/* called by the system timer, every timer_ms */
+void sndirq(void)
+{
+    sndplay();
+#if CONF_WITH_PSG_EMULATION
+    psg_update();
+#endif
+}
+
 static const UBYTE bellsnd[] = {
   0, 0x34,    /* channel A pitch */
   1, 0,
@@ -246,7 +325,7 @@ static const UBYTE keyclicksnd[] = {
   0xFF, 0,
 };
 
-#endif /* CONF_WITH_YM2149 */
+#endif /* CONF_WITH_YM2149 || CONF_WITH_PSG_EMULATION */
 
 void bell(void)
 {
@@ -255,14 +334,14 @@ void bell(void)
 
 static void do_bell(void)
 {
-#if CONF_WITH_YM2149
+#if CONF_WITH_YM2149 || CONF_WITH_PSG_EMULATION
     dosound(bellsnd);
 #endif
 }
 
 static void do_keyclick(void)
 {
-#if CONF_WITH_YM2149
+#if CONF_WITH_YM2149 || CONF_WITH_PSG_EMULATION
     dosound(keyclicksnd);
 #endif
 }
@@ -31,12 +31,17 @@ void snd_init(void);
 /* play bell sound, called by the vt52 handler */
 void bell(void);
 
-#if CONF_WITH_YM2149
+#if CONF_WITH_PSG_EMULATION
+/* chip playing the emulated PSG, pointed to by the FPSG cookie */
+extern UWORD psg_target;
+#endif
+
+#if CONF_WITH_YM2149 || CONF_WITH_PSG_EMULATION
 
 /* timer C int sound routine */
 void sndirq(void);
 
-#endif /* CONF_WITH_YM2149 */
+#endif /* CONF_WITH_YM2149 || CONF_WITH_PSG_EMULATION */
 
 /*
  * the routine below is implemented in assembler in vectors.S, because
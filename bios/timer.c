@@ -29,6 +29,12 @@
 #include "keyboard.h" /* for key_repeat_tick */
 #include "sound.h"
 #include "../foenix/timer.h"
+#if defined(MACHINE_A2560U) || defined(MACHINE_A2560K) || defined(MACHINE_A2560M) || defined(MACHINE_A2560X) || defined(MACHINE_GENX)
+# include "../foenix/ps2.h"
+#endif
+#if MACHINE_A2560_TRACE
+# include "../foenix/a2560_debug.h"
+#endif
 
 /* Non-Atari hardware vectors */
 #if !CONF_WITH_MFP
@@ -51,15 +57,32 @@ void timer_20ms_routine(void);
 void timer_20ms_routine(void)
 {
     // Repeat keys
+#if defined(MACHINE_A2560U) || defined(MACHINE_A2560K) || defined(MACHINE_A2560M) || defined(MACHINE_A2560X) || defined(MACHINE_GENX)
+    // Not while the PS/2 drivers are feeding kbd_int(), which updates the
+    // same repeat state and keyboard iorec: we would be interrupting it
+    if (!ps2_busy())
+        key_repeat_tick();
+#else
     key_repeat_tick();
+#endif
 
-#if CONF_WITH_YM2149
+#if defined(MACHINE_A2560U) || defined(MACHINE_A2560K) || defined(MACHINE_A2560M) || defined(MACHINE_A2560X) || defined(MACHINE_GENX)
+    // Carry on resetting the PS/2 devices during the boot
+    a2560_bios_kbd_init_step();
+#endif
+
+#if CONF_WITH_YM2149 || CONF_WITH_PSG_EMULATION
     // Play Dosound() if appropriate
     sndirq();
 #endif
 
     // GEM
     (*etv_timer)(timer_ms); // We may as well hardcode 20...
+
+#if MACHINE_A2560_TRACE
+    // Send some pending debug output
+    a2560_trace_drain();
+#endif
 }
 
 
@@ -83,6 +106,7 @@ void init_system_timer(void)
     /* Timer C: ctrl = divide 64, data = 192 */
     xbtimer(2, 0x50, 192, (LONG)int_timerc);
 #elif defined(MACHINE_A2560U) || defined(MACHINE_A2560K) || defined(MACHINE_A2560M) || defined(MACHINE_A2560X) || defined(MACHINE_GENX)
+    a2560_timer_claim(HZ200_TIMER_NUMBER, A2560_TIMER_SYSTEM);
     a2560_set_timer(HZ200_TIMER_NUMBER, 200, true, int_timerc);
 #endif
 
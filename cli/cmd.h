@@ -44,6 +44,7 @@ extern LONG jmp_xbios(WORD, ...);
 #define jmp_gemdos_p(a,b)       jmp_gemdos((WORD)(a),(void*)(b))
 #define jmp_gemdos_ww(a,b,c)    jmp_gemdos((WORD)(a),(WORD)(b),(WORD)(c))
 #define jmp_gemdos_pw(a,b,c)    jmp_gemdos((WORD)(a),(void *)(b),(WORD)(c))
+#define jmp_gemdos_lww(a,b,c,d) jmp_gemdos((WORD)(a),(LONG)(b),(WORD)(c),(WORD)(d))
 #define jmp_gemdos_wlp(a,b,c,d) jmp_gemdos((WORD)(a),(WORD)(b),(LONG)(c),(void *)(d))
 #define jmp_gemdos_wpp(a,b,c,d) jmp_gemdos((WORD)(a),(WORD)(b),(void *)(c),(void *)(d))
 #define jmp_gemdos_pww(a,b,c,d) jmp_gemdos((WORD)(a),(void *)(b),(WORD)(c),(WORD)(d))
@@ -69,6 +70,7 @@ extern LONG jmp_xbios(WORD, ...);
 #define Fread(a,b,c)        jmp_gemdos_wlp(0x3f,a,b,c)
 #define Fwrite(a,b,c)       jmp_gemdos_wlp(0x40,a,b,c)
 #define Fdelete(a)          jmp_gemdos_p(0x41,a)
+#define Fseek(a,b,c)        jmp_gemdos_lww(0x42,a,b,c)
 #define Fattrib(a,b,c)      jmp_gemdos_pww(0x43,a,b,c)
 #define Fdup(a)             jmp_gemdos_w(0x45,a)
 #define Fforce(a,b)         jmp_gemdos_ww(0x46,a,b)
@@ -99,10 +101,17 @@ extern LONG jmp_xbios(WORD, ...);
 #define MAXCMDLINE      125     /* the most amount of real data allowed */
 
 #define IOBUFSIZE       16384L  /* buffer size */
+#define MX_PREFTTRAM    3       /* Mxalloc() mode: prefer TT-RAM */
 
 #define MAX_LINE_SIZE   200L    /* must be greater than the largest screen width */
 #define HISTORY_SIZE    10      /* number of lines of history */
 #define MAX_ARGS        30      /* maximum number of args we can parse */
+#define MAX_STAGES      4       /* maximum number of commands in a pipeline */
+#define MAX_BATCH_DEPTH 4       /* maximum nesting of batch files */
+#define MAX_BATCH_ARGS  10      /* %0 to %9 */
+#define VARIABLES_SIZE  1024L   /* space for variables set by SET */
+#define PATH_CACHE_SIZE 32      /* entries in PATH cache, must be a power of 2 */
+#define MAX_RESIDENT    8       /* maximum number of resident programs */
 
 #define LOCAL           static  /* comment out for testing */
 #define PRIVATE         static  /* comment out for testing */
@@ -121,6 +130,21 @@ extern LONG jmp_xbios(WORD, ...);
 #define DEFAULT_DT_SEPARATOR    '/'
 #define DEFAULT_DT_FORMAT   ((_IDT_12H<<12) + (_IDT_YMD<<8) + DEFAULT_DT_SEPARATOR)
 
+/*
+ * Foenix debug trace ring (see a2560trace.h)
+ */
+#if defined(MACHINE_A2560U) || defined(MACHINE_A2560K) || defined(MACHINE_A2560M) || defined(MACHINE_A2560X) || defined(MACHINE_GENX)
+#define WITH_TRACE_CMD  1
+#else
+#define WITH_TRACE_CMD  0
+#endif
+#define FTRC_COOKIE     0x46545243L     /* 'FTRC' */
+
+/*
+ * CPU type, for cache management
+ */
+#define _CPU_COOKIE     0x5f435055L     /* '_CPU' */
+
 /*
  * video stuff
  */
@@ -175,12 +199,20 @@ typedef LONG FUNC(WORD argc,char **argv);
 #define CMDLINE_LENGTH  -103
 #define DIR_NOT_EMPTY   -104        /* translated from EACCDN for folders */
 #define CANT_DELETE     -105        /* translated from EACCDN for files */
+#define PIPE_FULL       -106
+#define NO_PIPES        -107        /* Fcreate("PIPE:") is not supported */
+#define BAD_PROGRAM     -108        /* not a valid program file */
+#define NO_LABEL        -109        /* goto target not found */
+#define BATCH_DEPTH     -110        /* batch files nested too deeply */
+#define LINE_LENGTH     -111        /* line too long after expanding variables */
+#define EXIT_EMUCON     -124        /* returned by exit in a batch file */
 #define CHANGE_RES      -125        /* returned by mode command */
 #define INVALID_PARAM   -126        /* for builtin commands */
 #define WRONG_NUM_ARGS  -127        /* for builtin commands */
 
 #define ESC             0x1b
 #define DBLQUOTE        0x22
+#define PIPECHAR        '|'
 
 #define CTL_C           ('C'-0x40)
 #define CTL_Q           ('Q'-0x40)
@@ -208,13 +240,25 @@ extern WORD linewrap;
 extern WORD nflops_copy;
 extern DTA *dta;
 extern LONG redir_handle;
+extern LONG input_handle;              /* piped input, or -1L */
+extern LONG errorlevel;                /* result of last command */
+extern LONG cpu_type;                  /* from _CPU cookie, for flush_caches() */
 extern char user_path[MAXPATHLEN];     /* from PATH command */
 extern char *environment;              /* from cmdasm.S */
 
 /*
  *  function prototypes
  */
+/* cmdbatch.c */
+WORD batch_command(char *line);
+char *check_condition(char *line);
+WORD expand_line(char *line);
+const char *next_variable(const char *p);
+LONG run_batch(const char *path,WORD argc,char **argv);
+LONG set_variable(const char *assignment);
+
 /* cmdmain.c */
+WORD execute_line(char *line,LONG out);
 int valid_res(WORD res);
 
 /* cmdedit.c */
@@ -225,7 +269,11 @@ WORD read_line(char *line);
 void save_history(const char *line);
 
 /* cmdexec.c */
-LONG exec_program(WORD argc,char **argv,char *redir_name);
+LONG exec_program(WORD argc,char **argv);
+void flush_path_cache(void);
+LONG load_resident(const char *name);
+const char *next_resident(WORD *n,LONG *size);
+LONG unload_resident(const char *name);
 
 /* cmdint.c */
 LONG get_path(char *buf,WORD drive);
@@ -233,6 +281,7 @@ LONG (*lookup_builtin(WORD argc,char **argv))(WORD,char **);
 
 /* cmdparse.c */
 WORD parse_line(char *line,char **argv,char *redir_name);
+WORD split_pipeline(char *line,char **stages);
 
 /* cmdutil.c */
 WORD decode_date_time(char *s,UWORD date,UWORD time);
@@ -252,3 +301,4 @@ char *strupper(char *str);
 /* cmdasm.S */
 ULONG getwh(void);
 WORD getht(void);
+LONG flush_caches(void);
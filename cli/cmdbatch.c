@@ -0,0 +1,453 @@
+/*
+ * EmuCON2 batch files & variables
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+/*
+ * A batch file is a text file with the extension .BAT, which is run like
+ * a program.  Each line is executed as if it had been typed, after the
+ * following have been replaced:
+ *      %0 to %9        the name of the batch file & its arguments
+ *      %NAME%          the value of a variable set by SET
+ *      %ERRORLEVEL%    the result of the last command
+ *      %%              a single %
+ *
+ * The following are also supported, and all except GOTO may be typed
+ * interactively:
+ *      :label          a label for GOTO
+ *      GOTO label      continue after the label
+ *      IF [NOT] EXIST filespec command
+ *      IF [NOT] ERRORLEVEL n command   (true if the result is >= n, or an error)
+ *      IF [NOT] string1==string2 command
+ *      REM ...         a comment
+ */
+#include "cmd.h"
+#include "string.h"
+
+typedef struct batch {
+    struct batch *outer;        /* the batch file that ran this one */
+    char *text;                 /* contents of the file, NUL-terminated */
+    char *next;                 /* next line to execute */
+    WORD argc;
+    char *argv[MAX_BATCH_ARGS]; /* point into args[] */
+    char args[MAXPATHLEN+MAX_LINE_SIZE];
+    char line[MAX_LINE_SIZE];   /* line being executed */
+} BATCH;
+
+LOCAL BATCH *batch;             /* innermost batch file being run */
+LOCAL WORD batch_depth;
+LOCAL char variables[VARIABLES_SIZE];   /* NAME=value\0 ... NAME=value\0\0 */
+LOCAL char expand_buf[MAX_LINE_SIZE];
+
+/*
+ *  function prototypes
+ */
+PRIVATE char *copy_word(char *p,char *dest,WORD size);
+PRIVATE const char *get_variable(const char *name,WORD len);
+PRIVATE char *match_word(char *line,const char *word);
+PRIVATE char *next_line(char *p,char *dest);
+PRIVATE WORD same_name(const char *upper,const char *name,WORD len);
+
+
+/*
+ *  run a batch file
+ *
+ *  the output of its commands goes to redir_handle, unless redirected
+ *
+ *  returns EXIT_EMUCON or CHANGE_RES if a command requested it, which
+ *  ends the batch file, otherwise 0 or an error code
+ */
+LONG run_batch(const char *path,WORD argc,char **argv)
+{
+BATCH *b;
+LONG rc, size, saved_input, saved_output;
+WORD handle, i;
+char *p;
+
+    if (batch_depth >= MAX_BATCH_DEPTH)
+        return BATCH_DEPTH;
+
+    rc = Fsfirst(path,0x07);
+    if (rc < 0L)
+        return rc;
+    size = dta->d_length;
+
+    b = (BATCH *)Malloc(sizeof(BATCH)+size+1);
+    if (!b)
+        return ENSMEM;
+    b->text = (char *)(b+1);
+
+    rc = Fopen(path,0);
+    if (rc >= 0L) {
+        handle = LOWORD(rc);
+        rc = Fread(handle,size,b->text);
+        Fclose(handle);
+    }
+    if (rc < 0L) {
+        Mfree(b);
+        return rc;
+    }
+    b->text[rc] = '\0';
+
+    /*
+     * copy the arguments, since the buffer they are in may be reused
+     */
+    strcpy(b->args,path);
+    b->argv[0] = b->args;
+    p = b->args + strlen(path) + 1;
+    for (i = 1; (i < argc) && (i < MAX_BATCH_ARGS); i++) {
+        strcpy(p,argv[i]);
+        b->argv[i] = p;
+        p += strlen(p) + 1;
+    }
+    b->argc = i;
+
+    b->next = b->text;
+    b->outer = batch;
+    batch = b;
+    batch_depth++;
+
+    saved_output = redir_handle;
+    saved_input = input_handle;
+    input_handle = -1L;
+
+    for (rc = 0L; *b->next; ) {
+        if (constat() && (LOBYTE(conin()) == CTL_C)) {
+            rc = USER_BREAK;
+            break;
+        }
+        b->next = next_line(b->next,b->line);
+        if (b->line[0] == ':')          /* label */
+            continue;
+        i = execute_line(b->line,saved_output);
+        if (i) {
+            rc = (i < 0) ? EXIT_EMUCON : CHANGE_RES;
+            break;
+        }
+    }
+
+    redir_handle = saved_output;
+    input_handle = saved_input;
+
+    batch = b->outer;
+    batch_depth--;
+    Mfree(b);
+
+    return rc;
+}
+
+/*
+ *  handle the commands which change the flow of a batch file
+ *
+ *  returns 1 iff the line was one of them
+ */
+WORD batch_command(char *line)
+{
+char label[MAX_LINE_SIZE], temp[MAX_LINE_SIZE];
+char *p;
+
+    if (match_word(line,"rem"))
+        return 1;
+
+    p = match_word(line,"goto");
+    if (!p)
+        return 0;
+
+    if (!batch) {
+        messagenl(_("GOTO is only valid in a batch file"));
+        return 1;
+    }
+
+    if (*p == ':')
+        p++;
+    copy_word(p,label,sizeof(label));
+
+    for (p = batch->text; *p; ) {
+        p = next_line(p,temp);
+        if (temp[0] == ':') {
+            copy_word(temp+1,temp,sizeof(temp));
+            if (strequal(temp,label)) {
+                batch->next = p;
+                return 1;
+            }
+        }
+    }
+
+    errmsg(NO_LABEL);
+    batch->next = p;                    /* end the batch file */
+
+    return 1;
+}
+
+/*
+ *  handle IF
+ *
+ *  returns a pointer to the command to execute, or NULL if none
+ */
+char *check_condition(char *line)
+{
+char word[MAXPATHLEN];
+char *p, *q, *eq;
+WORD negate = 0, result, n;
+
+    p = match_word(line,"if");
+    if (!p)
+        return line;
+
+    q = match_word(p,"not");
+    if (q) {
+        negate = 1;
+        p = q;
+    }
+
+    if ((q = match_word(p,"exist")) != NULL) {
+        p = copy_word(q,word,sizeof(word));
+        result = (Fsfirst(word,0x17) == 0);
+    } else if ((q = match_word(p,"errorlevel")) != NULL) {
+        p = copy_word(q,word,sizeof(word));
+        n = getword(word);
+        if (n < 0) {
+            errmsg(INVALID_PARAM);
+            return NULL;
+        }
+        result = (errorlevel < 0L) || (errorlevel >= n);
+    } else {
+        p = copy_word(p,word,sizeof(word));
+        for (eq = word; *eq; eq++)
+            if ((eq[0] == '=') && (eq[1] == '='))
+                break;
+        if (!*eq) {
+            messagenl(_("IF: missing =="));
+            return NULL;
+        }
+        *eq = '\0';
+        result = (strcmp(word,eq+2) == 0);
+    }
+
+    if (!*p) {
+        messagenl(_("IF: missing command"));
+        return NULL;
+    }
+
+    return (result ^ negate) ? check_condition(p) : NULL;
+}
+
+/*
+ *  replace %0-%9, %NAME% & %% in the line
+ *
+ *  returns 0, or LINE_LENGTH if the result would be too long
+ */
+WORD expand_line(char *line)
+{
+char *p, *q, *r, *end;
+const char *v;
+
+    for (p = line, q = expand_buf, end = expand_buf + MAX_LINE_SIZE - 1; *p; ) {
+        if (*p != '%') {
+            if (q >= end)
+                return LINE_LENGTH;
+            *q++ = *p++;
+            continue;
+        }
+        p++;
+        if (*p == '%') {                /* %% */
+            v = "%";
+            p++;
+        } else if (batch && (*p >= '0') && (*p <= '9')) {
+            v = (*p - '0' < batch->argc) ? batch->argv[*p - '0'] : "";
+            p++;
+        } else {
+            for (r = p; *r && (*r != '%') && (*r != ' '); r++)
+                ;
+            if ((*r != '%') || (r == p))
+                v = "%";                /* not a variable: keep it */
+            else {
+                v = get_variable(p,r-p);
+                p = r + 1;
+            }
+        }
+        while(*v) {
+            if (q >= end)
+                return LINE_LENGTH;
+            *q++ = *v++;
+        }
+    }
+    *q = '\0';
+
+    strcpy(line,expand_buf);
+
+    return 0;
+}
+
+/*
+ *  iterate over the variables
+ *
+ *  returns the first "NAME=value" string if p is NULL, otherwise the
+ *  one following p, or NULL at the end
+ */
+const char *next_variable(const char *p)
+{
+    if (!p)
+        p = variables;
+    else p += strlen(p) + 1;
+
+    return *p ? p : NULL;
+}
+
+/*
+ *  set a variable from a "NAME=value" string; an empty value
+ *  removes the variable
+ */
+LONG set_variable(const char *assignment)
+{
+const char *eq;
+char *p, *end;
+LONG len;
+WORD namelen;
+
+    eq = strchr(assignment,'=');
+    if (!eq || (eq == assignment))
+        return INVALID_PARAM;
+    namelen = eq - assignment;
+
+    for (end = variables; *end; end += strlen(end) + 1)
+        ;
+
+    for (p = variables; *p; p += strlen(p) + 1) {
+        if (same_name(p,assignment,namelen) && (p[namelen] == '=')) {
+            len = strlen(p) + 1;
+            memmove(p,p+len,end+1-(p+len));
+            end -= len;
+            break;
+        }
+    }
+
+    if (!eq[1])
+        return 0L;
+
+    len = strlen(assignment) + 1;
+    if (end + len + 1 > variables + VARIABLES_SIZE)
+        return ENSMEM;
+
+    strcpy(end,assignment);
+    end[namelen] = '\0';
+    strupper(end);                      /* names are not case-sensitive */
+    end[namelen] = '=';
+    end[len] = '\0';
+
+    return 0L;
+}
+
+/*
+ *  look up a variable whose name is 'len' chars at 'name'
+ *
+ *  returns a pointer to its value, or "" if not found
+ */
+PRIVATE const char *get_variable(const char *name,WORD len)
+{
+static char buf[12];
+const char *p;
+
+    for (p = variables; *p; p += strlen(p) + 1)
+        if (same_name(p,name,len) && (p[len] == '='))
+            return p + len + 1;
+
+    if ((len == 10) && same_name("ERRORLEVEL",name,len)) {
+        sprintf(buf,"%ld",errorlevel);
+        return buf;
+    }
+
+    return "";
+}
+
+/*
+ *  compare 'len' chars of an uppercase name with a name in any case
+ *
+ *  returns 1 iff they are the same
+ */
+PRIVATE WORD same_name(const char *upper,const char *name,WORD len)
+{
+WORD i;
+char c;
+
+    for (i = 0; i < len; i++) {
+        c = name[i];
+        if ((c >= 'a') && (c <= 'z'))
+            c &= ~0x20;
+        if (upper[i] != c)
+            return 0;
+    }
+
+    return 1;
+}
+
+/*
+ *  copy the next line of a batch file to 'dest'
+ *
+ *  returns a pointer to the following line
+ */
+PRIVATE char *next_line(char *p,char *dest)
+{
+char *end = dest + MAX_LINE_SIZE - 1;
+
+    while(*p && (*p != '\r') && (*p != '\n')) {
+        if (dest < end)
+            *dest++ = *p;
+        p++;
+    }
+    *dest = '\0';
+
+    if (*p == '\r')
+        p++;
+    if (*p == '\n')
+        p++;
+
+    return p;
+}
+
+/*
+ *  if the first word of the line is 'word' (lowercase letters), ignoring
+ *  case, return a pointer to the next word, otherwise NULL
+ */
+PRIVATE char *match_word(char *line,const char *word)
+{
+char *p;
+const char *q;
+
+    for (p = line; *p == ' '; p++)
+        ;
+    for (q = word; *q; p++, q++)
+        if ((*p | 0x20) != *q)
+            return NULL;
+    if (*p && (*p != ' '))
+        return NULL;
+
+    while(*p == ' ')
+        p++;
+
+    return p;
+}
+
+/*
+ *  copy the next word, truncated to 'size' chars including the
+ *  terminating NUL
+ *
+ *  returns a pointer to the following word
+ */
+PRIVATE char *copy_word(char *p,char *dest,WORD size)
+{
+    while(*p && (*p != ' ')) {
+        if (size-- > 1)
+            *dest++ = *p;
+        p++;
+    }
+    *dest = '\0';
+
+    while(*p == ' ')
+        p++;
+
+    return p;
+}
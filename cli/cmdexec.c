@@ -12,47 +12,269 @@
 #include "cmd.h"
 #include "string.h"
 
-static UWORD old_stdout;
+#define LEN_FNAME       12      /* 8.3 */
+#define PATH_PROBES     4       /* PATH cache entries checked for a name */
+#define PRG_MAGIC       0x601a
+#define PE_GOTHENFREE   6       /* Pexec() modes */
+#define PE_BASEPAGEFLAGS 7
+
+/*
+ *  program header & basepage
+ */
+typedef struct {
+    WORD    ph_magic;
+    LONG    ph_tlen;
+    LONG    ph_dlen;
+    LONG    ph_blen;
+    LONG    ph_slen;
+    LONG    ph_res1;
+    ULONG   ph_flags;
+    WORD    ph_abs;             /* not zero if no relocation */
+} PRGHDR;
+
+typedef struct {
+    char    *p_lowtpa;
+    char    *p_hitpa;
+    char    *p_tbase;
+    LONG    p_tlen;
+    char    *p_dbase;
+    LONG    p_dlen;
+    char    *p_bbase;
+    LONG    p_blen;
+    char    *p_dta;
+    void    *p_parent;
+    LONG    p_reserved;
+    char    *p_env;
+    char    p_undef[80];
+    char    p_cmdlin[128];
+} BASEPAGE;
+
+/*
+ *  PATH cache
+ *
+ *  For a command found in the user_path[] directories, this remembers in
+ *  which directory, and the extension added, so that running it again
+ *  needs a single Fsfirst() instead of one per directory.  It is flushed
+ *  when the path or the current directory changes, since the path may
+ *  contain relative directories.
+ */
+typedef struct {
+    char    name[LEN_FNAME+1];  /* as typed, empty if unused */
+    char    ext[4];             /* extension added, if any */
+    UBYTE   dir;                /* index in user_path[] */
+} PATHCACHE;
+
+/*
+ *  resident programs
+ *
+ *  The program file (without the symbol table) is kept in memory.  Each
+ *  time the program is run, it is copied into a new basepage and
+ *  relocated there, then started as if it had been loaded from disk.
+ */
+typedef struct {
+    char    name[LEN_FNAME+1];  /* file name, lowercase, empty if unused */
+    PRGHDR  *image;             /* header, text, data & relocation info */
+    LONG    size;
+} RESIDENT;
+
+LOCAL PATHCACHE path_cache[PATH_CACHE_SIZE];
+LOCAL RESIDENT resident[MAX_RESIDENT];
 
 /*
  *  function prototypes
  */
 PRIVATE void add_to_path(char *path,const char *name);
 PRIVATE WORD build_cmdline(char *cmdline,WORD argc,char **argv);
+PRIVATE void cache_path(const char *name,WORD dir,const char *path);
+PRIVATE WORD check_path_cache(char *path,const char *name);
 PRIVATE WORD check_user_path(char *path,const char *name);
 PRIVATE WORD find_executable(char *fullname,const char *name);
+PRIVATE WORD find_program(char *path,const char *name);
+PRIVATE RESIDENT *find_resident(const char *name);
+PRIVATE WORD has_extension(const char *name,const char *ext);
+PRIVATE WORD hash_name(const char *name);
 PRIVATE WORD is_graphical(const char *name);
-PRIVATE LONG redirect_stdout(char *redir);
-PRIVATE void restore_stdout(char *redir);
+PRIVATE LONG redirect(WORD std,LONG handle);
+PRIVATE void restore(WORD std,LONG old);
+PRIVATE LONG run_resident(const RESIDENT *r,char *cmdline);
+PRIVATE LONG start_program(const char *path,char *cmdline,const RESIDENT *r);
 
 
-LONG exec_program(WORD argc,char **argv,char *redir)
+/*
+ *  execute a program or batch file, with its standard output sent to
+ *  redir_handle and its standard input taken from input_handle, if not
+ *  negative
+ */
+LONG exec_program(WORD argc,char **argv)
 {
 char path[MAXPATHLEN];
 char cmdline[CMDLINELEN];
+RESIDENT *r;
 LONG rc;
 
     if (has_wildcard(argv[0]))
-        return EPTHNF;
+        rc = EPTHNF;
+    else if (build_cmdline(cmdline,argc,argv) < 0)
+        rc = CMDLINE_LENGTH;
+    else if ((r = find_resident(argv[0])) != NULL)
+        rc = start_program(r->name,cmdline,r);
+    else if (find_program(path,argv[0]) < 0)
+        rc = EFILNF;
+    else if (has_extension(path,"bat"))
+        return run_batch(path,argc,argv);   /* its commands set errorlevel */
+    else rc = start_program(path,cmdline,NULL);
+
+    errorlevel = rc;
 
-    if (build_cmdline(cmdline,argc,argv) < 0)
-        return CMDLINE_LENGTH;
+    return rc;
+}
 
-    if (find_executable(path,argv[0]) == 0)
-        ;
-    else if (check_user_path(path,argv[0]) < 0)
+/*
+ *  flush the PATH cache
+ */
+void flush_path_cache(void)
+{
+WORD i;
+
+    for (i = 0; i < PATH_CACHE_SIZE; i++)
+        path_cache[i].name[0] = '\0';
+}
+
+/*
+ *  load a program, found like an external command, as a resident program
+ */
+LONG load_resident(const char *name)
+{
+char path[MAXPATHLEN];
+PRGHDR hdr;
+RESIDENT *r, *slot;
+LONG rc, size, rlen;
+WORD handle, i;
+
+    if (has_wildcard(name))
+        return EPTHNF;
+
+    if ((find_program(path,name) < 0) || (Fsfirst(path,0x07) != 0))
         return EFILNF;
+    size = dta->d_length;
+
+    r = find_resident(dta->d_fname);
+    if (r)                          /* reload it */
+        unload_resident(r->name);
+    for (i = 0, slot = resident; i < MAX_RESIDENT; i++, slot++)
+        if (!slot->name[0])
+            break;
+    if (i >= MAX_RESIDENT)
+        return ENSMEM;
+    strcpy(slot->name,dta->d_fname);
+    strlower(slot->name);
 
-    rc = redirect_stdout(redir);
-    if (rc < 0L)
+    rc = Fopen(path,0);
+    if (rc < 0L) {
+        slot->name[0] = '\0';
         return rc;
+    }
+    handle = LOWORD(rc);
+
+    rc = Fread(handle,sizeof(PRGHDR),&hdr);
+    rlen = size - sizeof(PRGHDR) - hdr.ph_tlen - hdr.ph_dlen - hdr.ph_slen;
+    if ((rc != sizeof(PRGHDR)) || (hdr.ph_magic != PRG_MAGIC) || (rlen < 0L))
+        rc = BAD_PROGRAM;
+    else {
+        slot->size = sizeof(PRGHDR) + hdr.ph_tlen + hdr.ph_dlen + rlen;
+        slot->image = (PRGHDR *)Malloc(slot->size);
+        if (!slot->image)
+            rc = ENSMEM;
+    }
 
-    if (is_graphical(path))
-        (void)Cursconf(0,0);
-    rc = Pexec(0,path,cmdline,NULL);
-    (void)Cursconf(1,0);
+    if (rc >= 0L) {
+        *slot->image = hdr;
+        rc = Fread(handle,hdr.ph_tlen+hdr.ph_dlen,slot->image+1);
+        if (rc >= 0L)
+            rc = Fseek(sizeof(PRGHDR)+hdr.ph_tlen+hdr.ph_dlen+hdr.ph_slen,handle,0);
+        if (rc >= 0L)
+            rc = Fread(handle,rlen,(char *)(slot->image+1)+hdr.ph_tlen+hdr.ph_dlen);
+        if ((rc >= 0L) && (rc != rlen))
+            rc = BAD_PROGRAM;
+        if (rc < 0L)
+            Mfree(slot->image);
+    }
+    Fclose(handle);
 
-    restore_stdout(redir);
+    if (rc < 0L) {
+        slot->name[0] = '\0';
+        return rc;
+    }
+
+    return 0L;
+}
+
+/*
+ *  iterate over the resident programs, starting with *n = 0
+ *
+ *  returns the name of the next one, or NULL at the end
+ */
+const char *next_resident(WORD *n,LONG *size)
+{
+RESIDENT *r;
+
+    for ( ; *n < MAX_RESIDENT; (*n)++) {
+        r = &resident[*n];
+        if (r->name[0]) {
+            (*n)++;
+            *size = r->size;
+            return r->name;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ *  free a resident program
+ */
+LONG unload_resident(const char *name)
+{
+RESIDENT *r;
+
+    r = find_resident(name);
+    if (!r)
+        return EFILNF;
+
+    Mfree(r->image);
+    r->name[0] = '\0';
+
+    return 0L;
+}
+
+/*
+ *  start a program, from disk or resident
+ */
+PRIVATE LONG start_program(const char *path,char *cmdline,const RESIDENT *r)
+{
+LONG rc, old_stdin = -1L, old_stdout = -1L;
+
+    if (redir_handle >= 0L) {
+        old_stdout = redirect(1,redir_handle);
+        if (old_stdout < 0L)
+            return old_stdout;
+    }
+    if (input_handle >= 0L)
+        old_stdin = redirect(0,input_handle);
+
+    if (old_stdin < -1L)            /* couldn't redirect stdin */
+        rc = old_stdin;
+    else {
+        if (is_graphical(path))
+            (void)Cursconf(0,0);
+        rc = r ? run_resident(r,cmdline) : Pexec(0,path,cmdline,NULL);
+        (void)Cursconf(1,0);
+    }
+
+    if (old_stdin >= 0L)
+        restore(0,old_stdin);
+    if (old_stdout >= 0L)
+        restore(1,old_stdout);
 
     return rc;
 }
@@ -113,18 +335,206 @@ PRIVATE WORD check_user_path(char *path,const char *name)
 {
 char temp[MAXPATHLEN];
 const char *p;
+WORD dir;
+
+    if (check_path_cache(path,name) == 0)
+        return 0;
 
-    for (p = user_path; *p; ) {
+    for (p = user_path, dir = 0; *p; dir++) {
         if (get_path_component(&p,temp) == 0)
             return -1;
         add_to_path(temp,name);
-        if (find_executable(path,temp) == 0)
+        if (find_executable(path,temp) == 0) {
+            cache_path(name,dir,path);
             return 0;
+        }
     }
 
     return -1;
 }
 
+/*
+ *  look up the PATH cache, checking that the file still exists
+ *
+ *  if found, 'path' contains full path, rc = 0
+ */
+PRIVATE WORD check_path_cache(char *path,const char *name)
+{
+PATHCACHE *pc;
+const char *p;
+WORD i, n, dir;
+
+    for (i = 0, n = hash_name(name); i < PATH_PROBES; i++, n = (n + 1) & (PATH_CACHE_SIZE-1)) {
+        pc = &path_cache[n];
+        if (!pc->name[0] || !strequal(pc->name,name))
+            continue;
+        for (p = user_path, dir = 0; get_path_component(&p,path); dir++) {
+            if (dir == pc->dir) {
+                add_to_path(path,name);
+                if (pc->ext[0]) {
+                    strcat(path,".");
+                    strcat(path,pc->ext);
+                }
+                if (Fsfirst(path,0x07) == 0)
+                    return 0;
+                break;
+            }
+        }
+        pc->name[0] = '\0';        /* stale entry */
+        break;
+    }
+
+    return -1;
+}
+
+/*
+ *  add a command found in user_path[] to the PATH cache
+ */
+PRIVATE void cache_path(const char *name,WORD dir,const char *path)
+{
+PATHCACHE *pc;
+const char *p, *dot;
+WORD i, n;
+
+    if ((strlen(name) > LEN_FNAME) || (dir > 255))
+        return;
+
+    /* use the first free entry, else replace the first one */
+    for (i = 0, n = hash_name(name); i < PATH_PROBES; i++, n = (n + 1) & (PATH_CACHE_SIZE-1))
+        if (!path_cache[n].name[0])
+            break;
+    if (i >= PATH_PROBES)
+        n = hash_name(name);
+    pc = &path_cache[n];
+
+    strcpy(pc->name,name);
+    pc->dir = dir;
+
+    /* remember the extension added by find_executable(), if any */
+    pc->ext[0] = '\0';
+    for (p = name; *p; p++)
+        if (*p == '.')
+            return;
+    for (p = path, dot = NULL; *p; p++) {
+        if (*p == '.')
+            dot = p;
+        else if (*p == PATHSEP)
+            dot = NULL;
+    }
+    if (dot && (strlen(dot+1) < sizeof(pc->ext)))
+        strcpy(pc->ext,dot+1);
+}
+
+/*
+ *  hash a command name, ignoring case
+ */
+PRIVATE WORD hash_name(const char *name)
+{
+UWORD h;
+
+    for (h = 0; *name; name++)
+        h = h * 31 + (*name | 0x20);
+
+    return h & (PATH_CACHE_SIZE-1);
+}
+
+/*
+ *  find an external command, in the current directory then in the path
+ *
+ *  if found, 'path' contains full path, rc = 0
+ */
+PRIVATE WORD find_program(char *path,const char *name)
+{
+    if (find_executable(path,name) == 0)
+        return 0;
+
+    return check_user_path(path,name);
+}
+
+/*
+ *  find a resident program by file name, with or without the extension
+ */
+PRIVATE RESIDENT *find_resident(const char *name)
+{
+RESIDENT *r;
+const char *p, *q;
+WORD i;
+
+    for (i = 0, r = resident; i < MAX_RESIDENT; i++, r++) {
+        if (!r->name[0])
+            continue;
+        if (strequal(r->name,name))
+            return r;
+        for (p = r->name, q = name; *q; p++, q++)
+            if ((*p | 0x20) != (*q | 0x20))
+                break;
+        if (!*q && (*p == '.'))
+            return r;
+    }
+
+    return NULL;
+}
+
+/*
+ *  run a resident program: copy it into a new basepage, relocate it,
+ *  then start it (the basepage is freed when it terminates)
+ */
+PRIVATE LONG run_resident(const RESIDENT *r,char *cmdline)
+{
+const PRGHDR *hdr = r->image;
+BASEPAGE *bp;
+char *tbase;
+const UBYTE *fixup;
+LONG offset;
+
+    bp = (BASEPAGE *)Pexec(PE_BASEPAGEFLAGS,hdr->ph_flags,cmdline,NULL);
+    if ((LONG)bp < 0L)
+        return (LONG)bp;
+
+    tbase = (char *)(bp + 1);
+    if (bp->p_hitpa - tbase < hdr->ph_tlen + hdr->ph_dlen + hdr->ph_blen) {
+        Mfree(bp->p_env);
+        Mfree(bp);
+        return ENSMEM;
+    }
+
+    bp->p_tbase = tbase;
+    bp->p_tlen = hdr->ph_tlen;
+    bp->p_dbase = tbase + hdr->ph_tlen;
+    bp->p_dlen = hdr->ph_dlen;
+    bp->p_bbase = bp->p_dbase + hdr->ph_dlen;
+    bp->p_blen = hdr->ph_blen;
+
+    memcpy(tbase,hdr+1,hdr->ph_tlen+hdr->ph_dlen);
+    memset(bp->p_bbase,0,hdr->ph_blen);
+
+    /*
+     * relocate: the fixups are a LONG offset to the first one (0 if none),
+     * then for each following one a byte, which is the offset from the
+     * previous one, or 1 to advance 254 bytes, or 0 at the end
+     */
+    fixup = (const UBYTE *)(hdr+1) + hdr->ph_tlen + hdr->ph_dlen;
+    if (!hdr->ph_abs && (r->size > fixup - (const UBYTE *)hdr + 4)) {
+        offset = ((LONG)fixup[0] << 24) | ((LONG)fixup[1] << 16) | ((LONG)fixup[2] << 8) | fixup[3];
+        if (offset) {
+            for (fixup += 4; ; fixup++) {
+                *(LONG *)(tbase + offset) += (LONG)tbase;
+                while(*fixup == 1) {
+                    offset += 254;
+                    fixup++;
+                }
+                if (!*fixup)
+                    break;
+                offset += *fixup;
+            }
+        }
+    }
+
+    Supexec(flush_caches);
+
+    return Pexec(PE_GOTHENFREE,NULL,bp,NULL);
+}
+
 /*
  *  find executable, adding extension if necessary
  */
@@ -170,6 +580,23 @@ LONG rc;
     return -1;
 }
 
+/*
+ *  test the extension of a filename
+ */
+PRIVATE WORD has_extension(const char *name,const char *ext)
+{
+const char *p;
+
+    for (p = name; *p; p++)
+        ;
+    p -= 4;         /* back up to putative period */
+
+    if (p < name)
+        return 0;
+
+    return (*p == '.') && strequal(p+1,ext);
+}
+
 /*
  *  test type of executed program
  */
@@ -194,41 +621,29 @@ const char *p;
 }
 
 /*
- *  redirect stdout with Fdup()/Fforce()
+ *  redirect a standard handle with Fdup()/Fforce()
+ *
+ *  returns a duplicate of the original handle, or an error code
  */
-PRIVATE LONG redirect_stdout(char *redir)
+PRIVATE LONG redirect(WORD std,LONG handle)
 {
-LONG rc;
-
-    redir_handle= -1;
+LONG old, rc;
 
-    if (!redir[0])
-        return 0L;
-
-    rc = Fcreate(redir,0);
-    if (rc < 0L)
-        return rc;
+    old = Fdup(std);                /* remember current handle */
+    if (old < 0L)
+        return old;
 
-    redir_handle = rc;
-    old_stdout = Fdup(1);           /* remember current stdout */
-    rc = Fforce(1,redir_handle);    /* redirect it */
+    rc = Fforce(std,(WORD)handle);  /* redirect it */
     if (rc < 0L) {
-        restore_stdout(redir);      /* undo the redirection */
+        Fclose((WORD)old);          /* undo the redirection */
         return rc;
     }
 
-    return 0;
+    return old;
 }
 
-PRIVATE void restore_stdout(char *redir)
+PRIVATE void restore(WORD std,LONG old)
 {
-    if (!redir[0])                  /* not redirected ... */
-        return;
-
-    Fforce(1,old_stdout);           /* get old stdout back */
-    Fclose(old_stdout);             /* release duplicate */
-    Fclose(redir_handle);           /*  & original */
-
-    redir[0] = '\0';                /* end redirection */
-    redir_handle = -1L;
+    Fforce(std,(WORD)old);          /* get old handle back */
+    Fclose((WORD)old);              /* release duplicate */
 }
@@ -12,6 +12,10 @@
 #include "cmd.h"
 #include "string.h"
 #include "shellutl.h"
+#include "filecopy.h"
+#if WITH_TRACE_CMD
+#include "a2560trace.h"
+#endif
 
 typedef struct {
     const char *name;
@@ -26,7 +30,10 @@ typedef struct {
  *  function prototypes
  */
 PRIVATE LONG check_path_component(char *component);
+PRIVATE WORD copy_error(void *arg,WORD type,const char *path,LONG rc);
 PRIVATE LONG copy_move(WORD argc,char **argv,WORD delete);
+PRIVATE WORD copy_progress(void *arg,const FCSTAT *stat);
+PRIVATE LONG get_hz200(void);
 PRIVATE void display_dta_detail(void);
 PRIVATE char *extract_path(char *dest,const char *src);
 PRIVATE void fixup_filespec(char *filespec);
@@ -40,6 +47,7 @@ PRIVATE void output(const char *s);
 PRIVATE void outputnl(const char *s);
 PRIVATE LONG outputbuf(const char *s,LONG len,WORD paging);
 PRIVATE LONG output_files(WORD argc,char **argv,WORD paging);
+PRIVATE LONG output_handle(WORD handle,char *iobuf,LONG bufsize,WORD paging);
 PRIVATE void padname(char *buf,const char *name);
 PRIVATE void show_line(const char *title,ULONG n);
 PRIVATE WORD user_break(void);
@@ -60,10 +68,15 @@ PRIVATE LONG run_path(WORD argc,char **argv);
 PRIVATE LONG run_pwd(WORD argc,char **argv);
 PRIVATE LONG run_mv(WORD argc,char **argv);
 PRIVATE LONG run_ren(WORD argc,char **argv);
+PRIVATE LONG run_resident(WORD argc,char **argv);
 PRIVATE LONG run_rm(WORD argc,char **argv);
 PRIVATE LONG run_rmdir(WORD argc,char **argv);
+PRIVATE LONG run_set(WORD argc,char **argv);
 PRIVATE LONG run_setdrv(WORD argc,char **argv);
 PRIVATE LONG run_show(WORD argc,char **argv);
+#if WITH_TRACE_CMD
+PRIVATE LONG run_trace(WORD argc,char **argv);
+#endif
 PRIVATE LONG run_version(WORD argc,char **argv);
 PRIVATE LONG run_wrap(WORD argc,char **argv);
 #if 0
@@ -73,8 +86,9 @@ PRIVATE LONG run_opl3(WORD argc,char **argv);
 /*
  *  help strings
  */
-LOCAL const char * const help_cat[] = { "<filespec> ...",
-    N_("Copy <filespec> ... to standard output"), NULL };
+LOCAL const char * const help_cat[] = { "[<filespec> ...]",
+    N_("Copy <filespec> ... to standard output"),
+    N_("or copy the input from a pipe (cmd | cat)"), NULL };
 LOCAL const char * const help_cd[] = { "[<dir>]",
     N_("Change current directory to <dir>"),
     N_("or display current directory"), NULL };
@@ -96,7 +110,8 @@ LOCAL const char * const help_exit[] = { "",
 LOCAL const char * const help_help[] = { "[<cmd>]",
     N_("Get help about <cmd> or list available commands"),
     N_("Use HELP ALL for help on all commands"),
-    N_("Use HELP EDIT for help on line editing"), NULL };
+    N_("Use HELP EDIT for help on line editing"),
+    N_("Use HELP BATCH for help on batch files"), NULL };
 LOCAL const char * const help_ls[] = { "[-l] <path>",
     N_("List files (default terse, horizontal)"),
     N_("Specify -l for detailed list"), NULL };
@@ -106,9 +121,10 @@ LOCAL const char * const help_mode[] = { "con[:] [res=<r>] [delay=<m>] [rate=<n>
     N_("Set or display console settings:"),
     N_("res for screen resolution (0,1)[ST] (0,1,2,4,7)[TT];"),
     N_("delay/rate for the keyboard"), NULL };
-LOCAL const char * const help_more[] = { "<filespec>",
+LOCAL const char * const help_more[] = { "[<filespec>]",
     N_("Copy <filespec> to standard output,"),
-    N_("pausing every screenful"), NULL };
+    N_("pausing every screenful"),
+    N_("or page the input from a pipe (cmd | more)"), NULL };
 LOCAL const char * const help_mv[] = { "<filespec> <dir>",
     N_("Copy files matching <filespec> to <dir>,"),
     N_("then delete input files"), NULL };
@@ -120,13 +136,26 @@ LOCAL const char * const help_pwd[] = { "",
     N_("Display current drive and directory"), NULL };
 LOCAL const char * const help_ren[] = { "<oldname> <newname>",
     N_("Rename <oldname> to <newname>"), NULL };
+LOCAL const char * const help_resident[] = { "[[-d] <program>]",
+    N_("Keep <program> in memory, so that it runs"),
+    N_("without being loaded, or list such programs"),
+    N_("Specify -d to remove it from memory"), NULL };
 LOCAL const char * const help_rm[] = { " [-q] <filespec>",
     N_("Delete files matching <filespec>"),
     N_("Specify -q to be prompted each time"), NULL };
 LOCAL const char * const help_rmdir[] = { "<dir>",
     N_("Delete directory <dir>"), NULL };
+LOCAL const char * const help_set[] = { "[<name>=[<value>]]",
+    N_("Set variable <name>, used as %<name>%,"),
+    N_("or list variables"),
+    N_("An empty <value> removes the variable"), NULL };
 LOCAL const char * const help_show[] = { "[<drive>]",
     N_("Show info for <drive> or current drive"), NULL };
+#if WITH_TRACE_CMD
+LOCAL const char * const help_trace[] = { "[<filename>]",
+    N_("Show the status of the debug trace ring,"),
+    N_("or save it to <filename> for tools/tracedec"), NULL };
+#endif
 LOCAL const char * const help_version[] = { "",
     N_("Display GEMDOS version"), NULL };
 LOCAL const char * const help_wrap[] = { "[on|off]",
@@ -138,6 +167,18 @@ LOCAL const char * const help_edit[] = {
  N_("left/right arrow = previous/next character"),
  N_("control-left/right arrow = previous/next word"), NULL };
 
+LOCAL const char * const help_batch[] = {
+ N_("<name>.bat is run like a program: each line"),
+ N_("is executed like a command, after replacing"),
+ N_("%0-%9 (the name & arguments), %<name>% (a"),
+ N_("variable), %ERRORLEVEL% (the last result) & %%"),
+ N_(":<label> = a label for GOTO"),
+ N_("GOTO <label> = continue after the label"),
+ N_("IF [NOT] EXIST <filespec> <command>"),
+ N_("IF [NOT] ERRORLEVEL <n> <command>"),
+ N_("IF [NOT] <string1>==<string2> <command>"),
+ N_("REM ... = a comment"), NULL };
+
 // TODO CLEAN ME
 LONG run_showmouse(WORD argc, char **argv); // in cmdtest.S
 LONG run_hidemouse(WORD argc, char **argv); // in cmdtest.S
@@ -170,7 +211,7 @@ static LONG run_testmouse(WORD argc, char **argv)
  *  command table
  */
 LOCAL const COMMAND cmdtable[] = {
-    { "cat", "type", 1, 255, run_cat, help_cat },
+    { "cat", "type", 0, 255, run_cat, help_cat },
     { "cd", NULL, 0, 1, run_cd, help_cd },
     { "chmod", NULL, 2, 2, run_chmod, help_chmod },
     { "cls", "clear", 0, 0, run_cls, help_cls },
@@ -181,7 +222,7 @@ LOCAL const COMMAND cmdtable[] = {
     { "ls", "dir", 0, 2, run_ls, help_ls },
     { "mkdir", "md", 1, 1, run_mkdir, help_mkdir },
     { "mode", NULL, 1, 4, run_mode, help_mode },
-    { "more", NULL, 1, 1, run_more, help_more },
+    { "more", NULL, 0, 1, run_more, help_more },
     { "mv", "move", 2, 2, run_mv, help_mv },
 #if 0
     { "opl3", NULL, 0, 0, run_opl3, help_path },
@@ -189,9 +230,14 @@ LOCAL const COMMAND cmdtable[] = {
     { "path", NULL, 0, 1, run_path, help_path },
     { "pwd", NULL, 0, 0, run_pwd, help_pwd },
     { "ren", NULL, 2, 2, run_ren, help_ren },
+    { "resident", NULL, 0, 2, run_resident, help_resident },
     { "rm", "del", 1, 2, run_rm, help_rm },
     { "rmdir", "rd", 1, 1, run_rmdir, help_rmdir },
+    { "set", NULL, 0, 255, run_set, help_set },
     { "show", NULL, 0, 1, run_show, help_show },
+#if WITH_TRACE_CMD
+    { "trace", NULL, 0, 1, run_trace, help_trace },
+#endif
     { "version", NULL, 0, 0, run_version, help_version },
     { "wrap", NULL, 0, 1, run_wrap, help_wrap },
     { "showmouse", NULL, 0, 0, run_showmouse, NULL},
@@ -294,6 +340,7 @@ WORD current_drive, temp_drive;
 
     rc = Dsetpath(p);
     Dsetdrv(current_drive);
+    flush_path_cache();             /* the path may be relative */
 
     return rc;
 }
@@ -382,6 +429,14 @@ const char * const *s;
         return 0L;
     }
 
+    if (strequal(argv[1],"batch")) {
+        for (s = &help_batch[0]; *s; s++) {
+            output("  ");
+            outputnl(gettext(*s));
+        }
+        return 0L;
+    }
+
     for (p = cmdtable, lines = 0; p->func; p++) {
         if (help_wanted(p,argv[1])) {
             if (redir_handle < 0L) {    /* not redirecting output: */
@@ -526,6 +581,7 @@ const char *p;
 
     } else {
         strcpy(user_path,argv[1]);
+        flush_path_cache();
     }
 
     return 0L;
@@ -544,9 +600,34 @@ LONG rc;
 
 PRIVATE LONG run_ren(WORD argc,char **argv)
 {
+    flush_path_cache();
+
     return Frename(0,argv[1],argv[2]);
 }
 
+PRIVATE LONG run_resident(WORD argc,char **argv)
+{
+char buf[20];
+const char *name;
+LONG size;
+WORD n;
+
+    if (argc == 1) {
+        for (n = 0; (name = next_resident(&n,&size)) != NULL; ) {
+            output("  ");
+            output(name);
+            sprintf(buf," %ld",size);
+            outputnl(buf);
+        }
+        return 0L;
+    }
+
+    if (strequal(argv[1],"-d"))
+        return (argc == 3) ? unload_resident(argv[2]) : WRONG_NUM_ARGS;
+
+    return (argc == 2) ? load_resident(argv[1]) : WRONG_NUM_ARGS;
+}
+
 PRIVATE LONG run_rm(WORD argc,char **argv)
 {
 WORD prompt = 0;
@@ -600,6 +681,30 @@ LONG rc;
     return (rc==EACCDN) ? DIR_NOT_EMPTY : rc;
 }
 
+PRIVATE LONG run_set(WORD argc,char **argv)
+{
+char assignment[MAX_LINE_SIZE];
+const char *p;
+WORD i;
+
+    if (argc == 1) {
+        for (p = next_variable(NULL); p; p = next_variable(p))
+            outputnl(p);
+        return 0L;
+    }
+
+    /* the value may contain spaces */
+    for (i = 1, assignment[0] = '\0'; i < argc; i++) {
+        if (strlen(assignment) + strlen(argv[i]) + 2 > sizeof(assignment))
+            return LINE_LENGTH;
+        if (i > 1)
+            strcat(assignment," ");
+        strcat(assignment,argv[i]);
+    }
+
+    return set_variable(assignment);
+}
+
 PRIVATE LONG run_setdrv(WORD argc,char **argv)
 {
     if (!is_valid_drive(argv[0][0]))
@@ -607,6 +712,7 @@ PRIVATE LONG run_setdrv(WORD argc,char **argv)
 
     strlower(argv[0]);
     Dsetdrv(argv[0][0]-'a');
+    flush_path_cache();
 
     return 0L;
 }
@@ -645,6 +751,54 @@ char id[] = "X:";
     return rc;
 }
 
+#if WITH_TRACE_CMD
+PRIVATE LONG run_trace(WORD argc,char **argv)
+{
+struct a2560_trace_t *ring, hdr;
+char buf[80];
+ULONG first, n, i;
+LONG rc;
+WORD handle;
+
+    if (!getcookie(FTRC_COOKIE,(LONG *)&ring) || (ring->magic != A2560_TRACE_MAGIC)) {
+        messagenl(_("No debug trace ring"));
+        return 0L;
+    }
+
+    memcpy(&hdr,ring,sizeof(hdr));  /* snapshot: the ring may still be growing */
+
+    if (argc == 1) {
+        sprintf(buf,"%lu records, %lu waiting for output, %lu dropped (ring size %u)",
+                (ULONG)hdr.head,(ULONG)(hdr.head-hdr.tail),(ULONG)hdr.dropped,hdr.nrecs);
+        outputnl(buf);
+        return 0L;
+    }
+
+    rc = Fcreate(argv[1],0);
+    if (rc < 0L)
+        return rc;
+    handle = LOWORD(rc);
+
+    /*
+     * write the header, then the most recent records, oldest first;
+     * since the ring wraps, they are written in up to two chunks
+     */
+    rc = Fwrite(handle,sizeof(hdr),&hdr);
+    first = (hdr.head > hdr.nrecs) ? hdr.head - hdr.nrecs : 0;
+    while ((rc >= 0L) && (first < hdr.head)) {
+        i = first & (hdr.nrecs - 1);
+        n = hdr.head - first;
+        if (n > hdr.nrecs - i)
+            n = hdr.nrecs - i;
+        rc = Fwrite(handle,n*hdr.recsize,(char *)hdr.recs+i*hdr.recsize);
+        first += n;
+    }
+    Fclose(handle);
+
+    return (rc < 0L) ? rc : 0L;
+}
+#endif
+
 PRIVATE LONG run_version(WORD argc,char **argv)
 {
 UWORD n;
@@ -707,11 +861,19 @@ WORD handle, i;
 char name[MAXPATHLEN];
 char *iobuf, *p;
 
+    if ((argc == 1) && (input_handle < 0L)) /* no files & no piped input */
+        return WRONG_NUM_ARGS;
+
     bufsize = IOBUFSIZE;
     iobuf = (char *)Malloc(bufsize);
     if (!iobuf)
         return ENSMEM;
 
+    if (argc == 1) {
+        linecount = 0L;
+        rc = output_handle((WORD)input_handle,iobuf,bufsize,paging);
+    }
+
     for (i = 1; i < argc; i++, argv++) {
         p = extract_path(name,argv[i]);
         for (rc = Fsfirst(argv[i],0x07), n = 0; rc == 0; rc = Fsnext()) {
@@ -721,16 +883,7 @@ char *iobuf, *p;
                 break;
             handle = LOWORD(rc);
             linecount = 0L;
-            do {
-                n = rc = Fread(handle,bufsize,iobuf);
-                if (rc < 0L)
-                    break;
-                rc = outputbuf(iobuf,n,paging);
-                if (rc < 0L)
-                    break;
-                if (rc != n)
-                    rc = DISK_FULL;
-            } while(rc > 0L);
+            rc = output_handle(handle,iobuf,bufsize,paging);
             Fclose(handle);
             if (rc < 0L)
                 break;
@@ -749,6 +902,27 @@ char *iobuf, *p;
     return rc;
 }
 
+/*
+ *  copy an open file or pipe to standard output
+ */
+PRIVATE LONG output_handle(WORD handle,char *iobuf,LONG bufsize,WORD paging)
+{
+LONG n, rc;
+
+    do {
+        n = rc = Fread(handle,bufsize,iobuf);
+        if (rc < 0L)
+            break;
+        rc = outputbuf(iobuf,n,paging);
+        if (rc < 0L)
+            break;
+        if (rc != n)    /* pipes are character devices */
+            rc = ((WORD)redir_handle < 0) ? PIPE_FULL : DISK_FULL;
+    } while(rc > 0L);
+
+    return rc;
+}
+
 /*
  *  extract next dirname from input path (includes any terminating separator)
  *
@@ -837,16 +1011,71 @@ LONG rc = 0L;
     return rc;
 }
 
+/*
+ *  callbacks for the copy engine used by copy_move()
+ */
+LOCAL LONG copy_rc;     /* reason for abort */
+LOCAL WORD copy_delete; /* sources are deleted (move) */
+LOCAL ULONG copy_files; /* files reported so far */
+
+PRIVATE WORD copy_error(void *arg,WORD type,const char *path,LONG rc)
+{
+    copy_rc = (type == FC_ERR_FULL) ? DISK_FULL : rc;
+
+    message(path);
+    message(": ");
+
+    return FC_ABORT;
+}
+
+PRIVATE WORD copy_progress(void *arg,const FCSTAT *stat)
+{
+    /*
+     * the engine may buffer files, so they are only reported once they
+     * have actually been written (and deleted, for a move)
+     */
+    if (stat->files != copy_files) {
+        copy_files = stat->files;
+        message(_("Copying "));
+        message(stat->src);
+        message(_(" to "));
+        message(stat->name);
+        if (copy_delete) {
+            message(_(" ... deleting "));
+            message(stat->src);
+        }
+        messagenl(_(" ... done"));
+    }
+
+    /* allow user to interrupt during file copy/move */
+    if (constat()) {
+        if (user_break()) {
+            copy_rc = USER_BREAK;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+PRIVATE LONG get_hz200(void)
+{
+    return *(volatile LONG *)0x4ba;
+}
+
 /*
  *  copy_move
  */
 PRIVATE LONG copy_move(WORD argc,char **argv,WORD delete)
 {
 char inname[MAXPATHLEN], outname[MAXPATHLEN], fullname[MAXPATHLEN];
+char buf[50];
 char *inptr, *outptr;
-WORD in, out, output_is_dir = 0;
-char *iobuf;
-LONG bufsize, n, rc;
+WORD output_is_dir = 0;
+FCOPY fc;
+LONG n, rc, start, ticks;
+
+    flush_path_cache();             /* a program may be added or removed */
 
     inptr = extract_path(inname,argv[1]);
     outptr = extract_path(outname,argv[2]);
@@ -888,10 +1117,18 @@ LONG bufsize, n, rc;
         *outptr = '\0';
     }
 
-    bufsize = IOBUFSIZE;
-    iobuf = (char *)Malloc(bufsize);
-    if (!iobuf)
+    /*
+     * the copy engine sizes its buffer from free memory, leaving a
+     * little for GEMDOS (e.g. for the directories it creates)
+     */
+    if (fc_init(&fc,0x400L,MX_PREFTTRAM) < 0L)
         return ENSMEM;
+    fc.error = copy_error;
+    fc.progress = copy_progress;
+    copy_rc = 0L;
+    copy_delete = delete;
+    copy_files = 0UL;
+    start = Supexec(get_hz200);
 
     for (rc = Fsfirst(inname,0x07); rc == 0; rc = Fsnext()) {
         /* allow user to interrupt or pause before every file copy/move */
@@ -912,66 +1149,37 @@ LONG bufsize, n, rc;
             continue;
         }
 
-        message(_("Copying "));
-        message(inname);
-        message(_(" to "));
-        message(outname);
-
-        rc = Fopen(inname,0);
-        if (rc < 0L)
-            break;
-        in = LOWORD(rc);
-
-        rc = Fcreate(outname,0);
-        if (rc < 0L) {
-            Fclose(in);
-            break;
-        }
-        out = LOWORD(rc);
-
-        do {
-            /* allow user to interrupt during file copy/move */
-            if (constat()) {
-                if (user_break()) {
-                    rc = USER_BREAK;
-                    break;
-                }
-            }
-            n = rc = Fread(in,bufsize,iobuf);
-            if (rc < 0L)
-                break;
-            rc = Fwrite(out,n,iobuf);
-            if (rc < 0L)
-                break;
-            if (rc != n)
-                rc = DISK_FULL;
-        } while(rc > 0L);
-        Fclose(in);
-        Fclose(out);
-
-        /* if the copy failed, delete the output to avoid an incomplete file */
-        if (rc < 0L)
-            Fdelete(outname);
-
-        if (delete && (rc == 0L)) { /* don't delete unless copy successful */
-            message(_(" ... deleting "));
-            message(inptr);
-            rc = Fdelete(inname);
-        }
-
-        if (rc < 0L) {
-            message(" ... ");
+        /*
+         * the copy (and the delete, for a move) may be deferred until
+         * the engine's buffer is full: it is reported, as is any error,
+         * by the callbacks
+         */
+        if (fc_copy(&fc,inname,outname,0,delete?FC_MOVE:0) != FC_OK) {
+            rc = copy_rc;
             break;
         }
-
-        messagenl(_(" ... done"));
     }
     if (rc == ENMFIL)   /* not really an error */
         rc = 0L;
 
-    Mfree(iobuf);
+    if ((rc == 0L) && (fc_flush(&fc) != FC_OK))
+        rc = copy_rc;
+    fc_exit(&fc);
 
-    return rc;
+    if (rc < 0L)
+        return rc;
+
+    /*
+     * report throughput
+     */
+    ticks = Supexec(get_hz200) - start;
+    if ((fc.stat.files > 1) && (ticks > 0)) {
+        sprintf(buf,"%lu files, %lu bytes, %lu KB/s",fc.stat.files,fc.stat.bytes,
+                (fc.stat.bytes / 1024) * 200 / ticks);
+        outputnl(buf);
+    }
+
+    return 0L;
 }
 
 /*
@@ -16,10 +16,12 @@
  *      execution of standard TOS programs
  *      commandline history & editing
  *      output redirection
+ *      pipelines, via in-memory pipes
+ *      batch files & variables
+ *      resident programs
  *
  * The following omissions are deliberate:
- *      no batch/shell files
- *      no input redirection or pipes
+ *      no input redirection
  */
 #include "cmd.h"
 #include "version.h"
@@ -36,6 +38,9 @@ WORD nflops_copy;
 DTA *dta;
 char user_path[MAXPATHLEN];
 LONG redir_handle;
+LONG input_handle;
+LONG errorlevel;
+LONG cpu_type;
 
 /*
  * local to this set of functions
@@ -51,9 +56,11 @@ LOCAL LONG vdo_value;
  *  function prototypes
  */
 PRIVATE void change_res(WORD res);
-PRIVATE void close_redir(void);
-PRIVATE void create_redir(const char *name);
-PRIVATE WORD execute(WORD argc,char **argv,char *redir);
+PRIVATE void close_pipe(LONG *handle);
+PRIVATE void close_redir(LONG pipe);
+PRIVATE LONG create_pipe(void);
+PRIVATE LONG create_redir(const char *name,LONG pipe);
+PRIVATE WORD execute(WORD argc,char **argv,char *redir,LONG pipe);
 PRIVATE WORD get_nflops(void);
 PRIVATE void strip_quotes(int argc,char **argv);
 PRIVATE void getenv(char **ppath, const char *psrch);
@@ -72,6 +79,9 @@ WORD argc, rc;
 
     if (getcookie(_VDO_COOKIE,&vdo_value) == 0)
         vdo_value = _VDO_ST;
+
+    if (getcookie(_CPU_COOKIE,&cpu_type) == 0)
+        cpu_type = 0;
 #if CONF_WITH_TT_SHIFTER
     original_res = (vdo_value < _VDO_VIDEL) ? Getrez() : -1;
 #else
@@ -98,6 +108,7 @@ WORD argc, rc;
     dta = (DTA *)Fgetdta();
     redir_name[0] = '\0';
     redir_handle = -1L;
+    input_handle = -1L;
 
     if (init_cmdedit() < 0)
         messagenl(_("warning: no history buffers"));
@@ -112,7 +123,7 @@ WORD argc, rc;
             if (largv[1][0]) {
                 /* path ${PATH$} */
                 largv[0] = "path";
-                execute(2,largv,redir_name);
+                execute(2,largv,redir_name,-1L);
             }
         }
     }
@@ -125,10 +136,7 @@ WORD argc, rc;
             save_history(input_line);
             if (rc < 0)         /* user cancelled line */
                 continue;
-            argc = parse_line(input_line,arglist,redir_name);
-            if (argc < 0)       /* parse error */
-                continue;
-            rc = execute(argc,arglist,redir_name);
+            rc = execute_line(input_line,-1L);
             if (rc < 0) {       /* exit EmuCON */
                 change_res(original_res);
                 return 0;
@@ -141,14 +149,79 @@ WORD argc, rc;
     return 0;
 }
 
+/*
+ * expand & execute a command line, which may be a pipeline
+ *
+ * each command of a pipeline runs in turn, with its output sent to an
+ * in-memory pipe which is then used as the input of the next command.
+ * The output of the last one goes to 'out' if not negative, unless it
+ * is redirected.
+ *
+ * each command is parsed just before it runs, since it may be a batch
+ * file which reuses arglist[]
+ *
+ * returns: as for execute()
+ */
+WORD execute_line(char *line,LONG out)
+{
+char *stages[MAX_STAGES];
+WORD argc, n, i, rc;
+LONG pipe;
+
+    redir_name[0] = '\0';
+    if (expand_line(line) < 0) {
+        errmsg(LINE_LENGTH);
+        return 0;
+    }
+
+    line = check_condition(line);
+    if (!line || batch_command(line))
+        return 0;
+
+    n = split_pipeline(line,stages);
+    if (n < 0)              /* parse error */
+        return 0;
+
+    for (i = 0, rc = 0; i < n; i++) {
+        argc = parse_line(stages[i],arglist,redir_name);
+        if (argc < 0)       /* parse error */
+            break;
+        if ((i < n-1) && redir_name[0]) {
+            messagenl(_("only the last command may be redirected"));
+            redir_name[0] = '\0';
+            break;
+        }
+        pipe = out;
+        if (i < n-1) {
+            pipe = create_pipe();
+            if (pipe < 0L) {
+                errmsg(pipe);
+                break;
+            }
+        }
+        rc = execute(argc,arglist,redir_name,pipe);
+        close_pipe(&input_handle);  /* the previous command's output has been read */
+        input_handle = (i < n-1) ? pipe : -1L;  /* 'out' belongs to the caller */
+        if (rc)             /* exit or resolution change */
+            break;
+    }
+    close_pipe(&input_handle);
+    redir_name[0] = '\0';
+
+    return rc;
+}
+
 /*
  * execute a builtin or external command
  *
+ * output is redirected to the file named by 'redir', if any; otherwise
+ * it goes to 'pipe' if that is not negative
+ *
  * returns: -1  EmuCON should exit
  *          0   normal
  *          +1  EmuCON should change resolution
  */
-PRIVATE WORD execute(WORD argc,char **argv,char *redir)
+PRIVATE WORD execute(WORD argc,char **argv,char *redir,LONG pipe)
 {
 FUNC *func;
 LONG rc;
@@ -162,45 +235,86 @@ LONG rc;
 
     if (func == LOOKUP_ARGS)
         rc = WRONG_NUM_ARGS;
-    else if (func) {
-        create_redir(redir);
-        strip_quotes(argc,argv);
-        rc = func(argc,argv);
-        close_redir();
+    else {
+        rc = create_redir(redir,pipe);
+        if (rc == 0L) {
+            if (func) {
+                strip_quotes(argc,argv);
+                rc = func(argc,argv);
+                errorlevel = rc;
+            }
+            else rc = exec_program(argc,argv);
+        }
+        close_redir(pipe);
+        if (rc == EXIT_EMUCON)  /* exit from a batch file */
+            return -1;
         if (rc == CHANGE_RES)
             return 1;
     }
-    else rc = exec_program(argc,argv,redir);
 
     errmsg(rc);
 
     return 0;
 }
 
-PRIVATE void create_redir(const char *name)
+PRIVATE LONG create_redir(const char *name,LONG pipe)
 {
 LONG rc;
 
-    redir_handle = -1L;     /* no redirection */
+    redir_handle = pipe;    /* no redirection if negative */
 
     if (!*name)
-        return;
+        return 0L;
 
     rc = Fcreate(name,0);
     if (rc < 0)
-        errmsg(rc);
-    else redir_handle = rc;
+        return rc;
+
+    redir_handle = rc;
+
+    return 0L;
 }
 
-PRIVATE void close_redir(void)
+PRIVATE void close_redir(LONG pipe)
 {
-    if (redir_handle >= 0)
+    if ((redir_handle >= 0) && (redir_handle != pipe))
         Fclose((WORD)redir_handle);
 
     redir_name[0] = '\0';
     redir_handle = -1L;
 }
 
+/*
+ * create an in-memory pipe
+ *
+ * its handle is a (negative) character device handle, returned as
+ * a positive LONG like the other special names, e.g. "CON:"
+ */
+PRIVATE LONG create_pipe(void)
+{
+LONG rc;
+
+    rc = Fcreate("PIPE:",0);
+    if (rc < 0L)
+        return rc;
+
+    if ((WORD)rc >= 0) {    /* we got a real file: the OS has no pipes */
+        Fclose((WORD)rc);
+        Fdelete("PIPE:");
+        return NO_PIPES;
+    }
+
+    return rc;
+}
+
+PRIVATE void close_pipe(LONG *handle)
+{
+    if (*handle >= 0L)
+        Fclose((WORD)*handle);
+
+    *handle = -1L;
+}
+
 /*
  *  strips surrounding quotes from all args
  */
@@ -78,6 +78,48 @@ WORD argc, n, rc;
     return -1;
 }
 
+/*
+ *  splits buffer into the commands of a pipeline
+ *      . replaces each '|' (pipe character) with '\0'
+ *      . stores a pointer to each command in stages[]
+ *
+ *  returns number of commands, or -1 if error
+ */
+WORD split_pipeline(char *line,char **stages)
+{
+char *p;
+WORD i, n, inquotes;
+
+    stages[0] = line;
+    for (p = line, n = 1, inquotes = 0; *p; p++) {
+        if (*p == DBLQUOTE)
+            inquotes ^= 1;
+        if (!inquotes) {
+            if (*p == PIPECHAR) {
+                if (n >= MAX_STAGES) {
+                    messagenl(_("too many commands in pipeline"));
+                    return -1;
+                }
+                *p = '\0';
+                stages[n++] = p + 1;
+            }
+        }
+    }
+
+    if (n > 1) {
+        for (i = 0; i < n; i++) {
+            for (p = stages[i]; *p == ' '; p++)
+                ;
+            if (!*p) {
+                messagenl(_("missing command in pipeline"));
+                return -1;
+            }
+        }
+    }
+
+    return n;
+}
+
 /*
  *  scans buffer for '>' (output redirection character)
  *      . replaces '>' with ' '
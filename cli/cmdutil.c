@@ -97,6 +97,24 @@ const char *p;
     case CANT_DELETE:
         p = _("can't delete file (read-only?)");
         break;
+    case PIPE_FULL:
+        p = _("pipe full");
+        break;
+    case NO_PIPES:
+        p = _("pipes not supported");
+        break;
+    case BAD_PROGRAM:
+        p = _("not a program");
+        break;
+    case NO_LABEL:
+        p = _("label not found");
+        break;
+    case BATCH_DEPTH:
+        p = _("batch files nested too deeply");
+        break;
+    case LINE_LENGTH:
+        p = _("line too long");
+        break;
     case INVALID_PARAM:
         p = _("invalid parameter");
         break;
@@ -278,7 +296,7 @@ const char *p;
     for (p = dtaptr->d_fname; *p; ) {
         if (*p++ == '.') {
             if (strequal(p,"app") || strequal(p,"gtp") || strequal(p,"prg")
-             || strequal(p,"tos") || strequal(p,"ttp"))
+             || strequal(p,"tos") || strequal(p,"ttp") || strequal(p,"bat"))
                 return p;
         }
     }
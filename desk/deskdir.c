@@ -40,14 +40,12 @@
 #include "deskdir.h"
 #include "deskins.h"
 #include "gemerror.h"
+#include "filecopy.h"
 
 
-#define MAX_CLUS_SIZE   (32*1024L)  /* maximum cluster size */
-
 #define OP_RENAME   777     /* used internally by dir_op(): must not be the same as any other OP_XXX ! */
 
-static UBYTE    *copybuf;   /* for copy operations */
-static LONG     copylen;    /* size of above buffer */
+static FCOPY    fcopy;      /* for copy operations */
 
 static WORD     ml_havebox;
 static WORD     deleted_folders;
@@ -380,42 +378,78 @@ static WORD output_fname(char *psrc_file, char *pdst_file)
 }
 
 
+/*
+ *  Error callback for the copy engine: issue the appropriate alert
+ *  and convert the reply
+ */
+static WORD copy_error(void *arg, WORD type, const char *path, LONG rc)
+{
+    char *name = filename_start((char *)path);
+    WORD alert;
+
+    switch(type)
+    {
+    case FC_ERR_FULL:
+        fun_alert_merge(1, STDISKFU, path[0]);
+        return FC_ABORT;
+    case FC_ERR_READ:
+    case FC_ERR_WRITE:
+        /* Skip or Abort ? */
+        alert = (type == FC_ERR_READ) ? STRDFILE : STWRFILE;
+        return (fun_alert_merge(1, alert, name) == 1) ? FC_SKIP : FC_ABORT;
+    case FC_ERR_OPEN:
+        alert = STOPFAIL;
+        break;
+    case FC_ERR_CREATE:
+        alert = STCRTFIL;
+        break;
+    default:    /* FC_ERR_DELETE */
+        alert = STDELFIL;
+        break;
+    }
+
+    switch(fun_alert_merge(1, alert, name))
+    {
+    case 1:     /* skip */
+        return FC_SKIP;
+    case 2:     /* retry */
+        return FC_RETRY;
+    }
+
+    return FC_ABORT;
+}
+
+
+/*
+ *  Progress callback for the copy engine: allow the user to abort
+ *  while large files are being copied
+ */
+static WORD copy_progress(void *arg, const FCSTAT *stat)
+{
+    return user_abort();
+}
+
+
 /*
  *  Directory routine to DO File COPYing
  *
+ *  The copy is done by the copy engine, which may buffer it: if so,
+ *  errors are reported later, and the source file of a move is not
+ *  deleted until copy_flush() is called.
+ *
  *  Returns:
  *      1/TRUE  ok
  *      0/FALSE if error opening destination, or user said stop,
  *              or error during copy (including disk full)
  *      -1      user skipped this copy
  */
-static WORD d_dofcopy(char *psrc_file, char *pdst_file, WORD time, WORD date, WORD attr)
+static WORD d_dofcopy(char *psrc_file, char *pdst_file, WORD attr, WORD op)
 {
-    BOOL diskfull = FALSE;
-    WORD srcfh, dstfh, rc;
-    LONG readlen, writelen, error;
-
-    while(1)
-    {
-        error = dos_open(psrc_file, 0);
-        if (error >= 0)
-            break;
-        switch(fun_alert_merge(1, STOPFAIL, filename_start(psrc_file)))
-        {
-        case 1:     /* skip */
-            return -1;
-        case 2:     /* retry */
-            break;
-        case 3:     /* abort */
-            return 0;
-        }
-    }
-    srcfh = (WORD)error;
+    WORD rc;
 
     rc = output_fname(psrc_file, pdst_file);
     if (rc <= 0)        /* not allowed to copy file */
     {
-        dos_close(srcfh);
         if (rc == 0)    /* unexpected error opening dest, or user said stop */
             return FALSE;
         return -1;      /* user said skip, notify caller */
@@ -424,80 +458,18 @@ static WORD d_dofcopy(char *psrc_file, char *pdst_file, WORD time, WORD date, WO
     /*
      * we have the (possibly-modified) filename in pdst_file
      */
-    while(1)
-    {
-        error = dos_create(pdst_file, attr);
-        if (error >= 0)
-            break;
-        switch(fun_alert_merge(1, STCRTFIL, filename_start(pdst_file)))
-        {
-        case 1:     /* skip */
-            dos_close(srcfh);
-            return -1;
-        case 2:     /* retry */
-            break;
-        case 3:     /* abort */
-            dos_close(srcfh);
-            return 0;
-        }
-    }
-    dstfh = (WORD)error;
-
-    /*
-     * perform copy
-     */
-    rc = TRUE;
-    while(1)
-    {
-        error = readlen = dos_read(srcfh, copylen, copybuf);
-        if (error == 0L)    /* end of file */
-        {
-            dos_setdt(dstfh, time, date);   /* update target date/time */
-            break;
-        }
-        if (error < 0L)     /* read error */
-            break;
-
-        error = writelen = dos_write(dstfh, readlen, copybuf);
-        if (error < 0L)
-            break;
-
-        if (writelen != readlen)
-        {
-            fun_alert_merge(1, STDISKFU, pdst_file[0]);
-            diskfull = TRUE;
-            break;
-        }
-    }
-
-    if (error < 0L)
-    {
-        WORD alert;
-        char *file;
-        if (readlen < 0)
-        {
-            alert = STRDFILE;
-            file = psrc_file;
-        }
-        else
-        {
-            alert = STWRFILE;
-            file = pdst_file;
-        }
-        /* Skip or Abort ? */
-        rc = (fun_alert_merge(1, alert, filename_start(file))==1) ? -1 : 0;
-    }
-
-    dos_close(srcfh);       /* close files */
-    dos_close(dstfh);
+    return fc_copy(&fcopy, psrc_file, pdst_file, attr, (op==OP_MOVE) ? FC_MOVE : 0);
+}
 
-    if (diskfull)
-    {
-        dos_delete(pdst_file);
-        rc = FALSE;
-    }
 
-    return rc;
+/*
+ *  Write out any copies buffered by the copy engine
+ *
+ *  Returns FALSE iff the user said stop
+ */
+static WORD copy_flush(void)
+{
+    return fc_flush(&fcopy) != FC_ABORT;
 }
 
 
@@ -566,8 +538,15 @@ WORD d_doop(WORD level, WORD op, char *psrc_path, char *pdst_path, OBJECT *tree,
             case OP_COUNT:
                 G.g_ndirs++;
                 break;
-            case OP_DELETE:
             case OP_MOVE:
+                /* the folder must be empty before we can delete it */
+                if (!copy_flush())
+                {
+                    more = FALSE;
+                    break;
+                }
+                FALLTHROUGH;
+            case OP_DELETE:
                 ptmp = filename_start(psrc_path) - 1;
                 *ptmp = '\0';
                 more = d_dofoldel(psrc_path);
@@ -659,12 +638,8 @@ WORD d_doop(WORD level, WORD op, char *psrc_path, char *pdst_path, OBJECT *tree,
         case OP_COPY:
         case OP_MOVE:
             ptmpdst = add_fname(pdst_path, dta->d_fname);
-            more = d_dofcopy(psrc_path, pdst_path, dta->d_time,
-                            dta->d_date, dta->d_attrib);
+            more = d_dofcopy(psrc_path, pdst_path, dta->d_attrib, op);
             set_all_files(ptmpdst); /* restore original dest path */
-            /* if moving, delete original only if copy was ok */
-            if ((op == OP_MOVE) && (more > 0))
-                more = d_dofdel(psrc_path);
             break;
         }
         if (op != OP_COUNT)
@@ -889,6 +864,13 @@ WORD dir_op(WORD op, WORD icontype, PNODE *pspath, char *pdst_path, DIRCOUNT *co
     tree = NULL;
     if (op != OP_COUNT)
     {
+#if CONF_WITH_DIR_CACHE
+        /*
+         * any number of directories may be modified by the operation,
+         * so don't trust any cached listings afterwards
+         */
+        pn_invalidate(NULL);
+#endif
         tree = desk_rs_trees[ADCPYDEL];
         obj = tree + CDTITLE;
     }
@@ -906,32 +888,25 @@ WORD dir_op(WORD op, WORD icontype, PNODE *pspath, char *pdst_path, DIRCOUNT *co
         break;
     case OP_COPY:
     case OP_MOVE:
-        lavail = dos_avail_stram() - 0x400; /* allow safety margin */
+        /*
+         * the copy engine sizes its buffer from available memory,
+         * allowing a safety margin.  we prefer ST RAM, if so
+         * configured, to avoid extra copying via the FRB for ACSI &
+         * floppy I/O.
+         */
+#if CONF_PREFER_STRAM_DISK_BUFFERS
+        lavail = fc_init(&fcopy, 0x400, MX_STRAM);
+#else
+        lavail = fc_init(&fcopy, 0x400, MX_PREFTTRAM);
+#endif
         if (lavail < 0L)
         {
             desk_busy_off();
             malloc_fail_alert();        /* let user know */
             return FALSE;
         }
-        /*
-         * for efficiency, the copy length should be a multiple of
-         * cluster size.  it's a lot of work to figure out the actual
-         * cluster sizes for the source and destination, but in most
-         * cases, available memory will be >=32K, the maximum possible
-         * cluster size.  in this case, we set 'copylen' to the largest
-         * multiple that fits in available memory.  if we have less
-         * than 32K available, we just set it as large as possible.
-         * we always allocate in ST RAM to avoid extra copying via
-         * the FRB for ACSI & floppy I/O.
-         */
-        if (lavail >= MAX_CLUS_SIZE)
-            copylen = lavail & ~(MAX_CLUS_SIZE-1);
-        else copylen = lavail;
-#if CONF_PREFER_STRAM_DISK_BUFFERS
-        copybuf = dos_alloc_stram(copylen);
-#else
-        copybuf = dos_alloc_anyram(copylen);
-#endif
+        fcopy.error = copy_error;
+        fcopy.progress = copy_progress;
         FALLTHROUGH;
     case OP_RENAME:
         confirm = G.g_ccopypref;
@@ -1036,11 +1011,8 @@ WORD dir_op(WORD op, WORD icontype, PNODE *pspath, char *pdst_path, DIRCOUNT *co
         case OP_RENAME:
             ptmpdst = add_fname(dstpth, pf->f_name);
             more = (op==OP_RENAME) ? d_dofileren(srcpth,dstpth,FALSE) :
-                    d_dofcopy(srcpth, dstpth, pf->f_time, pf->f_date, pf->f_attr);
+                    d_dofcopy(srcpth, dstpth, pf->f_attr, op);
             set_all_files(ptmpdst); /* restore original dest path */
-            /* if moving, delete original only if copy was ok */
-            if ((op == OP_MOVE) && (more > 0))
-                more = d_dofdel(srcpth);
             break;
         }
         if (op != OP_COUNT)
@@ -1066,7 +1038,9 @@ WORD dir_op(WORD op, WORD icontype, PNODE *pspath, char *pdst_path, DIRCOUNT *co
         break;
     case OP_COPY:
     case OP_MOVE:
-        dos_free(copybuf);
+        if (!copy_flush())
+            more = FALSE;
+        fc_exit(&fcopy);
         break;
     }
 
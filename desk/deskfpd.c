@@ -35,6 +35,210 @@
 #include "desksupp.h"
 
 #include "string.h"
+#include "intmath.h"
+
+
+#if CONF_WITH_DIR_CACHE
+/*
+ * Directory listing cache
+ *
+ * When a window stops displaying a directory (because it is closed, or
+ * because the user navigates to another folder), the FNODE list is kept
+ * here rather than freed, so that re-opening the directory does not need
+ * to read it from disk again.  An entry is only reused if GEMDOS reports
+ * no change to any directory or medium since it was read, see
+ * dos_dirchanges().  The desktop also discards entries for directories
+ * that it modifies itself, see pn_invalidate().
+ */
+#define NUM_PCACHE  4       /* number of listings kept */
+#define PCACHE_MINFREE  (32*1024L)  /* flush the cache if free memory drops below this */
+
+typedef struct
+{
+    char  c_spec[LEN_ZPATH];    /* path incl filemask; empty if entry unused */
+    FNODE *c_fbase;             /* start of malloc'd fnodes */
+    FNODE *c_flist;             /* linked list of fnodes */
+    WORD  c_count;              /* number of items (fnodes) */
+    LONG  c_size;               /* total size of items */
+    WORD  c_sort;               /* value of G.g_isort when list was sorted */
+    ULONG c_changes;            /* value of dos_dirchanges() when list was read */
+    UWORD c_lru;                /* higher values were used more recently */
+} PCACHE;
+
+static PCACHE pcache[NUM_PCACHE];
+static UWORD pcache_lru;
+
+
+static void pc_free(PCACHE *pc)
+{
+    if (pc->c_fbase)
+        dos_free(pc->c_fbase);
+    pc->c_fbase = pc->c_flist = NULL;
+    pc->c_spec[0] = '\0';
+}
+
+
+/*
+ *  Get the value used to validate a cached listing, i.e. the number of
+ *  changes to directories and media counted by GEMDOS
+ *
+ *  The directory (or the volume label, for a root directory) is searched
+ *  for first, so that GEMDOS checks for a media change on the drive.
+ *
+ *  Returns FALSE if the directory cannot be found, or GEMDOS does not
+ *  count the changes (e.g. MiNT is running).
+ */
+static BOOL pc_changes(char *spec, ULONG *pchanges)
+{
+    DTA *dtasave;
+    WORD ret;
+    char path[MAXPATHLEN];
+    char *p;
+
+    strcpy(path, spec);
+    p = filename_start(path);
+    if (p - path > 3)           /* subdirectory: search for the folder itself */
+    {
+        *(p-1) = '\0';
+        ret = FA_SUBDIR;
+    }
+    else                        /* root: search for the volume label */
+        ret = FA_VOL;
+
+    dtasave = dos_gdta();
+    dos_sdta(&G.g_wdta);
+    ret = dos_sfirst(path, ret);
+    dos_sdta(dtasave);
+
+    if (ret < 0)
+        return FALSE;
+
+    return dos_dirchanges(pchanges);
+}
+
+
+/*
+ *  Move the file list of a pathnode into the cache, evicting the least
+ *  recently used entry if necessary
+ */
+static BOOL pc_store(PNODE *pn)
+{
+    PCACHE *pc, *victim;
+
+    if (!pn->p_cacheok || !pn->p_fbase)
+        return FALSE;
+
+    victim = pcache;
+    for (pc = pcache; pc < pcache+NUM_PCACHE; pc++)
+    {
+        if (!pc->c_spec[0])
+        {
+            victim = pc;
+            break;
+        }
+        if (pc->c_lru < victim->c_lru)
+            victim = pc;
+    }
+    pc_free(victim);
+
+    strcpy(victim->c_spec, pn->p_spec);
+    victim->c_fbase = pn->p_fbase;
+    victim->c_flist = pn->p_flist;
+    victim->c_count = pn->p_count;
+    victim->c_size = pn->p_size;
+    victim->c_sort = G.g_isort;
+    victim->c_changes = pn->p_changes;
+    victim->c_lru = ++pcache_lru;
+
+    return TRUE;
+}
+
+
+static PCACHE *pc_find(char *spec)
+{
+    PCACHE *pc;
+
+    for (pc = pcache; pc < pcache+NUM_PCACHE; pc++)
+        if (pc->c_spec[0] && (strcmp(pc->c_spec, spec) == 0))
+            return pc;
+
+    return NULL;
+}
+
+
+/*
+ *  Look for a valid cached listing for the pathnode; if found, move it
+ *  from the cache into the pathnode
+ */
+static BOOL pc_fetch(PNODE *pn)
+{
+    PCACHE *pc;
+    FNODE *pf;
+    ULONG changes;
+    WORD sort;
+
+    pc = pc_find(pn->p_spec);
+    if (!pc)
+        return FALSE;
+
+    if (!pc_changes(pn->p_spec, &changes) || (changes != pc->c_changes))
+    {
+        pc_free(pc);
+        return FALSE;
+    }
+
+    pn->p_fbase = pc->c_fbase;
+    pn->p_flist = pc->c_flist;
+    pn->p_count = pc->c_count;
+    pn->p_size = pc->c_size;
+    pn->p_changes = changes;
+    pn->p_cacheok = TRUE;
+    sort = pc->c_sort;
+    pc->c_fbase = NULL;
+    pc_free(pc);
+
+    for (pf = pn->p_flist; pf; pf = pf->f_next)
+        pf->f_selected = FALSE;
+
+    if (sort != G.g_isort)          /* sort sequence changed meanwhile */
+        pn->p_flist = pn_sort(pn);
+
+    return TRUE;
+}
+
+
+/*
+ *  Initialise the directory listing cache
+ */
+void pn_init(void)
+{
+    bzero(pcache, sizeof(pcache));
+    pcache_lru = 0;
+}
+
+
+/*
+ *  Discard any cached listings for the directory of the specified path
+ *  (the filemask is ignored) and for its subdirectories; if path is NULL,
+ *  discard all cached listings
+ */
+void pn_invalidate(char *path)
+{
+    PCACHE *pc;
+    WORD len = 0;
+
+    if (path)
+        len = filename_start(path) - path;
+
+    for (pc = pcache; pc < pcache+NUM_PCACHE; pc++)
+    {
+        if (!pc->c_spec[0])
+            continue;
+        if (!path || (strncmp(pc->c_spec, path, len) == 0))
+            pc_free(pc);
+    }
+}
+#endif
 
 
 /*
@@ -48,6 +252,9 @@ static void fl_free(PNODE *pn)
     pn->p_fbase = pn->p_flist = NULL;
     pn->p_count = 0;
     pn->p_size = 0L;
+#if CONF_WITH_DIR_CACHE
+    pn->p_cacheok = FALSE;
+#endif
 }
 
 
@@ -56,6 +263,15 @@ static void fl_free(PNODE *pn)
  */
 void pn_close(PNODE *thepath)
 {
+#if CONF_WITH_DIR_CACHE
+    /* keep our file list for later if possible */
+    if (pc_store(thepath))
+    {
+        thepath->p_fbase = NULL;
+        thepath->p_cacheok = FALSE;
+    }
+#endif
+
     /* free our file list */
     fl_free(thepath);
 }
@@ -88,119 +304,136 @@ PNODE *pn_open(char *pathname, WNODE *pw)
 
 
 /*
- *  Compare file nodes pf1 & pf2, using:
- *      (1) a field determined by 'which'
- *      (2) the full name, if (1) compares equal
- *
- *  Returns -ve if pf1<pf2, 0 if pf1==pf2, +ve if pf1>pf2
+ *  Sort entry, holding the precomputed sort keys for one FNODE
  */
-static LONG pn_fcomp(FNODE *pf1, FNODE *pf2, WORD which)
+typedef struct
 {
-    LONG chk = 0L;
-    char *ps1, *ps2;
+    FNODE *pf;
+    const char *ext;        /* file extension, used for S_TYPE */
+    ULONG key;              /* primary key: lower values sort first */
+    WORD  group;            /* folders (0) sort before files (1) */
+} SORTENT;
 
-    ps1 = pf1->f_name;
-    ps2 = pf2->f_name;
 
-    switch(which)
+/*
+ *  Compute the sort keys for an FNODE, according to the G.g_isort
+ *  parameter; folders always sort out first (unless 'unsorted' is
+ *  specified).
+ */
+static void pn_key(SORTENT *se, FNODE *pf)
+{
+    se->pf = pf;
+    se->ext = NULL;
+    se->key = 0L;
+    se->group = 0;
+
+    if (G.g_isort != S_NSRT)
+        se->group = (pf->f_attr & FA_SUBDIR) ? 0 : 1;
+
+    switch(G.g_isort)
     {
-    case S_DATE:
-        chk = (LONG)pf2->f_date - (LONG)pf1->f_date;
-        if (chk == 0L)
-            chk = (LONG)pf2->f_time - (LONG)pf1->f_time;
+    case S_DATE:                /* newest first */
+        se->key = ~(((ULONG)pf->f_date << 16) | pf->f_time);
         break;
-    case S_SIZE:
-        chk = (LONG)pf2->f_size - (LONG)pf1->f_size;
+    case S_SIZE:                /* largest first */
+        se->key = ~(ULONG)pf->f_size;
         break;
     case S_TYPE:
-        chk = strcmp(scasb(ps1,'.'),scasb(ps2,'.'));
+        se->ext = scasb(pf->f_name, '.');
         break;
-    case S_NSRT:
-        chk = (LONG)pf1->f_seq - (LONG)pf2->f_seq;  /* low seq #s sort first */
+    case S_NSRT:                /* low seq #s sort first */
+        se->key = pf->f_seq;
         break;
     }
-    if (chk)
-        return chk;
-
-    return strcmp(ps1,ps2); /* always the last test (the only test if S_NAME) */
 }
 
 
 /*
- *  Routine to compare two fnodes to see which one is greater.
- *  Sort sequence is based on the G.g_isort parameter; folders
- *  always sort out first (unless 'unsorted' is specified).
+ *  Compare sort entries se1 & se2, using:
+ *      (1) the precomputed keys
+ *      (2) the full name, if (1) compares equal
  *
- *  Returns -ve if pf1 < pf2, 0 if pf1 == pf2, and +ve if pf1 > pf2
+ *  Returns -ve if se1<se2, 0 if se1==se2, +ve if se1>se2
  */
-static LONG pn_comp(FNODE *pf1, FNODE *pf2)
+static WORD pn_comp(SORTENT *se1, SORTENT *se2)
 {
-    if (G.g_isort != S_NSRT)
+    WORD chk;
+
+    if (se1->group != se2->group)
+        return se1->group - se2->group;
+
+    if (se1->key != se2->key)
+        return (se1->key < se2->key) ? -1 : 1;
+
+    if (se1->ext)
     {
-        if ((pf1->f_attr ^ pf2->f_attr) & FA_SUBDIR)
-            return (pf1->f_attr & FA_SUBDIR) ? -1L : 1L;
+        chk = strcmp(se1->ext, se2->ext);
+        if (chk)
+            return chk;
     }
 
-    return pn_fcomp(pf1,pf2,G.g_isort);
+    return strcmp(se1->pf->f_name, se2->pf->f_name);
 }
 
 
 /*
  *  Sort the fnodes in the list chained from the specified pathnode
  *
+ *  this is a bottom-up merge sort, which is stable and does O(n log n)
+ *  comparisons; the sort keys are computed once per fnode beforehand
  */
 FNODE *pn_sort(PNODE *pn)
 {
-    FNODE *pf, *pftemp;
-    FNODE *newlist;
-    FNODE **ml_pfndx;
-    WORD  count, gap, i, j;
+    FNODE *pf;
+    SORTENT *base, *src, *dst, *tmp;
+    LONG  count, width, lo, mid, hi, i, j, k;   /* lo+2*width may not fit in a WORD */
 
     if (pn->p_count < 2)        /* the list is already sorted */
         return pn->p_flist;
 
     /*
-     * malloc & build index array
+     * malloc & build sort arrays
      */
-    ml_pfndx = dos_alloc_anyram(pn->p_count*sizeof(FNODE *));
-    if (!ml_pfndx)              /* no space, can't sort */
+    base = dos_alloc_anyram(2L*pn->p_count*sizeof(SORTENT));
+    if (!base)                  /* no space, can't sort */
     {
         malloc_fail_alert();
         return pn->p_flist;
     }
+    src = base;
+    dst = base + pn->p_count;
 
     for (count = 0, pf = pn->p_flist; pf; pf = pf->f_next)
-        ml_pfndx[count++] = pf;
+        pn_key(&src[count++], pf);
 
-    /* sort files using shell sort on page 108 of  K&R C Prog. Lang. */
-    for (gap = count/2; gap > 0; gap /= 2)
+    for (width = 1; width < count; width *= 2)
     {
-        for (i = gap; i < count; i++)
+        for (lo = 0; lo < count; lo += 2*width)
         {
-            for (j = i-gap; j >= 0; j -= gap)
+            mid = min(lo+width, count);
+            hi = min(lo+2*width, count);
+            for (i = lo, j = mid, k = lo; k < hi; k++)
             {
-                if (pn_comp(ml_pfndx[j], ml_pfndx[j+gap]) <= 0L)
-                    break;
-                pftemp = ml_pfndx[j];
-                ml_pfndx[j] = ml_pfndx[j+gap];
-                ml_pfndx[j+gap] = pftemp;
+                if ((i < mid) && ((j >= hi) || (pn_comp(&src[i], &src[j]) <= 0)))
+                    dst[k] = src[i++];
+                else
+                    dst[k] = src[j++];
             }
         }
+        tmp = src;
+        src = dst;
+        dst = tmp;
     }
 
     /* link up the list in order */
-    newlist = ml_pfndx[0];
-    pf = ml_pfndx[0];
-    for (i = 1; i < count; i++)
-    {
-        pf->f_next = ml_pfndx[i];
-        pf = ml_pfndx[i];
-    }
-    pf->f_next = (FNODE *) NULL;
+    for (i = 0; i < count-1; i++)
+        src[i].pf->f_next = src[i+1].pf;
+    src[count-1].pf->f_next = (FNODE *) NULL;
+    pf = src[0].pf;
 
-    dos_free(ml_pfndx);
+    dos_free(base);
 
-    return newlist;
+    return pf;
 }
 
 
@@ -228,6 +461,9 @@ WORD pn_active(PNODE *pn, BOOL include_folders)
     FNODE *fn, *prev;
     LONG maxmem, maxcount, size = 0L;
     WORD count, ret;
+#if CONF_WITH_DIR_CACHE
+    PCACHE *pc;
+#endif
 #if CONF_WITH_FILEMASK
     char search[MAXPATHLEN];
     char *match;
@@ -235,6 +471,19 @@ WORD pn_active(PNODE *pn, BOOL include_folders)
 
     fl_free(pn);                    /* free any existing filenodes */
 
+#if CONF_WITH_DIR_CACHE
+    /*
+     * the listing we are about to read supersedes any cached copy; if we
+     * are short of memory, sacrifice the other cached listings too
+     */
+    if ((pc = pc_find(pn->p_spec)) != NULL)
+        pc_free(pc);
+    if (dos_avail_anyram() < PCACHE_MINFREE)
+        pn_invalidate(NULL);
+    pn->p_cacheok = include_folders
+                    && pc_changes(pn->p_spec, &pn->p_changes);
+#endif
+
     maxmem = dos_avail_anyram();    /* allocate max possible memory */
     maxcount = maxmem / sizeof(FNODE);
     if (maxcount)
@@ -296,6 +545,25 @@ WORD pn_active(PNODE *pn, BOOL include_folders)
 }
 
 
+/*
+ *  Build the filenode list for the specified pathnode, for display in
+ *  a window
+ *
+ *  this is the same as pn_active(pn, TRUE), except that a cached listing
+ *  is used if available
+ */
+WORD pn_reopen(PNODE *pn)
+{
+#if CONF_WITH_DIR_CACHE
+    fl_free(pn);
+    if (pc_fetch(pn))
+        return 0;
+#endif
+
+    return pn_active(pn, TRUE);
+}
+
+
 /*
  *  Clear the selection flag in all FNODES chained from the PNODE in the specified WNODE
  */
@@ -75,6 +75,10 @@ struct _pathnode
     FNODE *p_flist;         /* linked list of fnodes */
     WORD  p_count;          /* number of items (fnodes) */
     LONG  p_size;           /* total size of items */
+#if CONF_WITH_DIR_CACHE
+    BOOL  p_cacheok;        /* TRUE iff the fnodes may be cached by pn_close() */
+    ULONG p_changes;        /* value of dos_dirchanges() when read, see pc_changes() */
+#endif
 };
 
 
@@ -87,6 +91,11 @@ void pn_close(PNODE *thepath);
 PNODE *pn_open(char *pathname, WNODE *pw);
 FNODE *pn_sort(PNODE *pn);
 WORD pn_active(PNODE *thepath, BOOL include_folders);
+WORD pn_reopen(PNODE *pn);
+#if CONF_WITH_DIR_CACHE
+void pn_init(void);
+void pn_invalidate(char *path);
+#endif
 FNODE *pn_selected(WNODE *pw);
 void pn_count(WNODE *pw, WORD *nsel, WORD *napp);
 
@@ -118,6 +118,10 @@ void fun_mark_for_rebld(char *path)
 {
     WNODE *pwin;
 
+#if CONF_WITH_DIR_CACHE
+    pn_invalidate(path);
+#endif
+
     for (pwin = G.g_wfirst; pwin; pwin = pwin->w_next)
     {
         /* if opened and same path then mark */
@@ -174,6 +178,10 @@ void fun_rebld(char *ptst)
 
     desk_busy_on();
 
+#if CONF_WITH_DIR_CACHE
+    pn_invalidate(ptst);
+#endif
+
     /* check all wnodes     */
     for (pwin = G.g_wfirst; pwin; pwin = pwin->w_next)
     {
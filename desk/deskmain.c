@@ -1923,6 +1923,9 @@ void static close_desktop_windows(void)
         dos_free(pw->w_pnode.p_fbase);  /* free the fnodes */
         win_free(pw);                   /* free the wnode */
     }
+#if CONF_WITH_DIR_CACHE
+    pn_invalidate(NULL);                /* free the cached fnodes */
+#endif
 }
 #endif
 
@@ -1944,6 +1947,11 @@ BOOL deskmain(void)
     /* remember start drive */
     G.g_stdrv = dos_gdrv();
 
+#if CONF_WITH_DIR_CACHE
+    /* any cached listings belonged to a previous desktop process */
+    pn_init();
+#endif
+
     /* initialize libraries */
     gl_apid = appl_init();
 
@@ -433,7 +433,7 @@ WORD do_diropen(WNODE *pw, WORD new_win, WORD curr_icon,
     }
 
     /* activate path by search and sort of directory */
-    ret = pn_active(&pw->w_pnode, TRUE);
+    ret = pn_reopen(&pw->w_pnode);
     if (ret < 0)    /* error reading directory */
     {
         KDEBUG(("Error reading directory %s\n",pathname));
@@ -1690,6 +1690,11 @@ void refresh_window(WNODE *pw, BOOL force_mediach)
         }
     }
 
+#if CONF_WITH_DIR_CACHE
+    /* the whole point is to re-read the directory */
+    pn_invalidate(pw->w_pnode.p_spec);
+#endif
+
     /* make sure we don't open a new window */
     do_fopen(pw, 0, pw->w_pnode.p_spec, FALSE);
 }
@@ -1702,6 +1707,12 @@ void refresh_window(WNODE *pw, BOOL force_mediach)
 void refresh_drive(WORD drive)
 {
     WNODE *pw;
+#if CONF_WITH_DIR_CACHE
+    char path[4];
+
+    build_root_path(path, drive);
+    pn_invalidate(path);
+#endif
 
     for (pw = G.g_wfirst; pw; pw = pw->w_next)
     {
@@ -546,91 +546,35 @@ static WORD win_delta(WNODE *pw, BOOL horizontal, WORD newcv)
 
 /*
  *  Routine to blt the contents of a window based on a new current row
- *  or column
+ *  or column.  Only the rows or columns that the blit exposes are drawn.
  */
 static void win_blt(WNODE *pw, BOOL horizontal, WORD newcv)
 {
-    WORD  delcv;
-    WORD  sx, sy, dx, dy, wblt, hblt, revblt, tmp;
-    GRECT c, t;
+    WORD  delcv, dx, dy;
+    GRECT c;
 
     delcv = win_delta(pw, horizontal, newcv);
     if (!delcv)
         return;
 
+    dx = dy = 0;
 #if CONF_WITH_SIZE_TO_FIT
     if (horizontal)
     {
         pw->w_cvcol += delcv;
+        dx = -delcv * G.g_iwspc;
     }
     else
 #endif
     {
         pw->w_cvrow += delcv;
+        dy = -delcv * G.g_ihspc;
     }
 
     wind_get_grect(pw->w_id, WF_WXYWH, &c);
     win_bldview(pw, &c);
 
-    /* see if any part is off the screen */
-    wind_get_grect(pw->w_id, WF_FIRSTXYWH, &t);
-    rc_intersect(&gl_rfull, &t);
-
-    if (rc_equal(&c, &t))
-    {
-        /* blt as much as we can, adjust clip & draw the rest */
-        if ((revblt = (delcv < 0)) != 0)
-            delcv = -delcv;
-        if (pw->w_pnrow > delcv)
-        {
-            /* see how much there is, pretend blt up */
-#if CONF_WITH_SIZE_TO_FIT
-            if (horizontal)
-            {
-                sy = dy = 0;
-                sx = delcv * G.g_iwspc;
-                dx = 0;
-                wblt = c.g_w - sx;
-                hblt = c.g_h;
-            }
-            else
-#endif
-            {
-                sx = dx = 0;
-                sy = delcv * G.g_ihspc;
-                dy = 0;
-                wblt = c.g_w;
-                hblt = c.g_h - sy;
-            }
-            if (revblt)
-            {
-                tmp = sx;
-                sx = dx;
-                dx = tmp;
-                tmp = sy;
-                sy = dy;
-                dy = tmp;
-            }
-            gsx_sclip(&c);
-            bb_screen(sx+c.g_x, sy+c.g_y, dx+c.g_x, dy+c.g_y, wblt, hblt);
-#if CONF_WITH_SIZE_TO_FIT
-            if (horizontal)
-            {
-                if (!revblt)
-                    c.g_x += wblt;
-                c.g_w -= wblt;
-            }
-            else
-#endif
-            {
-                if (!revblt)
-                    c.g_y += hblt;
-                c.g_h -= hblt;
-            }
-        }
-    }
-
-    do_wredraw(pw->w_id, &c);
+    wm_scroll(pw->w_id, &c, dx, dy, do_wredraw);
 }
 
 
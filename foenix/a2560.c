@@ -188,6 +188,7 @@ void a2560_midi_init(uint32_t (*timer)(void),uint16_t timeout) {
     a2560_irq_acknowledge(INT_MIDI);
     a2560_irq_enable(INT_MIDI);
     a2560_debugnl("mpu401_init returns %d",mpu401_init());
+    mpu401_queue_init();
 }
 
 #endif /* CONF_WITH_MPU401 */
@@ -5,6 +5,9 @@
 #include "regutils.h"
 #include "uart16550.h"
 #include "vicky2_txt_a_logger.h"
+#if MACHINE_A2560_TRACE
+#include "cpu.h"
+#endif
 
 void outchar(int c);
 void outchar(int c) {
@@ -30,6 +33,196 @@ void outchar(int c) {
 #endif
 }
 
+
+#if MACHINE_A2560_TRACE
+
+#define TRACE_LINELEN   128 /* longer lines are truncated */
+#define TRACE_DRAINMAX  64  /* max chars output per a2560_trace_drain() */
+
+extern const char os_header[];  /* start of the OS, see bios/startup.S */
+
+static struct a2560_trace_rec_t trace_recs[MACHINE_A2560_TRACE_RECORDS];
+static struct a2560_trace_t trace_info;
+
+/* The record being output */
+static char trace_line[TRACE_LINELEN];
+static uint16_t trace_linelen, trace_linepos;
+
+/* Until the timer drains the ring, records are output as soon as they're made */
+static bool trace_async;
+
+
+/*
+ * Return true if the debug port can accept a character without waiting.
+ */
+static bool debug_can_put(void)
+{
+#ifdef MACHINE_A2560U
+    return uart16550_can_put((UART16550*)UART1);
+#elif defined(MACHINE_A2560K) || defined(MACHINE_A2560X) || defined(MACHINE_GENX)
+ #if FOENIX_CHANNEL_A_DEBUG_PRINT
+    return true;
+ #else
+    return uart16550_can_put((UART16550*)UART2);
+ #endif
+#elif defined(MACHINE_A2560M)
+    return (R8(UART3_CTRL) & UART3_TX_EMPTY) != 0;
+#endif
+}
+
+
+static void trace_init(void)
+{
+    int i;
+
+    for (i = 0; i < MACHINE_A2560_TRACE_RECORDS; i++)
+        trace_recs[i].seq = 0xffff; /* never matches before the slot is used */
+
+    trace_info.version = A2560_TRACE_VERSION;
+    trace_info.recsize = sizeof(struct a2560_trace_rec_t);
+    trace_info.nrecs = MACHINE_A2560_TRACE_RECORDS;
+    trace_info.argbytes = A2560_TRACE_ARGBYTES;
+    trace_info.fine_hz = CPU_FREQ;
+    trace_info.rombase = (uint32_t)os_header;
+    trace_info.recs = trace_recs;
+    trace_info.magic = A2560_TRACE_MAGIC;
+}
+
+
+/*
+ * Add a record to the ring.
+ * The slot is claimed with interrupts masked, which only takes a few
+ * instructions; it is filled in with interrupts enabled, and only becomes
+ * visible to the consumer when its sequence number is written.
+ */
+static void trace_record(const char *fmt, va_list ap, uint16_t flags)
+{
+    struct a2560_trace_rec_t *r;
+    const uint8_t *args = (const uint8_t *)ap;
+    uint32_t n, tick, fine;
+    uint16_t sr;
+    int i;
+
+    if (trace_info.magic != A2560_TRACE_MAGIC)
+        trace_init();
+
+    sr = m68k_set_sr(0x2700);
+    n = trace_info.head;
+    if (n - trace_info.tail >= MACHINE_A2560_TRACE_RECORDS)
+    {
+        trace_info.dropped++;
+        m68k_set_sr(sr);
+        return;
+    }
+    trace_info.head = n + 1;
+    m68k_set_sr(sr);
+
+    /* The 200 Hz system timer is timer 2, counting up at CPU_FREQ */
+    do {
+        tick = R32(0x4ba); /* hz_200 */
+        fine = R32(TIMER2_VALUE);
+    } while (tick != R32(0x4ba));
+
+    r = &trace_recs[n & (MACHINE_A2560_TRACE_RECORDS-1)];
+    r->tick = tick;
+    r->fine = fine;
+    r->fmt = fmt;
+    r->flags = flags;
+
+    /*
+     * Save the raw arguments: with the m68k calling convention, a va_list
+     * is simply a pointer to the stacked arguments. We don't know how many
+     * there are, so just take as many bytes as we can store.
+     */
+    for (i = 0; i < A2560_TRACE_ARGBYTES; i++)
+        r->args[i] = args[i];
+
+    r->seq = (uint16_t)n;
+}
+
+
+static void trace_linechar(int c)
+{
+    if (trace_linelen < TRACE_LINELEN)
+        trace_line[trace_linelen++] = (char)c;
+}
+
+
+/*
+ * Format the next complete record into trace_line[].
+ * Returns false if there is none.
+ */
+static bool trace_format_next(void)
+{
+    struct a2560_trace_rec_t *r;
+
+    if (trace_info.tail == trace_info.head)
+        return false;
+
+    r = &trace_recs[trace_info.tail & (MACHINE_A2560_TRACE_RECORDS-1)];
+    if (r->seq != (uint16_t)trace_info.tail)
+        return false;   /* claimed, but still being filled in */
+
+    trace_linelen = trace_linepos = 0;
+    doprintf(trace_linechar, r->fmt, (va_list)r->args);
+    if (!(r->flags & A2560_TRACE_NONL))
+    {
+        if (trace_linelen > TRACE_LINELEN - 2)
+            trace_linelen = TRACE_LINELEN - 2;
+        trace_linechar('\r');
+        trace_linechar('\n');
+    }
+
+    trace_info.tail++;
+
+    return true;
+}
+
+
+/*
+ * Send pending trace output to the debug port, without waiting for it.
+ * Called from the 50 Hz part of the system timer interrupt.
+ */
+void a2560_trace_drain(void)
+{
+    int n;
+
+    trace_async = true;
+
+    for (n = 0; n < TRACE_DRAINMAX && debug_can_put(); n++)
+    {
+        if (trace_linepos == trace_linelen && !trace_format_next())
+            break;
+        outchar(trace_line[trace_linepos++]);
+    }
+}
+
+
+/*
+ * Send all pending trace output to the debug port, waiting as necessary.
+ */
+void a2560_trace_flush(void)
+{
+    for (;;)
+    {
+        while (trace_linepos < trace_linelen)
+            outchar(trace_line[trace_linepos++]);
+        if (!trace_format_next())
+            break;
+    }
+}
+
+
+struct a2560_trace_t *a2560_trace_info(void)
+{
+    if (trace_info.magic != A2560_TRACE_MAGIC)
+        trace_init();
+
+    return &trace_info;
+}
+#endif /* MACHINE_A2560_TRACE */
+
+
 /*
  * Output the string on the serial port.
  */
@@ -39,9 +232,15 @@ void a2560_debugnl(const char* __restrict__ fmt, ...)
 {
     va_list ap;
     va_start(ap, fmt);
+#if MACHINE_A2560_TRACE
+    trace_record(fmt, ap, 0);
+    if (!trace_async)
+        a2560_trace_flush();
+#else
     doprintf(outchar, fmt, ap);
-    va_end(ap);
     doprintf(outchar, "\r\n", 0L);
+#endif
+    va_end(ap);
 }
 #endif
 }
@@ -51,7 +250,13 @@ void a2560_debug(const char* __restrict__ fmt, ...)
 #if MACHINE_A2560_DEBUG
     va_list ap;
     va_start(ap, fmt);
+#if MACHINE_A2560_TRACE
+    trace_record(fmt, ap, A2560_TRACE_NONL);
+    if (!trace_async)
+        a2560_trace_flush();
+#else
     doprintf(outchar, fmt, ap);
+#endif
     va_end(ap);
 #endif
 }
@@ -61,4 +266,3 @@ void a2560_here(void) {
    a2560_debugnl("HERE");
 #endif
 }
-
@@ -7,4 +7,25 @@ void a2560_debugnl(const char* __restrict__ s, ...);
 void a2560_debug(const char* __restrict__ s, ...);
 void a2560_here(void);
 
+#if MACHINE_A2560_TRACE
+/*
+ * Trace ring
+ *
+ * When MACHINE_A2560_TRACE is enabled, a2560_debug()/a2560_debugnl() don't
+ * format anything: they store the format pointer and the raw argument bytes
+ * in a record of a RAM ring, which is formatted and sent to the debug port
+ * later, a few bytes at a time, from the system timer (see
+ * a2560_trace_drain()). The ring is published via the 'FTRC' cookie: EmuCON's
+ * TRACE command saves it to a file, which tools/tracedec.c decodes.
+ *
+ * Since formatting is deferred, "%s" arguments must point to strings that
+ * stay valid (e.g. constants), not to buffers on the stack.
+ */
+#include "../include/a2560trace.h"
+
+void a2560_trace_drain(void);
+void a2560_trace_flush(void);
+struct a2560_trace_t *a2560_trace_info(void);
+#endif
+
 #endif
@@ -23,4 +23,12 @@ typedef void (*mouse_packet_handler_t)(int8_t*);
 /* Handler for the Real Time Clock ticking, must save registers and return with RTE */
 typedef void (*tick_handler_t)(void);
 
+/* MIDI event for scheduled output */
+struct midi_event_t
+{
+    uint32_t delta;   /* Microseconds after the previous event */
+    uint8_t  length;  /* Number of bytes in data (0 for a pure delay) */
+    uint8_t  data[3]; /* A short MIDI message */
+};
+
 #endif
\ No newline at end of file
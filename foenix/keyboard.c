@@ -61,7 +61,22 @@ void a2560_kbd_init(const uint32_t *counter, uint16_t counter_freq)
     a2560_debugnl("port_cmd: %p", ps2_config.port_cmd);
 #endif
 
-    ps2_init();
+    /* The devices are reset in the background, see a2560_kbd_init_wait() */
+    ps2_init_start();
+}
+
+
+/* To be called regularly after a2560_kbd_init(), until it returns true (the devices are reset) */
+bool a2560_kbd_init_step(void)
+{
+    return ps2_init_step();
+}
+
+
+/* Wait until the devices are reset, then enable the keyboard and mouse */
+void a2560_kbd_init_wait(void)
+{
+    ps2_init_finish();
 
     /* Register GAVIN interrupt handlers */
 #ifndef MACHINE_A2560K
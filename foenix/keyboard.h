@@ -1,10 +1,13 @@
 #pragma once
 
 #include <stdint.h>
+#include <stdbool.h>
 #include "a2560_struct.h"
 
 
 void a2560_kbd_init(const uint32_t *counter, uint16_t counter_freq);
+bool a2560_kbd_init_step(void);
+void a2560_kbd_init_wait(void);
 
 /* They return the previous handler so you can daisy chain them */
 #ifndef MACHINE_A2560K
@@ -21,7 +21,9 @@
 
 #include "foenix.h"
 #include "a2560_debug.h"
+#include "cpu.h"
 #include "mpu401.h"
+#include "timer.h"
 
 /** Timeout for waiting on the MIDI interface */
 static uint16_t timeout_ticks; /* Number of ticks of the timer to wait before timing out */
@@ -119,7 +121,7 @@ bool mpu401_can_read(void) {
 
 /** Returns true if ready to send */
 bool mpu401_can_write(void) {
-    return ~(mpu401_read_status() & MPU401_STAT_TX_BUSY);
+    return !(mpu401_read_status() & MPU401_STAT_TX_BUSY);
 }
 
 void mpu401_write(uint8_t b) {
@@ -136,6 +138,195 @@ uint8_t mpu401_read_status(void) {
     return *MPU401_STAT;
 }
 
+
+
+/* Output queue **************************************************************/
+
+/* The MPU-401 in UART mode only interrupts when a byte is received, so the
+ * output queue is emptied from a hardware timer ticking once per byte time,
+ * which only runs while there is something to send. The receive interrupt
+ * also takes the opportunity to send. Scheduled events are released into
+ * the byte queue by the same timer, when they are due. */
+
+#define TXBUF_SIZE    1024 /* Must be a power of 2 */
+#define NEVENTS       256  /* Must be a power of 2 */
+#define TX_CHUNK      32   /* Bytes queued per masked section, to keep interrupt latency low */
+#define TX_BURST      4    /* Max bytes sent per drain, in case the SuperIO has a FIFO */
+#define TICK_US       (1000000UL / MPU401_TICK_HZ)
+
+extern void a2560_irq_mpu401_timer(void);
+
+/* Byte queue. Indexes are free running, the buffer is [tx_tail..tx_head[ */
+static uint8_t tx_buf[TXBUF_SIZE];
+static volatile uint16_t tx_head;
+static volatile uint16_t tx_tail;
+
+/* Scheduled events, with their due time */
+static struct sched_event_t {
+    uint32_t due;
+    uint8_t  length;
+    uint8_t  data[3];
+} sched[NEVENTS];
+static volatile uint16_t sched_head;
+static volatile uint16_t sched_tail;
+static volatile uint32_t sched_clock; /* Microseconds, advanced while the timer runs */
+static uint32_t sched_last;           /* Due time of the last event queued */
+
+static volatile bool timer_running;
+
+
+void mpu401_queue_init(void) {
+    tx_head = tx_tail = 0;
+    sched_head = sched_tail = 0;
+    sched_clock = sched_last = 0;
+    timer_running = false;
+    a2560_timer_claim(MPU401_TIMER, A2560_TIMER_MPU401);
+    a2560_set_timer(MPU401_TIMER, MPU401_TICK_HZ, true, a2560_irq_mpu401_timer);
+}
+
+
+/* Copy as much as possible of buf into the byte queue. Interrupts must be masked. */
+static uint16_t tx_copy(const uint8_t *buf, uint16_t count) {
+    uint16_t i, n = mpu401_tx_free();
+
+    if (count < n)
+        n = count;
+    for (i = 0; i < n; i++)
+        tx_buf[(uint16_t)(tx_head + i) & (TXBUF_SIZE-1)] = buf[i];
+    tx_head += n;
+
+    return n;
+}
+
+
+/* Send what we can, and start the timer if more remains. Interrupts must be masked. */
+static void queue_kick(void) {
+    mpu401_tx_drain();
+    if (!timer_running && (tx_tail != tx_head || sched_tail != sched_head)) {
+        timer_running = true;
+        a2560_timer_enable(MPU401_TIMER, true);
+    }
+}
+
+
+/**
+ * Queue bytes for output, without waiting.
+ * @return the number of bytes queued, which is less than count if the queue is full
+ */
+uint16_t mpu401_tx_put(const uint8_t *buf, uint16_t count) {
+    uint16_t sr, n, done = 0;
+
+    while (done < count) {
+        n = count - done;
+        if (n > TX_CHUNK)
+            n = TX_CHUNK;
+        sr = m68k_set_sr(0x2700);
+        n = tx_copy(buf + done, n);
+        queue_kick();
+        m68k_set_sr(sr);
+        if (n == 0)
+            break;
+        done += n;
+    }
+
+    return done;
+}
+
+
+/** Returns the number of bytes that can be queued */
+uint16_t mpu401_tx_free(void) {
+    return TXBUF_SIZE - (uint16_t)(tx_head - tx_tail);
+}
+
+
+/**
+ * Send queued bytes while the transmitter is ready. Called with interrupts
+ * masked, from the timer and receive interrupts; can also be used to poll.
+ */
+void mpu401_tx_drain(void) {
+    int n;
+
+    for (n = 0; n < TX_BURST && tx_tail != tx_head && mpu401_can_write(); n++) {
+        *MPU401_DATA = tx_buf[tx_tail & (TXBUF_SIZE-1)];
+        tx_tail++;
+    }
+}
+
+
+/**
+ * Queue events to be sent at a given time. The delta of the first event
+ * counts from now, or from the last event still queued if that is later, so
+ * a sequencer can hand over consecutive batches without drift.
+ * @return the number of events queued, which is less than count if the queue is full
+ */
+uint16_t mpu401_schedule(const struct midi_event_t *events, uint16_t count) {
+    struct sched_event_t *e;
+    uint16_t i, sr;
+
+    /* sched_clock doesn't advance when the queue is idle */
+    if ((int32_t)(sched_last - sched_clock) < 0)
+        sched_last = sched_clock;
+
+    /* Only the timer consumes events, so we can fill entries before publishing them */
+    for (i = 0; i < count && (uint16_t)(sched_head - sched_tail) < NEVENTS; i++) {
+        e = &sched[sched_head & (NEVENTS-1)];
+        sched_last += events[i].delta;
+        e->due = sched_last;
+        e->length = events[i].length > 3 ? 3 : events[i].length;
+        e->data[0] = events[i].data[0];
+        e->data[1] = events[i].data[1];
+        e->data[2] = events[i].data[2];
+        sched_head++;
+    }
+
+    sr = m68k_set_sr(0x2700);
+    queue_kick();
+    m68k_set_sr(sr);
+
+    return i;
+}
+
+
+/** Discard all scheduled events that haven't been sent yet (e.g. when a sequencer stops) */
+void mpu401_schedule_cancel(void) {
+    uint16_t sr = m68k_set_sr(0x2700);
+    sched_tail = sched_head;
+    sched_last = sched_clock;
+    m68k_set_sr(sr);
+}
+
+
+/** Returns the number of scheduled events not sent yet */
+uint16_t mpu401_schedule_pending(void) {
+    return sched_head - sched_tail;
+}
+
+
+/**
+ * Timer tick: release the events that are due, and send what we can.
+ * Called from a2560_irq_mpu401_timer with interrupts masked.
+ */
+void mpu401_tick(void) {
+    struct sched_event_t *e;
+
+    sched_clock += TICK_US;
+    while (sched_tail != sched_head) {
+        e = &sched[sched_tail & (NEVENTS-1)];
+        if ((int32_t)(e->due - sched_clock) > 0 || mpu401_tx_free() < e->length)
+            break;
+        tx_copy(e->data, e->length);
+        sched_tail++;
+    }
+
+    mpu401_tx_drain();
+
+    if (tx_tail == tx_head && sched_tail == sched_head) {
+        a2560_timer_enable(MPU401_TIMER, false);
+        timer_running = false;
+    }
+}
+
+
 /**
  * Send a command to the MPU-401
  */
@@ -13,6 +13,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "a2560_struct.h"
 
 #if defined(MACHINE_A2560K) || defined(MACHINE_A2560M) || defined(MACHINE_A2560X) || defined(MACHINE_GENX)
 
@@ -35,6 +36,20 @@ bool mpu401_can_write(void);
 void mpu401_write(uint8_t b);
 uint8_t mpu401_read(void);
 
+/* Output queue: bytes are sent from interrupts, paced by a hardware timer */
+#define MPU401_TIMER          1    /* Timer used to pace the output (must match a2560_irq_mpu401_timer).
+                                    * Claimed at boot, so Xbtimer can't have Timer B */
+#define MPU401_TICK_HZ        3125 /* One tick per byte at 31250 bauds */
+
+void mpu401_queue_init(void);
+uint16_t mpu401_tx_put(const uint8_t *buf, uint16_t count);
+uint16_t mpu401_tx_free(void);
+void mpu401_tx_drain(void);
+uint16_t mpu401_schedule(const struct midi_event_t *events, uint16_t count);
+void mpu401_schedule_cancel(void);
+uint16_t mpu401_schedule_pending(void);
+void mpu401_tick(void);
+
 #endif
 
 #endif
@@ -15,6 +15,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include "cpu.h"
 #include "ps2.h"
 
 /* WARNING enabling this causes crashes ! so leave it disabled
@@ -84,6 +85,15 @@ enum ps2_target
  #define FORCE_SELF_TEST_SUCCESS		0 /* Force the self test results to appear successful */
 #endif
 
+/* Bytes received by the IRQ handler, waiting for the driver */
+#define FIFO_SIZE 64 /* Power of 2 */
+struct ps2_fifo_t
+{
+	uint8_t data[FIFO_SIZE];
+	volatile uint8_t head; /* Free running, written by the IRQ handler */
+	volatile uint8_t tail; /* Free running, written by ps2_irq_process */
+};
+
 struct ps2_device_t
 {
 	enum ps2_target id; /* 0 for device 1, 1 for device 2 */
@@ -91,11 +101,14 @@ struct ps2_device_t
 	uint16_t status;
 	const struct ps2_driver_t *driver; /* Driver currently attached to the device */
 	struct ps2_driver_api_t api; /* Interface with the driver */
+	struct ps2_fifo_t fifo;
 };
 
 struct ps2_global_t
 {
 	uint16_t status; /* Status of the PS/2 system */
+	bool     started; /* ps2_init_start() got as far as resetting the devices */
+	uint8_t  config;  /* Controller configuration byte */
 	bool     dual;    /* Controller is dual channel */
 	uint8_t  in_data; /* Last received byte */
 	uint8_t  timeout; /* Number of timer ticks to wait before timing out */
@@ -107,6 +120,28 @@ struct ps2_global_t
 /* Local variables */
 static struct ps2_global_t L;
 
+/* Device reset, done in the background by ps2_init_step(): the Basic Assurance Test lasts
+ * 500-750ms per device, during which the rest of the OS can initialise. Each step only does
+ * what the controller is ready for, it never waits. */
+enum reset_state
+{
+	RS_SCAN_OFF,	 /* Send DEVCMD_SCAN_OFF */
+	RS_SCAN_OFF_ACK, /* Wait for its ACK */
+	RS_RESET,		 /* Send DEVCMD_RESET */
+	RS_RESET_ACK,	 /* Wait for its ACK */
+	RS_BAT			 /* Wait for the self test result */
+};
+
+static struct
+{
+	struct ps2_device_t *dev; /* Device being reset, NULL when done */
+	uint8_t  state;
+	int8_t   tries;
+	bool     prefixed;  /* The 0xd4 prefix for device 2 was sent */
+	bool     busy;      /* Stepping (the timer and ps2_init_finish() may both step) */
+	uint32_t deadline;  /* Counter value at which the current state times out */
+} R;
+
 /* Global */
 struct ps2_api_t ps2_config;
 
@@ -125,8 +160,7 @@ static bool get_config(uint8_t *config);
 static bool send_config(uint8_t config);
 static bool selftest(void);
 static bool enable_ports(uint8_t *config);
-static bool reset_device(struct ps2_device_t *dev);
-static void reset_devices(void);
+static void reset_begin(struct ps2_device_t *dev);
 static bool identify_device(struct ps2_device_t *dev);
 static bool enable_scanning(void);
 static void identify_devices(void);
@@ -137,8 +171,17 @@ static bool enable_irqs(uint8_t *config);
 static bool disable_irqs(uint8_t *config);
 
 
-/* Initialise the PS/2 system */
+/* Initialise the PS/2 system. This waits for the devices to reset. */
 uint16_t ps2_init(void)
+{
+	ps2_init_start();
+	return ps2_init_finish();
+}
+
+
+/* Initialise the controller and start resetting the devices. The reset is then carried on by
+ * calling ps2_init_step(), and ps2_init_finish() completes the initialisation. */
+void ps2_init_start(void)
 {
 	uint8_t config = 0;
 
@@ -152,6 +195,8 @@ uint16_t ps2_init(void)
 		L.timeout = 1;
 
 	L.status = 0;
+	L.started = false;
+	R.dev = NULL;
 	L.dev1.id = dev1;
 	L.dev2.id = dev2;
 	L.dev1.status = L.dev2.status = 0;
@@ -181,14 +226,14 @@ uint16_t ps2_init(void)
 	/* Update config (but don't send yet): enable IRQ, enable set 1 translation */
 	if (!configure_controller(&config)) {
 		a2560_debugnl("ps2_init: failed to configure controller");
-		return L.status;
+		return;
 	}
 
 	/* Test controller and interfaces */
 	if (!selftest()) {
 		a2560_debugnl("ps2_init: selftest failed");
 #if !FORCE_SELF_TEST_SUCCESS
-		return L.status;
+		return;
 #endif
 	}
 
@@ -198,11 +243,25 @@ uint16_t ps2_init(void)
 	if (!enable_ports(&config))
 	{
 		a2560_debugnl("Didn't manage to enable ports and IRQs");
-		return L.status;
+		return;
 	}
 
 	/* Reset devices attached to enabled ports. This detects whether a device is present. */
-	reset_devices();
+	L.config = config;
+	L.started = true;
+	reset_begin(&L.dev1);
+}
+
+
+/* Wait for the devices to be reset, and make them ready for use. Returns the
+ * status of the PS/2 system (ERR_xxx bits). */
+uint16_t ps2_init_finish(void)
+{
+	if (!L.started)
+		return L.status;
+
+	while (!ps2_init_step())
+		;
 
 	/* Flush input data */
 	while (get_data())
@@ -212,7 +271,7 @@ uint16_t ps2_init(void)
 
 	attach_drivers();
 
-	if (!enable_irqs(&config))
+	if (!enable_irqs(&L.config))
 	{
 		a2560_debugnl("Didn't manage to enable IRQs");
 		return L.status;
@@ -220,7 +279,7 @@ uint16_t ps2_init(void)
 
 	enable_scanning();
 
-	a2560_debugnl("PS/2 system initialized successfully (0x%02x)", config);
+	a2560_debugnl("PS/2 system initialized successfully (0x%02x)", L.config);
 	return L.status;
 }
 
@@ -316,48 +375,82 @@ static bool attach_driver(struct ps2_device_t *dev)
 	return ERROR;
 }
 
-/* We use these indirections because if the handlers are changed in a higher layer,
- * the driver's wouldn't know. */
-static void on_key_down(uint8_t scancode)
+static bool setup_driver_api(struct ps2_device_t *dev)
 {
-	ps2_config.callbacks.on_key_down(scancode);
+	dev->api.callbacks = &ps2_config.callbacks;
+
+	/* Flush */
+	while (get_data());
+
+	return dev->driver->init(&dev->api);
 }
 
-static void on_key_up(uint8_t scancode)
+
+static void fifo_put(struct ps2_fifo_t *fifo, uint8_t byte)
 {
-	ps2_config.callbacks.on_key_up(scancode | 0x80);
+	if ((uint8_t)(fifo->head - fifo->tail) < FIFO_SIZE)
+	{
+		fifo->data[fifo->head & (FIFO_SIZE-1)] = byte;
+		fifo->head++;
+	}
+	/* else the byte is lost, as it would have been with the controller overrun */
 }
 
-static void on_mouse(int8_t *packet)
+
+void ps2_channel1_irq_handler(void)
 {
-	ps2_config.callbacks.on_mouse(packet);
+	fifo_put(&L.dev1.fifo, get_data_no_wait());
 }
 
 
-static bool setup_driver_api(struct ps2_device_t *dev)
+void ps2_channel2_irq_handler(void)
 {
-	dev->api.callbacks.on_key_down = on_key_down;
-	dev->api.callbacks.on_key_up = on_key_up;
-	dev->api.callbacks.on_mouse = on_mouse;
+	fifo_put(&L.dev2.fifo, get_data_no_wait());
+}
 
-	/* Flush */
-	while (get_data());
 
-	return dev->driver->init(&dev->api);
+static void process_fifo(struct ps2_device_t *dev)
+{
+	struct ps2_fifo_t *fifo = &dev->fifo;
+	uint8_t byte;
+
+	while (fifo->tail != fifo->head)
+	{
+		byte = fifo->data[fifo->tail & (FIFO_SIZE-1)];
+		fifo->tail++;
+		if (dev->driver)
+			dev->driver->process(&dev->api, byte);
+	}
 }
 
 
-void ps2_channel1_irq_handler(void)
+static volatile bool busy; /* ps2_irq_process() is running */
+
+/* The drivers and the OS callbacks (key repeat, scancode conversion, mouse vectors...)
+ * run with the interrupt mask of the interrupted code, so they don't hold up the other
+ * devices, and more PS/2 bytes can be queued meanwhile. If the interrupted code was
+ * ourselves, we return right away: the byte will be processed when we get back there.
+ * The system timer may also interrupt us, see ps2_busy(). */
+void ps2_irq_process(uint16_t sr)
 {
-	/*a2560_debugnl("ps2_channel1_irq_handler");*/
-	L.dev1.driver->process(&L.dev1.api, get_data_no_wait());
+	if (busy)
+		return;
+	busy = true;
+
+	do {
+		m68k_set_sr(0x2000 | (sr & 0x0700));
+		process_fifo(&L.dev1);
+		process_fifo(&L.dev2);
+		m68k_set_sr(0x2700);
+	} while (L.dev1.fifo.tail != L.dev1.fifo.head || L.dev2.fifo.tail != L.dev2.fifo.head);
+
+	busy = false;
 }
 
 
-void ps2_channel2_irq_handler(void)
+bool ps2_busy(void)
 {
-	/*a2560_debugnl("ps2_channel2_irq_handler");*/
-	L.dev2.driver->process(&L.dev2.api, get_data_no_wait());
+	return busy;
 }
 
 
@@ -459,75 +552,150 @@ static bool send_data2(uint8_t data)
 }
 
 
-static bool reset_device(struct ps2_device_t *dev)
+static void reset_begin(struct ps2_device_t *dev)
 {
-	uint32_t timeout;
-	int tries = 5;
-
+	R.dev = dev;
+	R.state = RS_SCAN_OFF;
+	R.tries = 5;
+	R.prefixed = false;
+	R.deadline = *ps2_config.counter + L.timeout;
 	dev->status &= ~STAT_RESET_OK;
+}
+
 
-	if ((dev->status & STAT_PORT_ENABLED) == 0)
-		return ERROR;
+/* The reset of the current device is over, go on with the next one */
+static void reset_end(bool ok)
+{
+	struct ps2_device_t *dev = R.dev;
 
-	while (tries--)
+	if (ok)
 	{
-		if (!send_data(dev->id, DEVCMD_SCAN_OFF))
-		{
-			a2560_debugnl("Timeout when sending DEVCMD_SCAN_OFF to device %d", dev->id);
-			continue;
-		}
+		dev->status |= STAT_RESET_OK;
+		a2560_debugnl("ps2.reset_device: Device %d reset successful", dev->id);
+	}
+	else
+	{
+		L.status |= dev->id == dev1 ? ERR_DEV1_RESET_FAILED : ERR_DEV2_RESET_FAILED;
+		a2560_debugnl("ps2.reset_device: Reset of device %d failed", dev->id);
+	}
+
+	if (dev == &L.dev1)
+		reset_begin(&L.dev2);
+	else
+		R.dev = NULL;
+}
 
-		if (!get_data() || L.in_data != ACK)
-		{
-			a2560_debugnl("Device %d didn't acknowledge DEVCMD_SCAN_OFF (0x%x)", dev->id, L.in_data);
-			continue;
-		}
 
-		a2560_debugnl("ps2.reset_device: Sending RESET to device %d",dev->id);
+static void reset_retry(void)
+{
+	if (--R.tries <= 0)
+	{
+		reset_end(false);
+		return;
+	}
+	R.state = RS_SCAN_OFF;
+	R.prefixed = false;
+	R.deadline = *ps2_config.counter + L.timeout;
+}
 
-		if (!send_data(dev->id, DEVCMD_RESET) && ENABLE_DEVICES_RESET_CHECKS)
-			continue;
 
-		if (!get_data())
-		{
-			a2560_debugnl("ps2.reset_device: No response");
-			continue;
-		}
+/* Send a byte to the device being reset if the controller can take it. For device 2,
+ * this takes two calls, as the controller must first be told where the byte goes. */
+static bool try_send(uint8_t data)
+{
+	if (*ps2_config.port_status & INPUT_FULL)
+		return false;
 
-		a2560_debugnl("ps2.reset_device: Device %d responded to reset with 0x%02x ", dev->id, L.in_data);
+	if (R.dev->id == dev2 && !R.prefixed)
+	{
+		*ps2_config.port_cmd = 0xd4;
+		R.prefixed = true;
+		return false;
+	}
 
-		if (L.in_data == RESEND)
-			continue;
+	*ps2_config.port_data = data;
+	R.prefixed = false;
+	return true;
+}
 
-		if (L.in_data == ACK)
-			break;
-		else
-			a2560_debugnl("ps2.reset_device: Unexpected response 0x%02x", L.in_data);
+
+static bool try_receive(void)
+{
+	if ((*ps2_config.port_status & OUTPUT_FULL) == 0)
+		return false;
+
+	L.in_data = get_data_no_wait();
+	return true;
+}
+
+
+/* Carry on resetting the devices. Returns true when done. */
+bool ps2_init_step(void)
+{
+	uint32_t now;
+
+	if (R.busy || R.dev == NULL)
+		return R.dev == NULL;
+	R.busy = true;
+
+	if ((R.dev->status & STAT_PORT_ENABLED) == 0)
+	{
+		reset_end(false);
+		goto done;
 	}
-	if (tries < 0)
-		return ERROR;
 
-	timeout = *ps2_config.counter + ps2_config.counter_freq * 5 / 7; /* Basic Assurance Test should last 500-750ms  (5/7 -> 700ms)*/;
-	while (*ps2_config.counter < timeout)
+	now = *ps2_config.counter;
+	switch (R.state)
 	{
-		if (get_data())
-		{
-			if (L.in_data == 0xaa)
+		case RS_SCAN_OFF:
+		case RS_RESET:
+			if (try_send(R.state == RS_SCAN_OFF ? DEVCMD_SCAN_OFF : DEVCMD_RESET))
 			{
-				dev->status |= STAT_RESET_OK;
-				a2560_debugnl("ps2.reset_device: Device %d reset successful", dev->id);
-				return SUCCESS;
+				R.state++;
+				R.deadline = now + L.timeout;
 			}
-			else
-				break;
-		}
-	}
+			else if (now > R.deadline)
+			{
+				a2560_debugnl("Timeout when sending to device %d", R.dev->id);
+				if (R.state == RS_RESET && !ENABLE_DEVICES_RESET_CHECKS)
+					R.state = RS_RESET_ACK;
+				else
+					reset_retry();
+			}
+			break;
 
-	a2560_debugnl("ps2.reset_device: Reset of device %d failed", dev->id);
+		case RS_SCAN_OFF_ACK:
+		case RS_RESET_ACK:
+			if (try_receive())
+			{
+				a2560_debugnl("ps2.reset_device: Device %d responded with 0x%02x ", R.dev->id, L.in_data);
+				if (L.in_data != ACK)
+					reset_retry();
+				else if (R.state++ == RS_RESET_ACK)
+					R.deadline = now + ps2_config.counter_freq * 5 / 7; /* Basic Assurance Test should last 500-750ms  (5/7 -> 700ms)*/
+				else
+					R.deadline = now + L.timeout;
+			}
+			else if (now > R.deadline)
+			{
+				a2560_debugnl("ps2.reset_device: No response");
+				reset_retry();
+			}
+			break;
 
-	/* We can get here because we got no response after RESET ACK, or because the
-	 * device reset was not successful */
-	return ERROR;
+		case RS_BAT:
+			/* The reset fails if there is no response after the RESET ACK,
+			 * or if the self test fails */
+			if (try_receive())
+				reset_end(L.in_data == 0xaa);
+			else if (now > R.deadline)
+				reset_end(false);
+			break;
+	}
+
+done:
+	R.busy = false;
+	return R.dev == NULL;
 }
 
 
@@ -766,16 +934,6 @@ static bool selftest(void)
 }
 
 
-static void reset_devices(void)
-{
-	if (!reset_device(&L.dev1))
-		L.status |= ERR_DEV1_RESET_FAILED;
-
-	if (!reset_device(&L.dev2))
-		L.status |= ERR_DEV2_RESET_FAILED;
-}
-
-
 static bool get_config(uint8_t *config)
 {
 	if (!send_command_with_response(CMD_GET_CONFIG))
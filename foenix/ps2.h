@@ -55,8 +55,9 @@ struct ps2_callbacks_t {
 /* This is what the PS/2 system provides to the driver so it knows what to fire and can keep its state */
 struct ps2_driver_api_t
 {
-	/* Provided by the PS/2 system to the driver */
-	struct ps2_callbacks_t callbacks;
+	/* Provided by the PS/2 system to the driver: the OS callbacks themselves, so the
+	 * driver sees it when they are changed. Key up codes must have bit 7 set. */
+	const struct ps2_callbacks_t *callbacks;
 
 	/* State of the driver, driver does what it wants with this, nobody cares. */
 	uint32_t driver_data;
@@ -90,8 +91,23 @@ extern struct ps2_api_t ps2_config;
 /* Initialises the PS/2 system (to be called by OS) */
 uint16_t ps2_init(void);
 
-/* To be called by IRQ handlers to handle an interrupt */
+/* Same in three parts, so the OS can do something else while the devices reset:
+ * ps2_init_step() is to be called regularly (eg. from a timer) until ps2_init_finish(),
+ * and returns true once the devices are reset. ps2_init_finish() returns like ps2_init(). */
+void ps2_init_start(void);
+bool ps2_init_step(void);
+uint16_t ps2_init_finish(void);
+
+/* To be called by IRQ handlers to handle an interrupt. They only queue the received byte. */
 void ps2_channel1_irq_handler(void);
 void ps2_channel2_irq_handler(void);
 
+/* To be called by IRQ handlers next, with interrupts still masked, to have the drivers process
+ * the queued bytes. 'sr' is the SR of the interrupted code. */
+void ps2_irq_process(uint16_t sr);
+
+/* Returns true if ps2_irq_process() has been interrupted. Interrupt handlers must then leave
+ * alone what the OS callbacks update, e.g. the key repeat of the BIOS and the keyboard iorec. */
+bool ps2_busy(void);
+
 #endif
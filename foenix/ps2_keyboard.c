@@ -31,25 +31,19 @@ const struct ps2_driver_t ps2_keyboard_driver =
     .process = process
 };
 
-/* States the keyboard state machine can be in */
+/* States the keyboard state machine can be in: the prefix bytes received */
 typedef enum sm_state
 {
     SM_IDLE = 0,
-    SM_E0,
-    SM_E02A,
-    SM_E02AE0,
-    SM_E1,
-    SM_E11D,
-    SM_E11D45,
-    SM_E11D45E1,
-    SM_E11D45E19D,
-    SM_E0B7,
-    SM_E0B7E0
+    SM_E0,      /* Extended key: the next byte is looked up in scancodeSet1_E0_to_key */
+    SM_E1,      /* Pause: E1 1D 45 when pressed, E1 9D C5 when released */
+    SM_E1XX
 } sm_state_t;
 
 
 /* Translation tables */
-/* Scancodes for E0xx. The index is xx */
+/* Scancodes for E0xx. The index is xx without the break bit. 0 means the code is ignored,
+ * which is used for the fake shifts that come with PrintScreen (E0 2A E0 37, E0 B7 E0 AA). */
 static const uint8_t scancodeSet1_E0_to_key[128] =
 {
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* 0x00 - 0x07 */
@@ -58,7 +52,7 @@ static const uint8_t scancodeSet1_E0_to_key[128] =
     0x00, KEY_NEXTSONG, 0x00, 0x00, KEY_KPENTER, KEY_RIGHTCTRL, 0x00, 0x00, /* 0x18 - 0x1F */
     KEY_MUTE, KEY_CALC, KEY_PLAYCD, 0x00, KEY_STOPCD, 0x00, 0x00, 0x00, /* 0x20 - 0x27 */
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, KEY_VOLUMEDOWN, 0x00, /* 0x28 - 0x2F */
-    KEY_VOLUMEUP, 0x00, KEY_HOMEPAGE, 0x00, 0x00, KEY_KPSLASH, 0x00, 0x00, /* 0x30 - 0x37 */
+    KEY_VOLUMEUP, 0x00, KEY_HOMEPAGE, 0x00, 0x00, KEY_KPSLASH, 0x00, KEY_SYSRQ, /* 0x30 - 0x37 */
     KEY_RIGHTALT, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, /* 0x38 - 0x3F */
     0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, KEY_HOME, /* 0x40 - 0x47 */
     KEY_UP, KEY_PAGEUP, 0x00, KEY_LEFT, 0x00, KEY_RIGHT, 0x00, KEY_END, /* 0x48 - 0x4F */
@@ -104,116 +98,49 @@ static bool can_drive(const uint8_t ps2_device_type[])
     return ERROR;
 }
 
+/* Translate the scancodes (set 1, as the controller translates them) to key codes. This is
+ * called once per byte, with a simple state for the prefixes. */
 static void process(struct ps2_driver_api_t *api, uint8_t scancode)
 {
-    /* Factoring helpers, see the meat below */
-    #define IS_BREAK(x) (x & 0x80)
+    uint8_t key;
 
-    /* On unexpected scan code, return the state machine to idle (swallow the code) */
-    #define check_and_set_next(expected, next) SET_STATE((scancode == expected) ? next : SM_IDLE);
-
-    #define check_and_down(expected, pressed) \
-        if (scancode == expected) \
-            api->callbacks.on_key_down(pressed); \
-        /* On success we're ideal, on failure we swallow the scan code */ \
-        SET_STATE(SM_IDLE);
-
-    #define check_and_up(expected, released) \
-        if (scancode == expected) \
-            api->callbacks.on_key_up(scancode); \
-        /* On success we're ideal, on failure we swallow the scan code */ \
-        SET_STATE(SM_IDLE);
-
-	/* a2560_debugnl("scancode:%02x",scancode); */
-
-    /* These are illegal, we just swallow them */
-	if (scancode == 0 || scancode == 0x80)
-        return;
-    /* Process the byte according to the state machine... */
     switch (STATE) {
-        case SM_IDLE:
-            switch (scancode) {
-                case 0xE0:
-                    SET_STATE(SM_E0);
-                    break;
-
-                case 0xE1:
-                    SET_STATE(SM_E1);
-                    break;
-
-                default:
-                    if (IS_BREAK(scancode))
-                        api->callbacks.on_key_up(scancode & 0x7f);
-                    else
-                        api->callbacks.on_key_down(scancode);
-                    break;
-            }
-            break;
-
         case SM_E0:
-            switch (scancode) {
-                case 0x2A:
-                    SET_STATE(SM_E02A);
-                    break;
-
-                case 0xB7:
-                    SET_STATE(SM_E0B7);
-                    break;
-
-                default:
-                    {
-                        /* Lookup the translation of the E0 prefixed code */
-                        uint8_t translated_code = scancodeSet1_E0_to_key[scancode & 0x7f];
-                        if (translated_code != 0) {
-                            if (IS_BREAK(scancode))
-                                api->callbacks.on_key_up(translated_code);
-                            else
-                                api->callbacks.on_key_down(translated_code);
-                        }
-                        else {
-                            a2560_debugnl("No scancodeSet1_E0_to_key for %02x", scancode);
-                        }
-                        SET_STATE(SM_IDLE);
-                    }
-                    break;
-            }
-            break;
-
-        case SM_E02A:
-            check_and_set_next(0xE0, SM_E02AE0);
-            break;
-        case SM_E02AE0:
-            /* Return our PrintScreen key */
-            check_and_down(0x37, KEY_SYSRQ);
-            break;
-
-        case SM_E0B7:
-            check_and_set_next(0xE0, SM_E0B7E0);
-            break;
-        case SM_E0B7E0:
-            /* Return our PrintScreen break */
-            check_and_up(0xAA, KEY_SYSRQ);
+            key = scancodeSet1_E0_to_key[scancode & 0x7f];
+            if (key == 0 && (scancode & 0x7f) != 0x2a)
+                a2560_debugnl("No scancodeSet1_E0_to_key for %02x", scancode);
+            SET_STATE(SM_IDLE);
             break;
 
         case SM_E1:
-            check_and_set_next(0x1D, SM_E11D);
-            break;
-        case SM_E11D:
-            check_and_set_next(0x45, SM_E11D45);
-            break;
-        case SM_E11D45:
-            check_and_set_next(0xE1, SM_E11D45E1);
-            break;
-        case SM_E11D45E1:
-            check_and_set_next(0x9D, SM_E11D45E19D);
-            break;
-        case SM_E11D45E19D:
-            /* Break key break */
-            check_and_up(0xC5, KEY_PAUSE);
+            /* Swallow the 1D/9D */
+            SET_STATE(SM_E1XX);
+            return;
+
+        case SM_E1XX:
+            key = KEY_PAUSE;
+            SET_STATE(SM_IDLE);
             break;
 
         default:
-            /* TODO: kernel panic? ;) */
-            ;
+            if (scancode == 0xE0) {
+                SET_STATE(SM_E0);
+                return;
+            }
+            if (scancode == 0xE1) {
+                SET_STATE(SM_E1);
+                return;
+            }
+            key = scancode & 0x7f;
+            break;
     }
+
+    /* 0 and 0x80 are illegal, we just swallow them like the ignored extended keys */
+    if (key == 0)
+        return;
+
+    if (scancode & 0x80)
+        api->callbacks->on_key_up(key | 0x80);
+    else
+        api->callbacks->on_key_down(key);
 }
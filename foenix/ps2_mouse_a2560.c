@@ -77,7 +77,7 @@ static void on_change(const vicky_mouse_event_t *event)
     ikbd_packet[0] = 0xf8 | (*packet++ & 3);
     ikbd_packet[1] = *packet++;
     ikbd_packet[2] = *packet++;
-    api->callbacks.on_mouse(ikbd_packet);
+    api->callbacks->on_mouse(ikbd_packet);
 }
 
 
@@ -15,6 +15,7 @@
 #include "sn76489.h"
 #include "foenix.h"
 #include "regutils.h"
+#include "sndq.h"
 
 
 static const uint8_t* psgs_ports[] = {
@@ -24,14 +25,36 @@ static const uint8_t* psgs_ports[] = {
 };
 
 static volatile uint8_t *sn76489_current;
+static uint8_t sn76489_number; /* Selected PSG */
+
+#if CONF_WITH_SOUND_QUEUE
+
+/* Write to the selected PSG(s) through the sound queue */
+static void sn76489_write(uint16_t reg, uint16_t value) {
+    if (sn76489_number != 1)
+        sndq_write(SNDQ_PSG_L, reg, value);
+    if (sn76489_number != 0)
+        sndq_write(SNDQ_PSG_R, reg, value);
+}
+#endif
 
 /*
  * Selects the PSG that next function calls will operate on.
  * 0 : left, 1: right, 2: both
  */
 void sn76489_select(uint8_t number) {
-    if (number <= SN76489_COUNT)
+    if (number <= SN76489_COUNT) {
         sn76489_current = (uint8_t*)psgs_ports[number];
+        sn76489_number = number;
+    }
+}
+
+/*
+ * Returns the PSG selected by sn76489_select(), so that code which runs
+ * under interrupt can put it back.
+ */
+uint8_t sn76489_selected(void) {
+    return sn76489_number;
 }
 
 /*
@@ -72,8 +95,12 @@ void sn76489_freq(uint8_t voice, uint16_t frequency) {
  * period = the period (10bits resolution, ie 0-1023)
  */
 void sn76489_tone(uint8_t voice, uint16_t period) {
+#if CONF_WITH_SOUND_QUEUE
+    sn76489_write(SNDQ_PSG_TONE(voice & 0x03), period);
+#else
     R8(sn76489_current) = 0x80 | ((voice & 0x03) << 5) | (period & 0x0f);
     R8(sn76489_current) = (period & 0x3f0) >> 4;
+#endif
 }
 
 /*
@@ -84,7 +111,11 @@ void sn76489_tone(uint8_t voice, uint16_t period) {
  * attenuation = volume level 0: loudest, 15: silent
  */
 void sn76489_attenuation(uint8_t voice, uint8_t attenuation) {
+#if CONF_WITH_SOUND_QUEUE
+    sn76489_write(SNDQ_PSG_ATT(voice & 0x03), attenuation & 0x0f);
+#else
     R8(sn76489_current) = 0x90 | ((voice & 0x03) << 5) | (attenuation & 0x0f);
+#endif
 }
 
 /*
@@ -98,5 +129,9 @@ void sn76489_noise_source(uint8_t type, uint8_t source) {
     if (type)
         v |= 0x04;
     v |= source & 3;
+#if CONF_WITH_SOUND_QUEUE
+    sn76489_write(SNDQ_PSG_NOISE, v & 0x0f);
+#else
     R8(sn76489_current) = v;
+#endif
 }
@@ -18,6 +18,7 @@
 
 /* Select the PSG (0:left, 1:right, 2:both) */
 void sn76489_select(uint8_t number);
+uint8_t sn76489_selected(void);
 
 void sn76489_mute_all(void);
 void sn76489_freq(uint8_t voice, uint16_t frequency);
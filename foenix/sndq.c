@@ -0,0 +1,227 @@
+/*
+ * sndq.c - Register write queue for the Foenix sound chips
+ *
+ * Music players write the chip registers through sndq_write(). When a commit
+ * rate is set, the writes are not sent right away: they are collected into a
+ * frame, in which writing a register that is already pending only updates
+ * its value, and the frame is sent to the chips from a timer interrupt.
+ * A player thus costs a fixed amount of CPU per tick however many times it
+ * updates each register, and the delays the chips require between writes
+ * are handled here: the commit goes round the chips, so the wait after a
+ * write to one chip is spent writing to the others.
+ *
+ * Without a commit rate (the default), writes go straight to the chip,
+ * after waiting for it to be ready.
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "foenix.h"
+#include "cpu.h"
+#include "regutils.h"
+#include "sndq.h"
+#include "timer.h"
+
+#if CONF_WITH_SOUND_QUEUE
+
+extern void a2560_irq_sndq(void);
+
+/* Microseconds to CPU clocks, which is what TIMER2 counts */
+#define US(n)   ((uint32_t)(n) * (CPU_FREQ / 1000000UL))
+
+static const struct sndq_chip_t {
+    volatile uint8_t *port;
+    uint16_t first;   /* First entry in values[] and regs[] */
+    uint16_t nregs;   /* Number of registers, power of 2 */
+    uint32_t wait;    /* Time the chip needs after a write, in CPU clocks */
+} chips[SNDQ_CHIPS] = {
+    { (volatile uint8_t *)OPL3_PORT,     0,    512, US(3)  },
+    { (volatile uint8_t *)OPM_INT_BASE,  512,  256, US(18) },
+    { (volatile uint8_t *)OPN2_INT_BASE, 768,  512, US(12) },
+    { (volatile uint8_t *)SN76489_L,     1280, 8,   US(9)  },
+    { (volatile uint8_t *)SN76489_R,     1288, 8,   US(9)  }
+};
+#define NREGS   1296
+
+/* Pending registers of each chip, in the order they were first written */
+static struct sndq_state_t {
+    uint16_t head;    /* Free running indexes into the chip's part of regs[] */
+    uint16_t tail;
+    uint32_t last;    /* TIMER2 value at the last write */
+} state[SNDQ_CHIPS];
+
+static uint16_t regs[NREGS];
+static uint16_t values[NREGS];
+static uint8_t pending[NREGS];
+
+static uint16_t rate;         /* Commits per second, 0 to write directly */
+static volatile bool held;    /* The application is building a frame */
+static bool committing;
+
+
+/*
+ * Time elapsed since a TIMER2 value, in CPU clocks. TIMER2 paces the system
+ * 200 Hz tick, so this is only right for less than 5ms, which is all we need.
+ */
+static uint32_t elapsed(uint32_t since)
+{
+    uint32_t t = R32(TIMER2_VALUE);
+
+    return t >= since ? t - since : t + R32(TIMER2_COMPARE) - since;
+}
+
+
+static void wait_ready(uint16_t chip)
+{
+    while (elapsed(state[chip].last) < chips[chip].wait)
+        ;
+}
+
+
+static void chip_write(uint16_t chip, uint16_t reg, uint16_t value)
+{
+    volatile uint8_t *port = chips[chip].port;
+
+    wait_ready(chip);
+    if (chip >= SNDQ_PSG_L)
+    {
+        /* Latch byte with the register and low 4 bits, then the high 6 bits of a period */
+        *port = 0x80 | (reg << 4) | (value & 0x0f);
+        if (!(reg & 1) && reg != SNDQ_PSG_NOISE)
+        {
+            state[chip].last = R32(TIMER2_VALUE);
+            wait_ready(chip);
+            *port = (value >> 4) & 0x3f;
+        }
+    }
+    else
+        port[reg] = value;
+    state[chip].last = R32(TIMER2_VALUE);
+}
+
+
+/*
+ * Write a chip register. See SNDQ_PSG_* for the SN76489 register numbers.
+ */
+void sndq_write(uint16_t chip, uint16_t reg, uint16_t value)
+{
+    const struct sndq_chip_t *c;
+    struct sndq_state_t *s;
+    uint16_t id, sr;
+
+    if (chip >= SNDQ_CHIPS)
+        return;
+    c = &chips[chip];
+    reg &= c->nregs - 1;
+
+    if (!rate)
+    {
+        chip_write(chip, reg, value);
+        return;
+    }
+
+    s = &state[chip];
+    id = c->first + reg;
+    sr = m68k_set_sr(0x2700);
+    values[id] = value;
+    if (!pending[id])
+    {
+        pending[id] = 1;
+        regs[c->first + (s->head & (c->nregs-1))] = reg;
+        s->head++;
+    }
+    m68k_set_sr(sr);
+}
+
+
+/*
+ * While held, frames are not committed, so an application can make a set of
+ * writes that must reach the chips together.
+ */
+void sndq_hold(bool hold)
+{
+    held = hold;
+}
+
+
+/*
+ * Set how many times per second the queue is committed, using SNDQ_TIMER.
+ * 0 commits what is pending, stops the timer and makes writes go straight
+ * to the chips again.
+ */
+void sndq_set_rate(uint16_t hz)
+{
+    if (rate)
+    {
+        a2560_timer_enable(SNDQ_TIMER, false);
+        a2560_timer_release(SNDQ_TIMER, A2560_TIMER_SNDQ);
+    }
+    held = false;
+    sndq_commit();
+
+    /* If a program took the timer with Xbtimer, we keep writing straight to the chips */
+    rate = hz && a2560_timer_claim(SNDQ_TIMER, A2560_TIMER_SNDQ) ? hz : 0;
+    if (rate)
+    {
+        a2560_set_timer(SNDQ_TIMER, hz, true, a2560_irq_sndq);
+        a2560_timer_enable(SNDQ_TIMER, true);
+    }
+}
+
+
+/*
+ * Send the pending writes to the chips. Called from a2560_irq_sndq, or by
+ * the application to commit a frame immediately. Writes made meanwhile
+ * are left for the next commit.
+ */
+void sndq_commit(void)
+{
+    const struct sndq_chip_t *c;
+    struct sndq_state_t *s;
+    uint16_t end[SNDQ_CHIPS];
+    uint16_t chip, reg, value, sr;
+    bool more;
+
+    sr = m68k_set_sr(0x2700);
+    if (held || committing)
+    {
+        m68k_set_sr(sr);
+        return;
+    }
+    committing = true;
+    for (chip = 0; chip < SNDQ_CHIPS; chip++)
+        end[chip] = state[chip].head;
+    m68k_set_sr(sr);
+
+    do {
+        more = false;
+        for (chip = 0; chip < SNDQ_CHIPS; chip++)
+        {
+            c = &chips[chip];
+            s = &state[chip];
+            if (s->tail == end[chip])
+                continue;
+            more = true;
+            if (elapsed(s->last) < c->wait)
+                continue; /* Try the next chip meanwhile */
+
+            sr = m68k_set_sr(0x2700);
+            reg = regs[c->first + (s->tail & (c->nregs-1))];
+            value = values[c->first + reg];
+            pending[c->first + reg] = 0;
+            s->tail++;
+            m68k_set_sr(sr);
+
+            chip_write(chip, reg, value);
+        }
+    } while (more);
+
+    committing = false;
+}
+
+#endif /* CONF_WITH_SOUND_QUEUE */
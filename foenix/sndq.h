@@ -0,0 +1,39 @@
+/*
+ * sndq.h - Register write queue for the Foenix sound chips
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#ifndef SNDQ_H
+#define SNDQ_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Chips, and their number of registers */
+#define SNDQ_OPL3       0 /* YMF262: 0x000-0x0ff low bank, 0x100-0x1ff high bank */
+#define SNDQ_OPM        1 /* YM2151 */
+#define SNDQ_OPN2       2 /* YM2612: 0x000-0x0ff port 0, 0x100-0x1ff port 1 */
+#define SNDQ_PSG_L      3 /* Left SN76489 */
+#define SNDQ_PSG_R      4 /* Right SN76489 */
+#define SNDQ_CHIPS      5
+
+/* SN76489 registers, as numbered by the chip: voice*2 for the tone period
+ * (10 bits; voice 3 is the noise control), voice*2+1 for the attenuation */
+#define SNDQ_PSG_TONE(voice)    ((voice)<<1)
+#define SNDQ_PSG_ATT(voice)     (((voice)<<1)|1)
+#define SNDQ_PSG_NOISE          6
+
+/* Timer used to commit the frames (must match a2560_irq_sndq). It is shared with
+ * Xbtimer Timer A: see a2560_timer_claim() */
+#define SNDQ_TIMER      0
+
+void sndq_write(uint16_t chip, uint16_t reg, uint16_t value);
+void sndq_hold(bool hold);
+void sndq_set_rate(uint16_t hz);
+void sndq_commit(void);
+
+#endif /* SNDQ_H */
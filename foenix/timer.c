@@ -47,6 +47,9 @@ static const struct a2560_timer_t {
     { TIMER_CTRL1, TIMER3_VALUE, TIMER3_COMPARE, 0xffffff00, TIMER_RESET << 0,  TIMER_PROG << 0,  TIMER_CTRL_ENABLE << 0,  1 << (INT_TIMER3&0xf), INT_TIMER3_VECN }
 };
 
+/* Who is using each timer, 0 if nobody */
+static uint16_t a2560_timer_owner[sizeof(a2560_timers)/sizeof(struct a2560_timer_t)];
+
 
 /*
  * Initialise the timers.
@@ -60,6 +63,41 @@ void a2560_timer_init(void)
         a2560_timer_enable(i, false);
 }
 
+/*
+ * Reserve a timer.
+ * timer: timer number
+ * owner: A2560_TIMER_xxx
+ * Returns false if the timer belongs to someone else.
+ */
+bool a2560_timer_claim(uint16_t timer, uint16_t owner)
+{
+    uint16_t sr;
+    bool ok;
+
+    if (timer > 3)
+        return false;
+
+    sr = m68k_set_sr(0x2700);
+    ok = a2560_timer_owner[timer] == 0 || a2560_timer_owner[timer] == owner;
+    if (ok)
+        a2560_timer_owner[timer] = owner;
+    m68k_set_sr(sr);
+
+    if (!ok)
+        a2560_debugnl("Timer %d is used by %d, refused to %d", timer, a2560_timer_owner[timer], owner);
+
+    return ok;
+}
+
+/*
+ * Give back a timer obtained with a2560_timer_claim(), which the owner must have stopped.
+ */
+void a2560_timer_release(uint16_t timer, uint16_t owner)
+{
+    if (timer <= 3 && a2560_timer_owner[timer] == owner)
+        a2560_timer_owner[timer] = 0;
+}
+
 /*
  * Program a timer but don't start it. This causes the timer to stop.
  * timer: timer number
@@ -175,7 +213,8 @@ uint32_t a2560_delay_calibrate(uint32_t calibration_time)
     uint32_t loop_count;
 
     a2560_debugnl("a2560_delay_calibrate(%ldms)", calibration_time);
-    /* We should disable timer 0 now but we really don't expect that anything uses it during boot */
+    /* This runs at boot, before the sound queue or Xbtimer can use timer 0 */
+    a2560_timer_claim(0, A2560_TIMER_CALIBRATION);
 
     /* Backup all interrupts masks because they would interfere with measuring time */
     a2560_irq_mask_all(masks);
@@ -190,6 +229,8 @@ uint32_t a2560_delay_calibrate(uint32_t calibration_time)
     /* Restore everything */
     R32(INT_TIMER0_VECN) = old_timer_vector;
     a2560_irq_restore(masks);
+    a2560_timer_enable(0, false);
+    a2560_timer_release(0, A2560_TIMER_CALIBRATION);
 
 	if (loop_count == -1) {
 		// error, retry with smaller calibration time
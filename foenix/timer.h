@@ -7,6 +7,20 @@
 void a2560_timer_init(void);
 void a2560_set_timer(uint16_t timer, uint32_t frequency, bool repeat, void *handler);
 void a2560_timer_enable(uint16_t timer, bool enable);
+
+/* There are no more timers than users (Xbtimer exposes all four), so whoever
+ * programs a timer must claim it first. The system timer (2) and the MIDI
+ * queue (1) claim theirs at boot and keep them. Timer 0 is borrowed by the
+ * delay calibration at boot, then by the sound queue while it runs. Xbtimer
+ * gets what is free, else the call is ignored. */
+#define A2560_TIMER_SYSTEM      1
+#define A2560_TIMER_CALIBRATION 2
+#define A2560_TIMER_MPU401      3
+#define A2560_TIMER_SNDQ        4
+#define A2560_TIMER_XBTIMER     5
+
+bool a2560_timer_claim(uint16_t timer, uint16_t owner);
+void a2560_timer_release(uint16_t timer, uint16_t owner);
 uint32_t a2560_run_calibration(uint32_t time);
 
 #endif
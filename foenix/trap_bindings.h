@@ -34,6 +34,11 @@ uint32_t ARGS_ON_STACK fnx_timer_run_calibration(uint32_t );
 /* SuperIO */
 void ARGS_ON_STACK fnx_superio_init(void);
 
+/* MIDI scheduled output. Returns the number of events queued, or -1 if there is no MIDI port */
+int32_t ARGS_ON_STACK fnx_midi_schedule(const struct midi_event_t *events, uint16_t count);
+void ARGS_ON_STACK fnx_midi_cancel(void);
+int32_t ARGS_ON_STACK fnx_midi_pending(void);
+
 /* SN76489 programmable sound generator */
 void ARGS_ON_STACK fnx_sn76489_select(int number);
 void ARGS_ON_STACK fnx_sn76489_mute_all(void);
@@ -43,8 +48,16 @@ void ARGS_ON_STACK fnx_sn76489_attenuation(uint8_t voice, uint8_t attenuation);
 /* Set the noise source. type: 0:periodid, 1:white ; source: 0:N/512 1:N/1024 2:N/2048 3:Tone generator 3 */
 void ARGS_ON_STACK fnx_sn76489_noise_source(uint8_t type, uint8_t source);
 
+/* Sound chips register queue, see sndq.h for the chip and register numbers */
+void ARGS_ON_STACK fnx_sndq_write(uint16_t chip, uint16_t reg, uint16_t value);
+void ARGS_ON_STACK fnx_sndq_hold(bool hold);
+void ARGS_ON_STACK fnx_sndq_set_rate(uint16_t hz);
+void ARGS_ON_STACK fnx_sndq_commit(void);
+
 /* Keyboard */
 void ARGS_ON_STACK fnx_kbd_init(const uint32_t *counter, uint16_t counter_freq);
+bool ARGS_ON_STACK fnx_kbd_init_step(void);
+void ARGS_ON_STACK fnx_kbd_init_wait(void);
 /* PS/2 stuff. Note: we don't assume the keyboard is PS/2 because e.g the K has a keyboard with a controller (Maurice) which is not PS/2*/
 #ifndef MACHINE_A2560K
 scancode_handler_t ARGS_ON_STACK fnx_ps2_set_key_up_handler(scancode_handler_t);
@@ -14,7 +14,9 @@
 #include "bq4802ly.h"
 #include "interrupts.h"
 #include "keyboard.h"
+#include "mpu401.h"
 #include "sn76489.h"
+#include "sndq.h"
 #include "superio.h"
 #include "timer.h"
 #include "wm8776.h"
@@ -55,6 +57,13 @@ int32_t trap_dispatch(uint16_t *args_on_stack)
 	/* SuperIO */
 	case FNX_SUPERIO_INIT: superio_init(); break;
 
+	/* MIDI */
+#if CONF_WITH_MPU401
+	case FNX_MIDI_SCHEDULE: { struct p_t { const struct midi_event_t *a; uint16_t b; } *p = (struct p_t*)args; return mpu401_schedule(p->a, p->b); }
+	case FNX_MIDI_CANCEL: mpu401_schedule_cancel(); break;
+	case FNX_MIDI_PENDING: return mpu401_schedule_pending();
+#endif
+
 	/* SN76489 programmable sound generator */
 	case FNX_SN76489_SELECT: sn76489_select(*((uint8_t*)args)); break;
 	case FNX_SN76489_MUTE_ALL: sn76489_mute_all(); break;
@@ -63,6 +72,14 @@ int32_t trap_dispatch(uint16_t *args_on_stack)
 	case FNX_SN76489_ATTENUATION: { struct p_t { uint8_t a; uint8_t b; } *p = (struct p_t*)args; sn76489_attenuation(p->a, p->b); break; }
 	case FNX_SN76489_NOISE_SOURCE: { struct p_t { uint8_t a; uint8_t b; } *p = (struct p_t*)args; sn76489_noise_source(p->a, p->b); break; }
 
+	/* Sound chips register queue */
+#if CONF_WITH_SOUND_QUEUE
+	case FNX_SNDQ_WRITE: { struct p_t { uint16_t a; uint16_t b; uint16_t c; } *p = (struct p_t*)args; sndq_write(p->a, p->b, p->c); break; }
+	case FNX_SNDQ_HOLD: sndq_hold(*((uint16_t*)args)); break;
+	case FNX_SNDQ_SET_RATE: sndq_set_rate(*((uint16_t*)args)); break;
+	case FNX_SNDQ_COMMIT: sndq_commit(); break;
+#endif
+
 	/* WM8776 mixer / codec */
 	case FNX_WM8776_INIT: wm8776_init(); break;
 	case FNX_WM8776_DEINIT: wm8776_deinit(); break;
@@ -77,6 +94,8 @@ int32_t trap_dispatch(uint16_t *args_on_stack)
 	case FNX_PS2_SET_KEY_DOWN_HANDLER: return (int32_t)a2560_ps2_set_key_down_handler(*((scancode_handler_t*)args));
 #endif
     case FNX_PS2_SET_MOUSE_HANDLER: return (int32_t)a2560_ps2_set_mouse_handler(*((mouse_packet_handler_t*)args));
+    case FNX_KBD_INIT_STEP: return a2560_kbd_init_step();
+    case FNX_KBD_INIT_WAIT: a2560_kbd_init_wait(); break;
 
 	/* Real time Clock */
 	case FNX_RTC_INIT: bq4802ly_init(); break;
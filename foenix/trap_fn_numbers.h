@@ -32,6 +32,12 @@
 #define FNX_SUPERIO_BASE    50
 #define FNX_SUPERIO_INIT    (FNX_SUPERIO_BASE+00)
 
+/* MIDI */
+#define FNX_MIDI_BASE           60
+#define FNX_MIDI_SCHEDULE       (FNX_MIDI_BASE+00)
+#define FNX_MIDI_CANCEL         (FNX_MIDI_BASE+01)
+#define FNX_MIDI_PENDING        (FNX_MIDI_BASE+02)
+
 /* SN76489 Programmable Sound Generator */
 #define FNX_SN76489_BASE        80
 #define FNX_SN76489_SELECT      (FNX_SN76489_BASE+0)
@@ -41,6 +47,13 @@
 #define FNX_SN76489_ATTENUATION (FNX_SN76489_BASE+4)
 #define FNX_SN76489_NOISE_SOURCE    (FNX_SN76489_BASE+5)
 
+/* Sound chips register queue */
+#define FNX_SNDQ_BASE           90
+#define FNX_SNDQ_WRITE          (FNX_SNDQ_BASE+0)
+#define FNX_SNDQ_HOLD           (FNX_SNDQ_BASE+1)
+#define FNX_SNDQ_SET_RATE       (FNX_SNDQ_BASE+2)
+#define FNX_SNDQ_COMMIT         (FNX_SNDQ_BASE+3)
+
 /* WM8776 mixer/codec */
 #define FNX_WM8776_BASE         100
 #define FNX_WM8776_INIT         (FNX_WM8776_BASE+0)
@@ -57,6 +70,8 @@
 #define FNX_PS2_SET_KEY_DOWN_HANDLER    (FNX_PS2_BASE+2)
 #endif
 #define FNX_PS2_SET_MOUSE_HANDLER       (FNX_PS2_BASE+3)
+#define FNX_KBD_INIT_STEP               (FNX_PS2_BASE+4)
+#define FNX_KBD_INIT_WAIT               (FNX_PS2_BASE+5)
 
 /* Real Time Clock */
 #define FNX_RTC_BASE                170
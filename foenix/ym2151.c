@@ -3,6 +3,8 @@
  */
 
 #include <stdint.h>
+#include "../include/config.h"
+#include "sndq.h"
 
 #define KEY_ON       0x08
 #define NE_NFRQ      0x0f
@@ -35,7 +37,11 @@ uint8_t *ym2151_base;
 
 
 static void ym2151_write(uint16_t reg, uint8_t value) {
+#if CONF_WITH_SOUND_QUEUE
+  sndq_write(SNDQ_OPM, reg, value);
+#else
   ym2151_base[reg] = value;
+#endif
 }
 
 /* Per-slot settings */
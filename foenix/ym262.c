@@ -2,12 +2,10 @@
  * Author: Vincent Barrilliot, October 2022
  * Public domain
  */
+#include "../include/config.h"
+#include "sndq.h"
 #include "ym262.h"
 
-// Experimental: try to use "session", if a scope of command that we send where we only try to
-// send at most one command per register. I
-#define YM262_SESSIONS 0
-
 #if !defined(YM262_DEBUG)
 # define YM262_DEBUG 0 /* For testing the library without the real thing */
 #endif
@@ -177,97 +175,17 @@ static uint16_t osc_number(uint16_t channel, uint16_t oscillator)
 }
 
 
-#ifdef YM262_SESSIONS
-
-#define REG_NOT_USED -1
-#define REG_USED 0
-static uint16_t sidx;    // Session index
-static int16_t *sdata; // Session data
-void ym262_session_start(int16_t *data);
-void ym262_session_write(uint32_t adr, uint8_t value);
-void ym262_session_flush(void);
-static int16_t reg_index[512]; // Index: YM262 register
-
-void ym262_session_start(int16_t *data)
-{
-	sidx = 0;
-	sdata = data;
-
-	int i;
-	for (i=0; i<sizeof(reg_index)/sizeof(int16_t); i++) {
-		reg_index[i] = REG_NOT_USED; // Speedup with memset ? -1 means (not used)
-	}
-}
-
-
-void ym262_session_write(uint32_t adr, uint8_t value)
-{
-	int reg = (uint16_t)(adr-YM262_L);
-	//	printf("reg: %03x, %d\n",reg,reg_index[reg]);
-	if (reg_index[reg] == REG_NOT_USED) {
-		sdata[sidx++] = reg;
-		reg_index[reg] = sidx;
-		sdata[sidx++] = value;
-#if YM262_DEBUG
-		printf("*");
-#endif
-	}
-	else {
-#if YM262_DEBUG
-		printf("-");
-#endif
-		sdata[reg_index[reg]] = value;
-	}
-}
-
-
-void ym262_session_flush(void)
-{
-	int16_t *d;
-
-	if (sidx == 0)
-		return;
-
-	sidx /= 2;
-	d = sdata;
-#if YM262_DEBUG
-	printf("sidx: %d\n",sidx);
-#endif
-
-	while (sidx--) {
-		int16_t reg = *d++;
-		int16_t val = *d++;
-		reg_index[reg] = REG_NOT_USED;
-
-#if !YM262_DEBUG
-		((uint8_t*)YM262_L)[reg] = val;
-		int z;
-		for(z=1;z<2000;z++);
-#endif
-
-#if YM262_DEBUG
-		printf("0x%04x, 0x%02x,\n", reg, val);
-#endif
-	}
-#if YM262_DEBUG
-	printf("\n");
-#endif
-
-}
-#endif // SESSIONS
 
 
+/* Writes are merged and paced by the sound queue, see sndq.c */
 void ym262_write_reg(unsigned long adr, uint8_t value)
 {
-#if YM262_SESSIONS
-	ym262_session_write(adr, value);
+#if YM262_DEBUG
+	printf("0x%04x, 0x%02x, ", (uint16_t)(adr-YM262_L), value);
+#elif CONF_WITH_SOUND_QUEUE
+	sndq_write(SNDQ_OPL3, (uint16_t)(adr-YM262_L), value);
 #else
-
- #if YM262_DEBUG == 0
 	*((uint8_t*)adr) = value;
- #else
-	printf("0x%04x, 0x%02x, ", (uint16_t)(adr-YM262_L), value);
- #endif
 #endif
 }
 
@@ -573,7 +491,6 @@ int ym262_test(int argc, char **argv)
 	uint32_t scale[128];
 	int note_number = 47;
 	int channel;
-	int16_t session[2048];
 
 #if 0
     for (i=0; i<7; i++)
@@ -581,8 +498,8 @@ int ym262_test(int argc, char **argv)
 	return 0;
 #endif
 
-#if YM262_SESSIONS
-	ym262_session_start(session);
+#if CONF_WITH_SOUND_QUEUE
+	sndq_hold(true); /* Send the whole setup in one frame */
 #endif
 
 	/* Compute frequencies for the scale */
@@ -662,8 +579,8 @@ int ym262_test(int argc, char **argv)
 		ym262_channel_on(channel);
 	}
 
-#if YM262_SESSIONS
-	ym262_session_flush();
+#if CONF_WITH_SOUND_QUEUE
+	sndq_hold(false);
 #endif
 
 	return 0;
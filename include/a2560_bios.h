@@ -19,6 +19,7 @@
 #include <stdbool.h>
 #include "../bios/conout.h"
 #include "../bios/serport.h"
+#include "../bios/psgconv.h"
 #include "../foenix/vicky2.h"
 #include "../foenix/vicky_mouse.h"
 #include "../foenix/a2560.h"
@@ -54,6 +55,8 @@ void a2560_bios_xbtimer(uint16_t timer, uint16_t control, uint16_t data, void *v
 
 /* Console support mode */
 void a2560_bios_kbd_init(void);
+void a2560_bios_kbd_init_step(void);
+void a2560_bios_kbd_init_wait(void);
 void a2560_bios_text_init(void);
 CONOUT_DRIVER *a2560_bios_get_conout(void);
 
@@ -61,6 +64,12 @@ CONOUT_DRIVER *a2560_bios_get_conout(void);
 void a2560_bios_midi_init(void);
 uint32_t a2560_bios_bcostat3(void);
 void a2560_bios_bconout3(uint8_t byte);
+void a2560_bios_midiws(uint32_t count, const uint8_t *ptr);
+
+/* PSG emulation */
+#if CONF_WITH_PSG_EMULATION
+void a2560_bios_psg_play(UWORD target, const PSGVOICES *v);
+#endif
 
 #endif /* MACHINE_A2560 */
 
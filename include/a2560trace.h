@@ -0,0 +1,50 @@
+/*
+ * a2560trace.h - layout of the Foenix debug trace ring
+ *
+ * The ring is filled by a2560_debug()/a2560_debugnl() (foenix/a2560_debug.c)
+ * and published via the 'FTRC' cookie. EmuCON's TRACE command saves it to a
+ * file: the struct a2560_trace_t, followed by the min(head, nrecs) most
+ * recent records, oldest first. tools/tracedec.c decodes such files.
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#ifndef A2560TRACE_H
+#define A2560TRACE_H
+
+#include <stdint.h>
+
+#define A2560_TRACE_MAGIC       0x46545243UL    /* 'FTRC' */
+#define A2560_TRACE_VERSION     1
+#define A2560_TRACE_ARGBYTES    16  /* 4 longs, or 8 (16-bit) ints */
+
+/* record flags */
+#define A2560_TRACE_NONL        1   /* from a2560_debug(): no newline */
+
+struct a2560_trace_rec_t {
+    uint32_t tick;          /* hz_200 when recorded */
+    uint32_t fine;          /* system timer count within that tick */
+    const char *fmt;        /* format string, also identifies the event */
+    uint16_t seq;           /* low 16 bits of the record number, written last */
+    uint16_t flags;
+    uint8_t args[A2560_TRACE_ARGBYTES]; /* raw (stacked) arguments */
+};
+
+struct a2560_trace_t {
+    uint32_t magic;         /* A2560_TRACE_MAGIC */
+    uint16_t version;       /* A2560_TRACE_VERSION */
+    uint16_t recsize;       /* sizeof(struct a2560_trace_rec_t) */
+    uint16_t nrecs;         /* size of the ring (a power of 2) */
+    uint16_t argbytes;      /* A2560_TRACE_ARGBYTES */
+    uint32_t fine_hz;       /* frequency of the 'fine' counter */
+    uint32_t rombase;       /* address of the OS header, to find format strings */
+    volatile uint32_t head; /* records logged so far */
+    volatile uint32_t tail; /* records sent to the debug port so far */
+    volatile uint32_t dropped; /* records lost because the ring was full */
+    struct a2560_trace_rec_t *recs;
+};
+
+#endif /* A2560TRACE_H */
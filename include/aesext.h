@@ -36,6 +36,10 @@ void gsx_start(void);
 void gsx_tblt(WORD tb_f, WORD x, WORD y, WORD tb_nc);
 void gsx_trans(void *addr, UWORD wb, UWORD h);
 
+/* function used by AES and desktop, found in gemwmlib.c */
+typedef void (*WM_REDRAW_FUNC)(WORD w_handle, GRECT *pt);
+void wm_scroll(WORD w_handle, const GRECT *pt, WORD dx, WORD dy, WM_REDRAW_FUNC redraw);
+
 /* functions used by AES and desktop, found in gemrslib.c */
 void xlate_obj_array(OBJECT *obj_array, int nobj);
 
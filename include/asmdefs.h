@@ -43,6 +43,8 @@
 #define MOVEC_D0_ITT1       .dc.l 0x4e7b0005        /* 68040-68060 */
 #define MOVEC_D0_DTT0       .dc.l 0x4e7b0006        /* 68040-68060 */
 #define MOVEC_D0_DTT1       .dc.l 0x4e7b0007        /* 68040-68060 */
+#define MOVEC_D0_URP        .dc.l 0x4e7b0806        /* 68040-68060 (except 68ec040) */
+#define MOVEC_D0_SRP        .dc.l 0x4e7b0807        /* 68040-68060 (except 68ec040) */
 
 #define PMOVE_FROM_TC(addr) .dc.l 0xf0394200,addr   /* 68030 (except 68ec030) */
 
@@ -64,6 +66,9 @@
 #define CINVA_DC            .dc.w 0xf458            /* 68040-68060 */
 #define CINVA_IC            .dc.w 0xf498            /* 68040-68060 */
 #define CINVA_BC            .dc.w 0xf4d8            /* 68040-68060 */
+#define CPUSHL_DC_A0        .dc.w 0xf468            /* 68040-68060 */
+#define CINVL_DC_A0         .dc.w 0xf448            /* 68040-68060 */
+#define PFLUSHA             .dc.w 0xf518            /* 68040-68060 */
 
 #define ADDIWL_0_A0         .dc.l 0x06d00000        /* 68080 */
 
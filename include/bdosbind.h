@@ -50,6 +50,9 @@ extern long trap1_pexec(short mode, const char *path, const char *tail, const ch
 #define Pexec(mode,name,cmdline,env) trap1_pexec(mode, name, cmdline, env)
 #define Fsfirst(filename,attr) trap1(0x4e, filename, attr)
 #define Fsnext() trap1(0x4f)
+#if CONF_WITH_FSEL_CATALOGUE || CONF_WITH_DIR_CACHE
+#define Ddirchanges(pcount) trap1(0x50, pcount)
+#endif
 #define Frename(oldname,newname) trap1(0x56, 0, oldname, newname)
 #define Fdatime(timeptr,handle,wflag) trap1(0x57, timeptr, handle, wflag)
 
@@ -33,7 +33,8 @@
 /*
  * Determine if this EmuTOS is built for ROM or RAM
  */
-#if defined(TARGET_PRG) || defined(TARGET_FLOPPY) || defined(TARGET_AMIGA_FLOPPY) || defined(TARGET_LISA_FLOPPY)
+#if defined(TARGET_PRG) || defined(TARGET_FLOPPY) || defined(TARGET_AMIGA_FLOPPY) || defined(TARGET_LISA_FLOPPY) \
+ || defined(TARGET_FOENIX_FLASH)
 #  define EMUTOS_LIVES_IN_RAM 1
 # else
 #  define EMUTOS_LIVES_IN_RAM 0
@@ -300,6 +301,18 @@
 # ifndef CONF_WITH_COLOUR_ICONS
 #  define CONF_WITH_COLOUR_ICONS 0
 # endif
+# ifndef CONF_WITH_CICON_CACHE
+#  define CONF_WITH_CICON_CACHE 0
+# endif
+# ifndef CONF_WITH_OBDRAW_BATCH
+#  define CONF_WITH_OBDRAW_BATCH 0
+# endif
+# ifndef CONF_WITH_SAVE_UNDER_STACK
+#  define CONF_WITH_SAVE_UNDER_STACK 0
+# endif
+# ifndef CONF_WITH_FSEL_CATALOGUE
+#  define CONF_WITH_FSEL_CATALOGUE 0
+# endif
 # ifndef CONF_WITH_GRAF_MOUSE_EXTENSION
 #  define CONF_WITH_GRAF_MOUSE_EXTENSION 0
 # endif
@@ -324,6 +337,9 @@
 # ifndef CONF_WITH_DESKTOP_SHORTCUTS
 #  define CONF_WITH_DESKTOP_SHORTCUTS 0
 # endif
+# ifndef CONF_WITH_DIR_CACHE
+#  define CONF_WITH_DIR_CACHE 0
+# endif
 # ifndef CONF_WITH_BACKGROUNDS
 #  define CONF_WITH_BACKGROUNDS 0
 # endif
@@ -716,6 +732,27 @@
 # ifndef CONF_WITH_WM8776
 #  define CONF_WITH_WM8776 1
 # endif
+# ifndef CONF_WITH_SOUND_QUEUE
+#  define CONF_WITH_SOUND_QUEUE 1
+# endif
+# ifndef CONF_WITH_PSG_EMULATION
+#  define CONF_WITH_PSG_EMULATION 1
+# endif
+# ifndef CONF_WITH_BOOT_TIMELINE
+#  define CONF_WITH_BOOT_TIMELINE 1
+# endif
+# ifndef CONF_WITH_WARM_BOOT_CACHE
+#  define CONF_WITH_WARM_BOOT_CACHE 1
+# endif
+# ifndef CONF_WITH_DYNAMIC_OSMEM
+#  define CONF_WITH_DYNAMIC_OSMEM 1
+# endif
+# ifndef CONF_WITH_FFIT_SIZE_CLASSES
+#  define CONF_WITH_FFIT_SIZE_CLASSES 1
+# endif
+# ifndef CONF_WITH_BDOS_PIPES
+#  define CONF_WITH_BDOS_PIPES 1
+# endif
 # ifndef CONF_WITH_BQ4802LY
 #  define CONF_WITH_BQ4802LY 1
 # endif
@@ -790,6 +827,33 @@
 # ifndef CONF_WITH_WM8776
 #  define CONF_WITH_WM8776 1
 # endif
+# ifndef CONF_WITH_SOUND_QUEUE
+#  define CONF_WITH_SOUND_QUEUE 1
+# endif
+# ifndef CONF_WITH_PSG_EMULATION
+#  define CONF_WITH_PSG_EMULATION 1
+# endif
+# ifndef CONF_WITH_BOOT_TIMELINE
+#  define CONF_WITH_BOOT_TIMELINE 1
+# endif
+# ifndef CONF_WITH_WARM_BOOT_CACHE
+#  define CONF_WITH_WARM_BOOT_CACHE 1
+# endif
+# ifndef CONF_WITH_DYNAMIC_OSMEM
+#  define CONF_WITH_DYNAMIC_OSMEM 1
+# endif
+# ifndef CONF_WITH_FFIT_SIZE_CLASSES
+#  define CONF_WITH_FFIT_SIZE_CLASSES 1
+# endif
+# ifndef CONF_WITH_BDOS_PIPES
+#  define CONF_WITH_BDOS_PIPES 1
+# endif
+# ifndef CONF_WITH_CACHE_MAP
+#  define CONF_WITH_CACHE_MAP 1
+# endif
+# ifndef CONF_WITH_HOT_TEXT
+#  define CONF_WITH_HOT_TEXT 1
+# endif
 # ifndef CONF_WITH_BQ4802LY
 #  define CONF_WITH_BQ4802LY 1
 # endif
@@ -867,6 +931,33 @@
 # ifndef CONF_WITH_WM8776
 #  define CONF_WITH_WM8776 1
 # endif
+# ifndef CONF_WITH_SOUND_QUEUE
+#  define CONF_WITH_SOUND_QUEUE 1
+# endif
+# ifndef CONF_WITH_PSG_EMULATION
+#  define CONF_WITH_PSG_EMULATION 1
+# endif
+# ifndef CONF_WITH_BOOT_TIMELINE
+#  define CONF_WITH_BOOT_TIMELINE 1
+# endif
+# ifndef CONF_WITH_WARM_BOOT_CACHE
+#  define CONF_WITH_WARM_BOOT_CACHE 1
+# endif
+# ifndef CONF_WITH_DYNAMIC_OSMEM
+#  define CONF_WITH_DYNAMIC_OSMEM 1
+# endif
+# ifndef CONF_WITH_FFIT_SIZE_CLASSES
+#  define CONF_WITH_FFIT_SIZE_CLASSES 1
+# endif
+# ifndef CONF_WITH_BDOS_PIPES
+#  define CONF_WITH_BDOS_PIPES 1
+# endif
+# ifndef CONF_WITH_CACHE_MAP
+#  define CONF_WITH_CACHE_MAP 1
+# endif
+# ifndef CONF_WITH_HOT_TEXT
+#  define CONF_WITH_HOT_TEXT 1
+# endif
 # ifndef CONF_WITH_BQ4802LY
 #  define CONF_WITH_BQ4802LY 1
 # endif
@@ -940,6 +1031,33 @@
 # ifndef CONF_WITH_WM8776
 #  define CONF_WITH_WM8776 1
 # endif
+# ifndef CONF_WITH_SOUND_QUEUE
+#  define CONF_WITH_SOUND_QUEUE 1
+# endif
+# ifndef CONF_WITH_PSG_EMULATION
+#  define CONF_WITH_PSG_EMULATION 1
+# endif
+# ifndef CONF_WITH_BOOT_TIMELINE
+#  define CONF_WITH_BOOT_TIMELINE 1
+# endif
+# ifndef CONF_WITH_WARM_BOOT_CACHE
+#  define CONF_WITH_WARM_BOOT_CACHE 1
+# endif
+# ifndef CONF_WITH_DYNAMIC_OSMEM
+#  define CONF_WITH_DYNAMIC_OSMEM 1
+# endif
+# ifndef CONF_WITH_FFIT_SIZE_CLASSES
+#  define CONF_WITH_FFIT_SIZE_CLASSES 1
+# endif
+# ifndef CONF_WITH_BDOS_PIPES
+#  define CONF_WITH_BDOS_PIPES 1
+# endif
+# ifndef CONF_WITH_CACHE_MAP
+#  define CONF_WITH_CACHE_MAP 1
+# endif
+# ifndef CONF_WITH_HOT_TEXT
+#  define CONF_WITH_HOT_TEXT 1
+# endif
 # ifndef CONF_WITH_BQ4802LY
 #  define CONF_WITH_BQ4802LY 1
 # endif
@@ -980,6 +1098,25 @@
 #endif
 #endif
 
+/*
+ * Foenix debug output: set MACHINE_A2560_TRACE to 1 to have a2560_debug()
+ * and a2560_debugnl() store binary records in a RAM ring of
+ * MACHINE_A2560_TRACE_RECORDS entries (a power of 2), which is formatted
+ * and sent to the debug port from the system timer, rather than
+ * formatting and sending each message synchronously.
+ */
+#ifdef MACHINE_A2560_DEBUG
+# ifndef MACHINE_A2560_TRACE
+#  define MACHINE_A2560_TRACE MACHINE_A2560_DEBUG
+# endif
+# ifndef MACHINE_A2560_TRACE_RECORDS
+#  define MACHINE_A2560_TRACE_RECORDS 256
+# endif
+#endif
+#ifndef MACHINE_A2560_TRACE
+# define MACHINE_A2560_TRACE 0
+#endif
+
 
 /*
  * By default, EmuTOS is built for Atari ST/TT/Falcon compatible hardware
@@ -1596,6 +1733,75 @@
 # define CONF_WITH_3D_OBJECTS 1
 #endif
 
+/*
+ * Set CONF_WITH_AES_SCHED_STATS to 1 to keep per-process scheduling
+ * statistics (context switches, time spent waiting for events) in the
+ * AES dispatcher.  They are published via the 'AESS' cookie and can be
+ * displayed by tools/aesstat.c.
+ */
+#ifndef CONF_WITH_AES_SCHED_STATS
+# define CONF_WITH_AES_SCHED_STATS 0
+#endif
+
+/*
+ * Set CONF_WITH_AES_DRAW_STATS to 1 to count objects drawn & culled,
+ * and VDI calls saved by attribute caching & fill batching, in
+ * objc_draw().  They are published via the 'AESD' cookie and can be
+ * displayed by tools/aesstat.c.
+ */
+#ifndef CONF_WITH_AES_DRAW_STATS
+# define CONF_WITH_AES_DRAW_STATS 0
+#endif
+
+/*
+ * Set CONF_WITH_AES_CALL_STATS to 1 to count the calls and the time spent
+ * for each AES function and process, and the time messages spend in the
+ * queue of each process.  They are published via the 'AESC' cookie and
+ * can be displayed by tools/aesstat.c.
+ */
+#ifndef CONF_WITH_AES_CALL_STATS
+# define CONF_WITH_AES_CALL_STATS 0
+#endif
+
+/*
+ * Set CONF_WITH_VDI_PROFILE to 1 to count the calls, the time spent and
+ * the pixels drawn for each VDI function and workstation.  This is
+ * published via the 'VPRF' cookie and can be displayed by tools/vdiprof.c.
+ */
+#ifndef CONF_WITH_VDI_PROFILE
+# define CONF_WITH_VDI_PROFILE 0
+#endif
+
+/*
+ * Set CONF_WITH_OBDRAW_BATCH to 1 to batch the box fills output while
+ * drawing an object tree, so that the nested backgrounds of a dialog
+ * or window are drawn with fewer VDI calls
+ */
+#ifndef CONF_WITH_OBDRAW_BATCH
+# define CONF_WITH_OBDRAW_BATCH 1
+#endif
+
+/*
+ * Set CONF_WITH_SAVE_UNDER_STACK to 1 to save the screen underneath
+ * the AES's own dialogs, submenus and popups in a stack of buffers, so
+ * that closing them is a blit rather than a redraw of the windows
+ * underneath, as long as nothing has changed there.  Application dialogs
+ * are always redrawn, since only the application knows what it drew.
+ */
+#ifndef CONF_WITH_SAVE_UNDER_STACK
+# define CONF_WITH_SAVE_UNDER_STACK 1
+#endif
+
+/*
+ * Set CONF_WITH_FSEL_CATALOGUE to 1 to keep the directories read by the
+ * file selector in memory, so that revisiting them or changing the mask
+ * does not read the disk again, and to jump to the first matching name
+ * while a filename is typed
+ */
+#ifndef CONF_WITH_FSEL_CATALOGUE
+# define CONF_WITH_FSEL_CATALOGUE 1
+#endif
+
 /*
  * Set CONF_WITH_COLOUR_ICONS to 1 to enable support for colour icons,
  * as in Atari TOS 4
@@ -1604,6 +1810,16 @@
 # define CONF_WITH_COLOUR_ICONS 1
 #endif
 
+/*
+ * Set CONF_WITH_CICON_CACHE to 1 to keep the converted (device-format)
+ * colour icons of recently-loaded resource files, so that reloading the
+ * same file in the same resolution (e.g. the desktop's icon file) does
+ * not convert them again
+ */
+#ifndef CONF_WITH_CICON_CACHE
+# define CONF_WITH_CICON_CACHE CONF_WITH_COLOUR_ICONS
+#endif
+
 /*
  * Set CONF_WITH_EXTENDED_OBJECTS to 1 to include AES support for a
  * number of MagiC-style object type extensions
@@ -1816,6 +2032,26 @@
 # define CONF_WITH_68040_PMMU 0
 #endif
 
+/*
+ * Set CONF_WITH_CACHE_MAP to 1 to set the cache modes of the Foenix memory
+ * map on a 68040 or 68060: copyback for the RAM, write-through for the
+ * video RAM and precise for I/O.  The data cache is then also pushed and
+ * invalidated line by line for small areas.
+ */
+#ifndef CONF_WITH_CACHE_MAP
+# define CONF_WITH_CACHE_MAP 0
+#endif
+
+/*
+ * Set CONF_WITH_HOT_TEXT to 1 to group the code used all the time
+ * (interrupt handlers, VDI blits and rasters, BDOS file I/O, memory and
+ * string copies) at the start of the TEXT segment, so it shares as few
+ * instruction cache lines as possible with the rest.
+ */
+#ifndef CONF_WITH_HOT_TEXT
+# define CONF_WITH_HOT_TEXT 0
+#endif
+
 /*
  * Set CONF_WITH_BIOS_EXTENSIONS to 1 to support various BIOS extension
  * functions
@@ -1847,6 +2083,52 @@
 # define CONF_WITH_MEMORY_TEST 0
 #endif
 
+/*
+ * set CONF_WITH_BOOT_TIMELINE to 1 to record the time at which each BIOS
+ * initialisation step starts.  The timeline is published via the BTIM
+ * cookie, and displayed by tools/boottime.c.
+ */
+#ifndef CONF_WITH_BOOT_TIMELINE
+# define CONF_WITH_BOOT_TIMELINE 0
+#endif
+
+/*
+ * set CONF_WITH_WARM_BOOT_CACHE to 1 to keep the results of slow hardware
+ * probes (delay calibration, IDE device detection) in a RAM area that
+ * survives a reset, so that they can be reused on warm boots.
+ */
+#ifndef CONF_WITH_WARM_BOOT_CACHE
+# define CONF_WITH_WARM_BOOT_CACHE 0
+#endif
+
+/*
+ * set CONF_WITH_DYNAMIC_OSMEM to 1 to let the BDOS internal memory pool
+ * (used for DNDs, OFDs and MDs) grow from the TPA when it runs out, rather
+ * than freeing cached directory information.  Usage statistics are then
+ * published via the OSMS cookie, and displayed by tools/osmstat.c.
+ */
+#ifndef CONF_WITH_DYNAMIC_OSMEM
+# define CONF_WITH_DYNAMIC_OSMEM 0
+#endif
+
+/*
+ * set CONF_WITH_FFIT_SIZE_CLASSES to 1 to make Malloc() skip the small
+ * free blocks at the start of the free lists, using one hint per size
+ * class.  The results are the same as with a plain first fit.
+ */
+#ifndef CONF_WITH_FFIT_SIZE_CLASSES
+# define CONF_WITH_FFIT_SIZE_CLASSES 0
+#endif
+
+/*
+ * set CONF_WITH_BDOS_PIPES to 1 to provide in-memory pipes: Fcreate("PIPE:")
+ * returns a character device handle which keeps what is written to it until
+ * it is read.  EmuCON uses them for command pipelines.
+ */
+#ifndef CONF_WITH_BDOS_PIPES
+# define CONF_WITH_BDOS_PIPES 0
+#endif
+
 /*
  * Set CONF_WITH_XBIOS_SOUND to 1 to enable support for the XBIOS sound
  * extension.  This extension provides (some of) the Falcon XBIOS sound
@@ -2106,6 +2388,16 @@
 # define CONF_WITH_DESKTOP_SHORTCUTS 1
 #endif
 
+/*
+ * Set CONF_WITH_DIR_CACHE to 1 to keep the listings of recently-viewed
+ * directories in memory, so that re-opening them in a desktop window
+ * does not require the directory to be read again, as long as GEMDOS
+ * reports no change to any directory or medium meanwhile
+ */
+#ifndef CONF_WITH_DIR_CACHE
+# define CONF_WITH_DIR_CACHE 1
+#endif
+
 /*
  * Set CONF_WITH_EASTER_EGG to 1 to include the EmuDesk Easter Egg
  * (this plays a small tune and therefore requires YM2149 support)
@@ -2391,6 +2683,26 @@
 # define CONF_WITH_WM8776 0
 #endif
 
+/*
+ * Set CONF_WITH_SOUND_QUEUE to queue the register writes to the Foenix sound
+ * chips (OPL3, OPM, OPN2, SN76489s). Writes to the same register within a
+ * frame are merged, and frames are committed from a timer interrupt at a
+ * rate chosen by the application; see foenix/sndq.c.
+ */
+#ifndef CONF_WITH_SOUND_QUEUE
+# define CONF_WITH_SOUND_QUEUE 0
+#endif
+
+/*
+ * Set CONF_WITH_PSG_EMULATION to emulate the YM2149 for Dosound() and
+ * Giaccess() on machines without one: the register values are translated
+ * for the SN76489s or the OPL3 on each system timer tick; see bios/psgconv.c.
+ * The FPSG cookie points to the UWORD that selects the chip.
+ */
+#ifndef CONF_WITH_PSG_EMULATION
+# define CONF_WITH_PSG_EMULATION 0
+#endif
+
 /*
  * Set CONF_WITH_BQ4802LY if the machine has a bq4802LY real time clock.
  * If this is defined, the driver requires BQ4802LY_PORT to be defined as the address
@@ -2499,6 +2811,16 @@
 # endif
 #endif
 
+#if CONF_WITH_YM2149 && CONF_WITH_PSG_EMULATION
+# error CONF_WITH_PSG_EMULATION must not be used with CONF_WITH_YM2149.
+#endif
+
+#if !CONF_WITH_COLOUR_ICONS
+# if CONF_WITH_CICON_CACHE
+#  error CONF_WITH_CICON_CACHE requires CONF_WITH_COLOUR_ICONS.
+# endif
+#endif
+
 #if !CONF_WITH_ALT_RAM
 # if CONF_WITH_STATIC_ALT_RAM
 #  error CONF_WITH_STATIC_ALT_RAM requires CONF_WITH_ALT_RAM.
@@ -2641,12 +2963,27 @@
 # endif
 #endif
 
+#if MACHINE_A2560_TRACE
+# if !MACHINE_A2560_DEBUG
+#  error MACHINE_A2560_TRACE requires MACHINE_A2560_DEBUG.
+# endif
+# if MACHINE_A2560_TRACE_RECORDS & (MACHINE_A2560_TRACE_RECORDS - 1)
+#  error MACHINE_A2560_TRACE_RECORDS must be a power of 2.
+# endif
+#endif
+
 #ifndef MACHINE_ARANYM
 # if CONF_WITH_68040_PMMU
 #  error CONF_WITH_68040_PMMU requires MACHINE_ARANYM.
 # endif
 #endif
 
+#if CONF_WITH_CACHE_MAP
+# if !(defined(MACHINE_A2560K) || defined(MACHINE_A2560M) || defined(MACHINE_A2560X) || defined(MACHINE_GENX))
+#  error CONF_WITH_CACHE_MAP requires a Foenix machine with a 68040 or 68060.
+# endif
+#endif
+
 /* Convenience */
 #if defined(MACHINE_A2560U) || defined(MACHINE_A2560K) || defined(MACHINE_A2560M) || defined(MACHINE_A2560X) || defined(MACHINE_GENX)
 #define MACHINE_FOENIX
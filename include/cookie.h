@@ -42,6 +42,15 @@ struct cookie {
 #define COOKIE__5MS     0x5f354d53L
 #define COOKIE_NVDI     0x4e564449L
 #define COOKIE_SCSIDRIV 0x53435349L
+#define COOKIE_AESS     0x41455353L     /* EmuTOS AES scheduling statistics */
+#define COOKIE_AESD     0x41455344L     /* EmuTOS AES drawing statistics */
+#define COOKIE_FTRC     0x46545243L     /* Foenix debug trace ring */
+#define COOKIE_FPSG     0x46505347L     /* Foenix PSG emulation target */
+#define COOKIE_BTIM     0x4254494dL     /* EmuTOS boot timeline */
+#define COOKIE_OSMS     0x4f534d53L     /* EmuTOS BDOS internal memory statistics */
+#define COOKIE_FCMP     0x46434d50L     /* Foenix cache map */
+#define COOKIE_VPRF     0x56505246L     /* EmuTOS VDI profile */
+#define COOKIE_AESC     0x41455343L     /* EmuTOS AES call statistics */
 
 /*
  * values of _MCH cookie
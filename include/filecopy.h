@@ -0,0 +1,79 @@
+/*
+ * filecopy.h - shared file copy engine
+ *
+ * Used by both the desktop and EmuCON to copy/move files.
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#ifndef _FILECOPY_H
+#define _FILECOPY_H
+
+#include "portab.h"
+
+#define FC_CLUSTER  (32*1024L)  /* maximum cluster size */
+
+/*
+ * return values from fc_copy()/fc_flush(), and from the error callback
+ */
+#define FC_SKIP     (-1)        /* this file was skipped */
+#define FC_ABORT    0           /* stop the whole operation */
+#define FC_OK       1           /* ok (fc_copy()/fc_flush() only) */
+#define FC_RETRY    2           /* retry the failing call (error callback only) */
+
+/*
+ * flags for fc_copy()
+ */
+#define FC_MOVE     0x0001      /* delete source after copying it */
+
+/*
+ * error types passed to the error callback
+ */
+#define FC_ERR_OPEN     0       /* opening source */
+#define FC_ERR_CREATE   1       /* creating destination */
+#define FC_ERR_READ     2       /* reading source (retry not possible) */
+#define FC_ERR_WRITE    3       /* writing destination (retry not possible) */
+#define FC_ERR_FULL     4       /* destination disk full (always aborts) */
+#define FC_ERR_DELETE   5       /* deleting source after a move */
+
+/*
+ * progress information passed to the progress callback
+ */
+typedef struct
+{
+    ULONG bytes;                /* bytes written so far */
+    ULONG files;                /* files written (and deleted, for a move) so far */
+    const char *src;            /* source of the file being written */
+    const char *name;           /* destination being written */
+} FCSTAT;
+
+typedef struct _fcpend FCPEND;
+
+typedef struct
+{
+    UBYTE *buf;                 /* copy buffer */
+    LONG buflen;                /* its length, in whole clusters if possible */
+    LONG used;                  /* bytes of buffered file data */
+    UBYTE *low;                 /* lowest pending descriptor (they grow downwards) */
+    FCPEND *first;              /* pending (buffered) files, in order */
+    FCPEND *last;
+    /*
+     * called after each buffer written, and after each file is complete,
+     * i.e. when 'files' changes: return non-zero to abort
+     */
+    WORD (*progress)(void *arg, const FCSTAT *stat);
+    /* called on error: returns FC_SKIP, FC_RETRY or FC_ABORT */
+    WORD (*error)(void *arg, WORD type, const char *path, LONG rc);
+    void *arg;                  /* passed to the callbacks */
+    FCSTAT stat;
+} FCOPY;
+
+LONG fc_init(FCOPY *fc, LONG reserve, WORD mode);
+WORD fc_copy(FCOPY *fc, const char *src, const char *dst, WORD attr, WORD flags);
+WORD fc_flush(FCOPY *fc);
+void fc_exit(FCOPY *fc);
+
+#endif /* _FILECOPY_H */
@@ -0,0 +1,68 @@
+/*
+ * finetime.h - fine-grained time, for the profilers
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#ifndef FINETIME_H
+#define FINETIME_H
+
+#include "tosvars.h"
+
+#if defined(MACHINE_A2560U) || defined(MACHINE_A2560K) || defined(MACHINE_A2560M) || defined(MACHINE_A2560X) || defined(MACHINE_GENX)
+# include <stdint.h>
+# include "../foenix/foenix.h"
+# include "../foenix/regutils.h"
+/* The system timer counts up at the CPU frequency, and restarts at each tick */
+# define FINE_TIME_HZ   CPU_FREQ
+# define FINE_COUNT()   R32(TIMER2_VALUE)
+#else
+# define FINE_TIME_HZ   200UL
+# define FINE_COUNT()   0UL
+#endif
+
+/*
+ * return the current time, in counts of FINE_TIME_HZ.  This wraps around,
+ * so only differences are meaningful.
+ */
+static __inline__ ULONG fine_time(void)
+{
+    ULONG ticks, fine;
+
+    /* read both counters within the same tick */
+    do
+    {
+        ticks = hz_200;
+        fine = FINE_COUNT();
+    } while (ticks != hz_200);
+
+    return ticks * (FINE_TIME_HZ / 200) + fine;
+}
+
+/*
+ * return the time elapsed since 'start', a value returned by fine_time().
+ * A difference less than one tick below zero means that the timer had
+ * restarted before the tick was counted, and is taken as 0; any other
+ * value is a real duration, up to 2^32 counts.
+ */
+static __inline__ ULONG fine_time_since(ULONG start)
+{
+    ULONG time = fine_time() - start;
+
+    if (time > (ULONG)-(LONG)(FINE_TIME_HZ / 200))
+        time = 0;
+
+    return time;
+}
+
+/* convert a difference of fine_time() values to milliseconds */
+#if FINE_TIME_HZ >= 1000
+# define FINE_TIME_MS(t)    ((t) / (FINE_TIME_HZ / 1000))
+#else
+# define FINE_TIME_MS(t)    ((t) * (1000 / FINE_TIME_HZ))
+#endif
+
+#endif /* FINETIME_H */
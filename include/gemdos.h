@@ -18,6 +18,9 @@ WORD dos_setdt(UWORD h, UWORD time, UWORD date);
 WORD dos_label(char drive, char *plabel);
 void dos_space(WORD drv, LONG *ptotal, LONG *pavail);
 LONG dos_load_file(char *filename, LONG count, char *buf);
+#if CONF_WITH_FSEL_CATALOGUE || CONF_WITH_DIR_CACHE
+BOOL dos_dirchanges(ULONG *pcount);
+#endif
 
 void *dos_alloc_stram(LONG nbytes);
 void *dos_alloc_anyram(LONG nbytes);
@@ -46,6 +46,8 @@ ULONG Isqrt(ULONG x);
  * d1 = signed 16 bit integer
  */
 
+#ifdef __mc68000__
+
 /*
  * mul_div - signed integer multiply and divide
  * return ( m1 * m2 ) / d1
@@ -122,4 +124,32 @@ static __inline__ UWORD divu(ULONG d1, UWORD d2)
     return (UWORD)d1;
 }
 
+#else
+
+/*
+ * portable versions of the above, for when parts of EmuTOS are built
+ * on the host for testing (see tests/vdi)
+ */
+static __inline__ WORD mul_div(WORD m1, WORD m2, WORD d1)
+{
+    return (WORD)(((LONG)m1 * m2) / d1);
+}
+
+static __inline__ UWORD umul_shift(UWORD m1, UWORD m2)
+{
+    return (UWORD)(((ULONG)m1 * m2 + 32768UL) >> 16);
+}
+
+static __inline__ LONG muls(WORD m1, WORD m2)
+{
+    return (LONG)m1 * m2;
+}
+
+static __inline__ UWORD divu(ULONG d1, UWORD d2)
+{
+    return (UWORD)(d1 / d2);
+}
+
+#endif /* __mc68000__ */
+
 #endif
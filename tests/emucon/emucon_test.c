@@ -0,0 +1,406 @@
+/*
+ * emucon_test.c - host test of EmuCON redirection, pipelines & batch files
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include "cmd.h"
+
+#define MAX_FILES   8
+#define MAX_HANDLES 10
+#define FILE_HANDLE 6           /* first handle returned for a file */
+#define PIPE_HANDLE -10         /* first (WORD) handle returned for a pipe */
+#define EIHNDL      -37
+
+static int failures;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            failures++; \
+        } \
+    } while (0)
+
+/*
+ * the in-memory file system
+ */
+typedef struct {
+    char name[16];
+    char data[1024];
+    long len;
+} MEMFILE;
+
+typedef struct {
+    int open;
+    MEMFILE *f;
+    long rpos, wpos;            /* a pipe is both written & read */
+} MEMHANDLE;
+
+static MEMFILE files[MAX_FILES];
+static MEMHANDLE handles[MAX_HANDLES];
+static MEMFILE pipes[MAX_HANDLES];
+static int bad_closes;
+static char console[1024];
+static DTA test_dta;
+
+/*
+ * stubs for the EmuCON globals & functions not built here
+ */
+char *environment = "";
+const char version[] = "test";
+
+static void add_console(const char *s)
+{
+    strncat(console, s, sizeof(console) - strlen(console) - 1);
+}
+
+static MEMFILE *find_file(const char *name)
+{
+    int i;
+
+    for (i = 0; i < MAX_FILES; i++)
+        if (files[i].name[0] && !strcasecmp(files[i].name, name))
+            return &files[i];
+
+    return NULL;
+}
+
+static MEMFILE *new_file(const char *name, const char *text)
+{
+    MEMFILE *f = find_file(name);
+    int i;
+
+    for (i = 0; !f && (i < MAX_FILES); i++)
+        if (!files[i].name[0])
+            f = &files[i];
+    if (!f)
+        return NULL;
+
+    strcpy(f->name, name);
+    strcpy(f->data, text);
+    f->len = strlen(text);
+
+    return f;
+}
+
+static MEMHANDLE *get_handle(WORD h)
+{
+    int i = (h >= FILE_HANDLE) ? h - FILE_HANDLE : PIPE_HANDLE - h;
+
+    if ((i < 0) || (i >= MAX_HANDLES) || !handles[i].open)
+        return NULL;
+
+    return &handles[i];
+}
+
+static LONG open_handle(MEMFILE *f, int pipe)
+{
+    int i;
+
+    for (i = 0; i < MAX_HANDLES; i++) {
+        if (!handles[i].open) {
+            if (pipe) {
+                f = &pipes[i];
+                f->len = 0;
+            }
+            handles[i].open = 1;
+            handles[i].f = f;
+            handles[i].rpos = handles[i].wpos = 0;
+            return pipe ? (LONG)(UWORD)(PIPE_HANDLE - i) : FILE_HANDLE + i;
+        }
+    }
+
+    return -35;                 /* ENHNDL */
+}
+
+LONG jmp_gemdos(WORD op, ...)
+{
+    va_list ap;
+    MEMFILE *f;
+    MEMHANDLE *h;
+    const char *name;
+    char *buf;
+    LONG rc, count;
+
+    va_start(ap, op);
+    switch(op) {
+    case 0x3c:                  /* Fcreate */
+        name = va_arg(ap, const char *);
+        if (!strcmp(name, "PIPE:"))
+            rc = open_handle(NULL, 1);
+        else {
+            f = new_file(name, "");
+            rc = f ? open_handle(f, 0) : -36;
+        }
+        break;
+    case 0x3d:                  /* Fopen */
+        f = find_file(va_arg(ap, const char *));
+        rc = f ? open_handle(f, 0) : EFILNF;
+        break;
+    case 0x3e:                  /* Fclose */
+        h = get_handle(va_arg(ap, int));
+        if (h) {
+            h->open = 0;
+            rc = 0L;
+        } else {
+            bad_closes++;
+            rc = EIHNDL;
+        }
+        break;
+    case 0x3f:                  /* Fread */
+        h = get_handle(va_arg(ap, int));
+        count = va_arg(ap, LONG);
+        buf = va_arg(ap, char *);
+        if (!h) {
+            rc = EIHNDL;
+            break;
+        }
+        if (count > h->f->len - h->rpos)
+            count = h->f->len - h->rpos;
+        memcpy(buf, h->f->data + h->rpos, count);
+        h->rpos += count;
+        rc = count;
+        break;
+    case 0x40:                  /* Fwrite */
+        h = get_handle(va_arg(ap, int));
+        count = va_arg(ap, LONG);
+        buf = va_arg(ap, char *);
+        if (!h) {
+            rc = EIHNDL;
+            break;
+        }
+        if (count > (LONG)sizeof(h->f->data) - h->wpos)
+            count = sizeof(h->f->data) - h->wpos;
+        memcpy(h->f->data + h->wpos, buf, count);
+        h->wpos += count;
+        if (h->f->len < h->wpos)
+            h->f->len = h->wpos;
+        rc = count;
+        break;
+    case 0x48:                  /* Malloc */
+        rc = (LONG)malloc(va_arg(ap, LONG));
+        break;
+    case 0x49:                  /* Mfree */
+        free(va_arg(ap, void *));
+        rc = 0L;
+        break;
+    case 0x4e:                  /* Fsfirst */
+        f = find_file(va_arg(ap, const char *));
+        if (f)
+            dta->d_length = f->len;
+        rc = f ? 0L : EFILNF;
+        break;
+    default:
+        printf("unexpected GEMDOS call 0x%02x\n", op);
+        failures++;
+        rc = -32;               /* EINVFN */
+        break;
+    }
+    va_end(ap);
+
+    return rc;
+}
+
+LONG jmp_bios(WORD op, ...)
+{
+    return (op == 0x01) ? 0L : -1L;     /* Bconstat: no key pressed */
+}
+
+LONG jmp_xbios(WORD op, ...)
+{
+    (void)op;
+    return -1L;
+}
+
+void message(const char *msg)
+{
+    add_console(msg);
+}
+
+void messagenl(const char *msg)
+{
+    add_console(msg);
+    add_console("\r\n");
+}
+
+void errmsg(LONG rc)
+{
+    char buf[32];
+
+    if (rc < 0L) {
+        sprintf(buf, "error %ld\r\n", (long)rc);
+        add_console(buf);
+    }
+}
+
+void escape(char c) { (void)c; }
+WORD getcookie(LONG cookie, LONG *pvalue) { (void)cookie; (void)pvalue; return 0; }
+WORD init_cmdedit(void) { return 0; }
+void init_screen(void) { }
+WORD read_line(char *line) { line[0] = '\0'; return -1; }
+void save_history(const char *line) { (void)line; }
+
+WORD getword(char *buf)
+{
+    return (WORD)atoi(buf);
+}
+
+WORD strequal(const char *s1, const char *s2)
+{
+    return !strcasecmp(s1, s2);
+}
+
+char *strupper(char *str)
+{
+    char *p;
+
+    for (p = str; *p; p++)
+        if ((*p >= 'a') && (*p <= 'z'))
+            *p &= ~0x20;
+
+    return str;
+}
+
+/*
+ * the builtins used by the tests
+ */
+static void output(const char *s)
+{
+    if (redir_handle < 0L)
+        message(s);
+    else Fwrite((WORD)redir_handle, strlen(s), s);
+}
+
+static LONG run_echo(WORD argc, char **argv)
+{
+    WORD i;
+
+    for (i = 1; i < argc; i++) {
+        output(argv[i]);
+        if (i < argc-1)
+            output(" ");
+    }
+    output("\r\n");
+
+    return 0L;
+}
+
+static LONG run_upper(WORD argc, char **argv)
+{
+    char buf[32];
+    LONG n;
+
+    (void)argc; (void)argv;
+    if (input_handle < 0L)
+        return 0L;
+
+    while ((n = Fread((WORD)input_handle, sizeof(buf) - 1, buf)) > 0L) {
+        buf[n] = '\0';
+        output(strupper(buf));
+    }
+
+    return 0L;
+}
+
+LONG (*lookup_builtin(WORD argc, char **argv))(WORD, char **)
+{
+    (void)argc;
+    if (!strcmp(argv[0], "echo"))
+        return run_echo;
+    if (!strcmp(argv[0], "upper"))
+        return run_upper;
+
+    return NULL;
+}
+
+LONG exec_program(WORD argc, char **argv)
+{
+    size_t len = strlen(argv[0]);
+
+    if ((len > 4) && !strcasecmp(argv[0] + len - 4, ".bat"))
+        return run_batch(argv[0], argc, argv);
+
+    return EFILNF;
+}
+
+/*
+ * run a command line as typed at the prompt, and check that every
+ * handle it opened has been closed exactly once
+ */
+static void run(const char *cmd)
+{
+    char line[MAX_LINE_SIZE];
+    int i;
+
+    strcpy(line, cmd);
+    bad_closes = 0;
+    console[0] = '\0';
+
+    CHECK(execute_line(line, -1L) == 0);
+    CHECK(redir_handle == -1L);
+    CHECK(input_handle == -1L);
+    CHECK(bad_closes == 0);
+    for (i = 0; i < MAX_HANDLES; i++)
+        CHECK(!handles[i].open);
+    if (console[0])
+        printf("%s: %s", cmd, console);
+    CHECK(console[0] == '\0');
+}
+
+static int contents(const char *name, const char *text)
+{
+    MEMFILE *f = find_file(name);
+
+    return f && (f->len == (long)strlen(text)) && !memcmp(f->data, text, f->len);
+}
+
+static void test_batch(void)
+{
+    new_file("T.BAT", "echo one\r\necho two\r\necho three\r\n");
+    new_file("P.BAT", "echo a | upper\r\necho b\r\n");
+
+    run("t.bat > out1");
+    CHECK(contents("OUT1", "one\r\ntwo\r\nthree\r\n"));
+
+    run("t.bat | upper > out2");
+    CHECK(contents("OUT2", "ONE\r\nTWO\r\nTHREE\r\n"));
+
+    run("p.bat > out3");
+    CHECK(contents("OUT3", "A\r\nb\r\n"));
+
+    run("p.bat | upper > out4");
+    CHECK(contents("OUT4", "A\r\nB\r\n"));
+}
+
+static void test_pipeline(void)
+{
+    run("echo x y | upper | upper > out5");
+    CHECK(contents("OUT5", "X Y\r\n"));
+}
+
+int main(void)
+{
+    dta = &test_dta;
+    redir_handle = -1L;
+    input_handle = -1L;
+
+    test_batch();
+    test_pipeline();
+
+    if (failures)
+    {
+        printf("emucon: %d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("emucon: all checks passed\n");
+
+    return 0;
+}
@@ -0,0 +1,221 @@
+/*
+ * iumem_bench.c - compare ffit()/freeit() with and without size class hints
+ *
+ * The same random sequence of Malloc(), Malloc(-1), Mshrink() and Mfree()
+ * is run against two memory partitions: one managed by iumem.c built with
+ * CONF_WITH_FFIT_SIZE_CLASSES, the other by iumem.c built without.  The
+ * results must be identical; the number of MDs visited shows the gain.
+ *
+ * Usage: iumem_bench [blocks [rounds]]
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static const double clocks_per_sec = CLOCKS_PER_SEC;    /* redefined by biosdefs.h */
+#undef CLOCKS_PER_SEC
+
+#include "emutos.h"
+#include "fs.h"
+#include "mem.h"
+#include "bdosstub.h"
+
+#define POOL_SIZE   (4UL*1024*1024)
+#define MAX_SLOTS   4000
+
+/* what iumem.c needs */
+MEMORY_PARTITION_BLOCK pmd, pmdalt;
+MEMORY_PARTITION_BLOCK plain_pmd, plain_pmdalt;
+PD *run;
+ULONG malloc_align_stram = 1;
+
+MEMORY_DESCRIPTOR *xmgetmd(void)
+{
+    return calloc(1, sizeof(MEMORY_DESCRIPTOR));
+}
+
+void xmfremd(MEMORY_DESCRIPTOR *md)
+{
+    free(md);
+}
+
+/* the routines built without the hints */
+MEMORY_DESCRIPTOR *plain_ffit(long amount, MEMORY_PARTITION_BLOCK *mp);
+void plain_freeit(MEMORY_DESCRIPTOR *m, MEMORY_PARTITION_BLOCK *mp);
+WORD plain_shrinkit(MEMORY_DESCRIPTOR *m, MEMORY_PARTITION_BLOCK *mp, LONG newlen);
+extern long ccvisits, plain_ccvisits;
+
+static UBYTE plain_ram[POOL_SIZE], hints_ram[POOL_SIZE];
+
+static struct {
+    MEMORY_DESCRIPTOR *plain, *hints;
+} slots[MAX_SLOTS];
+static int nslots, inuse;
+static unsigned long ops, fails;
+static long plain_ffit_visits, ffit_visits;
+
+/* ffit(), counting the MDs it visits */
+static MEMORY_DESCRIPTOR *plain_fit(long amount)
+{
+    long before = plain_ccvisits;
+    MEMORY_DESCRIPTOR *m = plain_ffit(amount, &plain_pmd);
+
+    plain_ffit_visits += plain_ccvisits - before;
+    return m;
+}
+
+static MEMORY_DESCRIPTOR *hints_fit(long amount)
+{
+    long before = ccvisits;
+    MEMORY_DESCRIPTOR *m = ffit(amount, &pmd);
+
+    ffit_visits += ccvisits - before;
+    return m;
+}
+
+/* same generator as tools/memstres.c, on 32 bits */
+static unsigned long qdrand(void)
+{
+    static unsigned long idum = 0;
+
+    idum = (1664525UL*idum + 1013904223UL) & 0xffffffffUL;
+
+    return idum;
+}
+
+static void init_pool(MEMORY_PARTITION_BLOCK *mp, UBYTE *ram)
+{
+    MEMORY_DESCRIPTOR *md = xmgetmd();
+
+    md->m_start = ram;
+    md->m_length = POOL_SIZE;
+    mp->mp_mfl = md;
+    mp->mp_mal = NULL;
+}
+
+static void mismatch(const char *what)
+{
+    printf("FAILED: %s differs after %lu operations\n", what, ops);
+    exit(1);
+}
+
+static void allocate(void)
+{
+    MEMORY_DESCRIPTOR *p, *h;
+    long size;
+    int k;
+
+    if (inuse == nslots)
+        return;
+    for (k = 0; slots[k].plain; k++)
+        ;
+
+    /* GEM programs often check the largest block first */
+    if ((qdrand() & 0x70) == 0)
+    {
+        if ((long)plain_fit(-1L) != (long)hints_fit(-1L))
+            mismatch("Malloc(-1)");
+    }
+
+    if (qdrand() & 8)
+        size = (qdrand() & 0xfffL) + 16L;
+    else
+        size = (qdrand() & 0xffL) + 16L;
+
+    p = plain_fit(size);
+    h = hints_fit(size);
+    ops++;
+    if (!p != !h)
+        mismatch("Malloc() success");
+    if (!p)
+    {
+        fails++;
+        return;
+    }
+    if (p->m_start - plain_ram != h->m_start - hints_ram)
+        mismatch("Malloc() address");
+
+    /* some programs give back what they don't need */
+    if ((qdrand() & 0xf00) == 0)
+    {
+        plain_shrinkit(p, &plain_pmd, size / 2);
+        shrinkit(h, &pmd, size / 2);
+    }
+
+    slots[k].plain = p;
+    slots[k].hints = h;
+    inuse++;
+}
+
+static void release(void)
+{
+    int k;
+
+    if (inuse == 0)
+        return;
+    do
+        k = qdrand() % nslots;
+    while (!slots[k].plain);
+
+    plain_freeit(slots[k].plain, &plain_pmd);
+    freeit(slots[k].hints, &pmd);
+    ops++;
+    slots[k].plain = slots[k].hints = NULL;
+    inuse--;
+}
+
+static int randomwalk(unsigned char p)
+{
+    return (unsigned char)(qdrand() & 0xff) < p;
+}
+
+int main(int argc, char *argv[])
+{
+    int rounds, i;
+    clock_t start;
+
+    nslots = (argc > 1) ? atoi(argv[1]) : 1000;
+    rounds = (argc > 2) ? atoi(argv[2]) : 20;
+    if ((nslots < 1) || (nslots > MAX_SLOTS) || (rounds < 1))
+    {
+        fprintf(stderr, "usage: iumem_bench [blocks (1-%d) [rounds]]\n", MAX_SLOTS);
+        return 1;
+    }
+
+    init_pool(&plain_pmd, plain_ram);
+    init_pool(&pmd, hints_ram);
+    fit_hints_reset(&pmd);
+
+    start = clock();
+    for (i = 0; i < rounds; i++)
+    {
+        /* alternate phases, as in memstres.c */
+        while (inuse < nslots && fails < 1000)
+        {
+            if (randomwalk(192))
+                allocate();
+            else release();
+        }
+        while (inuse > 0)
+        {
+            if (randomwalk(64))
+                allocate();
+            else release();
+        }
+    }
+
+    printf("%lu operations on %d blocks, %lu allocations failed\n", ops, nslots, fails);
+    printf("MDs visited: %ld first fit, %ld with size class hints (%.1f%%)\n",
+            plain_ccvisits, ccvisits, 100.0 * ccvisits / plain_ccvisits);
+    printf("ffit(): %ld and %ld, freeit() and shrinkit(): %ld and %ld\n",
+            plain_ffit_visits, ffit_visits, plain_ccvisits - plain_ffit_visits, ccvisits - ffit_visits);
+    printf("%.2f s\n", (double)(clock() - start) / clocks_per_sec);
+
+    return 0;
+}
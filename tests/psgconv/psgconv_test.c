@@ -0,0 +1,149 @@
+/*
+ * psgconv_test.c - host test of the YM2149 register translation
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "portab.h"
+#include "psgconv.h"
+
+#define SN_CLOCK    3579545UL   /* SN76489 clock on the A2560 */
+
+static int failures;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            failures++; \
+        } \
+    } while (0)
+
+static void test_envelope(void)
+{
+    /* period 1: a step every 8us, a ramp every 128us */
+    CHECK(psgconv_envelope(0x00, 1, 0) == 15);      /* \___ */
+    CHECK(psgconv_envelope(0x00, 1, 8*5) == 10);
+    CHECK(psgconv_envelope(0x00, 1, 128) == 0);
+    CHECK(psgconv_envelope(0x04, 1, 0) == 0);       /* /___ */
+    CHECK(psgconv_envelope(0x04, 1, 8*15) == 15);
+    CHECK(psgconv_envelope(0x04, 1, 128) == 0);
+
+    CHECK(psgconv_envelope(0x08, 1, 128 + 8*3) == 12);  /* \\\\ */
+    CHECK(psgconv_envelope(0x0c, 1, 128 + 8*3) == 3);   /* //// */
+    CHECK(psgconv_envelope(0x0a, 1, 128 + 8*3) == 3);   /* \/\/ */
+    CHECK(psgconv_envelope(0x0a, 1, 256 + 8*3) == 12);
+    CHECK(psgconv_envelope(0x0e, 1, 128 + 8*3) == 12);  /* /\/\ */
+
+    CHECK(psgconv_envelope(0x09, 1, 1000) == 0);    /* \___ */
+    CHECK(psgconv_envelope(0x0b, 1, 1000) == 15);   /* \~~~ */
+    CHECK(psgconv_envelope(0x0d, 1, 1000) == 15);   /* /~~~ */
+    CHECK(psgconv_envelope(0x0f, 1, 1000) == 0);    /* /___ */
+
+    /* period 0 behaves like period 1 */
+    CHECK(psgconv_envelope(0x00, 0, 8*5) == 10);
+    /* longer periods scale */
+    CHECK(psgconv_envelope(0x00, 1000, 8000UL*5) == 10);
+}
+
+static void test_voices(void)
+{
+    UBYTE regs[16];
+    PSGVOICES v;
+
+    memset(regs, 0, sizeof(regs));
+    regs[0] = 0x34; regs[1] = 0x12;     /* channel A: period 0x234 */
+    regs[2] = 0xff; regs[3] = 0xff;     /* channel B: 12 bits only */
+    regs[6] = 0xff;                     /* noise: 5 bits only */
+    regs[7] = 0x0e;                     /* tone A, noise B and C */
+    regs[8] = 0x0f;
+    regs[9] = 0x07;
+    regs[10] = 0x10;                    /* channel C uses the envelope */
+    regs[13] = 0x0d;                    /* /~~~ */
+
+    psgconv_voices(regs, 0, &v);
+    CHECK(v.period[0] == 0x234);
+    CHECK(v.period[1] == 0xfff);
+    CHECK(v.noise_period == 0x1f);
+    CHECK(v.level[0] == 15);
+    CHECK(v.level[1] == 0);             /* tone disabled */
+    CHECK(v.level[2] == 0);
+    CHECK(v.noise_level == 7);          /* B is louder than C */
+
+    psgconv_voices(regs, 100000UL, &v);
+    CHECK(v.noise_level == 15);         /* C's envelope has reached the top */
+
+    regs[7] = 0x3f;                     /* everything off */
+    psgconv_voices(regs, 0, &v);
+    CHECK(v.level[0] == 0);
+    CHECK(v.noise_level == 0);
+}
+
+static void test_sn76489(void)
+{
+    PSGVOICES v;
+    SNREGS sn;
+    int i;
+
+    memset(&v, 0, sizeof(v));
+    v.period[0] = 0x34;                 /* the bell: about 2.4kHz */
+    v.period[1] = 0x1000 - 1;           /* too low for the SN76489 */
+    v.period[2] = 0;
+    v.level[0] = 15;
+    v.level[1] = 1;
+    v.noise_period = 15;
+    v.noise_level = 8;
+
+    psgconv_sn76489(&v, SN_CLOCK, &sn);
+    CHECK(sn.tone[0] == 47);
+    CHECK(sn.tone[1] == 1023);
+    CHECK(sn.tone[2] == 1);
+    CHECK(sn.att[0] == 0);
+    CHECK(sn.att[1] == 14);
+    CHECK(sn.att[3] == 11);
+    CHECK(sn.noise == 0x05);
+
+    v.noise_period = 1;
+    psgconv_sn76489(&v, SN_CLOCK, &sn);
+    CHECK(sn.noise == 0x04);
+    v.noise_period = 31;
+    psgconv_sn76489(&v, SN_CLOCK, &sn);
+    CHECK(sn.noise == 0x06);
+
+    /* attenuation decreases as the level increases, silence is silent */
+    v.level[0] = 0;
+    psgconv_sn76489(&v, SN_CLOCK, &sn);
+    CHECK(sn.att[0] == 15);
+    for (i = 1; i < 16; i++)
+    {
+        UBYTE prev;
+
+        v.level[0] = i - 1;
+        psgconv_sn76489(&v, SN_CLOCK, &sn);
+        prev = sn.att[0];
+        v.level[0] = i;
+        psgconv_sn76489(&v, SN_CLOCK, &sn);
+        CHECK(sn.att[0] <= prev);
+    }
+}
+
+int main(void)
+{
+    test_envelope();
+    test_voices();
+    test_sn76489();
+
+    if (failures)
+    {
+        printf("psgconv: %d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("psgconv: all checks passed\n");
+
+    return 0;
+}
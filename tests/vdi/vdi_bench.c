@@ -0,0 +1,576 @@
+/*
+ * vdi_bench.c - run the VDI drawing primitives on a memory framebuffer
+ *
+ * The portable C parts of the VDI are built on the host and given the
+ * same random sequence of rectangles, lines, polygons, text, blits and
+ * seed fills in each screen format: 1, 2, 4 and 8 interleaved planes,
+ * and 16-bit.  The number of operations per second is reported, and a
+ * CRC of the resulting screen is compared with the expected one.
+ *
+ * Usage: vdi_bench [-g] [repeat]
+ *      -g      print a new table of expected CRCs, after a VDI change
+ *              which is meant to alter the output
+ *      repeat  number of times each workload is run (the best time is
+ *              reported)
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const double clocks_per_sec = CLOCKS_PER_SEC;    /* redefined by biosdefs.h */
+#undef CLOCKS_PER_SEC
+
+#include "emutos.h"
+#include "asm.h"
+#include "gemdos.h"
+#include "linea.h"
+#include "lineavars.h"
+#include "tosvars.h"
+#include "vdi_defs.h"
+#include "vdistub.h"
+
+#define SCREEN_W    640
+#define SCREEN_H    400
+#define NUM_FORMATS 5
+#define NUM_LOADS   7
+#define TEXT_LEN    40
+
+/* the line-A variables & VDI globals that the code under test uses */
+WORD *CONTRL, *INTIN, *PTSIN, *INTOUT, *PTSOUT;
+UWORD v_planes, v_lin_wr, V_REZ_HZ, V_REZ_VT;
+UBYTE v_planes_shift;
+UBYTE *v_bas_ad;
+WORD DEV_TAB[45], INQ_TAB[45], SIZ_TAB[15];
+WORD MAP_COL[256], REV_MAP_COL[256];
+WORD X1, Y1, X2, Y2, WRT_MODE, CLIP, XMINCL, XMAXCL, YMINCL, YMAXCL;
+WORD COLBIT0, COLBIT1, COLBIT2, COLBIT3;
+UWORD *PATPTR, PATMSK;
+WORD LN_MASK, LSTLIN, COPYTRAN, MFILL;
+WORD XDDA, SCALDIR, MONO, SOURCEX, SOURCEY, DESTX, DESTY;
+UWORD DDAINC, DELX, DELY;
+const UWORD *FBASE;
+WORD FWIDTH, STYLE, WEIGHT, ROFF, LOFF, SCALE, CHUP, TEXTFG;
+WORD *SCRTCHP, SCRPT2;
+WORD line_cw = -1, num_qc_lines;
+Vwk phys_work;
+Vwk *CUR_WORK;
+WORD (*SEEDABORT)(void);
+
+/* this must match the structure in vdi/vdi_raster.c */
+struct blit_frame {
+    WORD b_wd, b_ht, plane_ct;
+    UWORD fg_col, bg_col;
+    UBYTE op_tab[4];
+    WORD s_xmin, s_ymin;
+    UWORD *s_form;
+    WORD s_nxwd, s_nxln, s_nxpl;
+    WORD d_xmin, d_ymin;
+    UWORD *d_form;
+    WORD d_nxwd, d_nxln, d_nxpl;
+    UWORD *p_addr;
+    WORD p_nxln, p_nxpl, p_mask;
+    WORD p_indx;
+    UWORD *s_addr;
+    WORD s_xmax, s_ymax;
+    UWORD *d_addr;
+    WORD d_xmax, d_ymax, inner_ct, dst_wr, src_wr;
+};
+
+extern const Fonthead fnt_st_8x16;
+
+static VwkExt phys_ext;
+static WORD contrl[16], intin[16], intout[16], ptsin[64], ptsout[16];
+static UBYTE font_data[256*16];     /* the 8x16 font, in m68k byte order */
+
+/* what the VDI needs from the rest of EmuTOS */
+void arb_corner(Rect *rect)
+{
+    WORD temp;
+
+    if (rect->x1 > rect->x2)
+    {
+        temp = rect->x1;
+        rect->x1 = rect->x2;
+        rect->x2 = temp;
+    }
+    if (rect->y1 > rect->y2)
+    {
+        temp = rect->y1;
+        rect->y1 = rect->y2;
+        rect->y2 = temp;
+    }
+}
+
+/* same result as the m68k version in util/miscasm.S */
+WORD mul_div_round(WORD mult1, WORD mult2, WORD divisor)
+{
+    LONG n = (LONG)mult1 * mult2 * 2 / divisor;
+
+    return (WORD)((n < 0) ? (n - 1) >> 1 : (n + 1) >> 1);
+}
+
+WORD linea_validate_color_index(WORD colnum)
+{
+    if ((colnum < 0) || (colnum >= numcolors))
+        return 1;
+
+    return colnum;
+}
+
+void bzero_nobuiltin(void *address, size_t size)
+{
+    memset(address, 0, size);
+}
+
+void *dos_alloc_anyram(LONG nbytes)
+{
+    return malloc(nbytes);
+}
+
+WORD dos_free(void *maddr)
+{
+    free(maddr);
+    return 0;
+}
+
+/* the planar text_blt() path is only available in assembler */
+void normal_blit(void *vars, UBYTE *src, UBYTE *dst)
+{
+    fprintf(stderr, "normal_blit() is not available on the host\n");
+    exit(2);
+}
+
+/* same generator as tools/memstres.c, on 32 bits */
+static unsigned long seed;
+
+static unsigned long qdrand(void)
+{
+    seed = (1664525UL*seed + 1013904223UL) & 0xffffffffUL;
+
+    return seed;
+}
+
+static WORD rnd(WORD n)
+{
+    return (qdrand() >> 8) % n;
+}
+
+/* a random colour other than 0, if there is one */
+static WORD rnd_color(void)
+{
+    return (numcolors > 2) ? 1 + rnd(numcolors-1) : 1;
+}
+
+/* a random coordinate, sometimes beyond the screen to exercise clipping */
+static WORD rnd_x(void)
+{
+    return rnd(SCREEN_W + 64) - 32;
+}
+
+static WORD rnd_y(void)
+{
+    return rnd(SCREEN_H + 64) - 32;
+}
+
+static void set_fill(WORD style, WORD index, WORD color)
+{
+    intin[0] = style;
+    vdi_vsf_interior(&phys_work);
+    intin[0] = index;
+    vdi_vsf_style(&phys_work);
+    intin[0] = color;
+    vdi_vsf_color(&phys_work);
+}
+
+static void set_line(WORD type, WORD width, WORD color)
+{
+    intin[0] = type;
+    vdi_vsl_type(&phys_work);
+    ptsin[0] = width;
+    vdi_vsl_width(&phys_work);
+    intin[0] = color;
+    vdi_vsl_color(&phys_work);
+}
+
+/*
+ * the workloads
+ */
+static void do_rect(void)
+{
+    set_fill(1 + rnd(3), 1 + rnd(12), rnd(numcolors));
+    phys_work.wrt_mode = rnd(4);
+
+    ptsin[0] = rnd_x();
+    ptsin[1] = rnd_y();
+    ptsin[2] = rnd_x();
+    ptsin[3] = rnd_y();
+    vdi_vr_recfl(&phys_work);
+}
+
+static void polyline_n(WORD width, WORD points)
+{
+    WORD i;
+
+    set_line(1 + rnd(6), width, rnd_color());
+    phys_work.wrt_mode = rnd(4);
+
+    for (i = 0; i < points; i++)
+    {
+        ptsin[2*i] = rnd_x();
+        ptsin[2*i+1] = rnd_y();
+    }
+    contrl[1] = points;
+    vdi_v_pline(&phys_work);
+}
+
+static void do_line(void)
+{
+    polyline_n(1, 2 + rnd(3));
+}
+
+static void do_wideline(void)
+{
+    polyline_n(5, 2 + rnd(2));
+}
+
+static void do_polygon(void)
+{
+    WORD i;
+
+    set_fill(1 + rnd(3), 1 + rnd(12), rnd(numcolors));
+    phys_work.wrt_mode = rnd(4);
+
+    for (i = 0; i < 5; i++)
+    {
+        ptsin[2*i] = rnd_x();
+        ptsin[2*i+1] = rnd_y();
+    }
+    contrl[1] = 5;
+    vdi_v_fillarea(&phys_work);
+}
+
+/* the common case handled by text_blt(): a monospaced, byte-aligned string */
+static void do_text(void)
+{
+    WORD str[TEXT_LEN], i;
+
+    for (i = 0; i < TEXT_LEN; i++)
+        str[i] = 32 + rnd(224);     /* offset in the font form */
+
+    DELY = fnt_st_8x16.form_height;
+    FWIDTH = fnt_st_8x16.form_width;
+    FBASE = (const UWORD *)font_data;
+    WRT_MODE = rnd(4);
+    TEXTFG = rnd_color();
+    DESTX = rnd(SCREEN_W/8 - TEXT_LEN) * 8;
+    DESTY = rnd(SCREEN_H - DELY);
+
+    direct_screen_blit(TEXT_LEN, str);
+}
+
+/* a copy within the screen, as done by the line-A BitBlt */
+static void do_blit(void)
+{
+    static const UBYTE ops[] = { 3, 6, 7, 12 };    /* S, S^D, S|D, ~S */
+    struct blit_frame info;
+    WORD scale, op;
+
+    bzero(&info, sizeof(info));
+
+    info.b_wd = 16 + rnd(200);
+    info.b_ht = 8 + rnd(100);
+    info.s_xmin = rnd(SCREEN_W - info.b_wd);
+    info.s_ymin = rnd(SCREEN_H - info.b_ht);
+    info.d_xmin = rnd(SCREEN_W - info.b_wd);
+    info.d_ymin = rnd(SCREEN_H - info.b_ht);
+    op = ops[rnd(4)];
+    info.op_tab[0] = info.op_tab[1] = info.op_tab[2] = info.op_tab[3] = op;
+
+    /* a 16-bit screen is handled as one plane, 16 times as wide */
+    scale = TRUECOLOR_MODE ? 16 : 1;
+    info.b_wd *= scale;
+    info.s_xmin *= scale;
+    info.d_xmin *= scale;
+    info.plane_ct = TRUECOLOR_MODE ? 1 : v_planes;
+
+    info.s_form = info.d_form = (UWORD *)v_bas_ad;
+    info.s_nxwd = info.d_nxwd = TRUECOLOR_MODE ? sizeof(WORD) : v_planes * sizeof(WORD);
+    info.s_nxln = info.d_nxln = v_lin_wr;
+    info.s_nxpl = info.d_nxpl = sizeof(WORD);
+
+    linea_blit(&info);
+}
+
+/* a seed fill of one side of a cleared box, split by a line */
+static void do_fill(void)
+{
+    WORD x, y, w, h;
+
+    w = 16 + rnd(200);
+    h = 16 + rnd(150);
+    x = rnd(SCREEN_W - w);
+    y = rnd(SCREEN_H - h);
+
+    set_fill(FIS_SOLID, 1, 0);
+    phys_work.wrt_mode = WM_REPLACE;
+    ptsin[0] = x;
+    ptsin[1] = y;
+    ptsin[2] = x + w - 1;
+    ptsin[3] = y + h - 1;
+    vdi_vr_recfl(&phys_work);
+
+    set_line(1, 1, 1);
+    ptsin[0] = ptsin[6] = ptsin[8] = x;
+    ptsin[1] = ptsin[3] = ptsin[9] = y;
+    ptsin[2] = ptsin[4] = x + w - 1;
+    ptsin[5] = ptsin[7] = y + h - 1;
+    contrl[1] = 5;
+    vdi_v_pline(&phys_work);
+
+    ptsin[0] = x + w/4 + rnd(w/2);
+    ptsin[1] = y;
+    ptsin[2] = x + w/4 + rnd(w/2);
+    ptsin[3] = y + h - 1;
+    contrl[1] = 2;
+    vdi_v_pline(&phys_work);
+
+    /*
+     * the fill must be solid: contourfill() keeps finding the gaps left
+     * by a pattern, since they are not of the border colour either
+     */
+    set_fill(FIS_SOLID, 1, (numcolors > 2) ? 2 + rnd(numcolors-2) : 1);
+    ptsin[0] = x + 1;
+    ptsin[1] = y + h/2;
+    intin[0] = 1;                   /* fill up to the box & the line */
+    vdi_v_contourfill(&phys_work);
+}
+
+static const struct {
+    const char *name;
+    void (*func)(void);
+    long count;
+    int noise;                      /* start from random data, not a clear screen */
+    int bytewise;                   /* planar output is written a byte at a time */
+} loads[NUM_LOADS] = {
+    { "rect", do_rect, 4000, 0, 0 },
+    { "line", do_line, 20000, 0, 0 },
+    { "wideline", do_wideline, 1000, 0, 0 },
+    { "polygon", do_polygon, 2000, 0, 0 },
+    { "text", do_text, 20000, 0, 1 },
+    { "blit", do_blit, 2000, 1, 0 },
+    { "fill", do_fill, 500, 0, 0 },
+};
+
+static const UWORD formats[NUM_FORMATS] = { 1, 2, 4, 8, 16 };
+
+/*
+ * expected CRCs: these must be regenerated with -g whenever the VDI
+ * output is changed on purpose
+ */
+static const unsigned long golden[NUM_FORMATS][NUM_LOADS] = {
+    { 0x3ab0b563UL, 0x68c885b3UL, 0xf1c0beb3UL, 0x8370fdd8UL, 0xcd622ea9UL, 0xb30cb666UL, 0xd4110cc4UL },
+    { 0xd721948dUL, 0x16ca727eUL, 0x62d5a55bUL, 0x539fe356UL, 0x078c8591UL, 0xabd9297dUL, 0x898477bbUL },
+    { 0x2f2440caUL, 0xa2c85cf8UL, 0x16b9fce4UL, 0x393d9dedUL, 0xbee7cf0fUL, 0x1127214eUL, 0xa1fee5aaUL },
+    { 0xb14f3452UL, 0x5c6e1224UL, 0x730dc626UL, 0x425d82b3UL, 0x62c102ecUL, 0x7f4c6452UL, 0x9fb62014UL },
+    { 0xaa892eb9UL, 0x5d030f82UL, 0x8d23b76cUL, 0x4fbbe3a5UL, 0x96f07d51UL, 0x7a018cabUL, 0x1da39702UL },
+};
+
+/*
+ * set up the variables that linea_init() and the VDI would set for the
+ * format, for a full-screen workstation with an identity colour map
+ */
+static void set_format(UWORD planes)
+{
+    static const UBYTE shift[] = { 0, 3, 2, 0, 1 };
+    WORD i;
+
+    v_planes = planes;
+    V_REZ_HZ = SCREEN_W;
+    V_REZ_VT = SCREEN_H;
+    v_lin_wr = TRUECOLOR_MODE ? SCREEN_W * sizeof(WORD) : SCREEN_W / 8 * planes;
+    v_planes_shift = (planes > 4) ? 0 : shift[planes];
+
+    xres = SCREEN_W - 1;
+    yres = SCREEN_H - 1;
+    xsize = ysize = 278;
+    numcolors = (planes > 8) ? 256 : 1 << planes;
+    SIZ_TAB[6] = 40;                /* maximum line width */
+
+    for (i = 0; i < 256; i++)
+    {
+        MAP_COL[i] = REV_MAP_COL[i] = i;
+        phys_ext.palette[i] = (UWORD)(i * 0x9e37U + 0x1234U) & ~0x0020U;
+    }
+
+    XMINCL = YMINCL = 0;
+    XMAXCL = xres;
+    YMAXCL = yres;
+    CLIP = 1;
+
+    bzero(&phys_work, sizeof(phys_work));
+    phys_work.clip = 1;
+    phys_work.xmx_clip = xres;
+    phys_work.ymx_clip = yres;
+    phys_work.line_width = 1;
+    phys_work.ext = &phys_ext;
+    CUR_WORK = &phys_work;
+    line_cw = -1;
+}
+
+static unsigned long crc32(unsigned long crc, UBYTE c)
+{
+    int i;
+
+    crc ^= c;
+    for (i = 0; i < 8; i++)
+        crc = (crc >> 1) ^ (0xedb88320UL & -(crc & 1));
+
+    return crc;
+}
+
+/*
+ * the CRC of the screen as it would be in m68k memory: words are
+ * written big-endian, except that the planar text is written bytewise
+ */
+static unsigned long screen_crc(int bytewise)
+{
+    unsigned long crc = 0xffffffffUL;
+    UWORD *w = (UWORD *)v_bas_ad;
+    long i, n = (long)v_lin_wr * SCREEN_H;
+
+    if (bytewise && !TRUECOLOR_MODE)
+    {
+        for (i = 0; i < n; i++)
+            crc = crc32(crc, v_bas_ad[i]);
+    }
+    else
+    {
+        for (i = 0; i < n / 2; i++)
+        {
+            crc = crc32(crc, w[i] >> 8);
+            crc = crc32(crc, w[i] & 0xff);
+        }
+    }
+
+    return ~crc & 0xffffffffUL;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned long crcs[NUM_FORMATS][NUM_LOADS];
+    int generate = 0, repeat = 1, failed = 0;
+    int f, l, r;
+    long i, n;
+    const UWORD *s;
+    double t, best;
+    clock_t start;
+
+    if ((argc > 1) && !strcmp(argv[1], "-g"))
+    {
+        generate = 1;
+        argc--;
+        argv++;
+    }
+    if (argc > 1)
+        repeat = atoi(argv[1]);
+    if ((argc > 2) || (repeat < 1))
+    {
+        fprintf(stderr, "usage: vdi_bench [-g] [repeat]\n");
+        return 1;
+    }
+
+    CONTRL = contrl;
+    INTIN = intin;
+    INTOUT = intout;
+    PTSIN = ptsin;
+    PTSOUT = ptsout;
+
+    for (i = 0, s = fnt_st_8x16.dat_table; i < (long)sizeof(font_data); i += 2, s++)
+    {
+        font_data[i] = *s >> 8;
+        font_data[i+1] = *s & 0xff;
+    }
+
+    v_bas_ad = malloc(SCREEN_W * SCREEN_H * sizeof(WORD));
+    if (!v_bas_ad)
+    {
+        fprintf(stderr, "vdi_bench: out of memory\n");
+        return 1;
+    }
+
+    printf("%-10s", "ops/s");
+    for (f = 0; f < NUM_FORMATS; f++)
+        printf(" %8u%s", formats[f], (formats[f] > 8) ? "-bit" : "-pl.");
+    printf("\n");
+
+    for (l = 0; l < NUM_LOADS; l++)
+    {
+        printf("%-10s", loads[l].name);
+        for (f = 0; f < NUM_FORMATS; f++)
+        {
+            set_format(formats[f]);
+            n = (long)v_lin_wr * SCREEN_H;
+            for (r = 0, best = 0.0; r < repeat; r++)
+            {
+                seed = 12345;
+                if (loads[l].noise)
+                {
+                    for (i = 0; i < n; i++)
+                        v_bas_ad[i] = qdrand() >> 16;
+                }
+                else bzero(v_bas_ad, n);
+
+                start = clock();
+                for (i = 0; i < loads[l].count; i++)
+                    loads[l].func();
+                t = (double)(clock() - start) / clocks_per_sec;
+                if ((r == 0) || (t < best))
+                    best = t;
+
+                crcs[f][l] = screen_crc(loads[l].bytewise);
+                if (!generate && (crcs[f][l] != golden[f][l]))
+                    failed++;
+            }
+            printf(" %12.0f", (best > 0.0) ? loads[l].count / best : 0.0);
+            fflush(stdout);
+        }
+        printf("\n");
+    }
+
+    if (generate)
+    {
+        printf("\nstatic const unsigned long golden[NUM_FORMATS][NUM_LOADS] = {\n");
+        for (f = 0; f < NUM_FORMATS; f++)
+        {
+            printf("    {");
+            for (l = 0; l < NUM_LOADS; l++)
+                printf(" 0x%08lxUL%s", crcs[f][l], (l < NUM_LOADS-1) ? "," : "");
+            printf(" },\n");
+        }
+        printf("};\n");
+        return 0;
+    }
+
+    for (f = 0; f < NUM_FORMATS; f++)
+    {
+        for (l = 0; l < NUM_LOADS; l++)
+        {
+            if (crcs[f][l] != golden[f][l])
+                printf("FAILED: %s, %u planes: CRC 0x%08lx, expected 0x%08lx\n",
+                        loads[l].name, formats[f], crcs[f][l], golden[f][l]);
+        }
+    }
+    if (failed)
+        return 1;
+
+    printf("All CRCs match\n");
+
+    return 0;
+}
@@ -0,0 +1,304 @@
+/*
+ * aesstat.c : display the AES per-process scheduling statistics, the
+ *             object drawing statistics, and the call & message queue
+ *             statistics
+ *
+ * These are only available if EmuTOS was built with
+ * CONF_WITH_AES_SCHED_STATS, CONF_WITH_AES_DRAW_STATS and/or
+ * CONF_WITH_AES_CALL_STATS set to 1.
+ *
+ * Compile with:
+ *      m68k-atari-mint-gcc -o AESSTAT.TOS -Wall aesstat.c
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <osbind.h>
+
+#define COOKIE_AESS 0x41455353L
+#define COOKIE_AESD 0x41455344L
+#define COOKIE_AESC 0x41455343L
+#define AP_NAMELEN  8
+#define TOP_CALLS   12
+
+/*
+ * these must match the structures in aes/struct.h
+ */
+typedef struct
+{
+    char s_name[AP_NAMELEN];
+    unsigned long s_switches;
+    unsigned long s_waits;
+    unsigned long s_waitms;
+    long s_waitstart;
+    short s_waiting;
+} SCHEDSTAT;
+
+typedef struct
+{
+    short si_npds;
+    short si_statsize;
+    unsigned long si_idle;
+    unsigned long si_forks;
+    /* SCHEDSTAT si_pd[] follows */
+} SCHEDINFO;
+
+/*
+ * this must match the structure in aes/gemgraf.h
+ */
+typedef struct
+{
+    unsigned long ds_draws;
+    unsigned long ds_objects;
+    unsigned long ds_culled;
+    unsigned long ds_attrsaved;
+    unsigned long ds_fillsaved;
+    unsigned long ds_lastsaved;
+} DRAWSTAT;
+
+/*
+ * these must match the structures in aes/struct.h
+ */
+#define NUM_QSLOTS      8
+#define QLAT_BUCKETS    12
+
+typedef struct
+{
+    unsigned long c_calls;
+    unsigned long c_time_hi;
+    unsigned long c_time;
+    unsigned long c_max;
+} CALLSTAT;
+
+typedef struct
+{
+    char a_name[AP_NAMELEN];
+    CALLSTAT a_calls;
+    unsigned long a_msgs;
+    short a_maxdepth;
+    short a_nq;
+    short a_qlost;
+    unsigned long a_lat[QLAT_BUCKETS];
+    unsigned long a_qtime[NUM_QSLOTS];
+    short a_qbytes[NUM_QSLOTS];
+} APPSTAT;
+
+typedef struct
+{
+    short ci_nops;
+    short ci_npds;
+    short ci_appsize;
+    short ci_reserved;
+    unsigned long ci_hz;
+    /* CALLSTAT ci_op[ci_nops] follows, then APPSTAT ci_pd[ci_npds] */
+} CALLINFO;
+
+static const struct
+{
+    short opcode;
+    const char *name;
+} aes_names[] =
+{
+    { 10, "appl_init" }, { 11, "appl_read" }, { 12, "appl_write" },
+    { 13, "appl_find" }, { 14, "appl_tplay" }, { 15, "appl_trecord" },
+    { 17, "appl_yield" }, { 19, "appl_exit" }, { 20, "evnt_keybd" },
+    { 21, "evnt_button" }, { 22, "evnt_mouse" }, { 23, "evnt_mesag" },
+    { 24, "evnt_timer" }, { 25, "evnt_multi" }, { 26, "evnt_dclick" },
+    { 30, "menu_bar" }, { 31, "menu_icheck" }, { 32, "menu_ienable" },
+    { 33, "menu_tnormal" }, { 34, "menu_text" }, { 35, "menu_register" },
+    { 36, "menu_popup" }, { 37, "menu_attach" }, { 38, "menu_istart" },
+    { 39, "menu_settings" }, { 40, "objc_add" }, { 41, "objc_delete" },
+    { 42, "objc_draw" }, { 43, "objc_find" }, { 44, "objc_offset" },
+    { 45, "objc_order" }, { 46, "objc_edit" }, { 47, "objc_change" },
+    { 48, "objc_sysvar" }, { 50, "form_do" }, { 51, "form_dial" },
+    { 52, "form_alert" }, { 53, "form_error" }, { 54, "form_center" },
+    { 55, "form_keybd" }, { 56, "form_button" }, { 70, "graf_rubbox" },
+    { 71, "graf_dragbox" }, { 72, "graf_mbox" }, { 73, "graf_growbox" },
+    { 74, "graf_shrinkbox" }, { 75, "graf_watchbox" }, { 76, "graf_slidebox" },
+    { 77, "graf_handle" }, { 78, "graf_mouse" }, { 79, "graf_mkstate" },
+    { 80, "scrp_read" }, { 81, "scrp_write" }, { 82, "scrp_clear" },
+    { 90, "fsel_input" }, { 91, "fsel_exinput" }, { 100, "wind_create" },
+    { 101, "wind_open" }, { 102, "wind_close" }, { 103, "wind_delete" },
+    { 104, "wind_get" }, { 105, "wind_set" }, { 106, "wind_find" },
+    { 107, "wind_update" }, { 108, "wind_calc" }, { 109, "wind_new" },
+    { 110, "rsrc_load" }, { 111, "rsrc_free" }, { 112, "rsrc_gaddr" },
+    { 113, "rsrc_saddr" }, { 114, "rsrc_obfix" }, { 120, "shel_read" },
+    { 121, "shel_write" }, { 122, "shel_get" }, { 123, "shel_put" },
+    { 124, "shel_find" }, { 125, "shel_envrn" }, { 126, "shel_rdef" },
+    { 127, "shel_wdef" }, { 130, "appl_getinfo" }
+};
+
+static long cookie_tag;
+static long cookie_value;
+
+static long find_cookie(void)
+{
+    long *jar = *(long **)0x5a0;
+
+    if (!jar)
+        return 0;
+
+    for ( ; *jar; jar += 2)
+    {
+        if (*jar == cookie_tag)
+        {
+            cookie_value = jar[1];
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static void show_draw(void)
+{
+    DRAWSTAT *ds = (DRAWSTAT *)cookie_value;
+
+    printf("objc_draw calls: %lu, objects drawn: %lu, subtrees culled: %lu\r\n",
+            ds->ds_draws, ds->ds_objects, ds->ds_culled);
+    printf("VDI calls saved: %lu attribute, %lu fill (%lu in latest draw)\r\n",
+            ds->ds_attrsaved, ds->ds_fillsaved, ds->ds_lastsaved);
+}
+
+static const char *aes_name(int opcode)
+{
+    unsigned int i;
+
+    for (i = 0; i < sizeof(aes_names) / sizeof(aes_names[0]); i++)
+        if (aes_names[i].opcode == opcode)
+            return aes_names[i].name;
+
+    return "?";
+}
+
+static double call_ms(const CALLINFO *ci, const CALLSTAT *c)
+{
+    return (c->c_time_hi * 4294967296.0 + c->c_time) * 1000.0 / ci->ci_hz;
+}
+
+static int show_calls(void)
+{
+    CALLINFO *ci = (CALLINFO *)cookie_value;
+    CALLSTAT *ops = (CALLSTAT *)(ci + 1);
+    APPSTAT *a = (APPSTAT *)(ops + ci->ci_nops);
+    char name[AP_NAMELEN+1];
+    int order[256], i, j, n, best;
+
+    if (ci->ci_appsize != sizeof(APPSTAT))
+    {
+        printf("Unexpected APPSTAT size %d\r\n", ci->ci_appsize);
+        return 1;
+    }
+
+    /* the functions used, by decreasing total time */
+    for (i = 0, n = 0; i < ci->ci_nops && n < 256; i++)
+        if (ops[i].c_calls)
+            order[n++] = i;
+    for (i = 0; i < n && i < TOP_CALLS; i++)
+    {
+        for (j = i+1, best = i; j < n; j++)
+            if (call_ms(ci, &ops[order[j]]) > call_ms(ci, &ops[order[best]]))
+                best = j;
+        j = order[i];
+        order[i] = order[best];
+        order[best] = j;
+    }
+
+    printf("op  function          calls   total ms   max ms (evnt_* include waiting)\r\n");
+    for (i = 0; i < n && i < TOP_CALLS; i++)
+    {
+        CALLSTAT *c = &ops[order[i]];
+
+        printf("%3d %-14s %8lu %10.1f %8.1f\r\n", order[i], aes_name(order[i]),
+                c->c_calls, call_ms(ci, c), c->c_max * 1000.0 / ci->ci_hz);
+    }
+
+    printf("\r\npid name         calls   total ms   msgs maxq  latency ms: <1 <2 <4 ... >=1024\r\n");
+    for (i = 0; i < ci->ci_npds; i++, a++)
+    {
+        memcpy(name, a->a_name, AP_NAMELEN);
+        name[AP_NAMELEN] = '\0';
+        printf("%3d %-8s %9lu %10.1f %6lu %4d ", i, name, a->a_calls.c_calls,
+                call_ms(ci, &a->a_calls), a->a_msgs, a->a_maxdepth);
+        for (j = 0; j < QLAT_BUCKETS; j++)
+            printf(" %lu", a->a_lat[j]);
+        printf("\r\n");
+    }
+
+    return 0;
+}
+
+static int show_sched(void)
+{
+    SCHEDINFO *si;
+    SCHEDSTAT *s;
+    char name[AP_NAMELEN+1];
+    int i;
+
+    si = (SCHEDINFO *)cookie_value;
+    if (si->si_statsize != sizeof(SCHEDSTAT))
+    {
+        printf("Unexpected SCHEDSTAT size %d\r\n", si->si_statsize);
+        return 1;
+    }
+
+    printf("idle passes: %lu, fork ring entries: %lu\r\n\r\n", si->si_idle, si->si_forks);
+    printf("pid name      switches     waits  wait(ms) state\r\n");
+
+    s = (SCHEDSTAT *)(si + 1);
+    for (i = 0; i < si->si_npds; i++, s++)
+    {
+        memcpy(name, s->s_name, AP_NAMELEN);
+        name[AP_NAMELEN] = '\0';
+        printf("%3d %-8s %9lu %9lu %9lu %s\r\n", i, name,
+                s->s_switches, s->s_waits, s->s_waitms,
+                s->s_waiting ? "waiting" : "ready");
+    }
+
+    return 0;
+}
+
+int main(void)
+{
+    int found = 0, rc = 0;
+
+    cookie_tag = COOKIE_AESS;
+    if (Supexec(find_cookie))
+    {
+        rc = show_sched();
+        found++;
+    }
+
+    cookie_tag = COOKIE_AESD;
+    if (Supexec(find_cookie))
+    {
+        if (found)
+            printf("\r\n");
+        show_draw();
+        found++;
+    }
+
+    cookie_tag = COOKIE_AESC;
+    if (Supexec(find_cookie))
+    {
+        if (found)
+            printf("\r\n");
+        rc |= show_calls();
+        found++;
+    }
+
+    if (!found)
+    {
+        printf("No AESS/AESD/AESC cookie: the AES is not running, or was built\r\n");
+        printf("without CONF_WITH_AES_SCHED_STATS, CONF_WITH_AES_DRAW_STATS\r\n");
+        printf("or CONF_WITH_AES_CALL_STATS\r\n");
+        return 1;
+    }
+
+    return rc;
+}
@@ -0,0 +1,107 @@
+/*
+ * boottime.c : display the boot timeline recorded by the BIOS
+ *
+ * This is only available if EmuTOS was built with CONF_WITH_BOOT_TIMELINE
+ * set to 1.
+ *
+ * Compile with:
+ *      m68k-atari-mint-gcc -o BOOTTIME.TOS -Wall boottime.c
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#include <stdio.h>
+#include <osbind.h>
+
+#define COOKIE_BTIM 0x4254494dL
+
+/*
+ * these must match the structures in bios/boottime.h
+ */
+typedef struct
+{
+    const char *bt_name;
+    unsigned long bt_ticks;
+    unsigned long bt_fine;
+} BOOTSTEP;
+
+typedef struct
+{
+    unsigned short bt_nsteps;
+    unsigned short bt_maxsteps;
+    unsigned long bt_fine_hz;
+    /* BOOTSTEP bt_step[bt_maxsteps] follows */
+} BOOTTIMELINE;
+
+static long cookie_value;
+
+static long find_cookie(void)
+{
+    long *jar = *(long **)0x5a0;
+
+    if (!jar)
+        return 0;
+
+    for ( ; *jar; jar += 2)
+    {
+        if (*jar == COOKIE_BTIM)
+        {
+            cookie_value = jar[1];
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * time of a step, in microseconds since the system timer was started
+ */
+static unsigned long step_us(const BOOTTIMELINE *bt, const BOOTSTEP *s)
+{
+    unsigned long us = s->bt_ticks * 5000UL;
+
+    if (bt->bt_fine_hz >= 1000000UL)
+        us += s->bt_fine / (bt->bt_fine_hz / 1000000UL);
+
+    return us;
+}
+
+int main(void)
+{
+    BOOTTIMELINE *bt;
+    BOOTSTEP *s;
+    unsigned long t, next;
+    int i;
+
+    if (!Supexec(find_cookie))
+    {
+        printf("No BTIM cookie: EmuTOS was built without CONF_WITH_BOOT_TIMELINE\r\n");
+        return 1;
+    }
+
+    bt = (BOOTTIMELINE *)cookie_value;
+    s = (BOOTSTEP *)(bt + 1);
+
+    printf("    start(ms)  length(ms) step\r\n");
+    for (i = 0; i < bt->bt_nsteps; i++, s++)
+    {
+        t = step_us(bt, s);
+        if (i + 1 < bt->bt_nsteps)
+        {
+            next = step_us(bt, s + 1);
+            printf("%9lu.%03lu %7lu.%03lu %s\r\n", t / 1000, t % 1000,
+                    (next - t) / 1000, (next - t) % 1000, s->bt_name);
+        }
+        else
+            printf("%9lu.%03lu %11s %s\r\n", t / 1000, t % 1000, "", s->bt_name);
+    }
+
+    if (bt->bt_nsteps == bt->bt_maxsteps)
+        printf("The timeline is full, later steps were not recorded\r\n");
+
+    return 0;
+}
@@ -0,0 +1,189 @@
+/*
+ * cachebench.c : compare the cache modes of the Foenix memory map
+ *
+ * This times memcpy(), memset() and a screen fill with each combination
+ * of the RAM and video RAM cache modes, then restores the original modes.
+ * It needs EmuTOS built with CONF_WITH_CACHE_MAP set to 1, running on a
+ * 68040 or 68060.
+ *
+ * Compile with:
+ *      m68k-atari-mint-gcc -o CACHEBEN.TOS -Wall cachebench.c
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <osbind.h>
+
+#define COOKIE_FCMP 0x46434d50L
+
+#define CACHE_MODE_WRITETHROUGH 0
+#define CACHE_MODE_COPYBACK     1
+#define CACHE_MODE_PRECISE      2
+
+#define CACHEMAP_PMMU           0x0002
+
+/*
+ * this must match the structure in bios/cachemap.h
+ */
+typedef struct
+{
+    unsigned short cm_version;
+    unsigned short cm_flags;
+    unsigned short cm_ram_mode;
+    unsigned short cm_vram_mode;
+    long (*cm_set)(long ram_mode, long vram_mode);
+} CACHEMAP;
+
+static const char *const modename[3] = { "write-through", "copyback", "precise" };
+
+#define BUFSIZE     (64 * 1024L)
+#define RUN_TICKS   200             /* 1 second of the 200 Hz timer */
+
+static long cookie_value;
+static CACHEMAP *cm;
+static long new_ram_mode, new_vram_mode, set_result;
+
+static long find_cookie(void)
+{
+    long *jar = *(long **)0x5a0;
+
+    if (!jar)
+        return 0;
+
+    for ( ; *jar; jar += 2)
+    {
+        if (*jar == COOKIE_FCMP)
+        {
+            cookie_value = jar[1];
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static long set_modes(void)
+{
+    set_result = cm->cm_set(new_ram_mode, new_vram_mode);
+    return 0;
+}
+
+static long read_hz_200(void)
+{
+    return *(volatile long *)0x4ba;
+}
+
+static long ticks(void)
+{
+    return Supexec(read_hz_200);
+}
+
+static char *src, *dst, *screen;
+static long screen_size;
+
+/*
+ * return the throughput of 'op' in KB/s, running it for about RUN_TICKS
+ */
+static long kbps(void (*op)(void), long bytes)
+{
+    long start, end, count = 0;
+
+    /* wait for a tick boundary */
+    start = ticks();
+    while ((end = ticks()) == start)
+        ;
+    start = end;
+
+    do
+    {
+        op();
+        count++;
+        end = ticks();
+    } while (end - start < RUN_TICKS);
+
+    return (count * (bytes / 1024) * 200) / (end - start);
+}
+
+static void op_memcpy(void)
+{
+    memcpy(dst, src, BUFSIZE);
+}
+
+static void op_memset(void)
+{
+    memset(dst, 0x55, BUFSIZE);
+}
+
+static void op_screen(void)
+{
+    memset(screen, 0xff, screen_size);
+}
+
+int main(void)
+{
+    short old_ram_mode, old_vram_mode, ram_mode, vram_mode;
+    char *line_a;
+
+    if (!Supexec(find_cookie))
+    {
+        printf("No FCMP cookie: EmuTOS was built without CONF_WITH_CACHE_MAP,\r\n");
+        printf("or the CPU is not a 68040 or 68060\r\n");
+        return 1;
+    }
+
+    cm = (CACHEMAP *)cookie_value;
+    old_ram_mode = cm->cm_ram_mode;
+    old_vram_mode = cm->cm_vram_mode;
+    printf("Cache map set by the %s, RAM %s, video RAM %s\r\n\r\n",
+            (cm->cm_flags & CACHEMAP_PMMU) ? "PMMU" : "TTRs",
+            modename[old_ram_mode], modename[old_vram_mode]);
+
+    src = malloc(BUFSIZE);
+    dst = malloc(BUFSIZE);
+    if (!src || !dst)
+    {
+        printf("Not enough memory\r\n");
+        return 1;
+    }
+    memset(src, 0xaa, BUFSIZE);
+
+    /* bytes per line and number of lines, from the line-A variables */
+    __asm__ volatile ("dc.w 0xa000\n\tmove.l %%a0,%0"
+                      : "=g"(line_a) : : "d0", "d1", "d2", "a0", "a1", "a2");
+    screen = Logbase();
+    screen_size = (long)*(unsigned short *)(line_a - 2) * *(unsigned short *)(line_a - 4);
+
+    printf("RAM mode       video RAM mode  memcpy KB/s  memset KB/s  screen KB/s\r\n");
+    for (ram_mode = CACHE_MODE_WRITETHROUGH; ram_mode <= CACHE_MODE_PRECISE; ram_mode++)
+    {
+        for (vram_mode = CACHE_MODE_WRITETHROUGH; vram_mode <= CACHE_MODE_PRECISE; vram_mode++)
+        {
+            /* video RAM must stay visible to VICKY */
+            if (vram_mode == CACHE_MODE_COPYBACK)
+                continue;
+
+            new_ram_mode = ram_mode;
+            new_vram_mode = vram_mode;
+            Supexec(set_modes);
+            if (set_result < 0)
+                continue;
+
+            printf("%-14s %-15s %11ld  %11ld  %11ld\r\n",
+                    modename[set_result >> 8], modename[set_result & 0xff],
+                    kbps(op_memcpy, BUFSIZE), kbps(op_memset, BUFSIZE),
+                    kbps(op_screen, screen_size));
+        }
+    }
+
+    new_ram_mode = old_ram_mode;
+    new_vram_mode = old_vram_mode;
+    Supexec(set_modes);
+
+    return 0;
+}
@@ -0,0 +1,376 @@
+/*
+ * lz4pack.c - Compress an EmuTOS image in the LZ4 block format
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+/*
+ * The output is decompressed at boot by util/unlz4.S.  Compression only
+ * happens at build time, so this spends time on long hash chains and lazy
+ * matching to get the best ratio the format allows; the decompression
+ * speed does not depend on it.
+ *
+ * If the map file is given, the compression ratio of each section is
+ * reported, along with an estimate of the boot time spent decompressing
+ * compared to copying the uncompressed image from the flash.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#define MIN_MATCH       4
+#define LAST_LITERALS   5       /* the last bytes are always literals */
+#define MF_LIMIT        12      /* no match may start after end - MF_LIMIT */
+#define MAX_OFFSET      65535
+#define HASH_BITS       16
+#define HASH_SIZE       (1L << HASH_BITS)
+#define MAX_CHAIN       4096    /* candidates tried for each position */
+
+/*
+ * Cost model of util/unlz4.S on a 68000, in clock cycles without wait
+ * states, from the instruction timings of the loops.  The copy is the
+ * move.l loop of a plain RAM loader.
+ */
+#define CPU_MHZ             20L     /* as on the A2560U */
+#define SEQUENCE_CYCLES     260L
+#define BYTE_CYCLES         22L     /* move.b (a3)+,(a1)+ and dbra */
+#define EXTRA_CYCLES        40L     /* per extra length byte */
+#define COPY_CYCLES_PER_LONG 36L
+
+typedef struct
+{
+    const char *name;
+    const char *start_symbol;
+    const char *end_symbol;
+    unsigned long start;        /* offsets in the image */
+    unsigned long end;
+    unsigned long packed;       /* bytes of compressed data */
+} SECTION;
+
+static SECTION sections[] =
+{
+    { "TEXT",       "__text",       "__etext",      0, 0, 0 },
+    { "  hot TEXT", "__hot_text",   "__ehot_text",  0, 0, 0 },
+    { "DATA",       "__data",       "__edata",      0, 0, 0 }
+};
+#define NSECTIONS   (sizeof(sections) / sizeof(sections[0]))
+
+static const char *g_argv0;
+
+static unsigned char *in;
+static unsigned long insize;
+static unsigned char *out;
+static unsigned long outsize;
+static long *head;
+static long *chain;
+
+/* statistics for the cost model */
+static unsigned long nsequences, nbytes, nextra;
+
+/* Charge 'count' bytes of compressed output to the sections containing 'pos' */
+static void charge(unsigned long pos, unsigned long count)
+{
+    unsigned int i;
+
+    for (i = 0; i < NSECTIONS; i++)
+    {
+        if (pos >= sections[i].start && pos < sections[i].end)
+            sections[i].packed += count;
+    }
+}
+
+static void put_byte(unsigned long pos, unsigned char b)
+{
+    out[outsize++] = b;
+    charge(pos, 1);
+}
+
+static void put_length(unsigned long pos, unsigned long length)
+{
+    while (length >= 255)
+    {
+        put_byte(pos, 255);
+        nextra++;
+        length -= 255;
+    }
+    put_byte(pos, (unsigned char)length);
+    nextra++;
+}
+
+/*
+ * Emit the literals from 'start' for 'nlit' bytes, followed by a match
+ * of 'len' bytes at 'offset' (no match if len is 0)
+ */
+static void put_sequence(unsigned long start, unsigned long nlit,
+                         unsigned long offset, unsigned long len)
+{
+    unsigned long lit_nibble = nlit < 15 ? nlit : 15;
+    unsigned long match_nibble = 0;
+    unsigned long i;
+
+    if (len)
+        match_nibble = (len - MIN_MATCH) < 15 ? (len - MIN_MATCH) : 15;
+
+    put_byte(start, (unsigned char)((lit_nibble << 4) | match_nibble));
+    nsequences++;
+
+    if (lit_nibble == 15)
+        put_length(start, nlit - 15);
+    for (i = 0; i < nlit; i++)
+        put_byte(start + i, in[start + i]);
+    nbytes += nlit;
+
+    if (len)
+    {
+        put_byte(start + nlit, (unsigned char)offset);
+        put_byte(start + nlit, (unsigned char)(offset >> 8));
+        if (match_nibble == 15)
+            put_length(start + nlit, len - MIN_MATCH - 15);
+        nbytes += len;
+    }
+}
+
+static unsigned long hash(unsigned long pos)
+{
+    unsigned long v = ((unsigned long)in[pos] << 24) | ((unsigned long)in[pos + 1] << 16)
+                    | ((unsigned long)in[pos + 2] << 8) | in[pos + 3];
+
+    return ((v * 2654435761UL) & 0xffffffffUL) >> (32 - HASH_BITS);
+}
+
+static void insert(unsigned long pos)
+{
+    unsigned long h;
+
+    if (pos + MIN_MATCH > insize)
+        return;
+
+    h = hash(pos);
+    chain[pos] = head[h];
+    head[h] = (long)pos;
+}
+
+/* Return the length of the longest match for 'pos', and its offset */
+static unsigned long find_match(unsigned long pos, unsigned long *poffset)
+{
+    unsigned long limit = insize - LAST_LITERALS;
+    unsigned long best = 0, len;
+    long cand;
+    int depth;
+
+    if (pos + MF_LIMIT > insize)
+        return 0;
+
+    for (cand = head[hash(pos)], depth = 0;
+         cand >= 0 && pos - (unsigned long)cand <= MAX_OFFSET && depth < MAX_CHAIN;
+         cand = chain[cand], depth++)
+    {
+        if (in[cand + best] != in[pos + best])
+            continue;
+        for (len = 0; pos + len < limit && in[cand + len] == in[pos + len]; len++)
+            ;
+        if (len > best)
+        {
+            best = len;
+            *poffset = pos - (unsigned long)cand;
+            if (pos + best >= limit)
+                break;
+        }
+    }
+
+    return best >= MIN_MATCH ? best : 0;
+}
+
+static void compress(void)
+{
+    unsigned long pos = 0, anchor = 0;
+    unsigned long len, offset = 0, next_len, next_offset = 0;
+    long h;
+
+    for (h = 0; h < HASH_SIZE; h++)
+        head[h] = -1;
+
+    while (pos < insize)
+    {
+        len = find_match(pos, &offset);
+        if (!len)
+        {
+            insert(pos++);
+            continue;
+        }
+
+        /* lazy matching: prefer a longer match starting at the next byte */
+        insert(pos);
+        next_len = find_match(pos + 1, &next_offset);
+        if (next_len > len)
+        {
+            pos++;
+            continue;
+        }
+
+        put_sequence(anchor, pos - anchor, offset, len);
+        for (pos++, len--; len; len--)
+            insert(pos++);
+        anchor = pos;
+    }
+
+    put_sequence(anchor, insize - anchor, 0, 0);
+}
+
+/* Find the address of 'symbol' in a GNU ld map file */
+static int find_symbol(FILE *map, const char *symbol, unsigned long *paddr)
+{
+    char line[1024], name[256];
+    unsigned long addr;
+
+    rewind(map);
+    while (fgets(line, sizeof(line), map))
+    {
+        if (sscanf(line, " 0x%lx %255s", &addr, name) == 2 && !strcmp(name, symbol))
+        {
+            *paddr = addr;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static void read_sections(const char *mapfilename)
+{
+    FILE *map;
+    unsigned long base, start, end;
+    unsigned int i;
+
+    map = fopen(mapfilename, "r");
+    if (!map)
+    {
+        fprintf(stderr, "%s: %s: %s\n", g_argv0, mapfilename, strerror(errno));
+        return;
+    }
+
+    if (find_symbol(map, "__text", &base))
+    {
+        for (i = 0; i < NSECTIONS; i++)
+        {
+            if (find_symbol(map, sections[i].start_symbol, &start)
+             && find_symbol(map, sections[i].end_symbol, &end)
+             && start >= base && end >= start)
+            {
+                sections[i].start = start - base;
+                sections[i].end = end - base;
+            }
+        }
+    }
+
+    fclose(map);
+}
+
+static void report(const char *infilename, const char *outfilename)
+{
+    unsigned long size, dec_cycles, copy_cycles, flash_words;
+    unsigned int i;
+
+    printf("# %s: %lu bytes compressed to %lu bytes (%lu%%) in %s\n",
+           infilename, insize, outsize, insize ? outsize * 100 / insize : 0, outfilename);
+
+    for (i = 0; i < NSECTIONS; i++)
+    {
+        size = sections[i].end - sections[i].start;
+        if (!size)
+            continue;
+        printf("#   %-10s %8lu -> %8lu bytes (%lu%%)\n", sections[i].name,
+               size, sections[i].packed, sections[i].packed * 100 / size);
+    }
+
+    dec_cycles = nsequences * SEQUENCE_CYCLES + nbytes * BYTE_CYCLES + nextra * EXTRA_CYCLES;
+    copy_cycles = (insize + 3) / 4 * COPY_CYCLES_PER_LONG;
+    flash_words = (insize + 1) / 2;
+    printf("# Estimated boot time on a 68000 at %ld MHz, without flash wait states:\n"
+           "#   decompression %lu ms, copy %lu ms\n",
+           CPU_MHZ, dec_cycles / (CPU_MHZ * 1000), copy_cycles / (CPU_MHZ * 1000));
+
+    /* the decompressor reads each compressed byte once, the copy reads each word */
+    if (flash_words > outsize && dec_cycles > copy_cycles)
+        printf("#   decompression is faster with more than %lu wait states per flash access\n",
+               (dec_cycles - copy_cycles) / (flash_words - outsize));
+    else if (dec_cycles <= copy_cycles)
+        printf("#   decompression is always faster\n");
+    else
+        printf("#   decompression is never faster\n");
+}
+
+int main(int argc, char *argv[])
+{
+    const char *infilename, *outfilename;
+    FILE *infile, *outfile;
+    long size;
+
+    g_argv0 = argv[0];
+
+    if (argc != 3 && argc != 4)
+    {
+        fprintf(stderr, "usage: %s <infile> <outfile> [<mapfile>]\n", g_argv0);
+        return 1;
+    }
+    infilename = argv[1];
+    outfilename = argv[2];
+
+    infile = fopen(infilename, "rb");
+    if (!infile)
+    {
+        fprintf(stderr, "%s: %s: %s\n", g_argv0, infilename, strerror(errno));
+        return 1;
+    }
+    if (fseek(infile, 0, SEEK_END) != 0 || (size = ftell(infile)) < 0)
+    {
+        fprintf(stderr, "%s: %s: %s\n", g_argv0, infilename, strerror(errno));
+        return 1;
+    }
+    rewind(infile);
+    insize = (unsigned long)size;
+
+    in = malloc(insize + 1);
+    out = malloc(insize + insize / 255 + 16);
+    head = malloc(HASH_SIZE * sizeof(long));
+    chain = malloc((insize + 1) * sizeof(long));
+    if (!in || !out || !head || !chain)
+    {
+        fprintf(stderr, "%s: out of memory\n", g_argv0);
+        return 1;
+    }
+
+    if (fread(in, 1, insize, infile) != insize)
+    {
+        fprintf(stderr, "%s: %s: read error\n", g_argv0, infilename);
+        return 1;
+    }
+    fclose(infile);
+
+    if (argc == 4)
+        read_sections(argv[3]);
+
+    compress();
+
+    outfile = fopen(outfilename, "wb");
+    if (!outfile)
+    {
+        fprintf(stderr, "%s: %s: %s\n", g_argv0, outfilename, strerror(errno));
+        return 1;
+    }
+    if (fwrite(out, 1, outsize, outfile) != outsize || fclose(outfile) != 0)
+    {
+        fprintf(stderr, "%s: %s: write error\n", g_argv0, outfilename);
+        remove(outfilename);
+        return 1;
+    }
+
+    report(infilename, outfilename);
+
+    return 0;
+}
@@ -0,0 +1,84 @@
+/*
+ * osmstat.c : display the BDOS internal memory pool statistics
+ *
+ * These are only available if EmuTOS was built with
+ * CONF_WITH_DYNAMIC_OSMEM set to 1.
+ *
+ * Compile with:
+ *      m68k-atari-mint-gcc -o OSMSTAT.TOS -Wall osmstat.c
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#include <stdio.h>
+#include <osbind.h>
+
+#define COOKIE_OSMS 0x4f534d53L
+
+/*
+ * this must match the structure in bdos/mem.h
+ */
+typedef struct
+{
+    unsigned long os_evictions;
+    unsigned short os_static;
+    unsigned short os_slabsize;
+    unsigned short os_slabs;
+    unsigned short os_inuse[4];
+    unsigned short os_maxuse[4];
+} OSMSTAT;
+
+static const char *const typename[4] = { "MDBLOCK", "DMD", "DND", "OFD" };
+
+static long cookie_value;
+
+static long find_cookie(void)
+{
+    long *jar = *(long **)0x5a0;
+
+    if (!jar)
+        return 0;
+
+    for ( ; *jar; jar += 2)
+    {
+        if (*jar == COOKIE_OSMS)
+        {
+            cookie_value = jar[1];
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int main(void)
+{
+    OSMSTAT *os;
+    unsigned int total, inuse = 0;
+    int i;
+
+    if (!Supexec(find_cookie))
+    {
+        printf("No OSMS cookie: EmuTOS was built without CONF_WITH_DYNAMIC_OSMEM\r\n");
+        return 1;
+    }
+
+    os = (OSMSTAT *)cookie_value;
+    total = os->os_static + os->os_slabs * os->os_slabsize;
+
+    printf("type      in use   highest\r\n");
+    for (i = 0; i < 4; i++)
+    {
+        printf("%-8s %7u %9u\r\n", typename[i], os->os_inuse[i], os->os_maxuse[i]);
+        inuse += os->os_inuse[i];
+    }
+
+    printf("\r\n%u of %u blocks in use (%u static, %u slabs of %u)\r\n",
+            inuse, total, os->os_static, os->os_slabs, os->os_slabsize);
+    printf("DNDs freed to make room %lu times\r\n", os->os_evictions);
+
+    return 0;
+}
@@ -0,0 +1,102 @@
+/*
+ * rombench.c : time some OS calls, to compare EmuTOS running from the
+ * flash with EmuTOS running from RAM
+ *
+ * Run it once with the usual flash image, and once with the image built
+ * by "make a2560kflash" (or a2560mflash, a2560xflash), which copies
+ * EmuTOS to RAM at boot.  The calls chosen spend most of their time in
+ * the OS rather than in this program.
+ *
+ * Compile with:
+ *      m68k-atari-mint-gcc -o ROMBENCH.TOS -Wall rombench.c
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#include <stdio.h>
+#include <osbind.h>
+
+#define RUN_TICKS   200             /* 1 second of the 200 Hz timer */
+
+static long os_base;
+
+static long read_os_base(void)
+{
+    /* os_beg field of the OS header pointed to by _sysbase */
+    os_base = (*(long **)0x4f2)[2];
+    return 0;
+}
+
+static long read_hz_200(void)
+{
+    return *(volatile long *)0x4ba;
+}
+
+static long ticks(void)
+{
+    return Supexec(read_hz_200);
+}
+
+/*
+ * return the number of calls of 'op' per second, running it for about RUN_TICKS
+ */
+static long calls_per_second(void (*op)(void))
+{
+    long start, end, count = 0;
+
+    /* wait for a tick boundary */
+    start = ticks();
+    while ((end = ticks()) == start)
+        ;
+    start = end;
+
+    do
+    {
+        op();
+        op();
+        op();
+        op();
+        count += 4;
+        end = ticks();
+    } while (end - start < RUN_TICKS);
+
+    return (count * 200) / (end - start);
+}
+
+static void op_random(void)
+{
+    Random();
+}
+
+static void op_kbshift(void)
+{
+    Kbshift(-1);
+}
+
+static void op_tgettime(void)
+{
+    Tgettime();
+}
+
+static void op_fsfirst(void)
+{
+    Fsfirst("\\*.*", 0x17);
+}
+
+int main(void)
+{
+    Supexec(read_os_base);
+    printf("EmuTOS runs from %s, at 0x%08lx\r\n\r\n",
+            ((unsigned long)os_base < 0x01000000UL) ? "RAM" : "flash",
+            os_base);
+
+    printf("XBIOS Random()      %8ld calls/s\r\n", calls_per_second(op_random));
+    printf("BIOS Kbshift(-1)    %8ld calls/s\r\n", calls_per_second(op_kbshift));
+    printf("GEMDOS Tgettime()   %8ld calls/s\r\n", calls_per_second(op_tgettime));
+    printf("GEMDOS Fsfirst()    %8ld calls/s\r\n", calls_per_second(op_fsfirst));
+
+    return 0;
+}
@@ -0,0 +1,320 @@
+/*
+ * tracedec.c - decode a Foenix debug trace ring saved by EmuCON's TRACE
+ *              command
+ *
+ * The trace records only contain the address of their printf-style format
+ * string and the raw bytes of their arguments, so the format strings (and
+ * any constant "%s" arguments) are looked up in the ROM image that was
+ * running when the trace was made.
+ *
+ * Usage: tracedec [-b <hex address>] <EmuTOS ROM image> <trace file>
+ *
+ * -b gives the address at which the start of the ROM image is mapped; by
+ * default, it is found by looking for the OS header in the image.
+ *
+ * See include/a2560trace.h for the file layout. All values are big-endian,
+ * and arguments are stacked as by m68k-atari-mint-gcc -mshort: 16-bit ints,
+ * 32-bit longs and pointers.
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TRACE_MAGIC     0x46545243UL    /* 'FTRC' */
+#define TRACE_VERSION   1
+#define TRACE_NONL      1               /* record flag: no newline */
+#define HDR_SIZE        36              /* sizeof(struct a2560_trace_t) */
+#define REC_ARGS        16              /* offset of args in a record */
+#define HZ_200          200
+
+static unsigned char *rom;
+static unsigned long romsize, rombase;
+
+static unsigned long get16(const unsigned char *p)
+{
+    return ((unsigned long)p[0] << 8) | p[1];
+}
+
+static unsigned long get32(const unsigned char *p)
+{
+    return (get16(p) << 16) | get16(p+2);
+}
+
+static unsigned char *load(const char *name, unsigned long *psize)
+{
+    FILE *fp;
+    unsigned char *buf;
+    long size;
+
+    fp = fopen(name, "rb");
+    if (!fp || fseek(fp, 0L, SEEK_END) || (size = ftell(fp)) < 0) {
+        perror(name);
+        exit(1);
+    }
+    rewind(fp);
+    buf = malloc(size ? size : 1);
+    if (!buf || fread(buf, 1, size, fp) != (size_t)size) {
+        fprintf(stderr, "%s: read error\n", name);
+        exit(1);
+    }
+    fclose(fp);
+    *psize = size;
+
+    return buf;
+}
+
+/*
+ * return the string at the specified address in the ROM, or NULL
+ */
+static const char *rom_string(unsigned long addr)
+{
+    unsigned long offset = addr - rombase;
+
+    if ((addr < rombase) || (offset >= romsize))
+        return NULL;
+    if (!memchr(rom + offset, '\0', romsize - offset))
+        return NULL;
+
+    return (const char *)rom + offset;
+}
+
+/*
+ * find where the ROM image is mapped, given the address of the OS header:
+ * the header starts with a bra.s, and its os_beg field (at offset 8)
+ * contains its own address
+ */
+static int find_rombase(unsigned long os_header)
+{
+    unsigned long offset;
+
+    for (offset = 0; offset + 12 <= romsize; offset += 2) {
+        if ((rom[offset] == 0x60) && (get32(rom+offset+8) == os_header)
+         && (os_header >= offset)) {
+            rombase = os_header - offset;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/*
+ * fetch the next argument from a record
+ */
+static unsigned long next_arg(const unsigned char *args, int *pos, int size, int argbytes)
+{
+    unsigned long value;
+
+    if (*pos + size > argbytes) {
+        *pos = argbytes + 1;    /* flag overrun */
+        return 0;
+    }
+    value = (size == 4) ? get32(args + *pos) : get16(args + *pos);
+    *pos += size;
+
+    return value;
+}
+
+/*
+ * format a record like EmuTOS's doprintf(), into 'out'
+ */
+static void format(char *out, size_t outlen, const char *fmt, const unsigned char *args, int argbytes)
+{
+    char spec[32], buf[256];
+    const char *start, *s;
+    unsigned long value;
+    long svalue;
+    int pos = 0, n, len, islong;
+
+    *out = '\0';
+    len = 0;
+
+#define APPEND(str) do { strncat(out, str, outlen - len - 1); len = strlen(out); } while (0)
+
+    while (*fmt) {
+        if (*fmt != '%') {
+            buf[0] = *fmt++;
+            buf[1] = '\0';
+            APPEND(buf);
+            continue;
+        }
+
+        start = fmt++;
+        if (*fmt == '%') {
+            fmt++;
+            APPEND("%");
+            continue;
+        }
+        while (strchr("-0+ #", *fmt))
+            fmt++;
+        while (((*fmt >= '0') && (*fmt <= '9')) || (*fmt == '.'))
+            fmt++;
+        if (*fmt == '*') {      /* rarely used: take the int, but ignore it */
+            next_arg(args, &pos, 2, argbytes);
+            fmt++;
+        }
+        islong = 0;
+        if ((*fmt == 'l') || (*fmt == 'L')) {
+            islong = 1;
+            fmt++;
+        }
+        if (!*fmt)
+            break;
+
+        n = fmt - start;
+        if (n > (int)sizeof(spec) - 4)
+            n = sizeof(spec) - 4;
+        memcpy(spec, start, n);
+        spec[n] = '\0';
+        if (islong)
+            spec[n-1] = '\0';   /* we add our own 'l' */
+
+        switch(*fmt) {
+        case 'c':
+            strcat(spec, "c");
+            sprintf(buf, spec, (int)(next_arg(args, &pos, 2, argbytes) & 0xff));
+            break;
+        case 'd':
+        case 'i':
+            value = next_arg(args, &pos, islong ? 4 : 2, argbytes);
+            svalue = islong ? (long)(value ^ 0x80000000UL) - 0x80000000L : (long)(value ^ 0x8000) - 0x8000;
+            strcat(spec, "ld");
+            sprintf(buf, spec, svalue);
+            break;
+        case 'o':
+        case 'u':
+        case 'x':
+        case 'X':
+            value = next_arg(args, &pos, islong ? 4 : 2, argbytes);
+            n = strlen(spec);
+            spec[n] = 'l';
+            spec[n+1] = *fmt;
+            spec[n+2] = '\0';
+            sprintf(buf, spec, value);
+            break;
+        case 'p':
+        case 'P':
+            value = next_arg(args, &pos, 4, argbytes);
+            sprintf(buf, (*fmt == 'p') ? "0x%08lx" : "0X%08lX", value);
+            break;
+        case 's':
+            value = next_arg(args, &pos, 4, argbytes);
+            s = value ? rom_string(value) : "(null)";
+            strcat(spec, "s");
+            if (!s)
+                sprintf(buf, "<string at 0x%08lx>", value);
+            else if (strlen(s) < sizeof(buf) / 2)
+                sprintf(buf, spec, s);
+            else {
+                APPEND(s);      /* too long for buf[]: ignore width etc. */
+                buf[0] = '\0';
+            }
+            break;
+        default:
+            buf[0] = *fmt;
+            buf[1] = '\0';
+            break;
+        }
+        fmt++;
+        APPEND(buf);
+    }
+
+    if (pos > argbytes)
+        APPEND(" <arguments truncated>");
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned char *trace, *rec;
+    unsigned long tracesize, base = 0, head, nrecs, count, first, i;
+    unsigned long recsize, argbytes, fine_hz, tick, fine, flags;
+    const char *fmt;
+    char line[512];
+    double t, last = 0.0;
+    int have_base = 0, bol = 1;
+
+    if ((argc > 2) && !strcmp(argv[1], "-b")) {
+        base = strtoul(argv[2], NULL, 16);
+        have_base = 1;
+        argc -= 2;
+        argv += 2;
+    }
+    if (argc != 3) {
+        fprintf(stderr, "usage: tracedec [-b <hex address>] <EmuTOS ROM image> <trace file>\n");
+        return 1;
+    }
+
+    rom = load(argv[1], &romsize);
+    trace = load(argv[2], &tracesize);
+
+    if ((tracesize < HDR_SIZE) || (get32(trace) != TRACE_MAGIC)) {
+        fprintf(stderr, "%s: not a trace file\n", argv[2]);
+        return 1;
+    }
+    if (get16(trace+4) != TRACE_VERSION) {
+        fprintf(stderr, "%s: unsupported version %lu\n", argv[2], get16(trace+4));
+        return 1;
+    }
+    recsize = get16(trace+6);
+    nrecs = get16(trace+8);
+    argbytes = get16(trace+10);
+    fine_hz = get32(trace+12);
+    head = get32(trace+20);
+    if ((recsize < REC_ARGS + argbytes) || !nrecs || !fine_hz) {
+        fprintf(stderr, "%s: invalid header\n", argv[2]);
+        return 1;
+    }
+
+    if (have_base)
+        rombase = base;
+    else if (!find_rombase(get32(trace+16))) {
+        fprintf(stderr, "%s: can't find the OS header at 0x%08lx, use -b\n", argv[1], get32(trace+16));
+        return 1;
+    }
+
+    count = (head > nrecs) ? nrecs : head;
+    if (tracesize < HDR_SIZE + count * recsize)
+        count = (tracesize - HDR_SIZE) / recsize;
+    first = head - count;
+
+    printf("# %lu records logged, %lu waiting for output, %lu dropped; showing the last %lu\n",
+            head, head - get32(trace+24), get32(trace+28), count);
+
+    for (i = 0, rec = trace + HDR_SIZE; i < count; i++, rec += recsize) {
+        if (get16(rec+12) != ((first + i) & 0xffff)) {
+            if (!bol)
+                putchar('\n');
+            printf("# record %lu was incomplete\n", first + i);
+            bol = 1;
+            continue;
+        }
+
+        tick = get32(rec);
+        fine = get32(rec+4);
+        flags = get16(rec+14);
+        fmt = rom_string(get32(rec+8));
+        if (fmt)
+            format(line, sizeof(line), fmt, rec + REC_ARGS, argbytes);
+        else sprintf(line, "<format at 0x%08lx>", get32(rec+8));
+
+        if (bol) {
+            t = (double)tick / HZ_200 + (double)fine / fine_hz;
+            printf("%12.6f (%+10.6f) ", t, (i > 0) ? t - last : 0.0);
+            last = t;
+        }
+        fputs(line, stdout);
+        bol = !(flags & TRACE_NONL);
+        if (bol)
+            putchar('\n');
+    }
+    if (!bol)
+        putchar('\n');
+
+    return 0;
+}
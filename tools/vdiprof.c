@@ -0,0 +1,257 @@
+/*
+ * vdiprof.c : display the VDI functions that take the most time
+ *
+ * This is only available if EmuTOS was built with CONF_WITH_VDI_PROFILE
+ * set to 1.  Run it after the GEM program to examine, or alongside it
+ * under a multitasking OS.  The table is refreshed every second; press R
+ * to clear the profile, P to pause or resume it, and any other key to
+ * exit.  The optional argument is the number of functions displayed.
+ *
+ * Compile with:
+ *      m68k-atari-mint-gcc -o VDIPROF.TTP -Wall vdiprof.c
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <osbind.h>
+
+#define COOKIE_VPRF 0x56505246L
+#define DEFAULT_TOP 15
+#define TOP_HANDLES 5
+
+/*
+ * these must match the structures in vdi/vdi_profile.h
+ */
+typedef struct
+{
+    unsigned long vp_calls;
+    unsigned long vp_time_hi;
+    unsigned long vp_time;
+    unsigned long vp_max;
+    unsigned long vp_pixels;
+} VDIPROFOP;
+
+typedef struct
+{
+    unsigned long vp_calls;
+    unsigned long vp_time_hi;
+    unsigned long vp_time;
+} VDIPROFWK;
+
+typedef struct
+{
+    unsigned short vp_slots;
+    unsigned short vp_handles;
+    unsigned short vp_enabled;
+    unsigned short vp_reserved;
+    unsigned long vp_hz;
+    /* VDIPROFOP vp_op[vp_slots] follows, then VDIPROFWK vp_wk[vp_handles] */
+} VDIPROFILE;
+
+static const char * const names1[] =
+{
+    "", "v_opnwk", "v_clswk", "v_clrwk", "v_updwk", "v_escape",
+    "v_pline", "v_pmarker", "v_gtext", "v_fillarea", "v_cellarray",
+    "v_gdp", "vst_height", "vst_rotation", "vs_color", "vsl_type",
+    "vsl_width", "vsl_color", "vsm_type", "vsm_height", "vsm_color",
+    "vst_font", "vst_color", "vsf_interior", "vsf_style", "vsf_color",
+    "vq_color", "vq_cellarray", "v_locator", "v_valuator", "v_choice",
+    "v_string", "vswr_mode", "vsin_mode", "", "vql_attributes",
+    "vqm_attributes", "vqf_attributes", "vqt_attributes", "vst_alignment"
+};
+
+static const char * const names2[] =
+{
+    "v_opnvwk", "v_clsvwk", "vq_extnd", "v_contourfill", "vsf_perimeter",
+    "v_get_pixel", "vst_effects", "vst_point", "vsl_ends", "vro_cpyfm",
+    "vr_trnfm", "vsc_form", "vsf_udpat", "vsl_udsty", "vr_recfl",
+    "vqin_mode", "vqt_extent", "vqt_width", "vex_timv", "vst_load_fonts",
+    "vst_unload_fonts", "vrt_cpyfm", "v_show_c", "v_hide_c", "vq_mouse",
+    "vex_butv", "vex_motv", "vex_curv", "vq_key_s", "vs_clip",
+    "vqt_name", "vqt_fontinfo", "vqt_justified", "vs_grayoverride", "vex_wheelv"
+};
+
+#define NAMES1  (sizeof(names1) / sizeof(names1[0]))
+#define NAMES2  (sizeof(names2) / sizeof(names2[0]))
+
+static VDIPROFILE *vp;
+static VDIPROFOP *ops;
+static VDIPROFWK *wks;
+
+static long find_cookie(void)
+{
+    long *jar = *(long **)0x5a0;
+
+    if (!jar)
+        return 0;
+
+    for ( ; *jar; jar += 2)
+    {
+        if (*jar == COOKIE_VPRF)
+        {
+            vp = (VDIPROFILE *)jar[1];
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static long read_hz_200(void)
+{
+    return *(volatile long *)0x4ba;
+}
+
+static long clear_profile(void)
+{
+    memset(ops, 0, vp->vp_slots * sizeof(VDIPROFOP));
+    memset(wks, 0, vp->vp_handles * sizeof(VDIPROFWK));
+    return 0;
+}
+
+static long toggle_profile(void)
+{
+    vp->vp_enabled = !vp->vp_enabled;
+    return 0;
+}
+
+static int slot_opcode(int slot)
+{
+    return (slot < 40) ? slot : slot + 60;
+}
+
+static const char *opcode_name(int opcode)
+{
+    if ((opcode < 100) && (opcode < (int)NAMES1))
+        return names1[opcode];
+    if ((opcode >= 100) && (opcode - 100 < (int)NAMES2))
+        return names2[opcode - 100];
+    return "";
+}
+
+/*
+ * total time as a double, since it is kept in 64 bits
+ */
+static double op_time(const VDIPROFOP *op)
+{
+    return op->vp_time_hi * 4294967296.0 + op->vp_time;
+}
+
+static double wk_time(const VDIPROFWK *wk)
+{
+    return wk->vp_time_hi * 4294967296.0 + wk->vp_time;
+}
+
+static double to_ms(double t)
+{
+    return t * 1000.0 / vp->vp_hz;
+}
+
+static void show(int top)
+{
+    int order[256], i, j, n, best;
+    double total = 0.0;
+
+    /* the slots used, by decreasing total time */
+    for (i = 0, n = 0; i < vp->vp_slots && n < 256; i++)
+    {
+        if (ops[i].vp_calls)
+        {
+            order[n++] = i;
+            total += op_time(&ops[i]);
+        }
+    }
+    for (i = 0; i < n && i < top; i++)
+    {
+        for (j = i+1, best = i; j < n; j++)
+            if (op_time(&ops[order[j]]) > op_time(&ops[order[best]]))
+                best = j;
+        j = order[i];
+        order[i] = order[best];
+        order[best] = j;
+    }
+
+    printf("\033H%s, %.0f ms in the VDI\033K\r\n\033K\r\n",
+            vp->vp_enabled ? "Profiling" : "Paused", to_ms(total));
+    printf("op  function            calls   total ms   %%  avg us   max us    kpixels\033K\r\n");
+    for (i = 0; i < n && i < top; i++)
+    {
+        VDIPROFOP *op = &ops[order[i]];
+        int opcode = slot_opcode(order[i]);
+
+        printf("%3d %-16s %8lu %10.1f %3d %7.0f %8.0f %10lu\033K\r\n",
+                opcode, opcode_name(opcode), op->vp_calls, to_ms(op_time(op)),
+                total > 0.0 ? (int)(op_time(op) * 100.0 / total) : 0,
+                to_ms(op_time(op)) * 1000.0 / op->vp_calls,
+                to_ms(op->vp_max) * 1000.0, op->vp_pixels / 1000);
+    }
+
+    /* the workstations that take the most time */
+    for (i = 0, n = 0; i < vp->vp_handles && n < 256; i++)
+    {
+        if (wks[i].vp_calls)
+            order[n++] = i;
+    }
+    printf("\033K\r\nhandle     calls   total ms\033K\r\n");
+    for (i = 0; i < n && i < TOP_HANDLES; i++)
+    {
+        for (j = i+1, best = i; j < n; j++)
+            if (wk_time(&wks[order[j]]) > wk_time(&wks[order[best]]))
+                best = j;
+        j = order[i];
+        order[i] = order[best];
+        order[best] = j;
+        printf("%6d %9lu %10.1f\033K\r\n", order[i], wks[order[i]].vp_calls,
+                to_ms(wk_time(&wks[order[i]])));
+    }
+    printf("\033J");
+}
+
+int main(int argc, char *argv[])
+{
+    int top = DEFAULT_TOP;
+    long next;
+    int c;
+
+    if (argc > 1)
+        top = atoi(argv[1]);
+    if (top <= 0)
+        top = DEFAULT_TOP;
+
+    if (!Supexec(find_cookie))
+    {
+        printf("No VPRF cookie: EmuTOS was built without CONF_WITH_VDI_PROFILE\r\n");
+        return 1;
+    }
+    ops = (VDIPROFOP *)(vp + 1);
+    wks = (VDIPROFWK *)(ops + vp->vp_slots);
+
+    printf("\033E\033f");
+    for (;;)
+    {
+        show(top);
+
+        next = Supexec(read_hz_200) + 200;
+        while (!Cconis() && (Supexec(read_hz_200) - next < 0))
+            ;
+        if (!Cconis())
+            continue;
+
+        c = (int)(Crawcin() & 0xff);
+        if ((c == 'r') || (c == 'R'))
+            Supexec(clear_profile);
+        else if ((c == 'p') || (c == 'P'))
+            Supexec(toggle_profile);
+        else
+            break;
+    }
+    printf("\033e\r\n");
+
+    return 0;
+}
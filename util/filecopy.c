@@ -0,0 +1,448 @@
+/*
+ * filecopy.c - shared file copy engine
+ *
+ * Used by both the desktop and EmuCON to copy/move files.
+ *
+ * The copy buffer is sized from free memory.  Files that are small
+ * relative to the buffer are read into it one after another and only
+ * written out when the buffer fills up (or on fc_flush()), so a folder
+ * of small files costs one pass of reads followed by one pass of
+ * creates/writes, rather than alternating between source & destination
+ * for every file.  Larger files are copied in buffer-sized chunks; since
+ * the buffer is normally a multiple of the maximum cluster size, these
+ * transfers go straight between the disk & the buffer, bypassing the
+ * BDOS sector cache.
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#include "emutos.h"
+#include "bdosbind.h"
+#include "gemerror.h"
+#include "filecopy.h"
+#include "string.h"
+
+/*
+ * a buffered file: these live at the top of the copy buffer, below
+ * each other, followed by the source & destination names
+ */
+struct _fcpend
+{
+    FCPEND *next;
+    LONG offset;                /* of file data within buffer */
+    LONG length;
+    UWORD datime[2];            /* as returned by Fdatime() */
+    WORD attr;
+    WORD flags;
+    char *dst;
+    char src[1];                /* actually variable length */
+};
+
+#define EVEN(n)     (((n)+1) & ~1L)
+#define FC_MINBUF   1024L       /* smallest useful copy buffer */
+
+
+/*
+ * compare two pathnames: we don't use strcmp() since it isn't
+ * available to the standalone EmuCON
+ */
+static BOOL fc_same(const char *a, const char *b)
+{
+    while(*a == *b++)
+        if (*a++ == '\0')
+            return TRUE;
+
+    return FALSE;
+}
+
+
+static WORD fc_error(FCOPY *fc, WORD type, const char *path, LONG rc)
+{
+    WORD action;
+
+    if (!fc->error)
+        return FC_ABORT;
+
+    action = fc->error(fc->arg, type, path, rc);
+    if ((action == FC_RETRY) && ((type == FC_ERR_READ) || (type == FC_ERR_WRITE)))
+        action = FC_SKIP;
+
+    return (type == FC_ERR_FULL) ? FC_ABORT : action;
+}
+
+
+static WORD fc_progress(FCOPY *fc, const char *src, const char *dst)
+{
+    fc->stat.src = src;
+    fc->stat.name = dst;
+
+    if (!fc->progress)
+        return 0;
+
+    return fc->progress(fc->arg, &fc->stat);
+}
+
+
+/*
+ * return the number of bytes available between the buffered data and
+ * the pending descriptors
+ */
+static LONG fc_space(FCOPY *fc)
+{
+    return fc->low - (fc->buf + fc->used);
+}
+
+
+/*
+ * discard all buffered files
+ */
+static void fc_reset(FCOPY *fc)
+{
+    fc->used = 0L;
+    fc->low = fc->buf + fc->buflen;
+    fc->first = fc->last = NULL;
+}
+
+
+/*
+ * return TRUE iff the specified path is the source or destination
+ * of a buffered file
+ */
+static BOOL fc_pending(FCOPY *fc, const char *path)
+{
+    FCPEND *p;
+
+    for (p = fc->first; p; p = p->next)
+        if (fc_same(p->src, path) || fc_same(p->dst, path))
+            return TRUE;
+
+    return FALSE;
+}
+
+
+/*
+ * open a file, calling the error callback on failure
+ *
+ * returns handle (>= 0), FC_SKIP-1 for skip, or FC_ABORT-1 for abort
+ */
+#define FC_NOFILE(rc)   ((rc)-1)
+
+static WORD fc_open(FCOPY *fc, const char *path, WORD create, WORD attr)
+{
+    LONG rc;
+    WORD action;
+
+    while(1)
+    {
+        rc = create ? Fcreate(path, attr) : Fopen(path, 0);
+        if (rc >= 0L)
+            return (WORD)rc;
+
+        action = fc_error(fc, create ? FC_ERR_CREATE : FC_ERR_OPEN, path, rc);
+        if (action != FC_RETRY)
+            return FC_NOFILE(action);
+    }
+}
+
+
+/*
+ * delete the source of a move
+ */
+static WORD fc_delsrc(FCOPY *fc, const char *path)
+{
+    LONG rc;
+    WORD action;
+
+    while(1)
+    {
+        rc = Fdelete(path);
+        if (rc == 0L)
+            return FC_OK;
+
+        action = fc_error(fc, FC_ERR_DELETE, path, rc);
+        if (action != FC_RETRY)
+            return action;
+    }
+}
+
+
+/*
+ * write one buffered file
+ */
+static WORD fc_write(FCOPY *fc, FCPEND *p)
+{
+    WORD fh, rc;
+    LONG n;
+
+    fh = fc_open(fc, p->dst, 1, p->attr);
+    if (fh < 0)
+        return fh + 1;
+
+    n = Fwrite(fh, p->length, fc->buf + p->offset);
+    if (n == p->length)
+        Fdatime(p->datime, fh, 1);
+    Fclose(fh);
+
+    if (n != p->length)
+    {
+        Fdelete(p->dst);    /* don't leave an incomplete file behind */
+        if (n >= 0L)
+            return fc_error(fc, FC_ERR_FULL, p->dst, n);
+        return fc_error(fc, FC_ERR_WRITE, p->dst, n);
+    }
+
+    fc->stat.bytes += n;
+
+    rc = FC_OK;
+    if (p->flags & FC_MOVE)
+        rc = fc_delsrc(fc, p->src);
+    if (rc == FC_ABORT)
+        return rc;
+
+    fc->stat.files++;
+    if (fc_progress(fc, p->src, p->dst))
+        return FC_ABORT;
+
+    return rc;
+}
+
+
+/*
+ * allocate the copy buffer
+ *
+ * 'reserve' bytes of free memory are left for the caller; 'mode' is
+ * the Mxalloc() mode.  returns the buffer length, or a negative error
+ * code.
+ *
+ * the standalone EmuCON may run on a TOS without Mxalloc() (before 2.06),
+ * which returns EINVFN: Malloc() is used instead.
+ */
+LONG fc_init(FCOPY *fc, LONG reserve, WORD mode)
+{
+    LONG avail;
+    BOOL mx;
+
+    fc->buf = NULL;
+    fc->progress = NULL;
+    fc->error = NULL;
+    fc->arg = NULL;
+    fc->stat.bytes = fc->stat.files = 0UL;
+    fc->stat.src = fc->stat.name = NULL;
+
+    avail = Mxalloc(-1L, mode);
+    mx = (avail != EINVFN);
+    if (!mx)
+        avail = Malloc(-1L);
+    avail -= reserve;
+    if (avail < FC_MINBUF)
+        return ENSMEM;
+
+    /*
+     * for efficiency, the buffer length should be a multiple of the
+     * cluster size.  rather than determine the actual cluster sizes for
+     * the source and destination, we use the largest multiple of the
+     * maximum possible cluster size that fits, if there is one.
+     */
+    if (avail >= FC_CLUSTER)
+        avail &= ~(FC_CLUSTER-1);
+    else avail &= ~1L;
+
+    fc->buf = (UBYTE *)(mx ? Mxalloc(avail, mode) : Malloc(avail));
+    if (!fc->buf)
+        return ENSMEM;
+    fc->buflen = avail;
+    fc_reset(fc);
+
+    return avail;
+}
+
+
+/*
+ * copy a file
+ *
+ * the destination is created with attributes 'attr' and the date/time
+ * of the source.  the copy may be buffered: it is only guaranteed to
+ * have been written after fc_flush() returns.  errors on buffered files
+ * are reported during a later fc_copy() or fc_flush().
+ *
+ * returns FC_OK, FC_SKIP (the current or some buffered file was skipped)
+ * or FC_ABORT (stop the operation; any buffered files are discarded)
+ */
+WORD fc_copy(FCOPY *fc, const char *src, const char *dst, WORD attr, WORD flags)
+{
+    FCPEND *p;
+    UWORD datime[2];
+    LONG size, need, n;
+    WORD srcfh, dstfh, rc;
+
+    /*
+     * if we are going to read a file we haven't written yet, or
+     * overwrite one we haven't read or deleted yet, catch up first
+     */
+    if (fc_pending(fc, src) || fc_pending(fc, dst))
+    {
+        rc = fc_flush(fc);
+        if (rc == FC_ABORT)
+            return rc;
+    }
+
+    srcfh = fc_open(fc, src, 0, 0);
+    if (srcfh < 0)
+        return srcfh + 1;
+
+    size = Fseek(0L, srcfh, 2);
+    Fseek(0L, srcfh, 0);
+    Fdatime(datime, srcfh, 0);
+
+    /*
+     * small files are buffered
+     */
+    need = EVEN(sizeof(FCPEND) + strlen(src) + strlen(dst) + 1);
+    if ((size >= 0L) && (size + need <= fc->buflen / 2))
+    {
+        if (EVEN(size) + need > fc_space(fc))
+        {
+            rc = fc_flush(fc);
+            if (rc == FC_ABORT)
+            {
+                Fclose(srcfh);
+                return rc;
+            }
+        }
+
+        n = Fread(srcfh, size, fc->buf + fc->used);
+        Fclose(srcfh);
+        if (n != size)
+            return fc_error(fc, FC_ERR_READ, src, (n < 0L) ? n : EREADF);
+
+        fc->low -= need;
+        p = (FCPEND *)fc->low;
+        p->next = NULL;
+        p->offset = fc->used;
+        p->length = size;
+        p->datime[0] = datime[0];
+        p->datime[1] = datime[1];
+        p->attr = attr;
+        p->flags = flags;
+        strcpy(p->src, src);
+        p->dst = p->src + strlen(src) + 1;
+        strcpy(p->dst, dst);
+        if (fc->last)
+            fc->last->next = p;
+        else fc->first = p;
+        fc->last = p;
+        fc->used += EVEN(size);
+
+        return FC_OK;
+    }
+
+    /*
+     * large files are copied directly, using the whole buffer
+     */
+    rc = fc_flush(fc);
+    if (rc == FC_ABORT)
+    {
+        Fclose(srcfh);
+        return rc;
+    }
+
+    dstfh = fc_open(fc, dst, 1, attr);
+    if (dstfh < 0)
+    {
+        Fclose(srcfh);
+        return dstfh + 1;
+    }
+
+    while(1)
+    {
+        size = Fread(srcfh, fc->buflen, fc->buf);
+        if (size <= 0L)
+            break;
+        n = Fwrite(dstfh, size, fc->buf);
+        if (n != size)
+            break;
+        fc->stat.bytes += n;
+        if (fc_progress(fc, src, dst))
+        {
+            size = n = 0L;
+            rc = FC_ABORT;
+            break;
+        }
+    }
+
+    if (size == 0L)
+        Fdatime(datime, dstfh, 1);
+    Fclose(srcfh);
+    Fclose(dstfh);
+
+    if (size != 0L)         /* read or write error, or disk full */
+    {
+        Fdelete(dst);
+        if (size < 0L)
+            return fc_error(fc, FC_ERR_READ, src, size);
+        if (n >= 0L)
+            return fc_error(fc, FC_ERR_FULL, dst, n);
+        return fc_error(fc, FC_ERR_WRITE, dst, n);
+    }
+    if (rc == FC_ABORT)     /* user abort */
+    {
+        Fdelete(dst);
+        return rc;
+    }
+
+    if (flags & FC_MOVE)
+        rc = fc_delsrc(fc, src);
+    if (rc == FC_ABORT)
+        return rc;
+
+    fc->stat.files++;
+    if (fc_progress(fc, src, dst))
+        return FC_ABORT;
+
+    return rc;
+}
+
+
+/*
+ * write all buffered files
+ *
+ * returns FC_OK, FC_SKIP (one or more files were skipped) or
+ * FC_ABORT (the remaining files were discarded)
+ */
+WORD fc_flush(FCOPY *fc)
+{
+    FCPEND *p;
+    WORD rc, ret = FC_OK;
+
+    for (p = fc->first; p; p = p->next)
+    {
+        rc = fc_write(fc, p);
+        if (rc == FC_ABORT)
+        {
+            ret = FC_ABORT;
+            break;
+        }
+        if (rc == FC_SKIP)
+            ret = FC_SKIP;
+    }
+
+    fc_reset(fc);
+
+    return ret;
+}
+
+
+/*
+ * free the copy buffer
+ *
+ * any files that have not been written by fc_flush() are discarded
+ */
+void fc_exit(FCOPY *fc)
+{
+    if (fc->buf)
+        Mfree(fc->buf);
+    fc->buf = NULL;
+}
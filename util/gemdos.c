@@ -74,6 +74,20 @@ WORD dos_label(char drive, char *plabel)
 }
 
 
+#if CONF_WITH_FSEL_CATALOGUE || CONF_WITH_DIR_CACHE
+/*
+ * get the number of changes made to directories and media, to check if
+ * a cached directory listing is still valid
+ *
+ * returns FALSE if the changes are not counted
+ */
+BOOL dos_dirchanges(ULONG *pcount)
+{
+    return Ddirchanges(pcount) == 0L;
+}
+#endif
+
+
 void dos_space(WORD drv, LONG *ptotal, LONG *pavail)
 {
     LONG    buf[4];
@@ -12,6 +12,7 @@
 #include "emutos.h"
 #include "lineavars.h"
 #include "vdi_defs.h"
+#include "vdi_profile.h"
 #include "biosbind.h"
 #include "xbiosbind.h"
 #include "biosext.h"
@@ -543,6 +544,9 @@ void vdi_v_opnwk(Vwk * vwk)
 
     timer_init();
     vdimouse_init();            /* initialize mouse */
+#if CONF_WITH_VDI_PROFILE
+    vdi_profile_init();
+#endif
     esc_init(vwk);              /* enter graphics mode */
 
     /* Just like TOS 2.06, make the physical workstation the current workstation for Line-A. */
@@ -22,9 +22,12 @@
 
 extern Vwk phys_work;           /* attribute area for physical workstation */
 
-/* special values used in y member of SEGMENT */
-#define EMPTY       0xffff          /* this entry is unused */
-#define DOWN_FLAG   0x8000
+/*
+ * special values used in y member of SEGMENT: these are WORDs, so that
+ * they compare correctly with it even when int is 32 bits (see tests/vdi)
+ */
+#define EMPTY       ((WORD)0xffff)  /* this entry is unused */
+#define DOWN_FLAG   ((WORD)0x8000)
 #define ABS(v)      ((v) & 0x7FFF)  /* strips DOWN_FLAG if present */
 
 /* Global variables */
@@ -12,6 +12,8 @@
 #include "vdi_defs.h"
 #include "lineavars.h"
 #include "asm.h"
+#include "vdi_profile.h"
+#include "finetime.h"
 
 /* forward prototypes */
 void vdi_screen_driver(void);
@@ -126,6 +128,9 @@ void vdi_screen_driver(void)
     WORD *contrl = CONTRL;
     const struct vdi_jmptab *jmptab;
     Vwk *vwk = NULL;
+#if CONF_WITH_VDI_PROFILE
+    ULONG pixels = 0, start = 0;
+#endif
 
     /* get workstation handle */
     handle = CONTRL[6];
@@ -163,9 +168,23 @@ void vdi_screen_driver(void)
     contrl[2] = jmptab->nptsout;
     contrl[4] = jmptab->nintout;
 
+#if CONF_WITH_VDI_PROFILE
+    if (vdi_profile.vp_enabled)
+    {
+        pixels = vdi_profile_pixels(opcode, vwk);
+        start = fine_time();
+    }
+#endif
+
     /* Call the appropriate function */
     (*jmptab->op) (vwk);
 
+#if CONF_WITH_VDI_PROFILE
+    /* v_opnwk() clears the profile, and v_opnvwk() sets the new handle in CONTRL[6] */
+    if (vdi_profile.vp_enabled && (opcode != V_OPNWK_OP))
+        vdi_profile_add(opcode, contrl[6], pixels, start);
+#endif
+
     /*
      * at this point, for v_opnwk() and v_opnvwk(), vwk is NULL.  we
      * must fix this before we use it to set the lineA variables below.
@@ -0,0 +1,159 @@
+/*
+ * vdi_profile.c - VDI call profiler
+ *
+ * vdi_screen_driver() records the number of calls, the time spent and an
+ * estimate of the pixels drawn for each opcode, and the number of calls
+ * and time for each workstation, so that they can be displayed by
+ * tools/vdiprof.c.
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#include "emutos.h"
+#include "vdi_defs.h"
+#include "vdi_profile.h"
+#include "lineavars.h"
+#include "intmath.h"
+#include "cookie.h"
+#include "string.h"
+#include "finetime.h"
+
+#if CONF_WITH_VDI_PROFILE
+
+/* not initialized here, since the DATA segment may be in ROM */
+VDIPROFILE vdi_profile;
+
+
+/*
+ * clear the profile & publish it via the 'VPRF' cookie
+ *
+ * called when the physical workstation is opened
+ */
+void vdi_profile_init(void)
+{
+    ULONG dummy;
+
+    bzero(&vdi_profile, sizeof(VDIPROFILE));
+    vdi_profile.vp_slots = VPROF_SLOTS;
+    vdi_profile.vp_handles = NUM_VDI_HANDLES+1;
+    vdi_profile.vp_hz = FINE_TIME_HZ;
+    vdi_profile.vp_enabled = 1;
+
+    if (!cookie_get(COOKIE_VPRF, &dummy))
+        cookie_add(COOKIE_VPRF, (ULONG)&vdi_profile);
+}
+
+
+static ULONG rect_pixels(const WORD *pts)
+{
+    LONG w = pts[2] - pts[0];
+    LONG h = pts[3] - pts[1];
+
+    if (w < 0)
+        w = -w;
+    if (h < 0)
+        h = -h;
+
+    return (w + 1) * (h + 1);
+}
+
+
+/*
+ * return an estimate of the pixels drawn by a VDI call, from its
+ * parameters: the area of the rectangle or bounding box drawn, the length
+ * of lines, or the size of the character cells.  Clipping is ignored.
+ */
+ULONG vdi_profile_pixels(WORD opcode, Vwk *vwk)
+{
+    const WORD *pts = PTSIN;
+    WORD i, n, dx, dy, xmin, xmax, ymin, ymax;
+    ULONG pixels = 0;
+
+    switch(opcode)
+    {
+    case 3:     /* v_clrwk */
+        pixels = (ULONG)V_REZ_HZ * V_REZ_VT;
+        break;
+    case 6:     /* v_pline */
+        for (i = 1, n = CONTRL[1]; i < n; i++, pts += 2)
+        {
+            dx = pts[2] - pts[0];
+            dy = pts[3] - pts[1];
+            pixels += max(dx < 0 ? -dx : dx, dy < 0 ? -dy : dy) + 1;
+        }
+        break;
+    case 8:     /* v_gtext */
+        if (vwk && vwk->cur_font)
+            pixels = (ULONG)CONTRL[3] * vwk->cur_font->max_cell_width * vwk->cur_font->form_height;
+        break;
+    case 9:     /* v_fillarea */
+        n = CONTRL[1];
+        if (n < 2)
+            break;
+        xmin = xmax = pts[0];
+        ymin = ymax = pts[1];
+        for (i = 1, pts += 2; i < n; i++, pts += 2)
+        {
+            xmin = min(xmin, pts[0]);
+            xmax = max(xmax, pts[0]);
+            ymin = min(ymin, pts[1]);
+            ymax = max(ymax, pts[1]);
+        }
+        pixels = (ULONG)(xmax - xmin + 1) * (ymax - ymin + 1);
+        break;
+    case 11:    /* v_gdp: v_bar, v_rbox, v_rfbox */
+        if ((CONTRL[5] == 1) || (CONTRL[5] == 8) || (CONTRL[5] == 9))
+            pixels = rect_pixels(pts);
+        break;
+    case 109:   /* vro_cpyfm */
+    case 121:   /* vrt_cpyfm */
+        pixels = rect_pixels(pts + 4);
+        break;
+    case 114:   /* vr_recfl */
+        pixels = rect_pixels(pts);
+        break;
+    }
+
+    return pixels;
+}
+
+
+/*
+ * account for a VDI call that started at time 'start'
+ */
+void vdi_profile_add(WORD opcode, WORD handle, ULONG pixels, ULONG start)
+{
+    VDIPROFOP *op;
+    VDIPROFWK *wk;
+    ULONG time, old;
+
+    time = fine_time_since(start);
+
+    if (((opcode >= 0) && (opcode < 40)) || ((opcode >= 100) && (opcode < 140)))
+    {
+        op = &vdi_profile.vp_op[VPROF_SLOT(opcode)];
+        op->vp_calls++;
+        old = op->vp_time;
+        op->vp_time += time;
+        if (op->vp_time < old)
+            op->vp_time_hi++;
+        if (time > op->vp_max)
+            op->vp_max = time;
+        op->vp_pixels += pixels;
+    }
+
+    if ((handle >= 0) && (handle <= NUM_VDI_HANDLES))
+    {
+        wk = &vdi_profile.vp_wk[handle];
+        wk->vp_calls++;
+        old = wk->vp_time;
+        wk->vp_time += time;
+        if (wk->vp_time < old)
+            wk->vp_time_hi++;
+    }
+}
+
+#endif /* CONF_WITH_VDI_PROFILE */
@@ -0,0 +1,60 @@
+/*
+ * vdi_profile.h - VDI call profiler
+ *
+ * Copyright (C) 2026 The EmuTOS development team
+ *
+ * This file is distributed under the GPL, version 2 or at your
+ * option any later version.  See doc/license.txt for details.
+ */
+
+#ifndef VDI_PROFILE_H
+#define VDI_PROFILE_H
+
+#if CONF_WITH_VDI_PROFILE
+
+/*
+ * opcodes 0-39 use slots 0-39, opcodes 100-139 use slots 40-79
+ */
+#define VPROF_SLOTS         80
+#define VPROF_SLOT(opcode)  ((opcode) < 100 ? (opcode) : (opcode) - 60)
+
+/*
+ * The profile is published via the VPRF cookie, for tools/vdiprof.c.
+ * Times are counts of a timer running at vp_hz.
+ */
+typedef struct
+{
+    ULONG vp_calls;
+    ULONG vp_time_hi;           /* total time, high 32 bits */
+    ULONG vp_time;              /* total time, low 32 bits */
+    ULONG vp_max;               /* longest call */
+    ULONG vp_pixels;            /* estimate of the pixels drawn */
+} VDIPROFOP;
+
+typedef struct
+{
+    ULONG vp_calls;
+    ULONG vp_time_hi;           /* total time, high 32 bits */
+    ULONG vp_time;              /* total time, low 32 bits */
+} VDIPROFWK;
+
+typedef struct
+{
+    UWORD vp_slots;             /* VPROF_SLOTS */
+    UWORD vp_handles;           /* entries in vp_wk[], indexed by handle */
+    UWORD vp_enabled;           /* may be cleared to pause the profiling */
+    UWORD vp_reserved;
+    ULONG vp_hz;
+    VDIPROFOP vp_op[VPROF_SLOTS];
+    VDIPROFWK vp_wk[NUM_VDI_HANDLES+1];
+} VDIPROFILE;
+
+extern VDIPROFILE vdi_profile;
+
+void vdi_profile_init(void);
+ULONG vdi_profile_pixels(WORD opcode, Vwk *vwk);
+void vdi_profile_add(WORD opcode, WORD handle, ULONG pixels, ULONG start);
+
+#endif /* CONF_WITH_VDI_PROFILE */
+
+#endif /* VDI_PROFILE_H */
@@ -1211,12 +1211,8 @@ void vertical_line(const Line *line, WORD wrt_mode, UWORD color)
     WORD yinc;                  /* in/decrease for each y step */
     UWORD bit, bitcomp;
     WORD plane, loopcnt;
-    UWORD linemask;
-    WORD bit_inverted_linemask;
+    UWORD linemask = LN_MASK;
 
-    //bit_inverted_linemask = ((1 << 16) - 1) ^ (WORD)LINEMASK;
-
-    
     /* calculate increase value for y to add to actual address */
     dy = line->y2 - line->y1;
     yinc = v_lin_wr / 2;        /* one line of words */